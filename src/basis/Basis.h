@@ -54,6 +54,8 @@ int num_valence_elec(int);
 
 // Basis_ovlp.cpp
 void update_overlap_matrix(int,int,int,const VECTOR&,const VECTOR&,const VECTOR&, vector<AO>&,MATRIX&);
+void update_overlap_matrix(vector<AO>& basis_ao, MATRIX& Sao, vector< pair<int,int> >& pairs);
+double overlap_pairs(vector<AO>& basis_ao, MATRIX& Sao, double thresh, double skin, vector< pair<int,int> >& pairs);
 
 void MO_overlap(MATRIX& Smo, vector<AO>& ao_i, vector<AO>& ao_j, MATRIX& Ci, MATRIX& Cj,
  vector<int>& active_orb_i, vector<int>& active_orb_j, double max_d2);
@@ -145,6 +145,76 @@ void update_overlap_matrix(int x_period,int y_period,int z_period,const VECTOR&
 }
 
 
+void update_overlap_matrix(vector<AO>& basis_ao, MATRIX& Sao, vector< pair<int,int> >& pairs){
+/**
+  \brief Update the overlap matrix (in AO basis) only for the selected pairs of AOs, the rest is set to zero
+
+  \param[in] basis_ao The list of all AOs (basis)
+  \param[out] Sao The output overlap matrix
+  \param[in] pairs The pairs of AO indices (i<=j) for which the overlaps are computed - see overlap_pairs()
+
+  Only the central cell - no periodic images
+*/
+
+  int Norb = basis_ao.size();
+
+  Sao = 0.0;
+
+  for(int n=0;n<pairs.size();n++){
+    int i = pairs[n].first;
+    int j = pairs[n].second;
+
+    Sao.M[i*Norb+j] = gaussian_overlap(basis_ao[i],basis_ao[j]);
+    Sao.M[j*Norb+i] = Sao.M[i*Norb+j];
+  }
+
+}
+
+
+double overlap_pairs(vector<AO>& basis_ao, MATRIX& Sao, double thresh, double skin, vector< pair<int,int> >& pairs){
+/**
+  \brief Builds the list of the AO pairs with non-negligible overlaps, for the screened overlap updates
+
+  The cutoff distance is the largest distance between the centers of the AOs whose overlap (given in Sao, computed
+  for the present positions of AOs) is larger than thresh. The pairs closer than cutoff + skin are kept, so the list
+  stays valid as long as no atom moves by more than skin/2 from the present positions.
+
+  \param[in] basis_ao The list of all AOs (basis)
+  \param[in] Sao The overlap matrix at the present positions of AOs
+  \param[in] thresh The threshold for the overlaps
+  \param[in] skin The margin for the cutoff distance [Bohr]
+  \param[out] pairs The list of the pairs (i<=j)
+
+  Returns the cutoff distance
+*/
+
+  int i,j;
+  int Norb = basis_ao.size();
+
+  double r_cut = 0.0;
+  for(i=0;i<Norb;i++){
+    for(j=i+1;j<Norb;j++){
+      if(fabs(Sao.M[i*Norb+j])>thresh){
+        double r = (basis_ao[i].primitives[0].R - basis_ao[j].primitives[0].R).length();
+        if(r>r_cut){  r_cut = r;  }
+      }
+    }// for j
+  }// for i
+
+  double r2 = (r_cut + skin)*(r_cut + skin);
+
+  pairs.clear();
+  for(i=0;i<Norb;i++){
+    for(j=i;j<Norb;j++){
+      if((basis_ao[i].primitives[0].R - basis_ao[j].primitives[0].R).length2() < r2){  pairs.push_back(pair<int,int>(i,j));  }
+    }// for j
+  }// for i
+
+  return r_cut;
+
+}
+
+
 void pop_cols(MATRIX& X, MATRIX& x, vector<int>& cols){
 // Copies selected columns from X to x 
 
@@ -14,7 +14,11 @@
     
 */
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 #include "Fermi.h"
+#include "Purification.h"
 
 
 /// liblibra namespace
@@ -304,24 +308,21 @@ double Chebyshev_fit(MATRIX& H, MATRIX& P, double (*f)(double _x, double _y, dou
   vector<double> c_k(np+1,0.0);   Chebyshev_coeff(c_k, f, ef,de,np);
 
 
-  // Recursive definition of Chebyshev matrices
+  // Recursive definition of Chebyshev matrices - done in place, with two buffers
   P = 0.0;
-  MATRIX T_k(N,N);     
-  MATRIX T_prev1(N,N); 
-  MATRIX T_prev2(N,N); 
-  
-  for(int k=0;k<=np;k++){
-
-    if(k==0){  T_k.Init_Unit_Matrix(1.0);}
-    else if(k==1){  T_prev1 = T_k; T_k = H; }
-    else{
-      T_prev2 = T_prev1;  T_prev1 = T_k;
-      T_k = 2.0*H*T_prev1 - T_prev2; 
-    }
+  MATRIX A(N,N);  A.Init_Unit_Matrix(1.0);   // T_{k-1}
+  MATRIX B(H);                               // T_k
+  MATRIX* pa = &A;  MATRIX* pb = &B;
+
+  for(int n=0;n<N;n++){  P.M[n*N+n] += 0.5*c_k[0];  }
+  if(np>=1){  for(int n=0;n<N*N;n++){  P.M[n] += c_k[1] * H.M[n];  }  }
 
+  for(int k=2;k<=np;k++){
 
-    P += c_k[k] * T_k; 
-    if(k==0){  P -= 0.5*c_k[0]*T_k; }    // T_k is simply unity matrix in this case
+    Chebyshev_step(&H, pb, pa, -1.0);   // now pa = T_k
+    MATRIX* t = pa; pa = pb; pb = t;
+
+    for(int n=0;n<N*N;n++){  P.M[n] += c_k[k] * pb->M[n];  }
 
   }// for k
 
@@ -330,6 +331,267 @@ double Chebyshev_fit(MATRIX& H, MATRIX& P, double (*f)(double _x, double _y, dou
 }
 
 
+void Chebyshev_step(MATRIX* H, MATRIX* T_curr, MATRIX* T_prev, double thresh){
+/**
+  One step of the Chebyshev matrix recurrence, done in place: T_prev <- 2 * H * T_curr - T_prev,
+  so on return T_prev contains the next polynomial and no temporary matrices are created.
+  The rows are distributed over the threads and the columns are processed by blocks, so the
+  used part of T_curr stays in cache. The elements of H not larger than thresh are skipped
+  (thresh < 0 - the exact product).
+
+  \param[in] H The (scaled) Hamiltonian
+  \param[in] T_curr The current polynomial T_k(H)
+  \param[in,out] T_prev On input - T_{k-1}(H), on output - T_{k+1}(H). Must be different from H and T_curr
+*/
+
+  int N = H->n_rows;
+  int M = T_curr->n_cols;
+  const int blk = 128;
+
+  if(T_prev==H || T_prev==T_curr){
+    cout<<"Error in Chebyshev_step: the output matrix must be different from the input matrices\nExiting...\n";
+    exit(0);
+  }
+
+  double* h = H->M;
+  double* t = T_curr->M;
+  double* tp = T_prev->M;
+
+  #pragma omp parallel for schedule(static)
+  for(int i=0;i<N;i++){
+
+    double* r = &tp[i*M];
+    for(int j=0;j<M;j++){  r[j] = -r[j];  }
+
+    for(int j0=0;j0<M;j0+=blk){
+      int j1 = (j0+blk<M) ? j0+blk : M;
+
+      for(int k=0;k<N;k++){
+        double a = h[i*N+k];
+        if(fabs(a)<=thresh){ continue; }
+
+        a *= 2.0;
+        double* b = &t[k*M];
+        for(int j=j0;j<j1;j++){  r[j] += a * b[j];  }
+      }// for k
+    }// for j0
+
+  }// for i
+
+}
+
+
+
+Chebyshev_FOE::Chebyshev_FOE(MATRIX& H, int _np, double _thresh) : Hs(H.n_rows, H.n_cols){
+/**
+  \brief Constructor: maps the spectrum of H on [-1,1] and computes the Chebyshev moments
+
+  \param[in] H The Hamiltonian matrix in an orthogonal basis
+  \param[in] _np The order of the Chebyshev expansion
+  \param[in] _thresh The threshold for the matrix products
+*/
+
+  int j, k, n;
+
+  N = H.n_cols;
+  np = _np;
+  thresh = _thresh;
+
+  double emin, emax;
+  spectral_bounds(&H, emin, emax);
+  e0 = 0.5*(emax + emin);
+  de = 0.5*(emax - emin) + 1e-10;
+
+  for(n=0;n<N*N;n++){  Hs.M[n] = H.M[n] / de;  }
+  for(n=0;n<N;n++){  Hs.M[n*N+n] -= e0 / de;  }
+
+
+  // The nodes and the polynomials at the nodes
+  x_k = vector<double>(np, 0.0);
+  T_nodes = vector<double>(np*np, 0.0);
+  for(k=0;k<np;k++){
+    double th = (k+0.5)*M_PI/(double)np;
+    x_k[k] = cos(th);
+    for(j=0;j<np;j++){  T_nodes[k*np+j] = cos(j*th);  }
+  }
+
+
+  // The moments: T_k and T_{k+1} give mu_{2k} and mu_{2k+1}
+  mu = vector<double>(np, 0.0);
+
+  MATRIX A(N,N);  A.Init_Unit_Matrix(1.0);
+  MATRIX B(Hs);
+  MATRIX* pa = &A;  MATRIX* pb = &B;
+
+  double mu0 = (double)N;
+  double mu1 = Hs.tr();
+
+  for(k=0;2*k<np;k++){
+
+    mu[2*k] = 2.0*trace_prod(pa, pa) - mu0;
+    if(2*k+1<np){  mu[2*k+1] = 2.0*trace_prod(pb, pa) - mu1;  }
+
+    if(2*k+2<np){
+      Chebyshev_step(&Hs, pb, pa, thresh);
+      MATRIX* t = pa; pa = pb; pb = t;
+    }
+  }
+
+
+  // Population weights of the nodes
+  w = vector<double>(np, 0.0);
+  for(k=0;k<np;k++){
+    double s = -0.5*mu[0];
+    for(j=0;j<np;j++){  s += T_nodes[k*np+j] * mu[j];  }
+    w[k] = s * 2.0 / (double)np;
+  }
+
+}
+
+
+void Chebyshev_FOE::coefficients(double (*f)(double _x, double _y, double _z), double ef, double kT, vector<double>& c){
+/**
+  \brief The Chebyshev expansion coefficients of the function f(e, ef, kT), using the precomputed nodes
+
+  \param[in] f The function, e.g. p_ef
+  \param[in] ef, kT The parameters of the function, in the units of the original H
+  \param[out] c The coefficients c[0]...c[np-1]
+*/
+
+  vector<double> f_k(np, 0.0);
+  for(int k=0;k<np;k++){  f_k[k] = f(x_k[k], (ef - e0)/de, kT/de) * 2.0 / (double)np;  }
+
+  c = vector<double>(np, 0.0);
+  for(int k=0;k<np;k++){
+    for(int j=0;j<np;j++){  c[j] += f_k[k] * T_nodes[k*np+j];  }
+  }
+
+}
+
+
+double Chebyshev_FOE::population(double ef, double kT){
+/**
+  \brief Tr(f(H)) for the Fermi function f with the chemical potential ef and broadening kT - from the moments only
+*/
+
+  double res = 0.0;
+  for(int k=0;k<np;k++){  res += p_ef(x_k[k], (ef - e0)/de, kT/de) * w[k];  }
+
+  return res;
+
+}
+
+
+double Chebyshev_FOE::chemical_potential(double Nocc, double kT, double ntol){
+/**
+  \brief The chemical potential at which Tr(P) = Nocc, found by bisection on the moments
+
+  \param[in] Nocc The number of occupied orbitals
+  \param[in] kT Broadening of the Fermi distribution
+  \param[in] ntol The tolerance for the number of the occupied orbitals
+*/
+
+  double ef_lo = e0 - de;  double ef_hi = e0 + de;  double ef = e0;
+
+  for(int iter=0;iter<200;iter++){
+
+    ef = 0.5*(ef_lo + ef_hi);
+    double nel = population(ef, kT);
+
+    if(fabs(nel - Nocc)<ntol){ break; }
+    if(nel<Nocc){  ef_lo = ef; }
+    else{ ef_hi = ef; }
+  }
+
+  return ef;
+
+}
+
+
+void Chebyshev_FOE::expand(vector<double>& c, MATRIX& P){
+/**
+  \brief P = sum_k c_k T_k(Hs) - c_0/2, the matrix polynomials are computed in place
+
+  \param[in] c The expansion coefficients, up to np of them are used
+  \param[out] P The result - must be allocated (N x N)
+*/
+
+  int n, k;
+  int nc = (c.size()<np) ? c.size() : np;
+
+  if(P.n_rows!=N || P.n_cols!=N){
+    cout<<"Error in Chebyshev_FOE::expand: the output matrix must be of the dimension "<<N<<" x "<<N<<"\nExiting...\n";
+    exit(0);
+  }
+
+  P = 0.0;
+  if(nc==0){ return; }
+
+  for(n=0;n<N;n++){  P.M[n*N+n] += 0.5*c[0];  }
+  if(nc>=2){  for(n=0;n<N*N;n++){  P.M[n] += c[1] * Hs.M[n];  }  }
+
+  MATRIX A(N,N);  A.Init_Unit_Matrix(1.0);
+  MATRIX B(Hs);
+  MATRIX* pa = &A;  MATRIX* pb = &B;
+
+  for(k=2;k<nc;k++){
+
+    Chebyshev_step(&Hs, pb, pa, thresh);
+    MATRIX* t = pa; pa = pb; pb = t;
+
+    double ck = c[k];
+    double* p = P.M;
+    double* x = pb->M;
+    #pragma omp parallel for schedule(static)
+    for(int m=0;m<N*N;m++){  p[m] += ck * x[m];  }
+
+  }// for k
+
+}
+
+
+void Chebyshev_FOE::density_matrix(double ef, double kT, MATRIX& P){
+/**
+  \brief The density matrix (occupations in [0,1]) for the chemical potential ef and broadening kT
+
+  \param[out] P The density matrix - must be allocated (N x N)
+*/
+
+  vector<double> c;
+  coefficients(p_ef, ef, kT, c);
+  expand(c, P);
+
+}
+
+
+
+double Chebyshev_density_matrix(MATRIX* H, MATRIX* P, double Nocc, double kT, int np, double thresh){
+/**
+  \brief Fermi operator expansion of the density matrix: P = f(H), with f - the Fermi function
+
+  The chemical potential is chosen such that Tr(P) = Nocc, see the Chebyshev_FOE class.
+
+  \param[in] H The Hamiltonian matrix in an orthogonal basis
+  \param[out] P The density matrix (occupations in [0,1]) - must be allocated
+  \param[in] Nocc The number of occupied orbitals
+  \param[in] kT Broadening factor for the Fermi distribution [a.u. of energy]
+  \param[in] np The order of the Chebyshev expansion
+  \param[in] thresh The threshold for the matrix products
+
+  Returns the chemical potential
+*/
+
+  Chebyshev_FOE foe(*H, np, thresh);
+
+  double ef = foe.chemical_potential(Nocc, kT, 1e-12);
+  foe.density_matrix(ef, kT, *P);
+
+  return ef;
+
+}
+
+
+
 
 
 
@@ -54,6 +54,42 @@ double p_dn(double e, double e_dn, double de);
 double p_ef(double e, double ef, double de);
 void Chebyshev_coeff(vector<double>& C, double (*f)(double x, double y, double z), double ef, double de, int N);
 double Chebyshev_fit(MATRIX& H, MATRIX& P, double (*f)(double _x, double _y, double _z), double ef, double de, int np);
+double Chebyshev_density_matrix(MATRIX* H, MATRIX* P, double Nocc, double kT, int np, double thresh);
+void Chebyshev_step(MATRIX* H, MATRIX* T_curr, MATRIX* T_prev, double thresh);
+
+
+class Chebyshev_FOE{
+/**
+  Fermi operator expansion engine. The spectrum of H is mapped on [-1,1] and the Chebyshev moments
+  mu_k = Tr(T_k(H)) are computed once (from T_0...T_{np/2} only, using T_{2k} = 2T_k^2 - I and
+  T_{2k+1} = 2T_{k+1}T_k - T_1). The moments are folded with the table of T_k at the Chebyshev nodes,
+  so the population at any trial chemical potential costs np scalar operations - the bisection for the
+  chemical potential does not touch the matrices. The density matrix is built once, at the end.
+*/
+
+  vector<double> T_nodes;     ///< T_j(x_k) at the Chebyshev nodes: T_nodes[k*np+j]
+  vector<double> w;           ///< population weights of the nodes: n(ef) = sum_k f(x_k, ef) * w[k]
+
+public:
+
+  int N;                      ///< the dimension of H
+  int np;                     ///< the order of the expansion
+  double e0;                  ///< the spectrum of H is mapped on [-1,1]: x = (e - e0)/de
+  double de;
+  double thresh;              ///< the elements of H not larger than this are skipped in the matrix products
+  MATRIX Hs;                  ///< the scaled Hamiltonian
+  vector<double> x_k;         ///< the Chebyshev nodes
+  vector<double> mu;          ///< the moments Tr(T_k(Hs)), k = 0...np-1
+
+  Chebyshev_FOE(MATRIX& H, int _np, double _thresh);
+
+  void coefficients(double (*f)(double _x, double _y, double _z), double ef, double kT, vector<double>& c);
+  double population(double ef, double kT);
+  double chemical_potential(double Nocc, double kT, double ntol);
+  void expand(vector<double>& c, MATRIX& P);
+  void density_matrix(double ef, double kT, MATRIX& P);
+
+};
 
 
 }// namespace libcalculators
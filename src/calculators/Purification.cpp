@@ -0,0 +1,466 @@
+/*********************************************************************************
+* Copyright (C) 2015 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Purification.cpp
+  \brief The file implements functions for computing the density matrix from the Fock matrix without
+  diagonalization: density matrix purification and Fermi operator expansion
+
+  All the methods only use matrix multiplications, which are done with the thresholded sparse multiplication,
+  so for the systems with the localized (nearly sparse) density matrices the number of floating point operations
+  is reduced. The matrices are still stored and scanned in the dense format, so the cost of every product
+  is at least O(N^2) and these methods do not scale linearly with the size of the system.
+*/
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+#include "Purification.h"
+#include "Fermi.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+
+/// libcalculators namespace
+namespace libcalculators{
+
+
+
+void sparse_mult(MATRIX* A, MATRIX* B, MATRIX* C, double thresh){
+/**
+  \brief Thresholded multiplication of the matrices: C = A * B
+
+  The matrices are stored in the dense format, but the elements of A and B that are not larger than thresh
+  in magnitude are skipped, so the number of multiply-adds scales with the number of non-negligible elements,
+  while all the N*K elements of A and K*M elements of B are still scanned. The elements of
+  the product that are not larger than thresh are set to zero, which keeps the matrices sparse during the
+  iterative procedures. With thresh < 0 the product is exact.
+
+  \param[in] A The left matrix
+  \param[in] B The right matrix
+  \param[out] C The product - must be allocated and must be different from A and B
+  \param[in] thresh The threshold for the matrix elements
+*/
+
+  int j,k;
+  int N = A->n_rows;
+  int K = A->n_cols;
+  int M = B->n_cols;
+
+  if(K!=B->n_rows || C->n_rows!=N || C->n_cols!=M){
+    cout<<"Error in sparse_mult: the dimensions of the matrices are not consistent\nExiting...\n";
+    exit(0);
+  }
+  if(C==A || C==B){
+    cout<<"Error in sparse_mult: the output matrix must be different from the input matrices\nExiting...\n";
+    exit(0);
+  }
+
+  // The non-negligible elements of the rows of B; the rows that are mostly filled are processed as dense ones
+  vector< vector<int> > nz(K);
+  vector<int> is_dense(K, 0);
+  for(k=0;k<K;k++){
+    for(j=0;j<M;j++){
+      if(fabs(B->M[k*M+j])>thresh){  nz[k].push_back(j);  }
+    }
+    if(2*nz[k].size() > M){  is_dense[k] = 1; }
+  }
+
+  *C = 0.0;
+
+  // The rows of C are independent - distributed over the threads
+  #pragma omp parallel for schedule(dynamic, 16)
+  for(int i=0;i<N;i++){
+    double* c = &C->M[i*M];
+
+    for(int k=0;k<K;k++){
+      double a = A->M[i*K+k];
+      if(fabs(a)<=thresh){ continue; }
+
+      double* b = &B->M[k*M];
+      if(is_dense[k]){  for(int j=0;j<M;j++){  c[j] += a * b[j];  }  }
+      else{
+        const int* ind = nz[k].data();
+        int sz = nz[k].size();
+        for(int n=0;n<sz;n++){  c[ind[n]] += a * b[ind[n]];  }
+      }
+    }// for k
+
+    if(thresh>0.0){
+      for(int j=0;j<M;j++){  if(fabs(c[j])<=thresh){  c[j] = 0.0; }  }
+    }
+  }// for i
+
+}
+
+
+void spectral_bounds(MATRIX* H, double& emin, double& emax){
+/**
+  \brief Gershgorin estimate of the spectral bounds of a symmetric matrix
+
+  \param[in] H The matrix
+  \param[out] emin The lower bound of the eigenvalues
+  \param[out] emax The upper bound of the eigenvalues
+*/
+
+  int N = H->n_rows;
+
+  for(int i=0;i<N;i++){
+    double r = 0.0;
+    for(int j=0;j<N;j++){  if(j!=i){  r += fabs(H->M[i*N+j]); }  }
+
+    double lo = H->M[i*N+i] - r;
+    double hi = H->M[i*N+i] + r;
+
+    if(i==0 || lo<emin){ emin = lo; }
+    if(i==0 || hi>emax){ emax = hi; }
+  }
+
+}
+
+
+double trace_prod(MATRIX* A, MATRIX* B){
+/**
+  Tr(A * B) for the symmetric matrix B, computed without forming the product
+*/
+  double res = 0.0;
+  int sz = A->n_elts;
+  #pragma omp parallel for reduction(+:res) schedule(static)
+  for(int n=0;n<sz;n++){  res += A->M[n] * B->M[n];  }
+  return res;
+}
+
+
+
+int inverse_sqrt_ns(MATRIX* S, MATRIX* Z, double thresh, double tol, int max_iter){
+/**
+  \brief Computes S^{-1/2} of a symmetric positive-definite matrix with the coupled Newton-Schulz iterations
+
+  The matrix is scaled by the upper bound of its spectrum, c, and the iterations
+
+     T_k = (3*I - Z_k * Y_k)/2,   Y_{k+1} = Y_k * T_k,   Z_{k+1} = T_k * Z_k
+
+  starting from Y_0 = S/c, Z_0 = I converge to Y = (S/c)^{1/2} and Z = (S/c)^{-1/2}
+
+  \param[in] S The matrix (the AO overlap matrix)
+  \param[out] Z The inverse square root of S - must be allocated
+  \param[in] thresh The threshold for the sparse matrix multiplications
+  \param[in] tol Convergence criterium: |T - I| < tol (Frobenius norm)
+  \param[in] max_iter The maximal number of iterations
+
+  Returns the number of iterations done
+*/
+
+  int N = S->n_rows;
+  int n, iter;
+
+  double emin, emax;
+  spectral_bounds(S, emin, emax);
+  double c = emax;
+
+  MATRIX Y(N,N); MATRIX T(N,N); MATRIX tmp(N,N);
+
+  for(n=0;n<N*N;n++){  Y.M[n] = S->M[n] / c;  }
+  Z->Init_Unit_Matrix(1.0);
+
+  for(iter=1;iter<=max_iter;iter++){
+
+    sparse_mult(Z, &Y, &T, thresh);
+
+    double err = 0.0;
+    for(n=0;n<N*N;n++){  T.M[n] = -0.5*T.M[n];  }
+    for(n=0;n<N;n++){  T.M[n*N+n] += 1.5; }
+    for(n=0;n<N*N;n++){  double d = T.M[n] - ((n%(N+1))==0 ? 1.0 : 0.0);  err += d*d;  }
+
+    sparse_mult(&Y, &T, &tmp, thresh);  Y = tmp;
+    sparse_mult(&T, Z, &tmp, thresh);  *Z = tmp;
+
+    if(sqrt(err)<tol){ break; }
+  }
+
+  if(iter>max_iter){  cout<<"Warning in inverse_sqrt_ns: not converged in "<<max_iter<<" iterations\n";  iter = max_iter; }
+
+  *Z = *Z / sqrt(c);
+
+  return iter;
+
+}
+
+
+
+int purify_mcweeny(MATRIX* H, double Nocc, MATRIX* P, double thresh, double tol, int max_iter){
+/**
+  \brief Canonical McWeeny purification [Palser, Manolopoulos, PRB 58, 12704 (1998)]
+
+  The initial guess is the linear function of H with the trace Nocc and the eigenvalues in [0,1], and
+  the McWeeny-like steps preserve the trace, so the chemical potential is not needed.
+
+  \param[in] H The Hamiltonian (Fock) matrix in an orthogonal basis
+  \param[in] Nocc The number of occupied orbitals
+  \param[out] P The density matrix (projector on the Nocc lowest eigenstates of H) - must be allocated
+  \param[in] thresh The threshold for the sparse matrix multiplications
+  \param[in] tol Convergence criterium: Tr(P - P^2) < tol
+  \param[in] max_iter The maximal number of iterations
+
+  Returns the number of iterations done
+*/
+
+  int N = H->n_rows;
+  int n, iter;
+
+  double emin, emax;
+  spectral_bounds(H, emin, emax);
+
+  double mu = H->tr() / (double)N;
+  double lambda = min( Nocc/(emax - mu + 1e-14), ((double)N - Nocc)/(mu - emin + 1e-14) );
+
+  for(n=0;n<N*N;n++){  P->M[n] = -lambda/N * H->M[n];  }
+  for(n=0;n<N;n++){  P->M[n*N+n] += lambda/N * mu + Nocc/N;  }
+
+  MATRIX P2(N,N); MATRIX P3(N,N);
+
+  for(iter=1;iter<=max_iter;iter++){
+
+    sparse_mult(P, P, &P2, thresh);
+    sparse_mult(&P2, P, &P3, thresh);
+
+    double trP = P->tr();
+    double trP2 = P2.tr();
+    double trP3 = P3.tr();
+
+    double idem = trP - trP2;
+    if(fabs(idem)<tol){ break; }
+
+    double c = (trP2 - trP3) / idem;
+
+    if(c>=0.5){
+      for(n=0;n<N*N;n++){  P->M[n] = ((1.0 + c)*P2.M[n] - P3.M[n]) / c;  }
+    }
+    else{
+      for(n=0;n<N*N;n++){  P->M[n] = ((1.0 - 2.0*c)*P->M[n] + (1.0 + c)*P2.M[n] - P3.M[n]) / (1.0 - c);  }
+    }
+
+  }// for iter
+
+  if(iter>max_iter){  cout<<"Warning in purify_mcweeny: not converged in "<<max_iter<<" iterations\n";  iter = max_iter; }
+
+  return iter;
+
+}
+
+
+
+int purify_trs4(MATRIX* H, double Nocc, MATRIX* P, double thresh, double tol, int max_iter){
+/**
+  \brief Trace-resetting 4-th order purification [Niklasson, Tymczak, Challacombe, JCP 118, 8611 (2003)]
+
+  The steps are X -> F(X) + gamma * G(X), with F(X) = X^2(4X - 3X^2), G(X) = X^2(I - X)^2 and gamma chosen
+  to give Tr = Nocc; when gamma is out of [0,6], the second-order steps X^2 or 2X - X^2 are used.
+  The traces of the 3-rd and 4-th powers are computed from X and X^2 without the extra multiplications.
+
+  \param[in] H The Hamiltonian (Fock) matrix in an orthogonal basis
+  \param[in] Nocc The number of occupied orbitals
+  \param[out] P The density matrix (projector on the Nocc lowest eigenstates of H) - must be allocated
+  \param[in] thresh The threshold for the sparse matrix multiplications
+  \param[in] tol Convergence criterium: |Tr(P - P^2)| < tol
+  \param[in] max_iter The maximal number of iterations
+
+  Returns the number of iterations done
+*/
+
+  int N = H->n_rows;
+  int n, iter;
+
+  double emin, emax;
+  spectral_bounds(H, emin, emax);
+
+  // X0 = (emax - H)/(emax - emin) - all eigenvalues in [0,1], in the reverse order
+  for(n=0;n<N*N;n++){  P->M[n] = -H->M[n] / (emax - emin);  }
+  for(n=0;n<N;n++){  P->M[n*N+n] += emax / (emax - emin);  }
+
+  MATRIX X2(N,N); MATRIX M(N,N);
+
+  for(iter=1;iter<=max_iter;iter++){
+
+    sparse_mult(P, P, &X2, thresh);
+
+    double trX = P->tr();
+    double trX2 = X2.tr();
+    if(fabs(trX - trX2)<tol){ break; }
+
+    double trX3 = trace_prod(&X2, P);
+    double trX4 = trace_prod(&X2, &X2);
+
+    double trF = 4.0*trX3 - 3.0*trX4;
+    double trG = trX2 - 2.0*trX3 + trX4;
+    double gamma = (trG>1e-14) ? (Nocc - trF)/trG : 0.0;
+
+    if(gamma>=0.0 && gamma<=6.0){
+      // F + gamma*G = X^2 * ( gamma*I + (4 - 2*gamma)*X + (gamma - 3)*X^2 )
+      for(n=0;n<N*N;n++){  M.M[n] = (4.0 - 2.0*gamma)*P->M[n] + (gamma - 3.0)*X2.M[n];  }
+      for(n=0;n<N;n++){  M.M[n*N+n] += gamma;  }
+      sparse_mult(&X2, &M, P, thresh);
+    }
+    else if(gamma<0.0){  *P = X2;  }
+    else{
+      for(n=0;n<N*N;n++){  P->M[n] = 2.0*P->M[n] - X2.M[n];  }
+    }
+
+  }// for iter
+
+  if(iter>max_iter){  cout<<"Warning in purify_trs4: not converged in "<<max_iter<<" iterations\n";  iter = max_iter; }
+
+  return iter;
+
+}
+
+
+
+int purify_sp2(MATRIX* H, double Nocc, MATRIX* P, double thresh, double tol, int max_iter){
+/**
+  \brief Second-order spectral projection purification [Niklasson, PRB 66, 155115 (2002)]
+
+  At every step either X^2 or 2X - X^2 is taken, whichever brings the trace closer to Nocc.
+  One matrix multiplication per iteration.
+
+  \param[in] H The Hamiltonian (Fock) matrix in an orthogonal basis
+  \param[in] Nocc The number of occupied orbitals
+  \param[out] P The density matrix (projector on the Nocc lowest eigenstates of H) - must be allocated
+  \param[in] thresh The threshold for the sparse matrix multiplications
+  \param[in] tol Convergence criterium: |Tr(P - P^2)| < tol
+  \param[in] max_iter The maximal number of iterations
+
+  Returns the number of iterations done
+*/
+
+  int N = H->n_rows;
+  int n, iter;
+
+  double emin, emax;
+  spectral_bounds(H, emin, emax);
+
+  for(n=0;n<N*N;n++){  P->M[n] = -H->M[n] / (emax - emin);  }
+  for(n=0;n<N;n++){  P->M[n*N+n] += emax / (emax - emin);  }
+
+  MATRIX X2(N,N);
+
+  for(iter=1;iter<=max_iter;iter++){
+
+    sparse_mult(P, P, &X2, thresh);
+
+    double trX = P->tr();
+    double trX2 = X2.tr();
+    if(fabs(trX - trX2)<tol){ break; }
+
+    if(fabs(trX2 - Nocc) < fabs(2.0*trX - trX2 - Nocc)){  *P = X2;  }
+    else{
+      for(n=0;n<N*N;n++){  P->M[n] = 2.0*P->M[n] - X2.M[n];  }
+    }
+
+  }// for iter
+
+  if(iter>max_iter){  cout<<"Warning in purify_sp2: not converged in "<<max_iter<<" iterations\n";  iter = max_iter; }
+
+  return iter;
+
+}
+
+
+
+void Fock_to_P_purify(std::string method, MATRIX* Fao, MATRIX* Sao, double Nocc,
+                      double thresh, double tol, int max_iter, double kT, int np, MATRIX* P){
+/**
+  \brief Computes the density matrix from the Fock matrix without diagonalization
+
+  For the non-orthogonal basis, the Fock matrix is transformed with Z = S^{-1/2} (computed by the Newton-Schulz
+  iterations): H = Z * F * Z, the orthogonal-basis density matrix X is computed for H, and P = Z * X * Z.
+  The transformation is skipped if S is the identity matrix (e.g. for INDO/CNDO).
+  The orbitals and the orbital energies are not computed.
+
+  \param[in] method The method to use: "mcweeny", "trs4", "sp2" (purification, integer occupations)
+             or "foe" (Chebyshev Fermi operator expansion, the Fermi occupations with the broadening kT)
+  \param[in] Fao The pointer to the Fock matrix
+  \param[in] Sao The pointer to the AO overlap matrix
+  \param[in] Nocc The number of occupied orbitals (each with the occupation 1)
+  \param[in] thresh The threshold for the sparse matrix multiplications
+  \param[in] tol Convergence criterium of the iterative procedures
+  \param[in] max_iter The maximal number of iterations
+  \param[in] kT Broadening factor for the Fermi distribution (only for "foe")
+  \param[in] np The order of the Chebyshev expansion (only for "foe")
+  \param[out] P The pointer to the density matrix - must be allocated
+*/
+
+  int N = Fao->n_rows;
+  int n;
+
+  // Is the basis orthogonal?
+  int is_orth = 1;
+  for(n=0;n<N*N && is_orth;n++){
+    double d = Sao->M[n] - ((n%(N+1))==0 ? 1.0 : 0.0);
+    if(fabs(d)>1e-12){ is_orth = 0; }
+  }
+
+  MATRIX H(N,N); MATRIX X(N,N); MATRIX Z(N,N); MATRIX tmp(N,N);
+
+  if(is_orth){  H = *Fao;  }
+  else{
+    inverse_sqrt_ns(Sao, &Z, thresh, tol, max_iter);
+    sparse_mult(&Z, Fao, &tmp, thresh);
+    sparse_mult(&tmp, &Z, &H, thresh);
+  }
+
+
+  if(Nocc<=0.0){  X = 0.0;  }
+  else if(Nocc>=N){  X.Init_Unit_Matrix(1.0); }
+  else if(method=="mcweeny"){  purify_mcweeny(&H, Nocc, &X, thresh, tol, max_iter);  }
+  else if(method=="trs4"){  purify_trs4(&H, Nocc, &X, thresh, tol, max_iter);  }
+  else if(method=="sp2"){  purify_sp2(&H, Nocc, &X, thresh, tol, max_iter);  }
+  else if(method=="foe"){  Chebyshev_density_matrix(&H, &X, Nocc, kT, np, thresh);  }
+  else{
+    cout<<"Error in Fock_to_P_purify: method = "<<method<<" is not known\n";
+    cout<<"Possible options are: mcweeny, trs4, sp2, foe\nExiting...\n";
+    exit(0);
+  }
+
+
+  if(is_orth){  *P = X;  }
+  else{
+    sparse_mult(&Z, &X, &tmp, thresh);
+    sparse_mult(&tmp, &Z, P, thresh);
+  }
+
+}
+
+
+MATRIX Fock_to_P_purify(std::string method, MATRIX& Fao, MATRIX& Sao, double Nocc,
+                        double thresh, double tol, int max_iter, double kT, int np){
+/**
+  \brief Computes the density matrix from the Fock matrix without diagonalization - Python-friendly version
+
+  See the description of the pointer version for the meaning of the parameters. Returns the density matrix
+*/
+
+  MATRIX P(Fao.n_rows, Fao.n_cols);
+
+  Fock_to_P_purify(method, &Fao, &Sao, Nocc, thresh, tol, max_iter, kT, np, &P);
+
+  return P;
+
+}
+
+
+
+}// namespace libcalculators
+}// liblibra
+
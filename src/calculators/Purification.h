@@ -0,0 +1,52 @@
+/*********************************************************************************
+* Copyright (C) 2015 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Purification.h
+  \brief The file describes functions for computing the density matrix from the Fock matrix without
+  diagonalization: density matrix purification and Fermi operator expansion
+
+*/
+
+#ifndef PURIFICATION_H
+#define PURIFICATION_H
+
+#include "../math_linalg/liblinalg.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+
+/// libcalculators namespace
+namespace libcalculators{
+
+
+void sparse_mult(MATRIX* A, MATRIX* B, MATRIX* C, double thresh);
+void spectral_bounds(MATRIX* H, double& emin, double& emax);
+double trace_prod(MATRIX* A, MATRIX* B);
+
+int inverse_sqrt_ns(MATRIX* S, MATRIX* Z, double thresh, double tol, int max_iter);
+
+int purify_mcweeny(MATRIX* H, double Nocc, MATRIX* P, double thresh, double tol, int max_iter);
+int purify_trs4(MATRIX* H, double Nocc, MATRIX* P, double thresh, double tol, int max_iter);
+int purify_sp2(MATRIX* H, double Nocc, MATRIX* P, double thresh, double tol, int max_iter);
+
+void Fock_to_P_purify(std::string method, MATRIX* Fao, MATRIX* Sao, double Nocc,
+                      double thresh, double tol, int max_iter, double kT, int np, MATRIX* P);
+MATRIX Fock_to_P_purify(std::string method, MATRIX& Fao, MATRIX& Sao, double Nocc,
+                        double thresh, double tol, int max_iter, double kT, int np);
+
+
+}// namespace libcalculators
+}// liblibra
+
+#endif // PURIFICATION_H
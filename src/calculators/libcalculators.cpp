@@ -71,6 +71,23 @@ void export_calculators_objects(){
   def("fermi_p_ef", expt_p_ef_v1);
 
 
+  class_<Chebyshev_FOE>("Chebyshev_FOE",init<MATRIX&, int, double>())
+      .def_readwrite("N",&Chebyshev_FOE::N)
+      .def_readwrite("np",&Chebyshev_FOE::np)
+      .def_readwrite("e0",&Chebyshev_FOE::e0)
+      .def_readwrite("de",&Chebyshev_FOE::de)
+      .def_readwrite("thresh",&Chebyshev_FOE::thresh)
+      .def_readwrite("Hs",&Chebyshev_FOE::Hs)
+      .def_readwrite("x_k",&Chebyshev_FOE::x_k)
+      .def_readwrite("mu",&Chebyshev_FOE::mu)
+
+      .def("population", &Chebyshev_FOE::population)
+      .def("chemical_potential", &Chebyshev_FOE::chemical_potential)
+      .def("expand", &Chebyshev_FOE::expand)
+      .def("density_matrix", &Chebyshev_FOE::density_matrix)
+  ;
+
+
 
 
 
@@ -102,6 +119,13 @@ void export_calculators_objects(){
 
 
 
+  //----------------- Purification.cpp ------------------------
+  MATRIX (*expt_Fock_to_P_purify_v1)(std::string method, MATRIX& Fao, MATRIX& Sao, double Nocc,
+                        double thresh, double tol, int max_iter, double kT, int np) = &Fock_to_P_purify;
+  def("Fock_to_P_purify",expt_Fock_to_P_purify_v1);
+
+
+
 
   //----------------- Excitations.cpp ---------------------------
   boost::python::list (*expt_excite_v1)(int I, int J, boost::python::list occ_ini) = &excite;
@@ -26,6 +26,7 @@
 #include "Density_Matrix.h"
 #include "Excitations.h"
 #include "Mulliken.h"
+#include "Purification.h"
 
 /// liblibra namespace
 namespace liblibra{
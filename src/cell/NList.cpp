@@ -14,6 +14,9 @@
     
 */
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 #include "NList.h"
 
 /// liblibra namespace
@@ -820,6 +823,323 @@ void make_nlist_auto(int Nat,VECTOR* r,MATRIX3x3& H,
 }
 
 
+void build_cell_list(int Nat, vector<VECTOR>& s, int Na, int Nb, int Nc,
+                     vector<int>& at2cell, vector<int>& cell_start, vector<int>& cell_atoms){
+/**
+  \brief Sort the atoms into the sub-cells using the counting sort
+
+  The simulation cell is split into Na x Nb x Nc sub-cells along its lattice vectors. The atoms are
+  binned in three passes: count the number of atoms per sub-cell, convert the counts into the 
+  starting positions (prefix sum), and place the atom indices. There are no per-cell containers: 
+  all the atoms of the sub-cell c are cell_atoms[cell_start[c]], ..., cell_atoms[cell_start[c+1]-1]
+
+  \param[in] Nat The number of atoms
+  \param[in] s The fractional coordinates of all atoms, folded into [0,1)
+  \param[in] Na, Nb, Nc The number of sub-cells along each of the lattice vectors
+  \param[out] at2cell The sub-cell index for each atom
+  \param[out] cell_start The CSR pointers: Na*Nb*Nc + 1 elements
+  \param[out] cell_atoms The atom indices sorted by the sub-cell
+
+*/
+
+  int i, c;
+  int Ncells = Na*Nb*Nc;
+
+  at2cell.resize(Nat);
+  cell_start.assign(Ncells+1, 0);
+  cell_atoms.resize(Nat);
+
+  // Pass 1: count
+  for(i=0;i<Nat;i++){
+    int ia = int(s[i].x * Na);  if(ia>=Na){ ia = Na-1; } if(ia<0){ ia = 0; }
+    int ib = int(s[i].y * Nb);  if(ib>=Nb){ ib = Nb-1; } if(ib<0){ ib = 0; }
+    int ic = int(s[i].z * Nc);  if(ic>=Nc){ ic = Nc-1; } if(ic<0){ ic = 0; }
+    c = (ia*Nb + ib)*Nc + ic;
+    at2cell[i] = c;
+    cell_start[c+1]++;
+  }
+
+  // Pass 2: prefix sum
+  for(c=0;c<Ncells;c++){ cell_start[c+1] += cell_start[c]; }
+
+  // Pass 3: fill
+  vector<int> pos(cell_start.begin(), cell_start.end()-1);
+  for(i=0;i<Nat;i++){ cell_atoms[pos[at2cell[i]]++] = i; }
+
+}
+
+
+void make_nlist_csr(int Nat,VECTOR* r,MATRIX3x3& H, double Roff, vector<int>& offset, vector<quartet>& neib){
+/**
+  \brief Create the neighbor list in the CSR format with the linear-scaling cell-list algorithm
+
+  This is the counterpart of make_nlist_auto that does not replicate the atoms into the periodic
+  images and does not allocate per-cell lists:
+
+  1) The atoms are folded into the simulation cell and binned into sub-cells, whose widths 
+     (measured perpendicular to the cell faces) are not smaller than Roff, with the counting sort 
+     (see build_cell_list). Periodic images are reached by wrapping the sub-cell indices.
+  2) Only the "half-shell" stencil of the sub-cell offsets is visited (the offsets that are
+     lexicographically larger than (0,0,0) plus the own sub-cell with j > i), so every pair
+     (i, j + n1*t1 + n2*t2 + n3*t3) is found exactly once.
+  3) The enumeration of the pairs is split between threads (OpenMP) over the sub-cells; the 
+     distances to all atoms of a neighbor sub-cell are computed in a vectorizable loop over the 
+     contiguous, cell-sorted coordinate arrays and are then filtered.
+  4) The pairs are collected into the CSR arrays with the counting sort over the first atom index.
+
+  The stored pairs follow the convention of make_nlist_auto: the neighbor j of the atom i has j >= i
+  and the vector between them is r[i] - (r[j] + n1*t1 + n2*t2 + n3*t3). Unlike make_nlist_auto, the
+  interactions of an atom with its own periodic images are listed once per pair of opposite translations.
+
+  \param[in] Nat The number of atoms in the system
+  \param[in] r The pointer to the array containing the coordinates of all atoms
+  \param[in] H is the matrix describing the shape and size of the unit cell
+  \param[in] Roff The cutoff distance which controls the formation of the neighbor list. It must not exceed 
+  half of the shortest cell width (the distance between the opposite faces of the cell)
+  \param[out] offset The CSR pointers: the neighbors of the atom i are neib[offset[i]], ..., neib[offset[i+1]-1]
+  \param[out] neib The neighbors of all atoms
+
+************************************************************************/
+
+  int i, c;
+  double Roff2 = Roff * Roff;
+
+  VECTOR t1,t2,t3,g1,g2,g3;
+  H.get_vectors(t1,t2,t3);
+  H.inverse().T().get_vectors(g1,g2,g3);
+
+  offset.assign(Nat+1, 0);
+  neib.clear();
+  if(Nat==0){ return; }
+
+  //=========== Fold the atoms into the cell ==============
+  vector<VECTOR> s(Nat);             // fractional coordinates in [0,1)
+  vector<triple> initT(Nat);         // r[i] = folded r[i] + initT[i] * (t1,t2,t3)
+  for(i=0;i<Nat;i++){
+    double sa = g1*r[i], sb = g2*r[i], sc = g3*r[i];
+    initT[i].n1 = floor(sa);  initT[i].n2 = floor(sb);  initT[i].n3 = floor(sc);
+    s[i].x = sa - initT[i].n1;  s[i].y = sb - initT[i].n2;  s[i].z = sc - initT[i].n3;
+  }
+
+  //=========== Sub-cells and the stencil =================
+  // Distances between the opposite faces of the cell
+  double da = 1.0/g1.length(), db = 1.0/g2.length(), dc = 1.0/g3.length();
+
+  // With the larger cutoff an atom may see several images of the same atom (or of itself) in 
+  // one direction, and the half-shell stencil would miss some of them
+  double dmin = da; if(db<dmin){ dmin = db; } if(dc<dmin){ dmin = dc; }
+  if(Roff > 0.5*dmin){
+    cout<<"Error in make_nlist_csr: the cutoff distance ("<<Roff<<") is larger than half of the shortest cell width ("<<0.5*dmin<<")\n";
+    cout<<"Use a larger cell (a supercell) or make_nlist_auto\nExiting...\n";
+    exit(0);
+  }
+  int Na = int(floor(da/Roff)); if(Na<1){ Na = 1; }
+  int Nb = int(floor(db/Roff)); if(Nb<1){ Nb = 1; }
+  int Nc = int(floor(dc/Roff)); if(Nc<1){ Nc = 1; }
+  // How many sub-cells in each direction may contain the neighbors
+  int ka = int(ceil(Roff*Na/da)); 
+  int kb = int(ceil(Roff*Nb/db)); 
+  int kc = int(ceil(Roff*Nc/dc)); 
+  int Ncells = Na*Nb*Nc;
+
+  vector<int> at2cell, cell_start, cell_atoms;
+  build_cell_list(Nat, s, Na, Nb, Nc, at2cell, cell_start, cell_atoms);
+
+  // Cell-sorted Cartesian coordinates (folded), structure-of-arrays for the vectorized distance loop
+  vector<double> X(Nat), Y(Nat), Z(Nat);
+  for(int p=0;p<Nat;p++){
+    i = cell_atoms[p];
+    VECTOR ri = r[i] - (initT[i].n1*t1 + initT[i].n2*t2 + initT[i].n3*t3);
+    X[p] = ri.x;  Y[p] = ri.y;  Z[p] = ri.z;
+  }
+
+  // Half-shell stencil
+  vector<triple> stencil;
+  for(int a=0;a<=ka;a++){
+    for(int b=-kb;b<=kb;b++){
+      for(int cc=-kc;cc<=kc;cc++){
+        if(a==0 && (b<0 || (b==0 && cc<0))){ continue; }
+        triple d; d.n1 = a; d.n2 = b; d.n3 = cc; d.is_central = (a==0 && b==0 && cc==0);
+        stencil.push_back(d);
+      }
+    }
+  }
+  int nst = stencil.size();
+
+
+  //=========== Enumerate the pairs =======================
+  int nthreads = 1;
+#if defined(_OPENMP)
+  nthreads = omp_get_max_threads();
+#endif
+  vector< vector<int> > th_owner(nthreads);     // the first atom of the pair (smaller index)
+  vector< vector<quartet> > th_pairs(nthreads); // the second atom and the translation
+
+#pragma omp parallel num_threads(nthreads)
+  {
+    int tid = 0;
+#if defined(_OPENMP)
+    tid = omp_get_thread_num();
+#endif
+    vector<int>& owner = th_owner[tid];
+    vector<quartet>& pairs = th_pairs[tid];
+    vector<double> d2;
+
+#pragma omp for schedule(static)
+    for(int c1=0;c1<Ncells;c1++){
+
+      int ia = c1/(Nb*Nc), ib = (c1/Nc)%Nb, ic = c1%Nc;
+
+      for(int st=0;st<nst;st++){
+
+        // Neighbor sub-cell and the number of cell translations required to reach it
+        int ja = ia + stencil[st].n1, jb = ib + stencil[st].n2, jc = ic + stencil[st].n3;
+        int Ta = (ja>=0) ? ja/Na : -((-ja+Na-1)/Na);   ja -= Ta*Na;
+        int Tb = (jb>=0) ? jb/Nb : -((-jb+Nb-1)/Nb);   jb -= Tb*Nb;
+        int Tc = (jc>=0) ? jc/Nc : -((-jc+Nc-1)/Nc);   jc -= Tc*Nc;
+        int c2 = (ja*Nb + jb)*Nc + jc;
+        VECTOR T = Ta*t1 + Tb*t2 + Tc*t3;
+
+        int beg2 = cell_start[c2], end2 = cell_start[c2+1];
+        int n2 = end2 - beg2;
+        if(n2==0){ continue; }
+        if(d2.size()<n2){ d2.resize(n2); }
+
+        for(int p1=cell_start[c1];p1<cell_start[c1+1];p1++){
+
+          double xi = X[p1] - T.x, yi = Y[p1] - T.y, zi = Z[p1] - T.z;
+          const double* x2 = &X[beg2];
+          const double* y2 = &Y[beg2];
+          const double* z2 = &Z[beg2];
+          double* dd = &d2[0];
+
+#pragma omp simd
+          for(int q=0;q<n2;q++){
+            double dx = xi - x2[q], dy = yi - y2[q], dz = zi - z2[q];
+            dd[q] = dx*dx + dy*dy + dz*dz;
+          }
+
+          int q0 = 0;
+          if(stencil[st].is_central){ q0 = p1 - beg2 + 1; } // own sub-cell: only the pairs p2 > p1
+
+          for(int q=q0;q<n2;q++){
+            if(dd[q]>Roff2){ continue; }
+
+            int at1 = cell_atoms[p1];
+            int at2 = cell_atoms[beg2+q];
+
+            // r[at1] - (r[at2] + n*t), with n = T + initT[at1] - initT[at2]
+            quartet qt;
+            qt.n1 = Ta + initT[at1].n1 - initT[at2].n1;
+            qt.n2 = Tb + initT[at1].n2 - initT[at2].n2;
+            qt.n3 = Tc + initT[at1].n3 - initT[at2].n3;
+
+            if(at2<at1){ int tmp = at1; at1 = at2; at2 = tmp; qt.n1 = -qt.n1; qt.n2 = -qt.n2; qt.n3 = -qt.n3; }
+            qt.j = at2;
+            qt.is_central = (qt.n1==0 && qt.n2==0 && qt.n3==0);
+
+            owner.push_back(at1);
+            pairs.push_back(qt);
+          }// for q
+        }// for p1
+      }// for st
+    }// for c1
+
+  }// omp parallel
+
+
+  //=========== Pack into CSR (counting sort over the first atom) ================
+  int th, k;
+  for(th=0;th<nthreads;th++){
+    for(k=0;k<th_owner[th].size();k++){ offset[th_owner[th][k]+1]++; }
+  }
+  for(i=0;i<Nat;i++){ offset[i+1] += offset[i]; }
+
+  neib.resize(offset[Nat]);
+  vector<int> pos(offset.begin(), offset.end()-1);
+  for(th=0;th<nthreads;th++){
+    for(k=0;k<th_owner[th].size();k++){ neib[pos[th_owner[th][k]]++] = th_pairs[th][k]; }
+  }
+
+}
+
+
+boost::python::list make_nlist_auto(MATRIX& R, MATRIX3x3& H, double cellx, double celly, double cellz, double Roff){
+/**
+  \brief Python-friendly version of make_nlist_auto
+
+  \param[in] R The coordinates of all atoms: ndof x 1 matrix
+  \param[in] H is the matrix describing the shape and size of the unit cell
+  \param[in] cellx The size of the sub-cells in x direction
+  \param[in] celly The size of the sub-cells in y direction
+  \param[in] cellz The size of the sub-cells in z direction
+  \param[in] Roff The cutoff distance which controls the formation of the neighbor list
+
+  Returns the list of the neighbors of every atom, each neighbor given as [is_central, j, n1, n2, n3]
+*/
+
+  int i, k;
+  int Nat = R.n_rows/3;
+  vector<VECTOR> r(Nat);
+  for(i=0;i<Nat;i++){  r[i].x = R.get(3*i, 0);  r[i].y = R.get(3*i+1, 0);  r[i].z = R.get(3*i+2, 0);  }
+
+  vector< vector<quartet> > nlist;
+  make_nlist_auto(Nat, &r[0], H, cellx, celly, cellz, Roff, nlist);
+
+  boost::python::list res;
+  for(i=0;i<Nat;i++){
+    boost::python::list nbi;
+    for(k=0;k<nlist[i].size();k++){
+      boost::python::list q;
+      q.append(nlist[i][k].is_central);  q.append(nlist[i][k].j);
+      q.append(nlist[i][k].n1);  q.append(nlist[i][k].n2);  q.append(nlist[i][k].n3);
+      nbi.append(q);
+    }
+    res.append(nbi);
+  }
+
+  return res;
+}
+
+
+boost::python::list make_nlist_csr(MATRIX& R, MATRIX3x3& H, double Roff){
+/**
+  \brief Python-friendly version of make_nlist_csr
+
+  \param[in] R The coordinates of all atoms: ndof x 1 matrix
+  \param[in] H is the matrix describing the shape and size of the unit cell
+  \param[in] Roff The cutoff distance which controls the formation of the neighbor list
+
+  Returns [offset, neib]: the CSR pointers and the list of all neighbors, each given as
+  [is_central, j, n1, n2, n3]
+*/
+
+  int i, k;
+  int Nat = R.n_rows/3;
+  vector<VECTOR> r(Nat);
+  for(i=0;i<Nat;i++){  r[i].x = R.get(3*i, 0);  r[i].y = R.get(3*i+1, 0);  r[i].z = R.get(3*i+2, 0);  }
+
+  vector<int> offset;
+  vector<quartet> neib;
+  make_nlist_csr(Nat, &r[0], H, Roff, offset, neib);
+
+  boost::python::list off, nb;
+  for(i=0;i<offset.size();i++){ off.append(offset[i]); }
+  for(k=0;k<neib.size();k++){
+    boost::python::list q;
+    q.append(neib[k].is_central);  q.append(neib[k].j);
+    q.append(neib[k].n1);  q.append(neib[k].n2);  q.append(neib[k].n3);
+    nb.append(q);
+  }
+
+  boost::python::list res;
+  res.append(off);
+  res.append(nb);
+
+  return res;
+}
+
+
 double energy(int Nat,VECTOR* r,MATRIX3x3& H,vector< vector<quartet> >& nlist){
 /**
   \brief Auxiliary function to test neighbor list
@@ -54,6 +54,15 @@ void make_nlist_auto(int Nat,VECTOR* r,MATRIX3x3& H,
                      double cellx,double celly,double cellz,
                      double Roff,vector< vector<quartet> >& nlist);
 
+// Linear-scaling version: counting-sort cell list, half-shell stencil, CSR output
+void build_cell_list(int Nat, vector<VECTOR>& s, int Na, int Nb, int Nc,
+                     vector<int>& at2cell, vector<int>& cell_start, vector<int>& cell_atoms);
+void make_nlist_csr(int Nat,VECTOR* r,MATRIX3x3& H, double Roff, vector<int>& offset, vector<quartet>& neib);
+
+// Python-friendly versions
+boost::python::list make_nlist_auto(MATRIX& R, MATRIX3x3& H, double cellx, double celly, double cellz, double Roff);
+boost::python::list make_nlist_csr(MATRIX& R, MATRIX3x3& H, double Roff);
+
 // For verification purposes
 void bruteforce(int Nat,VECTOR* r,MATRIX3x3& H,int maxa,int maxb,int maxc,double Roff,vector< vector<quartet> >& nlist);
 double energy(int Nat,VECTOR* r,MATRIX3x3& H,vector< vector<quartet> >& nlist);
@@ -0,0 +1,197 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file VerletList.cpp
+  \brief The file implements the persistent Verlet neighbor list with a skin distance
+
+*/
+
+#include "VerletList.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+
+/// libcell namespace
+namespace libcell{
+
+
+void VerletList::init(double Roff_, double skin_){
+/**
+  \brief Set up the cutoff and the skin distances
+
+  \param[in] Roff_ The interaction cutoff distance
+  \param[in] skin_ The skin distance. The list includes all pairs within Roff_ + skin_ and is rebuilt
+             only when some atom has moved by more than skin_/2 since the last rebuild
+
+  Changing the parameters invalidates the list, so it will be rebuilt on the next update
+*/
+
+  if(Roff_<=0.0){ cout<<"Error in VerletList::init: Roff must be positive\n"; exit(0); }
+  if(skin_<0.0){ cout<<"Error in VerletList::init: skin must be non-negative\n"; exit(0); }
+
+  Roff = Roff_;
+  skin = skin_;
+  is_built = 0;
+
+}
+
+
+double VerletList::max_displacement2(int sz, VECTOR* r){
+/**
+  \brief Compute the square of the largest atomic displacement since the last rebuild
+
+  \param[in] sz The number of atoms
+  \param[in] r The pointer to the array of the current atomic coordinates
+*/
+
+  double max_d2 = 0.0;
+
+  for(int i=0;i<sz;i++){
+    double d2 = (r[i] - r_ref[i]).length2();
+    if(d2>max_d2){ max_d2 = d2; }
+  }
+
+  return max_d2;
+}
+
+
+int VerletList::is_rebuild_needed(int sz, VECTOR* r, MATRIX3x3& H){
+/**
+  \brief Check if the stored list is still valid for the given configuration
+
+  The list has to be rebuilt if: a) it has never been built; b) the number of atoms has changed;
+  c) the simulation cell has changed; d) any atom has moved by more than skin/2 since the last rebuild,
+  because then two atoms could have approached each other by more than the skin distance
+
+  \param[in] sz The number of atoms
+  \param[in] r The pointer to the array of the current atomic coordinates
+  \param[in] H The current simulation cell
+*/
+
+  if(!is_built){ return 1; }
+  if(sz!=Nat){ return 1; }
+
+  const double tol = 1e-10;
+  if( fabs(H.xx - H_ref.xx)>tol || fabs(H.xy - H_ref.xy)>tol || fabs(H.xz - H_ref.xz)>tol ||
+      fabs(H.yx - H_ref.yx)>tol || fabs(H.yy - H_ref.yy)>tol || fabs(H.yz - H_ref.yz)>tol ||
+      fabs(H.zx - H_ref.zx)>tol || fabs(H.zy - H_ref.zy)>tol || fabs(H.zz - H_ref.zz)>tol  ){ return 1; }
+
+  // max|dr| > skin/2  <=>  4*max|dr|^2 > skin^2
+  if(4.0*max_displacement2(sz, r) > skin*skin){ return 1; }
+
+  return 0;
+}
+
+
+void VerletList::build(int sz, VECTOR* r, MATRIX3x3& H){
+/**
+  \brief Unconditionally (re)build the list
+
+  The pairs are found with the linear-scaling cell-list algorithm of make_nlist_csr, using the
+  extended radius Roff + skin, which fills the CSR arrays directly. The current coordinates and
+  the cell are memorized as the reference point for the displacement tracking
+
+  \param[in] sz The number of atoms
+  \param[in] r The pointer to the array of the atomic coordinates
+  \param[in] H The simulation cell
+*/
+
+  make_nlist_csr(sz, r, H, Roff + skin, offset, neib);
+
+  int i;
+  Nat = sz;
+  r_ref.resize(sz);
+  for(i=0;i<sz;i++){ r_ref[i] = r[i]; }
+  H_ref = H;
+
+  is_built = 1;
+  nbuilds++;
+
+}
+
+
+int VerletList::update(int sz, VECTOR* r, MATRIX3x3& H){
+/**
+  \brief Bring the list up to date with the current configuration
+
+  The list is rebuilt only if it is no longer guaranteed to contain all the pairs within Roff
+
+  \param[in] sz The number of atoms
+  \param[in] r The pointer to the array of the current atomic coordinates
+  \param[in] H The current simulation cell
+
+  Returns 1 if the list has been rebuilt, 0 otherwise
+*/
+
+  nupdates++;
+
+  if(is_rebuild_needed(sz, r, H)){  build(sz, r, H); return 1; }
+
+  return 0;
+}
+
+
+int VerletList::update(MATRIX& R, MATRIX3x3& H){
+/**
+  \brief Python-friendly version of update
+
+  \param[in] R The coordinates of all atoms: ndof x 1 matrix
+  \param[in] H The current simulation cell
+
+  Returns 1 if the list has been rebuilt, 0 otherwise
+*/
+
+  int sz = R.n_rows/3;
+  VECTOR* r; r = new VECTOR[sz];
+
+  for(int i=0;i<sz;i++){
+    r[i].x = R.get(3*i, 0);  r[i].y = R.get(3*i+1, 0);  r[i].z = R.get(3*i+2, 0);
+  }
+
+  int res = update(sz, r, H);
+
+  delete [] r;
+
+  return res;
+}
+
+
+boost::python::list VerletList::get_neighbors(int i){
+/**
+  \brief Returns the neighbors of the atom i as a list of [is_central, j, n1, n2, n3]
+
+  The format is the same as used by the Python version of apply_pbc
+
+  \param[in] i The index of the atom
+*/
+
+  if(i<0 || i>=Nat){ cout<<"Error in VerletList::get_neighbors: index "<<i<<" is out of range\n"; exit(0); }
+
+  boost::python::list res;
+
+  for(int k=offset[i];k<offset[i+1];k++){
+    boost::python::list q;
+    q.append(neib[k].is_central);
+    q.append(neib[k].j);
+    q.append(neib[k].n1);
+    q.append(neib[k].n2);
+    q.append(neib[k].n3);
+    res.append(q);
+  }
+
+  return res;
+}
+
+
+
+}//namespace libcell
+}// liblibra
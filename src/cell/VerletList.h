@@ -0,0 +1,88 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file VerletList.h
+  \brief The file describes the persistent Verlet neighbor list with a skin distance
+
+*/
+
+#ifndef VERLET_LIST_H
+#define VERLET_LIST_H
+
+#include "NList.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+
+/// libcell namespace
+namespace libcell{
+
+
+class VerletList{
+/**
+  \brief Persistent Verlet neighbor list with a skin distance
+
+  The list contains all the pairs (i, j + n1*t1 + n2*t2 + n3*t3) with j>=i that are separated by less
+  than Roff + skin at the moment of the last rebuild. The list remains valid (contains all the pairs
+  within Roff) as long as no atom has moved by more than skin/2 since then, so the rebuild is only done
+  when this condition is violated or when the simulation cell changes.
+
+  The neighbors are stored in the compressed sparse row (CSR) layout: the neighbors of the atom i
+  are the elements neib[offset[i]], ..., neib[offset[i+1]-1]
+
+*/
+
+  int Nat;                   ///< the number of atoms for which the list is built
+  vector<VECTOR> r_ref;      ///< atomic coordinates at the moment of the last rebuild
+  MATRIX3x3 H_ref;           ///< the simulation cell at the moment of the last rebuild
+  int is_built;              ///< the flag telling if the list has been built at least once
+
+  double max_displacement2(int sz, VECTOR* r);
+  int is_rebuild_needed(int sz, VECTOR* r, MATRIX3x3& H);
+
+
+public:
+
+  double Roff;               ///< interaction cutoff distance
+  double skin;               ///< the skin distance - the list includes the pairs within Roff + skin
+
+  vector<int> offset;        ///< CSR row pointers: Nat + 1 elements
+  vector<quartet> neib;      ///< all neighbors of all atoms, packed contiguously
+
+  int nbuilds;               ///< the number of times the list has been (re)built
+  int nupdates;              ///< the number of times the list has been requested to update
+
+
+  VerletList(){ Roff = 10.0; skin = 2.0; Nat = 0; is_built = 0; nbuilds = 0; nupdates = 0; }
+  VerletList(double Roff_, double skin_){ Nat = 0; is_built = 0; nbuilds = 0; nupdates = 0; init(Roff_, skin_); }
+
+  void init(double Roff_, double skin_);
+  void reset(){ is_built = 0; }  ///< Forces the rebuild on the next call of update
+
+  void build(int sz, VECTOR* r, MATRIX3x3& H);
+  int update(int sz, VECTOR* r, MATRIX3x3& H);
+  int update(MATRIX& R, MATRIX3x3& H);
+
+  int size(){ return Nat; }                               ///< the number of atoms
+  int num_pairs(){ return neib.size(); }                  ///< the total number of stored pairs
+  int begin(int i){ return offset[i]; }                   ///< the index of the first neighbor of the atom i
+  int end(int i){ return offset[i+1]; }                   ///< the index past the last neighbor of the atom i
+
+  boost::python::list get_neighbors(int i);
+
+};
+
+
+}//namespace libcell
+}// liblibra
+
+#endif // VERLET_LIST_H
@@ -49,12 +49,34 @@ void export_Cell_objects(){
             
   ;
 
+  int (VerletList::*expt_update_v1)(MATRIX& R, MATRIX3x3& H) = &VerletList::update;
+
+  class_<VerletList>("VerletList",init<>())
+      .def(init<double, double>())
+      .def("__copy__", &generic__copy__<VerletList>) 
+      .def("__deepcopy__", &generic__deepcopy__<VerletList>)
+      .def_readonly("Roff",&VerletList::Roff)
+      .def_readonly("skin",&VerletList::skin)
+      .def_readonly("nbuilds",&VerletList::nbuilds)
+      .def_readonly("nupdates",&VerletList::nupdates)
+      .def("init", &VerletList::init)
+      .def("reset", &VerletList::reset)
+      .def("update", expt_update_v1)
+      .def("size", &VerletList::size)
+      .def("num_pairs", &VerletList::num_pairs)
+      .def("get_neighbors", &VerletList::get_neighbors)
+  ;
+
   VECTOR (*expt_max_vector_v1)(VECTOR t1,VECTOR t2,VECTOR t3) = &max_vector;
   boost::python::list (*expt_apply_pbc_v1)(MATRIX3x3 H, boost::python::list in, boost::python::list t) = &apply_pbc;
   boost::python::list (*expt_serial_to_vector_v1)(int c,int Nx,int Ny,int Nz) = &serial_to_vector;
   boost::python::list (*expt_serial_to_vector_symm_v1)(int c,int Nx,int Ny,int Nz) = &serial_to_vector_symm;
   boost::python::list (*expt_form_neibc_v1)(int c,int Nx,int Ny,int Nz,double cellx,double celly,double cellz,double Roff) = &form_neibc;
   MATRIX (*expt_fold_coords_v1)(MATRIX& R, MATRIX3x3& box, std::string pbc_type) = &fold_coords;
+  void (*expt_make_nlist_auto_v1)(int Nat,VECTOR* r,MATRIX3x3& H, double cellx,double celly,double cellz,
+                                  double Roff,vector< vector<quartet> >& nlist) = &make_nlist_auto;
+  boost::python::list (*expt_make_nlist_auto_v2)(MATRIX& R, MATRIX3x3& H, double cellx, double celly, double cellz, double Roff) = &make_nlist_auto;
+  boost::python::list (*expt_make_nlist_csr_v1)(MATRIX& R, MATRIX3x3& H, double Roff) = &make_nlist_csr;
 
   def("max_vector", expt_max_vector_v1);
   def("apply_pbc", expt_apply_pbc_v1);
@@ -65,7 +87,9 @@ void export_Cell_objects(){
   def("find_min_shell",find_min_shell);
 
   def("make_nlist",make_nlist);
-  def("make_nlist_auto",make_nlist_auto);
+  def("make_nlist_auto",expt_make_nlist_auto_v1);
+  def("make_nlist_auto",expt_make_nlist_auto_v2);
+  def("make_nlist_csr",expt_make_nlist_csr_v1);
 
   def("bruteforce",bruteforce);  
   def("energy",energy);
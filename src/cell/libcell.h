@@ -19,6 +19,7 @@
 
 #include "Cell.h"
 #include "NList.h"
+#include "VerletList.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -45,6 +45,17 @@ Control_Parameters::Control_Parameters(){
   // <scf_options>
   scf_algo = "none";     /// scf_algo = "none" - This is the most robust option
   use_disk = 0;          /// use_disk = 0 
+  scf_mem_cap = 0.0;     /// scf_mem_cap = 0.0 - no memory limit
+  scf_mem_single = 0;    /// scf_mem_single = 0
+  scf_scratch_dir = "."; /// scf_scratch_dir = "."
+  dm_method = "diag";    /// dm_method = "diag" - diagonalization
+  dm_thresh = 1e-8;      /// dm_thresh = 1e-8
+  dm_tol = 1e-8;         /// dm_tol = 1e-8
+  dm_max_iter = 100;     /// dm_max_iter = 100
+  foe_order = 200;       /// foe_order = 200
+  foe_kT = 0.01;         /// foe_kT = 0.01
+  dm_extrap = "none";    /// dm_extrap = "none" - no density prediction
+  dm_extrap_order = 3;   /// dm_extrap_order = 3
   use_rosh = 0;          /// use_rosh = 0 
   do_annihilate = 0;     /// do_annihilate = 0 -  do not do spin annihilation by default
   pop_opt = 0;           /// pop_opt = 0 - integer occupations
@@ -283,6 +294,17 @@ void get_parameters_from_file(std::string filename, Control_Parameters& prms){
           if(file[i1].size()>2){  
             if(file[i1][0]=="scf_algo"){  prms.scf_algo = file[i1][2].c_str();   } 
             else if(file[i1][0]=="use_disk"){ prms.use_disk = atoi(file[i1][2].c_str());   } 
+            else if(file[i1][0]=="scf_mem_cap"){ prms.scf_mem_cap = atof(file[i1][2].c_str());   }
+            else if(file[i1][0]=="scf_mem_single"){ prms.scf_mem_single = atoi(file[i1][2].c_str());   }
+            else if(file[i1][0]=="scf_scratch_dir"){ prms.scf_scratch_dir = file[i1][2].c_str();   }
+            else if(file[i1][0]=="dm_method"){ prms.dm_method = file[i1][2].c_str();   }
+            else if(file[i1][0]=="dm_thresh"){ prms.dm_thresh = atof(file[i1][2].c_str());   }
+            else if(file[i1][0]=="dm_tol"){ prms.dm_tol = atof(file[i1][2].c_str());   }
+            else if(file[i1][0]=="dm_max_iter"){ prms.dm_max_iter = atoi(file[i1][2].c_str());   }
+            else if(file[i1][0]=="foe_order"){ prms.foe_order = atoi(file[i1][2].c_str());   }
+            else if(file[i1][0]=="foe_kT"){ prms.foe_kT = atof(file[i1][2].c_str());   }
+            else if(file[i1][0]=="dm_extrap"){ prms.dm_extrap = file[i1][2].c_str();   }
+            else if(file[i1][0]=="dm_extrap_order"){ prms.dm_extrap_order = atoi(file[i1][2].c_str());   }
             else if(file[i1][0]=="use_rosh"){ prms.use_rosh = atoi(file[i1][2].c_str());   } 
             else if(file[i1][0]=="do_annihilate"){ prms.do_annihilate = atoi(file[i1][2].c_str());   } 
             else if(file[i1][0]=="pop_opt"){  prms.pop_opt = atoi(file[i1][2].c_str());   } 
@@ -634,6 +656,37 @@ void get_parameters_from_file(std::string filename, Control_Parameters& prms){
     exit(0);
   }
 
+  if(prms.dm_method=="diag"||prms.dm_method=="mcweeny"||prms.dm_method=="trs4"||prms.dm_method=="sp2"||prms.dm_method=="foe"){
+  }else{
+    cout<<"Error: prms.dm_method = "<<prms.dm_method<<" is unknown or not registered\n";
+    cout<<" possible values are:\n";
+    cout<<" diag    - diagonalization of the Fock matrix (default)\n";
+    cout<<" mcweeny - canonical McWeeny purification\n";
+    cout<<" trs4    - trace-resetting 4-th order purification\n";
+    cout<<" sp2     - second-order spectral projection purification\n";
+    cout<<" foe     - Chebyshev Fermi operator expansion\n";
+    exit(0);
+  }
+
+  if(prms.dm_extrap=="none"||prms.dm_extrap=="aspc"||prms.dm_extrap=="xlbomd"){
+  }else{
+    cout<<"Error: prms.dm_extrap = "<<prms.dm_extrap<<" is unknown or not registered\n";
+    cout<<" possible values are:\n";
+    cout<<" none    - no prediction of the guess density (default)\n";
+    cout<<" aspc    - always stable predictor from the previous converged densities\n";
+    cout<<" xlbomd  - extended Lagrangian propagation of an auxiliary density\n";
+    exit(0);
+  }
+
+  if(prms.dm_extrap=="aspc" && prms.dm_extrap_order<0){
+    cout<<"Error: prms.dm_extrap_order must be non-negative for dm_extrap = aspc\n";
+    exit(0);
+  }
+  if(prms.dm_extrap=="xlbomd" && (prms.dm_extrap_order<3 || prms.dm_extrap_order>7)){
+    cout<<"Error: prms.dm_extrap_order must be in the range 3...7 for dm_extrap = xlbomd\n";
+    exit(0);
+  }
+
   if(prms.compute_excitations==1 && prms.compute_dipole!=1){
     cout<<"To compute excitations (spectra) dipole moments must be computed. Set compute_dipole to value 1\n";
     exit(0);
@@ -68,11 +68,35 @@ public:
 
   // <scf_options>
   std::string scf_algo;          ///< Algorithm for SCF iterations. 
-                                 ///< Possible options: "none", "oda"
+                                 ///< Possible options: "none", "oda", "diis_fock", "diis_dm"
                                  ///< Default: "none"
   int use_disk;                  ///< write temporary variables to disk instead of RAM - this can help reducing memory costs
-                                 ///< Possible options: 0 - do not use  disk (faster);  1 - use disk (less memory required)
+                                 ///< Possible options: 0 - do not use  disk (faster);  1 - use the memory-budgeted storage (less memory required), see scf_mem_cap
                                  ///< Default: 0
+  double scf_mem_cap;            ///< Memory budget for the working matrices of the SCF with use_disk = 1, in MB
+                                 ///< Possible options: 0 - no limit, all matrices are kept in RAM; any positive value
+                                 ///< Default: 0
+  int scf_mem_single;            ///< Keep the matrices that do not fit into scf_mem_cap in single precision, before spilling to disk
+                                 ///< Possible options: 0 - no, 1 - yes
+                                 ///< Default: 0
+  std::string scf_scratch_dir;   ///< The directory where the per-job scratch directory for the spilled SCF matrices is created
+                                 ///< Default: "."
+  std::string dm_method;         ///< How the density matrix is computed from the Fock matrix
+                                 ///< Possible options: "diag" - diagonalization; "mcweeny", "trs4", "sp2" - purification;
+                                 ///< "foe" - Chebyshev Fermi operator expansion (Fermi occupations with foe_kT)
+                                 ///< Default: "diag"
+  double dm_thresh;              ///< Elements smaller than this are neglected in the matrix products of purification/FOE. Default: 1e-8
+  double dm_tol;                 ///< Convergence criterium of the purification iterations. Default: 1e-8
+  int dm_max_iter;               ///< Maximal number of the purification iterations. Default: 100
+  int foe_order;                 ///< Order of the Chebyshev expansion for dm_method = "foe". Default: 200
+                                 ///< The order needed for a given accuracy grows as (spectral width of F)/foe_kT
+  double foe_kT;                 ///< Broadening of the Fermi distribution for dm_method = "foe" [a.u.]. Default: 0.01
+  std::string dm_extrap;         ///< How the guess density of energy_and_forces is predicted from the previous geometries (MD steps)
+                                 ///< Possible options: "none" - no prediction; "aspc" - always stable predictor from the
+                                 ///< converged densities; "xlbomd" - extended Lagrangian propagation of an auxiliary density
+                                 ///< Default: "none"
+  int dm_extrap_order;           ///< Order of the prediction: k for "aspc" (k+2 previous densities are used),
+                                 ///< K = 3...7 for "xlbomd" (the order of the dissipation term). Default: 3
   int use_rosh;                  ///< use restricted open-shell
                                  ///< Possible options: 1 (use), 0 (do not use)
                                  ///< Default: 0
@@ -88,10 +112,10 @@ public:
   int diis_max;                  ///< Dimension of DIIS matrix, if used
                                  ///< Possible values: 1, 2, 3, ...
                                  ///< Default: 3
-  int diis_start_iter;           ///< Iteration after which DIIS will start
+  int diis_start_iter;           ///< Iteration after which DIIS will start (the ODA steps are used before that)
                                  ///< Possible values: 0, 1, 2, ...
                                  ///< Default: 0
-  int use_level_shift;           ///< Flag to turn on/off level shifting (LS) (not yet implemented)
+  int use_level_shift;           ///< Flag to turn on/off level shifting (LS) (only used by the "diis_fock" and "diis_dm" algorithms)
                                  ///< Possible options: 0 - do not use LS; 1 - use LS
                                  ///< Default: use_level_shift = 0
   double shift_magnitude;        ///< The magnitude of the energy level shifts, if used
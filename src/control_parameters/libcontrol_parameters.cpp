@@ -55,6 +55,17 @@ void export_Control_Parameters_objects(){
 
       .def_readwrite("scf_algo", &Control_Parameters::scf_algo)
       .def_readwrite("use_disk", &Control_Parameters::use_disk)
+      .def_readwrite("scf_mem_cap", &Control_Parameters::scf_mem_cap)
+      .def_readwrite("scf_mem_single", &Control_Parameters::scf_mem_single)
+      .def_readwrite("scf_scratch_dir", &Control_Parameters::scf_scratch_dir)
+      .def_readwrite("dm_method", &Control_Parameters::dm_method)
+      .def_readwrite("dm_thresh", &Control_Parameters::dm_thresh)
+      .def_readwrite("dm_tol", &Control_Parameters::dm_tol)
+      .def_readwrite("dm_max_iter", &Control_Parameters::dm_max_iter)
+      .def_readwrite("foe_order", &Control_Parameters::foe_order)
+      .def_readwrite("foe_kT", &Control_Parameters::foe_kT)
+      .def_readwrite("dm_extrap", &Control_Parameters::dm_extrap)
+      .def_readwrite("dm_extrap_order", &Control_Parameters::dm_extrap_order)
       .def_readwrite("use_rosh", &Control_Parameters::use_rosh)
       .def_readwrite("do_annihilate", &Control_Parameters::do_annihilate)
       .def_readwrite("pop_opt", &Control_Parameters::pop_opt)
@@ -28,6 +28,7 @@
 #include "electronic/libelectronic.h"
 #include "Dynamics.h"
 #include "dyn_control_params.h"
+#include "../math_ann/libann.h"
 
 
 /// liblibra namespace
@@ -60,9 +61,26 @@ void update_Hamiltonian_q(dyn_control_params& prms, MATRIX& q, vector<CMATRIX>&
 
   /**
     Update of the vibronic Hamiltonian in response to changed q
+
+    py_funct is either a Python function computing the Hamiltonian of one trajectory, or
+    a trained NeuralNetwork object - the surrogate of the diabatic Hamiltonian, which is 
+    evaluated for all the trajectories at once in C++ (see nHamiltonian::compute_diabatic)
   */
 
   //------ Update the internals of the Hamiltonian object --------
+  bp::extract<libann::NeuralNetwork&> ann(py_funct);
+
+  if(ann.check()){
+    if(prms.rep_ham!=0){
+      cout<<"ERROR in update_Hamiltonian_q: the ANN surrogate only provides the diabatic Hamiltonian, ";
+      cout<<"so rep_ham = 0 should be used\nExiting...\n";
+      exit(0);
+    }
+    ham.compute_diabatic(ann(), q, 1);
+    if(prms.rep_tdse==1){  ham.compute_adiabatic(1, 1);  }
+    return;
+  }
+
   // We call the external function that would do the calculations
   if(prms.rep_tdse==0){      
     if(prms.rep_ham==0){
@@ -457,7 +475,8 @@ void compute_dynamics(MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<CMA
   \param[in] ham Is the Hamiltonian object that works as a functor (takes care of all calculations of given type) 
   - its internal variables (well, actually the variables it points to) are changed during the compuations
   \param[in] py_funct Python function object that is called when this algorithm is executed. The called Python function does the necessary 
-  computations to update the diabatic Hamiltonian matrix (and derivatives), stored externally.
+  computations to update the diabatic Hamiltonian matrix (and derivatives), stored externally. Alternatively, 
+  this can be a trained NeuralNetwork object that is used as the surrogate diabatic Hamiltonian (see update_Hamiltonian_q)
   \param[in] params The Python object containing any necessary parameters passed to the "py_funct" function when it is executed.
   \param[in] params1 The Python dictionary containing the control parameters passed to this function
   \param[in] rnd The Random number generator object
@@ -522,7 +541,8 @@ void compute_dynamics(MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<CMA
  
   //============== Electronic propagation ===================
   // Evolve electronic DOFs for all trajectories
-  propagate_electronic(0.5*prms.dt, C, projectors, ham.children, prms.rep_tdse);   
+  if(prms.is_nbra==1){  propagate_electronic_nbra(0.5*prms.dt, C, projectors, ham.children, prms.rep_tdse);  }
+  else{  propagate_electronic(0.5*prms.dt, C, projectors, ham.children, prms.rep_tdse);  }
 
   //============== Nuclear propagation ===================
 
@@ -600,7 +620,8 @@ void compute_dynamics(MATRIX& q, MATRIX& p, MATRIX& invM, CMATRIX& C, vector<CMA
   //============== Electronic propagation ===================
   // Evolve electronic DOFs for all trajectories
   update_Hamiltonian_p(prms, ham, p, invM);
-  propagate_electronic(0.5*prms.dt, C, projectors, ham.children, prms.rep_tdse);   
+  if(prms.is_nbra==1){  propagate_electronic_nbra(0.5*prms.dt, C, projectors, ham.children, prms.rep_tdse);  }
+  else{  propagate_electronic(0.5*prms.dt, C, projectors, ham.children, prms.rep_tdse);  }
 
 
 
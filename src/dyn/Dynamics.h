@@ -29,6 +29,9 @@
 #include "dyn_hop_proposal.h"
 #include "dyn_methods.h"
 #include "dyn_projectors.h"
+#include "dyn_nbra.h"
+#include "tsh_ensemble_stat.h"
+#include "hvib_store.h"
 
 
 
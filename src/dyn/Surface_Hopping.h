@@ -54,6 +54,15 @@ vector<int> get_permutation(vector<vector<int> >& inp);
 vector<int> Munkres_Kuhn_minimize(MATRIX& _X, int verbosity);
 vector<int> Munkres_Kuhn_maximize(MATRIX& _X, int verbosity);
 
+///================  In tsh_lapjv.cpp  =================================
+vector<int> Jonker_Volgenant_minimize(MATRIX& X, vector<int>& guess, int verbosity);
+vector<int> Jonker_Volgenant_minimize(MATRIX& X, int verbosity);
+vector<int> Jonker_Volgenant_maximize(MATRIX& X, vector<int>& guess, int verbosity);
+vector<int> Jonker_Volgenant_maximize(MATRIX& X, int verbosity);
+vector<int> Jonker_Volgenant_minimize_sparse(vector<vector<int> >& cols, vector<vector<double> >& costs,
+                                             vector<int>& guess, int verbosity);
+vector<int> Jonker_Volgenant_maximize_sparse(MATRIX& X, double threshold, vector<int>& guess, int verbosity);
+
 
 }// namespace libdyn
 }// liblibra
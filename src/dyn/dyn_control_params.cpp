@@ -51,6 +51,7 @@ dyn_control_params::dyn_control_params(){
   do_phase_correction = 1;
   phase_correction_tol = 1e-3; 
   state_tracking_algo = 2;
+  state_tracking_tol = 0.01;
   MK_alpha = 0.0;
   MK_verbosity = 0;
 
@@ -71,6 +72,8 @@ dyn_control_params::dyn_control_params(){
   ensemble = 0;
   thermostat_params = bp::dict();
 
+  is_nbra = 0;
+
 }
 
 
@@ -78,7 +81,8 @@ dyn_control_params::dyn_control_params(){
 void dyn_control_params::sanity_check(){
 
   if(state_tracking_algo==0 || state_tracking_algo==1 ||
-     state_tracking_algo==2 || state_tracking_algo==3){ ; ; }
+     state_tracking_algo==2 || state_tracking_algo==3 ||
+     state_tracking_algo==4 || state_tracking_algo==5){ ; ; }
   else{
     std::cout<<"Error in dyn_control_params::sanity_check: state_tracking_algo = "
         <<state_tracking_algo<<" is not allowed. Exiting...\n";
@@ -122,6 +126,7 @@ void dyn_control_params::set_parameters(bp::dict params){
 
     // State tracking options
     else if(key=="state_tracking_algo"){  state_tracking_algo = bp::extract<int>(params.values()[i]);  }
+    else if(key=="state_tracking_tol") { state_tracking_tol = bp::extract<double>(params.values()[i]);  }
     else if(key=="MK_alpha") { MK_alpha = bp::extract<double>(params.values()[i]);  }
     else if(key=="MK_verbosity") { MK_verbosity = bp::extract<int>(params.values()[i]);  }
 
@@ -169,6 +174,8 @@ void dyn_control_params::set_parameters(bp::dict params){
     else if(key=="ensemble"){ ensemble = bp::extract<int>(params.values()[i]); }    
     else if(key=="thermostat_params"){ thermostat_params = bp::extract<bp::dict>(params.values()[i]); }    
 
+    else if(key=="is_nbra"){ is_nbra = bp::extract<int>(params.values()[i]); }
+
 
   }
 
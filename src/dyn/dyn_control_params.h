@@ -191,16 +191,27 @@ class dyn_control_params{
       1 - method of Kosuke Sato (may fail by getting trapped into an infinite loop)
       2 - Munkres-Kuhn (Hungarian) algorithm (default)
       3 - stochastic reordering
+      4 - same assignment as 2, but with the Jonker-Volgenant algorithm (faster for many states)
+      5 - same as 4, but solved independently in the blocks of strongly overlapping states,
+          see state_tracking_tol (for many states with only a few crossings)
   */
   int state_tracking_algo;
 
+  /**
+    The states i and j are put in the same block for the state_tracking_algo = 5 if 
+    |<i(t)|j(t+dt)>|^2 or |<j(t)|i(t+dt)>|^2 is larger than this value [default: 0.01]
+  */
+  double state_tracking_tol;
+
   /** 
     Munkres-Kuhn alpha (selects the range of orbitals included in reordering) [default: 0.0]
+    Also used with the state_tracking_algo = 4
   */
   double MK_alpha;
 
   /**
     Munkres-Kuhn verbosity: 0 - no extra output (default), 1 - details
+    Also used with the state_tracking_algo = 4
   */
   int MK_verbosity;
 
@@ -305,6 +316,15 @@ class dyn_control_params{
   */
   int ensemble;
 
+
+  /**
+    NBRA mode: whether all the trajectories share the same vibronic Hamiltonian: 
+      0 - no, each trajectory's amplitudes are propagated with its own Hamiltonian [ default ]
+      1 - yes, the propagator is computed once per step and is applied to all trajectories as a 
+          single matrix-matrix product
+  */
+  int is_nbra;
+
   
   /**
     Thermostat parameters 
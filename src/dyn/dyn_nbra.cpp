@@ -0,0 +1,512 @@
+/*********************************************************************************
+* Copyright (C) 2015-2019 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file dyn_nbra.cpp
+  \brief The file implements the processing of the KS time series into the vibronic
+  Hamiltonians for the NBRA calculations (the C++ version of libra_py/workflows/nbra/step3.py)
+
+  All the KS matrices have the spin-block structure of the Python version:
+
+            | X_aa   X_ab |
+       X =  |             |,  each block is N x N, N - the number of orbitals
+            | X_ba   X_bb |
+
+  The blocks are handled in-place in the 2N x 2N matrices, so there is no
+  splitting/assembling of the supermatrices.
+
+*/
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "../math_meigen/libmeigen.h"
+#include "Surface_Hopping.h"
+#include "dyn_projectors.h"
+#include "dyn_nbra.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libdyn namespace
+namespace libdyn{
+
+using namespace libmeigen;
+
+
+vector<int> nbra_sd2indx(vector<int>& sd){
+/**
+  \brief Map the SD definition onto the indices of the occupied spin-orbitals
+
+  Same as mapping.sd2indx(sd, nbasis, True): the indices start from 1 in the input and
+  from 0 in the output, the sign (spin of the electron) is dropped and the result is sorted
+
+  \param[in] sd The SD definition, e.g. [1, -3]
+*/
+
+  int sz = sd.size();
+  vector<int> res(sz, 0);
+
+  for(int i=0;i<sz;i++){  res[i] = abs(sd[i]) - 1;  }
+  std::sort(res.begin(), res.end());
+
+  return res;
+}
+
+
+CMATRIX nbra_ovlp_mat_arb(vector<vector<int> >& SD1, vector<vector<int> >& SD2, CMATRIX& S){
+/**
+  \brief Compute the matrix of overlaps <SD1(i)|SD2(j)> in the basis of the SDs
+
+  The convention is the same as in the mapping.ovlp_mat_arb function
+
+  \param[in] SD1 The definitions of the N bra-SDs
+  \param[in] SD2 The definitions of the M ket-SDs
+  \param[in] S The matrix in the space of 1-electron spin-orbitals
+
+  Returns CMATRIX(N, M)
+*/
+
+  int N = SD1.size();
+  int M = SD2.size();
+  int n, m, i, j;
+
+  vector<vector<int> > sd1(N);  for(n=0;n<N;n++){ sd1[n] = nbra_sd2indx(SD1[n]); }
+  vector<vector<int> > sd2(M);  for(m=0;m<M;m++){ sd2[m] = nbra_sd2indx(SD2[m]); }
+
+  CMATRIX res(N, M);
+
+  for(n=0;n<N;n++){
+    for(m=0;m<M;m++){
+
+      int n1 = sd1[n].size();
+      int n2 = sd2[m].size();
+      CMATRIX s(n1, n2);
+
+      for(i=0;i<n1;i++){
+        for(j=0;j<n2;j++){
+          // The overlap is non-zero only if the orbitals are occupied with the same-spin electrons
+          if(SD1[n][i] * SD2[m][j] > 0){  s.M[i*n2+j] = S.get(sd1[n][i], sd2[m][j]);  }
+        }
+      }
+
+      res.M[n*M+m] = det(s);
+
+    }// for m
+  }// for n
+
+  return res;
+}
+
+
+CMATRIX nbra_energy_mat_arb(vector<vector<int> >& SD, CMATRIX& E, vector<double>& dE){
+/**
+  \brief Compute the diagonal matrix of the SD energies: sums of the occupied spin-orbitals energies
+  plus the SD-specific corrections
+
+  \param[in] SD The definitions of the SDs
+  \param[in] E The energies of the 1-electron spin-orbitals
+  \param[in] dE The energy corrections for each SD
+*/
+
+  int n = SD.size();
+  CMATRIX res(n, n);
+
+  for(int i=0;i<n;i++){
+    vector<int> sd = nbra_sd2indx(SD[i]);
+
+    complex<double> e(dE[i], 0.0);
+    for(int k=0;k<sd.size();k++){  e += E.get(sd[k], sd[k]);  }
+
+    res.M[i*n+i] = e;
+  }
+
+  return res;
+}
+
+
+void nbra_lowdin(CMATRIX& S, CMATRIX& S_i_half){
+/**
+  \brief Compute the block-diagonal inverse square root of the alpha-alpha and beta-beta blocks
+  of the orbital overlap matrix
+
+  \param[in] S The 2N x 2N overlap matrix of the spin-orbitals
+  \param[out] S_i_half The 2N x 2N matrix diag(S_aa^{-1/2}, S_bb^{-1/2})
+*/
+
+  int nst = S.n_cols/2;  // division by 2 because it is a super-matrix
+  int i, j, spin, rank, is_inv;
+
+  S_i_half = 0.0;
+
+  for(spin=0; spin<2; spin++){
+
+    int sh = spin * nst;
+    CMATRIX s(nst, nst), s_half(nst, nst), s_i_half(nst, nst);
+
+    for(i=0;i<nst;i++){
+      for(j=0;j<nst;j++){  s.M[i*nst+j] = S.get(sh+i, sh+j);  }
+    }
+
+    FullPivLU_rank_invertible(s, rank, is_inv);
+    if(is_inv!=1){
+      cout<<"Error in nbra_lowdin: S_"<<(spin==0 ? "aa" : "bb")<<" is not invertible\nExiting...\n"; exit(0);
+    }
+
+    sqrt_matrix(s, s_half, s_i_half);
+
+    for(i=0;i<nst;i++){
+      for(j=0;j<nst;j++){  S_i_half.set(sh+i, sh+j, s_i_half.M[i*nst+j]);  }
+    }
+
+  }// for spin
+
+}
+
+
+void nbra_apply_normalization(vector<CMATRIX>& S, vector<CMATRIX>& St){
+/**
+  \brief Transform the TDMs computed with non-orthonormal orbitals such that they correspond
+  to the Lowdin-orthonormalized orbitals:  St[n] -> U[n]^+ * St[n] * U[n+1], U = S^{-1/2}
+
+  As in the Python version, the last TDM is left untouched. Both the inverse square roots and
+  the transformations are computed in parallel over the timesteps
+
+  \param[in] S The overlaps of the orbitals at all timesteps
+  \param[in,out] St The TDMs at all timesteps
+*/
+
+  int nsteps = St.size();
+  if(nsteps<2){ return; }
+
+  int sz = St[0].n_cols;
+  int i;
+
+  vector<CMATRIX> U(nsteps, CMATRIX(sz, sz));
+
+  #pragma omp parallel for
+  for(i=0;i<nsteps;i++){  nbra_lowdin(S[i], U[i]);  }
+
+  #pragma omp parallel for
+  for(i=0;i<nsteps-1;i++){  St[i] = U[i].H() * St[i] * U[i+1];  }
+
+}
+
+
+void nbra_apply_state_reordering(vector<CMATRIX>& St, vector<CMATRIX>& E, int algo, double alpha, double tol){
+/**
+  \brief Perform the state reordering in the TDMs of all the timesteps
+
+  The algorithm is sequential in time, because the permutation found at the step n is used at
+  the step n+1
+
+  \param[in,out] St The TDMs at all timesteps
+  \param[in,out] E The orbital energies at all timesteps (only changed with algo = 1)
+  \param[in] algo The reordering algorithm: 1 - the older permutations-based approach,
+             2 - the Munkres-Kuhn (Hungarian) algorithm applied to the alpha-alpha and
+             beta-beta blocks separately, 4 - same as 2, but with the Jonker-Volgenant algorithm
+             warm-started from the previous permutation, 5 - same as 4, but solved independently
+             in the blocks of the strongly overlapping orbitals (see get_block_reordering)
+  \param[in] alpha The parameter of the cost function of the Hungarian algorithm [units: a.u.^-1]
+  \param[in] tol The threshold of the squared overlaps defining the blocks for algo = 5
+*/
+
+  int nsteps = St.size();
+  if(nsteps==0){ return; }
+
+  int sz = St[0].n_cols;
+  int nst = sz/2;  // division by 2 because it is a super-matrix
+  int i, a, b, spin;
+
+  // The cumulative (algo = 1) or the current (algo = 2, 4, 5) permutation of all spin-orbitals
+  vector<int> perm(sz, 0);
+  for(a=0;a<sz;a++){ perm[a] = a; }
+
+  CMATRIX st(nst, nst), en(nst, nst);
+  vector<int> perm_id(nst, 0);
+  for(a=0;a<nst;a++){ perm_id[a] = a; }
+
+  for(i=0;i<nsteps;i++){
+
+    if(algo==1){
+
+      vector<int> perm_t = get_reordering(St[i]);
+      update_permutation(perm_t, perm);
+
+      // Because St = <psi(t)|psi(t+dt)> - we permute only columns
+      St[i].permute_cols(perm);
+      E[i].permute_cols(perm);
+      E[i].permute_rows(perm);
+
+    }
+
+    else if(algo==2 || algo==4 || algo==5){
+
+      // Permute rows with the permutation found at the previous step: P_n
+      St[i].permute_rows(perm);
+
+      // Find the new permutation P_{n+1} for the diagonal blocks
+      for(spin=0; spin<2; spin++){
+        int sh = spin * nst;
+
+        for(a=0;a<nst;a++){
+          for(b=0;b<nst;b++){
+            st.M[a*nst+b] = St[i].get(sh+a, sh+b);
+            en.M[a*nst+b] = E[i].get(sh+a, sh+b);
+          }
+        }
+
+        // The rows are already permuted with P_n, so the identity continues the previous permutation
+        vector<int> perm_t;
+        if(algo==2){ perm_t = Munkres_Kuhn(st, en, alpha, 0); }
+        else if(algo==4){ perm_t = Jonker_Volgenant(st, en, alpha, perm_id, 0); }
+        else{ perm_t = get_block_reordering(st, en, alpha, tol); }
+        for(a=0;a<nst;a++){  perm[sh+a] = sh + perm_t[a];  }
+
+      }// for spin
+
+      // Permute columns with the new permutation
+      St[i].permute_cols(perm);
+
+    }
+
+  }// for i
+
+}
+
+void nbra_apply_state_reordering(vector<CMATRIX>& St, vector<CMATRIX>& E, int algo, double alpha){
+
+  nbra_apply_state_reordering(St, E, algo, alpha, 0.01);
+
+}
+
+
+void nbra_apply_phase_correction(vector<CMATRIX>& St){
+/**
+  \brief Perform the phase correction of the TDMs of all the timesteps according to:
+  Akimov, A. V. J. Phys. Chem. Lett, 2018, 9, 6096
+
+  St[n] -> F_n * St[n] * F_{n+1}^+, where F_{n+1} = F_n * f_{n+1} is the cumulative phase and
+  f_{n+1} are the phase corrections computed from the alpha-alpha and beta-beta blocks of St[n]
+
+  The instantaneous corrections and the transformations of the TDMs are computed in parallel
+  over the timesteps, only the accumulation of the phases is sequential
+
+  \param[in,out] St The TDMs at all timesteps
+*/
+
+  int nsteps = St.size();
+  if(nsteps==0){ return; }
+
+  int sz = St[0].n_cols;
+  int nst = sz/2;  // division by 2 because it is a super-matrix
+  int i, a, b;
+
+  // Instantaneous phase corrections f_n, for all spin-orbitals
+  vector<CMATRIX> phase_i(nsteps, CMATRIX(sz, 1));
+
+  #pragma omp parallel for private(a,b)
+  for(i=0;i<nsteps;i++){
+    for(int spin=0; spin<2; spin++){
+      int sh = spin * nst;
+      CMATRIX st(nst, nst);
+
+      for(a=0;a<nst;a++){
+        for(b=0;b<nst;b++){ st.M[a*nst+b] = St[i].get(sh+a, sh+b);  }
+      }
+
+      CMATRIX f(compute_phase_corrections(st));
+      for(a=0;a<nst;a++){  phase_i[i].M[sh+a] = f.M[a];  }
+    }
+  }
+
+  // Cumulative phases F_n
+  vector<CMATRIX> cum_phase(nsteps, CMATRIX(sz, 1));
+  for(a=0;a<sz;a++){  cum_phase[0].M[a] = complex<double>(1.0, 0.0);  }
+
+  for(i=1;i<nsteps;i++){
+    for(a=0;a<sz;a++){  cum_phase[i].M[a] = cum_phase[i-1].M[a] * phase_i[i-1].M[a];  }
+  }
+
+  #pragma omp parallel for private(a,b)
+  for(i=0;i<nsteps;i++){
+    for(a=0;a<sz;a++){
+      for(b=0;b<sz;b++){
+        St[i].M[a*sz+b] *= cum_phase[i].M[a] * std::conj(cum_phase[i].M[b]) * std::conj(phase_i[i].M[b]);
+      }
+    }
+  }
+
+}
+
+
+CMATRIX nbra_sac_matrix(CMATRIX& CI_basis, vector<vector<int> >& SD_basis, CMATRIX& S){
+/**
+  \brief Compute the SD-to-CI transformation matrix with the normalized CI states
+
+  \param[in] CI_basis The n_SD x n_CI matrix of the (unnormalized) CI coefficients
+  \param[in] SD_basis The definitions of the SDs
+  \param[in] S The overlaps of the spin-orbitals
+
+  Returns CMATRIX(n_SD, n_CI)
+*/
+
+  int n_chi = CI_basis.n_cols;
+
+  CMATRIX P2C(CI_basis);
+  CMATRIX Ssd(nbra_ovlp_mat_arb(SD_basis, SD_basis, S));
+  CMATRIX norm(n_chi, n_chi);
+  norm = P2C.H() * Ssd * P2C;
+
+  for(int i=0;i<n_chi;i++){
+    double nrm = norm.get(i,i).real();
+    if(nrm>0.0){  P2C.scale(-1, i, 1.0/sqrt(nrm));  }
+    else{  cout<<"Error in nbra_sac_matrix: some combination gives zero norm\nExiting...\n"; exit(0); }
+  }
+
+  return P2C;
+}
+
+
+CMATRIX nbra_compute_Hvib(vector<vector<int> >& SD_basis, CMATRIX& St, CMATRIX& E, vector<double>& dE, double dt){
+/**
+  \brief Compute the vibronic Hamiltonian in the basis of SDs:  Hvib = E - i/(2*dt) * Re(St - St^+)
+
+  \param[in] SD_basis The definitions of the SDs
+  \param[in] St The TDM in the basis of the spin-orbitals
+  \param[in] E The energies of the spin-orbitals
+  \param[in] dE The energy corrections for each SD
+  \param[in] dt The nuclear timestep [units: a.u.]
+*/
+
+  int n = SD_basis.size();
+
+  CMATRIX st(nbra_ovlp_mat_arb(SD_basis, SD_basis, St));
+  CMATRIX Hvib(nbra_energy_mat_arb(SD_basis, E, dE));
+
+  for(int i=0;i<n;i++){
+    for(int j=0;j<n;j++){
+      double d = (st.M[i*n+j] - std::conj(st.M[j*n+i])).real();
+      Hvib.M[i*n+j] -= complex<double>(0.0, 0.5*d/dt);
+    }
+  }
+
+  return Hvib;
+}
+
+
+CMATRIXMap nbra_step3(CMATRIXMap& S, CMATRIXMap& St, CMATRIXMap& E,
+  vector<vector<int> >& SD_basis, vector<double>& SD_energy_corr, CMATRIX& CI_basis, bp::dict params){
+/**
+  \brief Convert the KS time series of all data sets into the vibronic Hamiltonians in the basis
+  of the CI states - the C++ version of the step3.run function
+
+  \param[in] S The overlaps of the KS spin-orbitals: S[idata][istep]
+  \param[in,out] St The TDMs in the basis of the KS spin-orbitals: St[idata][istep]. Upon return,
+             these are orthonormalized, reordered, and phase-corrected according to the parameters
+  \param[in,out] E The energies of the KS spin-orbitals: E[idata][istep]
+  \param[in] SD_basis The definitions of the SDs - see step3.run
+  \param[in] SD_energy_corr The energy corrections for each SD [units: Ha]
+  \param[in] CI_basis The n_SD x n_CI matrix of the CI coefficients
+  \param[in] params The dictionary of the control parameters, the keys are the same as in step3.run:
+             "dt", "do_orthogonalization", "do_state_reordering", "state_reordering_alpha", "do_phase_correction",
+             and also "state_reordering_tol" - the block threshold for do_state_reordering = 5 [default: 0.01]
+
+  The data sets are processed in parallel; the timesteps are processed in parallel wherever they are
+  independent (all stages but the state reordering)
+
+  Returns the vibronic Hamiltonians Hvib[idata][istep]
+*/
+
+  double dt = 41.0;
+  int do_orthogonalization = 0;
+  int do_state_reordering = 2;
+  double state_reordering_alpha = 0.0;
+  double state_reordering_tol = 0.01;
+  int do_phase_correction = 1;
+
+  std::string key;
+  for(int i=0;i<len(params.values());i++){
+    key = bp::extract<std::string>(params.keys()[i]);
+
+    if(key=="dt") { dt = bp::extract<double>(params.values()[i]); }
+    else if(key=="do_orthogonalization") { do_orthogonalization = bp::extract<int>(params.values()[i]); }
+    else if(key=="do_state_reordering") { do_state_reordering = bp::extract<int>(params.values()[i]); }
+    else if(key=="state_reordering_alpha") { state_reordering_alpha = bp::extract<double>(params.values()[i]); }
+    else if(key=="state_reordering_tol") { state_reordering_tol = bp::extract<double>(params.values()[i]); }
+    else if(key=="do_phase_correction") { do_phase_correction = bp::extract<int>(params.values()[i]); }
+  }
+
+  int ndata = St.size();
+  int idata, i;
+
+  if(S.size()!=ndata || E.size()!=ndata){
+    cout<<"Error in nbra_step3: the S, St, and E inputs should contain the same number of data sets\nExiting...\n"; exit(0);
+  }
+  if(CI_basis.n_rows!=SD_basis.size()){
+    cout<<"Error in nbra_step3: the number of rows of CI_basis ("<<CI_basis.n_rows<<") should be equal ";
+    cout<<"to the number of SDs ("<<SD_basis.size()<<")\nExiting...\n"; exit(0);
+  }
+  if(SD_energy_corr.size()!=SD_basis.size()){
+    cout<<"Error in nbra_step3: the number of SD energy corrections should be equal to the number of SDs\nExiting...\n"; exit(0);
+  }
+
+  // Flattened list of all (data set, timestep) pairs
+  vector<int> job_data, job_step;
+  for(idata=0;idata<ndata;idata++){
+    for(i=0;i<St[idata].size();i++){  job_data.push_back(idata); job_step.push_back(i);  }
+  }
+  int njobs = job_data.size();
+
+
+  // 1. Lowdin orthonormalization of the KS orbitals
+  if(do_orthogonalization>0){
+    for(idata=0;idata<ndata;idata++){  nbra_apply_normalization(S[idata], St[idata]);  }
+  }
+
+  // 2. State reordering - sequential in time, so parallel over the data sets only
+  if(do_state_reordering>0){
+    #pragma omp parallel for
+    for(idata=0;idata<ndata;idata++){
+      nbra_apply_state_reordering(St[idata], E[idata], do_state_reordering, state_reordering_alpha, state_reordering_tol);
+    }
+  }
+
+  // 3. Phase correction
+  if(do_phase_correction>0){
+    for(idata=0;idata<ndata;idata++){  nbra_apply_phase_correction(St[idata]);  }
+  }
+
+  // 4. Hvib in the SD basis and its transformation to the CI basis
+  int n_chi = CI_basis.n_cols;
+  CMATRIXMap Hvib(ndata);
+  for(idata=0;idata<ndata;idata++){  Hvib[idata] = vector<CMATRIX>(St[idata].size(), CMATRIX(n_chi, n_chi));  }
+
+  #pragma omp parallel for
+  for(int job=0; job<njobs; job++){
+    int idat = job_data[job];
+    int istep = job_step[job];
+
+    CMATRIX hvib_sd(nbra_compute_Hvib(SD_basis, St[idat][istep], E[idat][istep], SD_energy_corr, dt));
+    CMATRIX SD2CI(nbra_sac_matrix(CI_basis, SD_basis, S[idat][istep]));
+
+    Hvib[idat][istep] = SD2CI.H() * hvib_sd * SD2CI;
+  }
+
+  return Hvib;
+}
+
+
+
+}// namespace libdyn
+}// liblibra
+
@@ -0,0 +1,55 @@
+/*********************************************************************************
+* Copyright (C) 2015-2019 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file dyn_nbra.h
+  \brief The header for dyn_nbra.cpp
+
+*/
+
+#ifndef DYN_NBRA_H
+#define DYN_NBRA_H
+
+// External dependencies
+#include "../math_linalg/liblinalg.h"
+#include "../io/libio.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace libio;
+namespace bp = boost::python;
+
+/// libdyn namespace
+namespace libdyn{
+
+
+vector<int> nbra_sd2indx(vector<int>& sd);
+CMATRIX nbra_ovlp_mat_arb(vector<vector<int> >& SD1, vector<vector<int> >& SD2, CMATRIX& S);
+CMATRIX nbra_energy_mat_arb(vector<vector<int> >& SD, CMATRIX& E, vector<double>& dE);
+
+void nbra_lowdin(CMATRIX& S, CMATRIX& S_i_half);
+void nbra_apply_normalization(vector<CMATRIX>& S, vector<CMATRIX>& St);
+void nbra_apply_state_reordering(vector<CMATRIX>& St, vector<CMATRIX>& E, int algo, double alpha, double tol);
+void nbra_apply_state_reordering(vector<CMATRIX>& St, vector<CMATRIX>& E, int algo, double alpha);
+void nbra_apply_phase_correction(vector<CMATRIX>& St);
+
+CMATRIX nbra_sac_matrix(CMATRIX& CI_basis, vector<vector<int> >& SD_basis, CMATRIX& S);
+CMATRIX nbra_compute_Hvib(vector<vector<int> >& SD_basis, CMATRIX& St, CMATRIX& E, vector<double>& dE, double dt);
+
+CMATRIXMap nbra_step3(CMATRIXMap& S, CMATRIXMap& St, CMATRIXMap& E,
+  vector<vector<int> >& SD_basis, vector<double>& SD_energy_corr, CMATRIX& CI_basis, bp::dict params);
+
+
+}// namespace libdyn
+}// liblibra
+
+#endif // DYN_NBRA_H
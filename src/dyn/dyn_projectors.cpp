@@ -19,6 +19,9 @@
   vector<int> get_reordering(CMATRIX& time_overlap)
   MATRIX make_cost_mat(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha)
   vector<int> Munkres_Kuhn(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha, int verbosity)
+  vector<int> Jonker_Volgenant(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha, vector<int>& guess, int verbosity)
+  vector<vector<int> > get_overlap_blocks(CMATRIX& time_overlap, double tol)
+  vector<int> get_block_reordering(CMATRIX& time_overlap, CMATRIX& en_mat_inp, double alpha, double tol)
   vector<int> get_stochastic_reordering(CMATRIX& time_overlap, Random& rnd)
   CMATRIX permute2cmatrix(vector<int>& permutation)
   void update_projectors(dyn_control_params& prms, vector<CMATRIX>& projectors, 
@@ -215,6 +218,121 @@ vector<int> Munkres_Kuhn(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha
 }
 
 
+vector<int> Jonker_Volgenant(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha, vector<int>& guess, int verbosity){
+/**
+  Same assignment as in Munkres_Kuhn, but found with the Jonker-Volgenant algorithm
+  starting from the guess permutation (e.g. the identity or the previous step's one)
+*/
+
+    MATRIX cost_mat = make_cost_mat(orb_mat_inp, en_mat_inp, alpha);
+
+    return Jonker_Volgenant_maximize(cost_mat, guess, verbosity);
+
+}
+
+
+vector<vector<int> > get_overlap_blocks(CMATRIX& time_overlap, double tol){
+/**
+  Split the states into the blocks connected by the significant time-overlaps: the states 
+  i and j are in the same block if |<i(t)|j(t+dt)>|^2 > tol, directly or via other states
+
+  \param[in] time_overlap ( CMATRIX ) the time overlap matrix, <phi_i(t)|phi_j(t+dt)>.
+  \param[in] tol The threshold for the squared overlaps
+
+  Returns: the list of blocks, each one is the ordered list of the state indices. The blocks are
+  ordered by their first state
+*/
+
+  int nst = time_overlap.n_rows;
+  int i,j;
+
+  // Union-find of the states, the root of each set is its smallest index
+  vector<int> root(nst, 0);
+  for(i=0;i<nst;i++){ root[i] = i; }
+
+  for(i=0;i<nst;i++){
+    for(j=0;j<nst;j++){
+      if(i==j){ continue; }
+      if(std::norm(time_overlap.M[i*nst+j]) > tol){
+
+        int ri = i; while(root[ri]!=ri){ ri = root[ri]; }
+        int rj = j; while(root[rj]!=rj){ rj = root[rj]; }
+
+        if(ri<rj){ root[rj] = ri; }
+        else if(rj<ri){ root[ri] = rj; }
+
+        root[i] = root[ri]; root[j] = root[rj];  // path shortcuts
+      }
+    }
+  }
+
+  vector<vector<int> > blocks;
+  vector<int> block_indx(nst, -1);
+
+  for(i=0;i<nst;i++){
+    int ri = i; while(root[ri]!=ri){ ri = root[ri]; }
+
+    if(block_indx[ri]<0){
+      block_indx[ri] = blocks.size();
+      blocks.push_back(vector<int>());
+    }
+    blocks[block_indx[ri]].push_back(i);
+  }
+
+  return blocks;
+}
+
+
+vector<int> get_block_reordering(CMATRIX& time_overlap, CMATRIX& en_mat_inp, double alpha, double tol){
+/**
+  The state reordering of the Munkres_Kuhn type, but solved independently for each block of the
+  strongly overlapping states (see get_overlap_blocks). The single-state blocks keep their labels,
+  so the cost only grows with the sizes of the blocks of the states that actually cross
+
+  \param[in] time_overlap ( CMATRIX ) the time overlap matrix, <phi_i(t)|phi_j(t+dt)>.
+  \param[in] en_mat_inp ( CMATRIX ) the energies of states [units: a.u.]
+  \param[in] alpha The parameter of the cost function, see make_cost_mat [units: a.u.^-1]
+  \param[in] tol The threshold for the squared overlaps defining the blocks
+
+  Returns: the permutation, with the same meaning as in get_reordering
+*/
+
+  int nst = time_overlap.n_rows;
+  int i,a,b;
+
+  vector<int> perm(nst, 0);
+  for(i=0;i<nst;i++){ perm[i] = i; }
+
+  vector<vector<int> > blocks = get_overlap_blocks(time_overlap, tol);
+
+  for(i=0;i<blocks.size();i++){
+
+    vector<int>& blk = blocks[i];
+    int sz = blk.size();
+
+    if(sz==1){ continue; }
+
+    CMATRIX st(sz, sz);
+    CMATRIX en(sz, sz);
+    vector<int> guess(sz, 0);
+
+    for(a=0;a<sz;a++){
+      guess[a] = a;
+      for(b=0;b<sz;b++){
+        st.M[a*sz+b] = time_overlap.M[blk[a]*nst+blk[b]];
+        en.M[a*sz+b] = en_mat_inp.M[blk[a]*nst+blk[b]];
+      }
+    }
+
+    vector<int> perm_blk = Jonker_Volgenant(st, en, alpha, guess, 0);
+    for(a=0;a<sz;a++){  perm[blk[a]] = blk[perm_blk[a]];  }
+
+  }// for i
+
+  return perm;
+}
+
+
 
 
 vector<int> get_stochastic_reordering(CMATRIX& time_overlap, Random& rnd){
@@ -350,6 +468,9 @@ void update_projectors(dyn_control_params& prms, vector<CMATRIX>& projectors,
   vector<int> perm_t(nst,0); 
   for(int i=0; i<nst; i++){ perm_t[i] = i; }
 
+  // The states are most likely to keep their labels - the warm start for the algo 4
+  vector<int> perm_id(perm_t);
+
   CMATRIX phase_i(nst, 1);
   CMATRIX st(nst, nst);
   CMATRIX ist(nst, nst);
@@ -366,19 +487,46 @@ void update_projectors(dyn_control_params& prms, vector<CMATRIX>& projectors,
     else if(prms.state_tracking_algo==2){
         perm_t = Munkres_Kuhn(st, Eadi[traj], prms.MK_alpha, prms.MK_verbosity);
     }
+    else if(prms.state_tracking_algo==4){
+        perm_t = Jonker_Volgenant(st, Eadi[traj], prms.MK_alpha, perm_id, prms.MK_verbosity);
+    }
+    else if(prms.state_tracking_algo==5){
+        perm_t = get_block_reordering(st, Eadi[traj], prms.MK_alpha, prms.state_tracking_tol);
+    }
     if(prms.state_tracking_algo==3){
         perm_t = get_stochastic_reordering(st, rnd);
     }
 
-    // P -> P * perm
-    CMATRIX p_i(nst, nst);
-    p_i = permutation2cmatrix(perm_t);
-    projectors[traj] = projectors[traj] * p_i; 
-    st = projector_old.H() * st * projectors[traj];
-    
+    // P -> P * perm: the column a of the new projector is the column perm_t[a] of the old one
+    for(int a=0; a<nst; a++){
+      for(int k=0; k<nst; k++){
+        projectors[traj].M[k*nst+a] = projector_old.M[k*nst+perm_t[a]];
+      }
+    }
+
 
     if(prms.do_phase_correction){
 
+      // Only the diagonal of st = P_old^+ * St * P_new is needed for the phase corrections. The
+      // projectors are the products of the permutations and phases, so only their non-zero
+      // elements are included
+      for(int a=0; a<nst; a++){
+        vector<int> k_old, k_new;
+        for(int k=0; k<nst; k++){
+          if(projector_old.M[k*nst+a]!=0.0){ k_old.push_back(k); }
+          if(projectors[traj].M[k*nst+a]!=0.0){ k_new.push_back(k); }
+        }
+
+        complex<double> saa(0.0, 0.0);
+        for(int k=0; k<k_old.size(); k++){
+          for(int l=0; l<k_new.size(); l++){
+            saa += std::conj(projector_old.M[k_old[k]*nst+a]) * St[traj].M[k_old[k]*nst+k_new[l]] 
+                 * projectors[traj].M[k_new[l]*nst+a];
+          }
+        }
+        st.M[a*nst+a] = saa;
+      }
+
       // ### Compute the instantaneous phase correction factors ###
       phase_i = compute_phase_corrections(st);  // f(i)
 
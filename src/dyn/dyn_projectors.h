@@ -37,6 +37,9 @@ CMATRIX compute_phase_corrections(CMATRIX& S);
 vector<int> get_reordering(CMATRIX& time_overlap);
 MATRIX make_cost_mat(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha);
 vector<int> Munkres_Kuhn(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha, int verbosity);
+vector<int> Jonker_Volgenant(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha, vector<int>& guess, int verbosity);
+vector<vector<int> > get_overlap_blocks(CMATRIX& time_overlap, double tol);
+vector<int> get_block_reordering(CMATRIX& time_overlap, CMATRIX& en_mat_inp, double alpha, double tol);
 vector<int> get_stochastic_reordering(CMATRIX& time_overlap, Random& rnd);
 CMATRIX permutation2cmatrix(vector<int>& permutation);
 void update_projectors(dyn_control_params& prms, vector<CMATRIX>& projectors, 
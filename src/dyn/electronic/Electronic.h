@@ -148,9 +148,44 @@ void propagate_electronic(double dt, CMATRIX& C, nHamiltonian& ham, int rep, int
 void propagate_electronic(double dt, CMATRIX& C, vector<CMATRIX>& projector, nHamiltonian& ham, int rep, int level);
 //void propagate_electronic(double dt, nHamiltonian& ham, int rep);
 
+void compute_propagator(double dt, CMATRIX& Hvib, CMATRIX& U);
+CMATRIX compute_propagator(double dt, CMATRIX& Hvib);
+void propagate_electronic_nbra(double dt, CMATRIX& C, vector<CMATRIX>& projector, vector<nHamiltonian*>& ham, int rep);
+void propagate_electronic_nbra(double dt, CMATRIX& C, vector<CMATRIX>& projector, nHamiltonian& ham, int rep, int level);
+
 void grid_propagator(double dt, CMATRIX& Hvib, CMATRIX& S, CMATRIX& U);
 
 
+// In Electronic_Krylov.cpp
+
+class Hvib_operator{
+/**
+  The vibronic Hamiltonian prepared for repeated matrix-vector products: the compressed sparse row (CSR)
+  storage is used if the matrix is sufficiently sparse, otherwise the dense matrix is referenced
+*/
+
+public:
+  int n;                              ///< the size of the matrix
+  int is_sparse;                      ///< 1 - CSR storage is used, 0 - the dense matrix is used
+  CMATRIX* dense;                     ///< the dense matrix (referenced, not copied)
+  vector<int> row_ptr;                ///< CSR row pointers: n + 1 elements
+  vector<int> col_idx;                ///< CSR column indices of the nonzero elements
+  vector< complex<double> > val;      ///< CSR values of the nonzero elements
+
+  Hvib_operator(CMATRIX& Hvib, double sparse_tol);
+  void apply(const complex<double>* x, complex<double>* y) const;
+};
+
+void expm_small(CMATRIX& A, CMATRIX& res);
+void krylov_exp(CMATRIX& Hm, int m, double h, CMATRIX& F);
+int krylov_step(double dt, complex<double>* c, const Hvib_operator& H, int max_dim, double tol, int is_hermitian);
+
+int propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int max_dim, double tol, int is_hermitian, double sparse_tol);
+int propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int max_dim, double tol, int is_hermitian);
+int propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib);
+int propagate_electronic_krylov(double dt, vector<CMATRIX>& Coeff, CMATRIX& Hvib, int max_dim, double tol, int is_hermitian, double sparse_tol);
+
+
 }// namespace libelectronic
 
 }// namespace libdyn
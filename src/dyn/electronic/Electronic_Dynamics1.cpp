@@ -1060,6 +1060,149 @@ void propagate_electronic(double dt, CMATRIX& C, vector<CMATRIX>& projector, vec
 
 
 
+void compute_propagator(double dt, CMATRIX& Hvib, CMATRIX& U){
+/**
+  \brief Computes the propagator U = exp(-i*Hvib*dt) for the Hermitian vibronic Hamiltonian
+
+  Once computed, the propagator can be applied to any number of amplitude vectors (e.g. all the trajectories
+  that experience the same Hamiltonian, as in the NBRA) as a single matrix-matrix product: C(t+dt) = U * C(t)
+
+  \param[in] dt The integration time step
+  \param[in] Hvib The vibronic Hamiltonian: nstates x nstates matrix, assumed to be Hermitian
+  \param[out] U The propagator: nstates x nstates matrix
+*/
+
+  int sz = Hvib.n_cols;
+  if(U.n_rows!=sz || U.n_cols!=sz){
+    cout<<"Error in compute_propagator: the propagator matrix must be "<<sz<<" x "<<sz<<"\nExiting...\n"; exit(0);
+  }
+
+  U = complex<double>(0.0, 0.0);
+  exp_matrix(U, Hvib, complex<double>(0.0, -dt) );
+
+}
+
+CMATRIX compute_propagator(double dt, CMATRIX& Hvib){
+/**
+  \brief Python-friendly version of compute_propagator: returns U = exp(-i*Hvib*dt)
+*/
+
+  CMATRIX U(Hvib.n_rows, Hvib.n_cols);
+  compute_propagator(dt, Hvib, U);
+
+  return U;
+}
+
+
+void propagate_electronic_nbra(double dt, CMATRIX& C, vector<CMATRIX>& projector, vector<nHamiltonian*>& ham, int rep){
+/**
+  \brief Propagates the amplitudes of all trajectories that share the same vibronic Hamiltonian (NBRA)
+
+  In the NBRA all the trajectories experience the same Hvib(t), so the propagator is computed only once
+  (from the first trajectory's Hamiltonian) and is applied to the whole nstates x ntraj block of amplitudes as
+  a single matrix-matrix product, instead of ntraj separate propagations.
+
+  In the adiabatic representation, the projectors (state tracking and phase corrections) may be different for
+  different trajectories. The trajectories whose projector coincides with that of the first trajectory are propagated
+  together, the remaining ones are propagated individually with the propagator built for their own projector.
+
+  \param[in] dt The integration time step
+  \param[in,out] C The amplitudes of all trajectories: nstates x ntraj matrix
+  \param[in] projector The projector matrices of all trajectories
+  \param[in] ham The Hamiltonians of all trajectories (all are assumed to contain the same Hvib)
+  \param[in] rep The representation: 0 - diabatic, 1 - adiabatic
+*/
+
+  if(C.n_cols!=ham.size()){
+    cout<<"ERROR in propagate_electronic_nbra: C.n_cols = "<<C.n_cols<<" is not equal to ham.size() = "<<ham.size()<<"\n";
+    cout<<"Exiting...\n";
+    exit(0);
+  }
+
+  int nst = C.n_rows;
+  int ntraj = C.n_cols;
+  int traj, st, i;
+
+  if(ntraj==0){ return; }
+
+  CMATRIX U(nst, nst);
+
+  if(rep==0){  // diabatic - the overlaps of the diabatic states are the same too
+
+    CMATRIX Hvib(ham[0]->ndia, ham[0]->ndia);  Hvib = ham[0]->get_hvib_dia();
+    CMATRIX Sdia(ham[0]->ndia, ham[0]->ndia);  Sdia = ham[0]->get_ovlp_dia();
+
+    grid_propagator(dt, Hvib, Sdia, U);
+    C = U * C;
+
+  }
+  else if(rep==1){  // adiabatic
+
+    CMATRIX Hraw(ham[0]->nadi, ham[0]->nadi);  Hraw = ham[0]->get_hvib_adi();
+    CMATRIX Hvib(nst, nst);
+
+    // Find the trajectories with the same projector as the first one
+    vector<int> batch;
+    vector<int> rest;
+    for(traj=0; traj<ntraj; traj++){
+      int is_same = 1;
+      for(i=0; i<nst*nst && is_same; i++){
+        if(std::abs(projector[traj].M[i] - projector[0].M[i]) > 1e-12){ is_same = 0; }
+      }
+      if(is_same){ batch.push_back(traj); }
+      else{ rest.push_back(traj); }
+    }
+
+    // All trajectories in the batch - one matrix-matrix product
+    Hvib = projector[0].H() * Hraw * projector[0];
+    compute_propagator(dt, Hvib, U);
+
+    if(batch.size()==ntraj){  C = U * C;  }
+    else{
+      int nb = batch.size();
+      CMATRIX Cb(nst, nb);
+      for(st=0; st<nst; st++){
+        for(i=0; i<nb; i++){  Cb.M[st*nb+i] = C.M[st*ntraj+batch[i]];  }
+      }
+      Cb = U * Cb;
+      for(st=0; st<nst; st++){
+        for(i=0; i<nb; i++){  C.M[st*ntraj+batch[i]] = Cb.M[st*nb+i];  }
+      }
+    }
+
+    // The remaining trajectories - one by one
+    CMATRIX ctmp(nst, 1);
+    for(i=0; i<rest.size(); i++){
+      traj = rest[i];
+
+      Hvib = projector[traj].H() * Hraw * projector[traj];
+      compute_propagator(dt, Hvib, U);
+
+      ctmp = C.col(traj);
+      ctmp = U * ctmp;
+      for(st=0; st<nst; st++){  C.set(st, traj, ctmp.get(st, 0));  }
+    }
+
+  }// rep == 1
+
+}
+
+
+void propagate_electronic_nbra(double dt, CMATRIX& C, vector<CMATRIX>& projector, nHamiltonian& ham, int rep, int level){
+/**
+  \brief Python-friendly version of propagate_electronic_nbra: the Hamiltonians of the trajectories are the branches
+  of the given level of the ham object
+*/
+
+  vector<nHamiltonian*> branches; 
+  branches = ham.get_branches(level);
+
+  propagate_electronic_nbra(dt, C, projector, branches, rep);
+
+}
+
+
+
 void propagate_electronic(double dt, CMATRIX& C, nHamiltonian& ham, int rep, int level){
 
   vector<nHamiltonian*> branches; 
@@ -0,0 +1,404 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Electronic_Krylov.cpp
+  \brief The file implements the Krylov-subspace (Lanczos/Arnoldi) short-iterative propagators for TD-SE
+
+*/
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "Electronic.h"
+#include <cmath>
+
+/// liblibra namespace
+namespace liblibra{
+
+
+/// libdyn namespace
+namespace libdyn{
+
+/// libelectronic namespace
+namespace libelectronic{
+
+
+Hvib_operator::Hvib_operator(CMATRIX& Hvib, double sparse_tol){
+/**
+  \brief Prepare the vibronic Hamiltonian for repeated matrix-vector products
+
+  The matrix elements with |H_ij| <= sparse_tol are dropped. If the remaining (nonzero) elements
+  constitute less than 30% of the matrix, the compressed sparse row (CSR) representation is used,
+  so the cost of the product scales with the number of nonzero elements. Otherwise, the dense
+  matrix is used.
+
+  \param[in] Hvib The vibronic Hamiltonian: nstates x nstates matrix
+  \param[in] sparse_tol The threshold below which the matrix elements are considered zero
+*/
+
+  if(Hvib.n_rows!=Hvib.n_cols){
+    cout<<"Error in Hvib_operator: the Hamiltonian matrix is not square\nExiting...\n"; exit(0);
+  }
+
+  int i,j;
+  n = Hvib.n_rows;
+  dense = &Hvib;
+
+  int nnz = 0;
+  for(i=0;i<n*n;i++){  if(std::abs(Hvib.M[i]) > sparse_tol){ nnz++; }  }
+
+  is_sparse = (nnz < 0.3*n*n);
+
+  if(is_sparse){
+    row_ptr = vector<int>(n+1, 0);
+    col_idx.reserve(nnz);
+    val.reserve(nnz);
+
+    for(i=0;i<n;i++){
+      for(j=0;j<n;j++){
+        complex<double> x = Hvib.M[i*n+j];
+        if(std::abs(x) > sparse_tol){  col_idx.push_back(j);  val.push_back(x);  }
+      }
+      row_ptr[i+1] = col_idx.size();
+    }
+  }
+
+}
+
+
+void Hvib_operator::apply(const complex<double>* x, complex<double>* y) const{
+/**
+  \brief Computes y = Hvib * x
+
+  \param[in] x The pointer to the input vector of n elements
+  \param[out] y The pointer to the output vector of n elements
+*/
+
+  int i,k;
+
+  if(is_sparse){
+    for(i=0;i<n;i++){
+      complex<double> s(0.0, 0.0);
+      for(k=row_ptr[i];k<row_ptr[i+1];k++){  s += val[k] * x[col_idx[k]];  }
+      y[i] = s;
+    }
+  }
+  else{
+    const complex<double>* h = dense->M;
+    for(i=0;i<n;i++){
+      complex<double> s(0.0, 0.0);
+      for(k=0;k<n;k++){  s += h[i*n+k] * x[k];  }
+      y[i] = s;
+    }
+  }
+
+}
+
+
+void expm_small(CMATRIX& A, CMATRIX& res){
+/**
+  \brief Computes res = exp(A) for a small general (not necessarily Hermitian) matrix A
+
+  The scaling and squaring method with the Taylor expansion is used: exp(A) = [exp(A/2^s)]^(2^s),
+  where s is chosen such that ||A/2^s|| < 0.5. This is used for the projected (Krylov) matrices,
+  whose size is only a few tens.
+
+  \param[in] A The input matrix
+  \param[out] res The exponential of the matrix A, must be allocated with the same size as A
+*/
+
+  int i,j;
+  int m = A.n_rows;
+
+  if(A.n_cols!=m || res.n_rows!=m || res.n_cols!=m){
+    cout<<"Error in expm_small: the matrices must be square and of the same size\nExiting...\n"; exit(0);
+  }
+
+  // Infinity norm
+  double nrm = 0.0;
+  for(i=0;i<m;i++){
+    double s = 0.0;
+    for(j=0;j<m;j++){ s += std::abs(A.M[i*m+j]); }
+    if(s>nrm){ nrm = s; }
+  }
+
+  int sc = 0;
+  if(nrm>0.5){ sc = (int)ceil(log(nrm/0.5)/log(2.0)); }
+
+  CMATRIX As(m,m);  As = A;  As *= (1.0/pow(2.0, sc));
+
+  CMATRIX term(m,m);  term.load_identity();
+  res.load_identity();
+
+  for(int k=1;k<=30;k++){
+    term = term * As;
+    term *= (1.0/k);
+    res += term;
+
+    double tnrm = 0.0;
+    for(i=0;i<m*m;i++){ tnrm += std::abs(term.M[i]); }
+    if(tnrm < 1e-18){ break; }
+  }
+
+  for(i=0;i<sc;i++){  res = res * res;  }
+
+}
+
+
+void krylov_exp(CMATRIX& Hm, int m, double h, CMATRIX& F){
+/**
+  \brief Computes F = exp(-i*h*H_m) for the leading m x m block H_m of the projected (Krylov) matrix Hm
+
+  \param[in] Hm The projected matrix (its leading dimension is Hm.n_cols)
+  \param[in] m The size of the subspace
+  \param[in] h The time step
+  \param[out] F The result: m x m matrix
+*/
+
+  int ld = Hm.n_cols;
+  const complex<double> one(0.0, 1.0);
+
+  CMATRIX A(m,m);
+  for(int i=0;i<m;i++){
+    for(int k=0;k<m;k++){  A.M[i*m+k] = -one * h * Hm.M[i*ld+k];  }
+  }
+  expm_small(A, F);
+
+}
+
+
+int krylov_step(double dt, complex<double>* c, const Hvib_operator& H, int max_dim, double tol, int is_hermitian){
+/**
+  \brief Propagates a single vector c by exp(-i*Hvib*dt) using the Krylov subspace of adaptive size
+
+  The Krylov subspace is extended until the a posteriori error estimate,
+  err = h_{m+1,m} * |[exp(-i*dt*H_m)]_{m,1}| * ||c||, drops below tol*(h/dt) (the error per unit time),
+  or until the subspace size reaches max_dim. In the latter case, the time step is halved (substepping)
+  until the estimate is satisfied - this reuses the same subspace, so no extra matrix-vector products are needed.
+  After each accepted step, a twice longer step is attempted.
+
+  \param[in] dt The duration of the propagation
+  \param[in,out] c The pointer to the vector of n elements (the size of H)
+  \param[in] H The vibronic Hamiltonian operator
+  \param[in] max_dim The maximal size of the Krylov subspace
+  \param[in] tol The error tolerance for the propagation over the whole dt
+  \param[in] is_hermitian If 1 - Hvib is Hermitian and the Lanczos 3-term recurrence is used,
+             if 0 - the Arnoldi process with the full orthogonalization is used
+
+  Returns the number of matrix-vector products performed
+*/
+
+  int n = H.n;
+  int i,j,k;
+  int nmv = 0;
+
+  if(max_dim>n){ max_dim = n; }
+  if(max_dim<1){ max_dim = 1; }
+
+  vector< vector< complex<double> > > V(max_dim+1, vector< complex<double> >(n));
+  vector< complex<double> > w(n);
+
+  double t = 0.0;
+  double h = dt;
+
+  while(t < dt*(1.0 - 1e-12)){
+
+    if(h > dt - t){ h = dt - t; }
+
+    double beta = 0.0;
+    for(i=0;i<n;i++){ beta += std::norm(c[i]); }  beta = sqrt(beta);
+    if(beta==0.0){ break; }
+
+    for(i=0;i<n;i++){ V[0][i] = c[i] / beta; }
+
+    CMATRIX Hm(max_dim+1, max_dim+1);
+    CMATRIX* F = NULL;
+    int m = 0;
+    int is_converged = 0;
+    double b = 0.0;
+
+    for(j=0;j<max_dim;j++){
+
+      H.apply(&V[j][0], &w[0]);  nmv++;
+
+      if(is_hermitian){
+        if(j>0){
+          complex<double> bp = Hm.M[(j-1)*(max_dim+1)+j];
+          for(i=0;i<n;i++){ w[i] -= bp * V[j-1][i]; }
+        }
+        complex<double> a(0.0, 0.0);
+        for(i=0;i<n;i++){ a += std::conj(V[j][i]) * w[i]; }
+        a = complex<double>(a.real(), 0.0);
+        for(i=0;i<n;i++){ w[i] -= a * V[j][i]; }
+        Hm.M[j*(max_dim+1)+j] = a;
+      }
+      else{
+        for(k=0;k<=j;k++){
+          complex<double> a(0.0, 0.0);
+          for(i=0;i<n;i++){ a += std::conj(V[k][i]) * w[i]; }
+          for(i=0;i<n;i++){ w[i] -= a * V[k][i]; }
+          Hm.M[k*(max_dim+1)+j] = a;
+        }
+      }
+
+      b = 0.0;
+      for(i=0;i<n;i++){ b += std::norm(w[i]); }  b = sqrt(b);
+
+      Hm.M[(j+1)*(max_dim+1)+j] = b;
+      if(is_hermitian){  Hm.M[j*(max_dim+1)+j+1] = b;  }
+
+      m = j+1;
+
+      if(F!=NULL){ delete F; }
+      F = new CMATRIX(m,m);
+      krylov_exp(Hm, m, h, *F);
+
+      // Happy breakdown: the subspace is invariant, so the result is exact
+      if(b < 1e-14 || m==n){ is_converged = 1; break; }
+
+      if(b * std::abs(F->M[(m-1)*m]) * beta <= tol*(h/dt)){ is_converged = 1; break; }
+
+      if(j+1<max_dim){  for(i=0;i<n;i++){ V[j+1][i] = w[i] / b; }  }
+
+    }// for j
+
+    // The subspace of the maximal size is not sufficient for the step h: reuse it with shorter steps
+    while(!is_converged){
+      h *= 0.5;
+      if(h < 1e-12*dt){
+        cout<<"Error in krylov_step: the time step became too small, increase max_dim or tol\nExiting...\n"; exit(0);
+      }
+      krylov_exp(Hm, m, h, *F);
+      if(b * std::abs(F->M[(m-1)*m]) * beta <= tol*(h/dt)){ is_converged = 1; }
+    }
+
+    // Accept the step: c = beta * V_m * exp(-i*h*H_m) * e_1
+    for(i=0;i<n;i++){
+      complex<double> s(0.0, 0.0);
+      for(k=0;k<m;k++){  s += V[k][i] * F->M[k*m];  }
+      c[i] = beta * s;
+    }
+    delete F;
+
+    t += h;
+
+    // Try a longer step next time: a subspace is never wasted, since it can be reused for shorter steps
+    h *= 2.0;
+
+  }// while
+
+  return nmv;
+}
+
+
+int propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int max_dim, double tol, int is_hermitian, double sparse_tol){
+/**
+  \brief Solves the TD-SE i*hbar*dc/dt = Hvib*c with the Krylov-subspace (Lanczos/Arnoldi) short-iterative propagator
+
+  Unlike propagate_electronic_eig, no diagonalization of the full Hvib is done: only matrix-vector products
+  with Hvib are needed, so the cost is O(N^2 * m) for dense or O(nnz * m) for sparse Hamiltonians, where m is
+  the (adaptively chosen) size of the Krylov subspace, typically 10-30.
+
+  All columns of Coeff (e.g. the amplitudes of all trajectories) are propagated with the same Hvib, which is
+  analyzed (converted to the sparse form, if beneficial) only once. With OpenMP, the columns are propagated in parallel.
+
+  \param[in] dt The integration time step (also the duration of propagation)
+  \param[in,out] Coeff The electronic amplitudes: nstates x ntraj matrix, each column is propagated
+  \param[in] Hvib The vibronic Hamiltonian: nstates x nstates matrix
+  \param[in] max_dim The maximal size of the Krylov subspace (default: 30)
+  \param[in] tol The error tolerance for the propagation of each vector over dt (default: 1e-10)
+  \param[in] is_hermitian 1 - Hvib is Hermitian, the Lanczos algorithm is used (default);
+             0 - a general Hvib, the Arnoldi algorithm is used
+  \param[in] sparse_tol The matrix elements of Hvib with the magnitude below this value are considered zero (default: 0.0)
+
+  Returns the total number of the matrix-vector products performed
+*/
+
+  if(Coeff.n_rows!=Hvib.n_rows){
+    cout<<"Error in propagate_electronic_krylov: the number of rows of Coeff ("<<Coeff.n_rows;
+    cout<<") does not match the size of Hvib ("<<Hvib.n_rows<<")\nExiting...\n"; exit(0);
+  }
+
+  int nst = Coeff.n_rows;
+  int ncol = Coeff.n_cols;
+  int nmv = 0;
+
+  Hvib_operator H(Hvib, sparse_tol);
+
+  #pragma omp parallel for reduction(+:nmv) schedule(dynamic)
+  for(int traj=0; traj<ncol; traj++){
+
+    vector< complex<double> > c(nst);
+    for(int i=0;i<nst;i++){ c[i] = Coeff.M[i*ncol+traj]; }
+
+    nmv += krylov_step(dt, &c[0], H, max_dim, tol, is_hermitian);
+
+    for(int i=0;i<nst;i++){ Coeff.M[i*ncol+traj] = c[i]; }
+  }
+
+  return nmv;
+}
+
+
+int propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib, int max_dim, double tol, int is_hermitian){
+  return propagate_electronic_krylov(dt, Coeff, Hvib, max_dim, tol, is_hermitian, 0.0);
+}
+
+int propagate_electronic_krylov(double dt, CMATRIX& Coeff, CMATRIX& Hvib){
+  return propagate_electronic_krylov(dt, Coeff, Hvib, 30, 1e-10, 1, 0.0);
+}
+
+
+int propagate_electronic_krylov(double dt, vector<CMATRIX>& Coeff, CMATRIX& Hvib, int max_dim, double tol, int is_hermitian, double sparse_tol){
+/**
+  \brief The multi-vector version of the Krylov-subspace propagator
+
+  The amplitudes of many trajectories, given as separate nstates x 1 matrices, are propagated through
+  the same Hvib, which is analyzed (converted to the sparse form, if beneficial) only once.
+
+  \param[in] dt The integration time step (also the duration of propagation)
+  \param[in,out] Coeff The electronic amplitudes of all trajectories: each element is nstates x 1 matrix
+  \param[in] Hvib The vibronic Hamiltonian: nstates x nstates matrix
+  \param[in] max_dim The maximal size of the Krylov subspace
+  \param[in] tol The error tolerance for the propagation of each vector over dt
+  \param[in] is_hermitian 1 - Lanczos (Hermitian Hvib), 0 - Arnoldi (general Hvib)
+  \param[in] sparse_tol The matrix elements of Hvib with the magnitude below this value are considered zero
+
+  Returns the total number of the matrix-vector products performed
+*/
+
+  int ntraj = Coeff.size();
+  int nmv = 0;
+
+  for(int traj=0; traj<ntraj; traj++){
+    if(Coeff[traj].n_rows!=Hvib.n_rows || Coeff[traj].n_cols!=1){
+      cout<<"Error in propagate_electronic_krylov: the amplitudes of the trajectory "<<traj;
+      cout<<" must be a "<<Hvib.n_rows<<" x 1 matrix\nExiting...\n"; exit(0);
+    }
+  }
+
+  Hvib_operator H(Hvib, sparse_tol);
+
+  #pragma omp parallel for reduction(+:nmv) schedule(dynamic)
+  for(int traj=0; traj<ntraj; traj++){
+    nmv += krylov_step(dt, Coeff[traj].M, H, max_dim, tol, is_hermitian);
+  }
+
+  return nmv;
+}
+
+
+
+}// namespace libelectronic
+}// namespace libdyn
+}// liblibra
+
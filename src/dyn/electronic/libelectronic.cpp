@@ -91,6 +91,7 @@ void export_Electronic_objects(){
   void (*expt_propagate_electronic_v5)(double dt,CMATRIX& Coeff, CMATRIX& Hvib, CMATRIX& S) = &propagate_electronic;
   void (*expt_propagate_electronic_v6)(double dt, CMATRIX& C, nHamiltonian& ham, int rep) = &propagate_electronic;
   void (*expt_propagate_electronic_v7)(double dt, CMATRIX& C, nHamiltonian& ham, int rep, int level) = &propagate_electronic;
+  void (*expt_propagate_electronic_v8)(double dt, CMATRIX& C, vector<CMATRIX>& projector, nHamiltonian& ham, int rep, int level) = &propagate_electronic;
 
 
   def("propagate_electronic", expt_propagate_electronic_v1);
@@ -100,6 +101,7 @@ void export_Electronic_objects(){
   def("propagate_electronic", expt_propagate_electronic_v5);
   def("propagate_electronic", expt_propagate_electronic_v6);
   def("propagate_electronic", expt_propagate_electronic_v7);
+  def("propagate_electronic", expt_propagate_electronic_v8);
 
 
   void (*expt_propagate_electronic_rot_v1)(double dt,CMATRIX& Coeff, CMATRIX& Hvib) = &propagate_electronic_rot;
@@ -109,6 +111,29 @@ void export_Electronic_objects(){
   def("propagate_electronic_nonHermitian", expt_propagate_electronic_nonHermitian_v1);
 
 
+  CMATRIX (*expt_compute_propagator_v1)(double dt, CMATRIX& Hvib) = &compute_propagator;
+  def("compute_propagator", expt_compute_propagator_v1);
+
+  void (*expt_propagate_electronic_nbra_v1)
+  (double dt, CMATRIX& C, vector<CMATRIX>& projector, nHamiltonian& ham, int rep, int level) = &propagate_electronic_nbra;
+  def("propagate_electronic_nbra", expt_propagate_electronic_nbra_v1);
+
+
+  int (*expt_propagate_electronic_krylov_v1)
+  (double dt, CMATRIX& Coeff, CMATRIX& Hvib, int max_dim, double tol, int is_hermitian, double sparse_tol) = &propagate_electronic_krylov;
+  int (*expt_propagate_electronic_krylov_v2)
+  (double dt, CMATRIX& Coeff, CMATRIX& Hvib, int max_dim, double tol, int is_hermitian) = &propagate_electronic_krylov;
+  int (*expt_propagate_electronic_krylov_v3)
+  (double dt, CMATRIX& Coeff, CMATRIX& Hvib) = &propagate_electronic_krylov;
+  int (*expt_propagate_electronic_krylov_v4)
+  (double dt, vector<CMATRIX>& Coeff, CMATRIX& Hvib, int max_dim, double tol, int is_hermitian, double sparse_tol) = &propagate_electronic_krylov;
+
+  def("propagate_electronic_krylov", expt_propagate_electronic_krylov_v1);
+  def("propagate_electronic_krylov", expt_propagate_electronic_krylov_v2);
+  def("propagate_electronic_krylov", expt_propagate_electronic_krylov_v3);
+  def("propagate_electronic_krylov", expt_propagate_electronic_krylov_v4);
+
+
   void (*expt_grid_propagator_v1)(double dt, CMATRIX& Hvib, CMATRIX& S, CMATRIX& U) = &grid_propagator;
   def("grid_propagator", expt_grid_propagator_v1);
 
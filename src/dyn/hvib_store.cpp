@@ -0,0 +1,481 @@
+/*********************************************************************************
+* Copyright (C) 2015-2019 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file hvib_store.cpp
+  \brief The file implements the binary memory-mapped container of the vibronic Hamiltonians
+  used by the NBRA calculations (the alternative to the one-pair-of-text-files-per-step layout)
+
+*/
+
+#include <fstream>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "hvib_store.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libdyn namespace
+namespace libdyn{
+
+
+static const char hvib_store_magic[8] = {'L','I','B','R','A','H','V','B'};
+static const int hvib_store_version = 1;
+static const size_t hvib_store_header_size = 48;
+
+
+class hvib_store_writer{
+/**
+  The streaming writer: the frames are written one at a time, so the complete data set
+  never has to be kept in memory. The offsets table is filled in at the end.
+*/
+
+  ofstream out;
+  std::string filename;
+  vector<long long> offsets;
+  long long table_pos;
+
+  public:
+
+  int nst, is_sparse;
+  double threshold;
+
+  void check(std::string what){
+    if(!out.good()){
+      cout<<"Error in hvib_store_writer: failed to write "<<what<<" to file "<<filename<<"\nExiting...\n"; exit(0);
+    }
+  }
+
+  hvib_store_writer(std::string _filename, int _nst, vector<int>& nframes, int _is_sparse, double _threshold){
+
+    filename = _filename;  nst = _nst;  is_sparse = _is_sparse;  threshold = _threshold;
+
+    out.open(filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if(!out.is_open()){
+      cout<<"Error in hvib_store_writer: can't open file "<<filename<<"\nExiting...\n"; exit(0);
+    }
+
+    int ndata = nframes.size();
+    long long ntot = 0;
+    for(int d=0; d<ndata; d++){  ntot += nframes[d];  }
+
+    char header[hvib_store_header_size];
+    memset(header, 0, hvib_store_header_size);
+    memcpy(header, hvib_store_magic, 8);
+    memcpy(header+8,  &hvib_store_version, 4);
+    memcpy(header+12, &nst, 4);
+    memcpy(header+16, &ndata, 4);
+    memcpy(header+20, &is_sparse, 4);
+    memcpy(header+24, &threshold, 8);
+    memcpy(header+32, &ntot, 8);
+    out.write(header, hvib_store_header_size);
+
+    for(int d=0; d<ndata; d++){
+      long long n = nframes[d];
+      out.write((char*)&n, 8);
+    }
+
+    // Reserve the place for the offsets table
+    table_pos = out.tellp();
+    offsets = vector<long long>(ntot+1, 0);
+    out.write((char*)&offsets[0], 8*(ntot+1));
+    check("the header");
+
+    offsets.clear();
+  }
+
+  void add_frame(CMATRIX& H){
+
+    if(H.n_rows!=nst || H.n_cols!=nst){
+      cout<<"Error in hvib_store_writer: all Hvib matrices should be "<<nst<<" x "<<nst<<"\nExiting...\n"; exit(0);
+    }
+
+    offsets.push_back(out.tellp());
+
+    if(is_sparse==0){
+      out.write((char*)H.M, sizeof(complex<double>)*nst*nst);
+    }
+    else{
+      vector<complex<double> > diag(nst);
+      for(int i=0;i<nst;i++){ diag[i] = H.M[i*nst+i]; }
+      out.write((char*)&diag[0], sizeof(complex<double>)*nst);
+
+      long long nnz = 0;
+      for(int i=0;i<nst;i++){
+        for(int j=0;j<nst;j++){
+          if(i!=j && std::abs(H.M[i*nst+j]) > threshold){ nnz++; }
+        }
+      }
+      out.write((char*)&nnz, 8);
+
+      for(int i=0;i<nst;i++){
+        for(int j=0;j<nst;j++){
+          if(i!=j && std::abs(H.M[i*nst+j]) > threshold){
+            double re = H.M[i*nst+j].real();
+            double im = H.M[i*nst+j].imag();
+            out.write((char*)&i, 4);   out.write((char*)&j, 4);
+            out.write((char*)&re, 8);  out.write((char*)&im, 8);
+          }
+        }
+      }
+    }// sparse
+
+    check("a frame");
+  }
+
+  void finish(){
+
+    offsets.push_back(out.tellp());
+
+    out.seekp(table_pos);
+    out.write((char*)&offsets[0], 8*offsets.size());
+    check("the offsets table");
+
+    out.close();
+    if(out.fail()){
+      cout<<"Error in hvib_store_writer: failed to close file "<<filename<<"\nExiting...\n"; exit(0);
+    }
+
+  }
+
+};
+
+
+
+void hvib_store_write(std::string filename, vector< vector<CMATRIX> >& Hvib, int is_sparse, double threshold){
+/**
+  \brief Write the vibronic Hamiltonians to the binary container that can be used with the Hvib_store class
+
+  \param[in] filename The name of the file to create
+  \param[in] Hvib The Hamiltonians: Hvib[idata][time] - CMATRIX(nst, nst)
+  \param[in] is_sparse The storage format of the frames: 0 - dense, 1 - the diagonal plus the off-diagonal
+             elements (NACs) with the absolute values larger than `threshold`
+  \param[in] threshold The threshold for the off-diagonal elements in the sparse format [units of Hvib]
+*/
+
+  int ndata = Hvib.size();
+  if(ndata==0){ cout<<"Error in hvib_store_write: no data sets\nExiting...\n"; exit(0); }
+
+  int nst = -1;
+  vector<int> nframes(ndata);
+  for(int d=0; d<ndata; d++){
+    nframes[d] = Hvib[d].size();
+    if(nst<0 && nframes[d]>0){ nst = Hvib[d][0].n_rows; }
+  }
+  if(nst<0){ cout<<"Error in hvib_store_write: no frames\nExiting...\n"; exit(0); }
+
+  hvib_store_writer w(filename, nst, nframes, is_sparse, threshold);
+  for(int d=0; d<ndata; d++){
+    for(int i=0; i<nframes[d]; i++){  w.add_frame(Hvib[d][i]);  }
+  }
+  w.finish();
+
+}
+
+
+
+void hvib_store_convert(std::string filename, vector<std::string>& data_set_paths,
+  std::string re_prefix, std::string re_suffix, std::string im_prefix, std::string im_suffix,
+  int nstates, int nfiles, vector<int>& active_space, int is_sparse, double threshold){
+/**
+  \brief Convert the text files with the vibronic Hamiltonians (as read by the nbra/step4.py get_Hvib2)
+  into the binary container. The files are processed one at a time.
+
+  \param[in] filename The name of the binary file to create
+  \param[in] data_set_paths The directories with the data sets (the prefixes of the file names)
+  \param[in] re_prefix, re_suffix The file with the real part of the Hvib at the step i of the data set d is
+             data_set_paths[d] + re_prefix + i + re_suffix
+  \param[in] im_prefix, im_suffix Same for the imaginary part
+  \param[in] nstates The number of rows/columns in the files
+  \param[in] nfiles The number of steps in each data set
+  \param[in] active_space The indices of the states to keep
+  \param[in] is_sparse, threshold See hvib_store_write
+*/
+
+  int ndata = data_set_paths.size();
+  int nst = active_space.size();
+
+  for(int a=0; a<nst; a++){
+    if(active_space[a]<0 || active_space[a]>=nstates){
+      cout<<"Error in hvib_store_convert: active_space["<<a<<"] = "<<active_space[a]<<" is out of range\nExiting...\n"; exit(0);
+    }
+  }
+
+  vector<int> nframes(ndata, nfiles);
+  hvib_store_writer w(filename, nst, nframes, is_sparse, threshold);
+
+  MATRIX re(nstates, nstates);
+  MATRIX im(nstates, nstates);
+  CMATRIX h(nst, nst);
+
+  for(int d=0; d<ndata; d++){
+    for(int i=0; i<nfiles; i++){
+
+      stringstream ss;  ss<<i;
+      std::string fre = data_set_paths[d] + re_prefix + ss.str() + re_suffix;
+      std::string fim = data_set_paths[d] + im_prefix + ss.str() + im_suffix;
+
+      if(!re.Load_Matrix_From_File(const_cast<char*>(fre.c_str()))){
+        cout<<"Error in hvib_store_convert: can't read file "<<fre<<"\nExiting...\n"; exit(0);
+      }
+      if(!im.Load_Matrix_From_File(const_cast<char*>(fim.c_str()))){
+        cout<<"Error in hvib_store_convert: can't read file "<<fim<<"\nExiting...\n"; exit(0);
+      }
+
+      for(int a=0; a<nst; a++){
+        for(int b=0; b<nst; b++){
+          int ia = active_space[a]*nstates + active_space[b];
+          h.M[a*nst+b] = complex<double>(re.M[ia], im.M[ia]);
+        }
+      }
+
+      w.add_frame(h);
+
+    }// for i
+  }// for d
+
+  w.finish();
+
+}
+
+
+
+
+Hvib_store::Hvib_store(std::string _filename){
+/**
+  \brief Constructor: map the binary container created by hvib_store_write or hvib_store_convert
+
+  \param[in] _filename The name of the file
+*/
+
+  data = NULL;  size = 0;
+  open_store(_filename);
+
+}
+
+
+Hvib_store::Hvib_store(const Hvib_store& ob){
+/**
+  \brief Copy constructor: the copy maps the same file independently
+*/
+
+  data = NULL;  size = 0;
+  open_store(ob.filename);
+
+}
+
+
+Hvib_store& Hvib_store::operator=(const Hvib_store& ob){
+
+  if(this!=&ob){
+    close_store();
+    open_store(ob.filename);
+  }
+  return *this;
+
+}
+
+
+Hvib_store::~Hvib_store(){
+
+  close_store();
+
+}
+
+
+void Hvib_store::open_store(std::string _filename){
+
+  filename = _filename;
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if(fd<0){ cout<<"Error in Hvib_store: can't open file "<<filename<<"\nExiting...\n"; exit(0); }
+
+  struct stat st;
+  if(fstat(fd, &st)!=0 || st.st_size < (off_t)hvib_store_header_size){
+    close(fd);
+    cout<<"Error in Hvib_store: file "<<filename<<" is not an Hvib store\nExiting...\n"; exit(0);
+  }
+  size = st.st_size;
+
+  void* ptr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if(ptr==MAP_FAILED){ cout<<"Error in Hvib_store: can't map file "<<filename<<"\nExiting...\n"; exit(0); }
+  data = (char*)ptr;
+
+  int version;
+  long long ntot;
+  memcpy(&version, data+8, 4);
+
+  if(memcmp(data, hvib_store_magic, 8)!=0 || version!=hvib_store_version){
+    close_store();
+    cout<<"Error in Hvib_store: file "<<filename<<" is not an Hvib store (version "<<hvib_store_version<<")\nExiting...\n"; exit(0);
+  }
+
+  memcpy(&nst, data+12, 4);
+  memcpy(&ndata, data+16, 4);
+  memcpy(&is_sparse, data+20, 4);
+  memcpy(&threshold, data+24, 8);
+  memcpy(&ntot, data+32, 8);
+
+  if(hvib_store_header_size + 8*(ndata + ntot + 1) > size){
+    close_store();
+    cout<<"Error in Hvib_store: file "<<filename<<" is truncated\nExiting...\n"; exit(0);
+  }
+
+  nframes = vector<int>(ndata);
+  first = vector<long long>(ndata);
+
+  long long cnt = 0;
+  for(int d=0; d<ndata; d++){
+    long long n;
+    memcpy(&n, data + hvib_store_header_size + 8*d, 8);
+    nframes[d] = n;
+    first[d] = cnt;
+    cnt += n;
+  }
+
+  // The frames are accessed in an arbitrary order
+  madvise(data, size, MADV_RANDOM);
+
+}
+
+
+void Hvib_store::close_store(){
+
+  if(data!=NULL){  munmap(data, size);  }
+  data = NULL;
+  size = 0;
+
+}
+
+
+const char* Hvib_store::frame_addr(int d, int i) const {
+
+  if(d<0 || d>=ndata){
+    cout<<"Error in Hvib_store: data set index "<<d<<" is out of range [0, "<<ndata<<")\nExiting...\n"; exit(0);
+  }
+  if(i<0 || i>=nframes[d]){
+    cout<<"Error in Hvib_store: frame index "<<i<<" is out of range [0, "<<nframes[d]<<") for the data set "<<d<<"\nExiting...\n"; exit(0);
+  }
+
+  long long off;
+  memcpy(&off, data + hvib_store_header_size + 8*(ndata + first[d] + i), 8);
+
+  return data + off;
+}
+
+
+int Hvib_store::get_nframes(int d) const {
+/**
+  \brief Returns the number of frames in the data set d
+*/
+
+  if(d<0 || d>=ndata){
+    cout<<"Error in Hvib_store: data set index "<<d<<" is out of range [0, "<<ndata<<")\nExiting...\n"; exit(0);
+  }
+  return nframes[d];
+
+}
+
+
+void Hvib_store::get_frame(int d, int i, CMATRIX& out) const {
+/**
+  \brief Copy the frame i of the data set d into the existing matrix (no memory allocation)
+
+  \param[in] d The index of the data set
+  \param[in] i The index of the frame (time step) within the data set
+  \param[out] out The Hvib matrix: CMATRIX(nst, nst)
+*/
+
+  if(out.n_rows!=nst || out.n_cols!=nst){
+    cout<<"Error in Hvib_store::get_frame: the output matrix should be "<<nst<<" x "<<nst<<"\nExiting...\n"; exit(0);
+  }
+
+  const char* p = frame_addr(d, i);
+
+  if(is_sparse==0){
+    memcpy(out.M, p, sizeof(complex<double>)*nst*nst);
+  }
+  else{
+    out = 0.0;
+
+    complex<double> z;
+    for(int a=0; a<nst; a++){
+      memcpy(&z, p + sizeof(complex<double>)*a, sizeof(complex<double>));
+      out.M[a*nst+a] = z;
+    }
+    p += sizeof(complex<double>)*nst;
+
+    long long nnz;
+    memcpy(&nnz, p, 8);  p += 8;
+
+    int a, b;
+    double re, im;
+    for(long long k=0; k<nnz; k++){
+      memcpy(&a, p, 4);  memcpy(&b, p+4, 4);
+      memcpy(&re, p+8, 8);  memcpy(&im, p+16, 8);
+      out.M[a*nst+b] = complex<double>(re, im);
+      p += 24;
+    }
+  }
+
+}
+
+
+CMATRIX Hvib_store::get_frame(int d, int i) const {
+/**
+  \brief Returns the frame i of the data set d as a new matrix
+*/
+
+  CMATRIX res(nst, nst);
+  get_frame(d, i, res);
+
+  return res;
+}
+
+
+vector<CMATRIX> Hvib_store::get_frames(int d, int start, int n) const {
+/**
+  \brief Returns n consecutive frames of the data set d, starting from the frame `start`
+*/
+
+  vector<CMATRIX> res(n, CMATRIX(nst, nst));
+  for(int k=0; k<n; k++){  get_frame(d, start+k, res[k]);  }
+
+  return res;
+}
+
+
+const complex<double>* Hvib_store::frame_ptr(int d, int i) const {
+/**
+  \brief Returns the pointer to the frame i of the data set d in the mapped memory (C++ only)
+
+  This is the zero-copy access: the nst x nst row-major matrix is read directly from the
+  mapped file. Only available for the dense stores - returns NULL for the sparse ones.
+  The pointer is valid as long as this object exists.
+*/
+
+  if(is_sparse){ return NULL; }
+
+  return (const complex<double>*)frame_addr(d, i);
+}
+
+
+
+}// namespace libdyn
+}// liblibra
+
@@ -0,0 +1,98 @@
+/*********************************************************************************
+* Copyright (C) 2015-2019 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file hvib_store.h
+  \brief The header for hvib_store.cpp
+
+*/
+
+#ifndef HVIB_STORE_H
+#define HVIB_STORE_H
+
+// External dependencies
+#include "../math_linalg/liblinalg.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+/// libdyn namespace
+namespace libdyn{
+
+
+void hvib_store_write(std::string filename, vector< vector<CMATRIX> >& Hvib, int is_sparse, double threshold);
+
+void hvib_store_convert(std::string filename, vector<std::string>& data_set_paths,
+  std::string re_prefix, std::string re_suffix, std::string im_prefix, std::string im_suffix,
+  int nstates, int nfiles, vector<int>& active_space, int is_sparse, double threshold);
+
+
+class Hvib_store{
+/**
+  The read-only access to the binary vibronic Hamiltonian (Hvib) container created by
+  hvib_store_write or hvib_store_convert. The file is memory-mapped, so only the
+  frames that are actually accessed are brought into memory (and the OS may evict them
+  when memory is needed), so the data sets can be much larger than the available RAM.
+
+  The file layout (all values in the native byte order):
+
+     header:   char magic[8] = "LIBRAHVB", int32 version, nst, ndata, is_sparse,
+               double threshold, int64 nframes_total, 8 bytes of padding
+     int64 nframes[ndata]              - the number of frames in each data set
+     int64 offsets[nframes_total + 1]  - byte offsets of all frames (data set by data set)
+     frames:
+        dense:  complex<double> H[nst * nst], row-major
+        sparse: complex<double> diag[nst], int64 nnz, then nnz records of
+                { int32 i, int32 j, double re, double im }  for the off-diagonal elements
+                with |H(i,j)| > threshold
+*/
+
+  std::string filename; ///< the name of the mapped file
+  char* data;           ///< the beginning of the mapped memory
+  size_t size;          ///< the size of the mapped region [bytes]
+
+  vector<long long> first;  ///< first[d] - the global index of the frame 0 of the data set d
+
+  void open_store(std::string _filename);
+  void close_store();
+  const char* frame_addr(int d, int i) const;
+
+  public:
+
+  int nst;              ///< the dimension of the Hvib matrices
+  int ndata;            ///< the number of data sets
+  int is_sparse;        ///< 0 - dense frames, 1 - sparse (diagonal + significant off-diagonal) frames
+  double threshold;     ///< the threshold used to keep the off-diagonal elements in the sparse format
+  vector<int> nframes;  ///< the number of frames in each data set
+
+
+  Hvib_store(std::string _filename);
+  Hvib_store(const Hvib_store& ob);
+  Hvib_store& operator=(const Hvib_store& ob);
+  ~Hvib_store();
+
+  int get_nframes(int d) const;
+
+  void get_frame(int d, int i, CMATRIX& out) const;
+  CMATRIX get_frame(int d, int i) const;
+  vector<CMATRIX> get_frames(int d, int start, int n) const;
+
+  const complex<double>* frame_ptr(int d, int i) const;
+
+};
+
+
+}// namespace libdyn
+}// liblibra
+
+#endif // HVIB_STORE_H
@@ -72,6 +72,7 @@ void export_dyn_control_params_objects(){
       .def_readwrite("do_phase_correction", &dyn_control_params::do_phase_correction)
       .def_readwrite("phase_correction_tol", &dyn_control_params::phase_correction_tol)
       .def_readwrite("state_tracking_algo", &dyn_control_params::state_tracking_algo)
+      .def_readwrite("state_tracking_tol", &dyn_control_params::state_tracking_tol)
       .def_readwrite("MK_alpha", &dyn_control_params::MK_alpha)
       .def_readwrite("MK_verbosity", &dyn_control_params::MK_verbosity)
       .def_readwrite("entanglement_opt", &dyn_control_params::entanglement_opt)
@@ -87,6 +88,7 @@ void export_dyn_control_params_objects(){
       .def_readwrite("collapse_option", &dyn_control_params::collapse_option)
       .def_readwrite("ensemble", &dyn_control_params::ensemble)
       .def_readwrite("thermostat_params", &dyn_control_params::thermostat_params)
+      .def_readwrite("is_nbra", &dyn_control_params::is_nbra)
 
       .def("sanity_check", expt_sanity_check_v1)
       .def("set_parameters", expt_set_parameters_v1)
@@ -287,6 +289,16 @@ void export_dyn_projectors_objects(){
   vector<int> (*expt_Munkres_Kuhn_v1)(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha, int verbosity) = &Munkres_Kuhn;
   def("Munkres_Kuhn", expt_Munkres_Kuhn_v1);  
 
+  vector<int> (*expt_Jonker_Volgenant_v1)(CMATRIX& orb_mat_inp, CMATRIX& en_mat_inp, double alpha, 
+  vector<int>& guess, int verbosity) = &Jonker_Volgenant;
+  def("Jonker_Volgenant", expt_Jonker_Volgenant_v1);  
+
+  vector<vector<int> > (*expt_get_overlap_blocks_v1)(CMATRIX& time_overlap, double tol) = &get_overlap_blocks;
+  def("get_overlap_blocks", expt_get_overlap_blocks_v1);  
+
+  vector<int> (*expt_get_block_reordering_v1)(CMATRIX& time_overlap, CMATRIX& en_mat_inp, double alpha, double tol) = &get_block_reordering;
+  def("get_block_reordering", expt_get_block_reordering_v1);  
+
   CMATRIX (*expt_permutation2cmatrix_v1)(vector<int>& permutation) = &permutation2cmatrix;
   def("permutation2cmatrix", expt_permutation2cmatrix_v1);  
 
@@ -297,6 +309,117 @@ void export_dyn_projectors_objects(){
 
 }
 
+void export_dyn_nbra_objects(){
+
+  //============= dyn_nbra.cpp ======================
+
+  vector<int> (*expt_nbra_sd2indx_v1)(vector<int>& sd) = &nbra_sd2indx;
+  def("nbra_sd2indx", expt_nbra_sd2indx_v1);
+
+  CMATRIX (*expt_nbra_ovlp_mat_arb_v1)(vector<vector<int> >& SD1, vector<vector<int> >& SD2, CMATRIX& S) = &nbra_ovlp_mat_arb;
+  def("nbra_ovlp_mat_arb", expt_nbra_ovlp_mat_arb_v1);
+
+  CMATRIX (*expt_nbra_energy_mat_arb_v1)(vector<vector<int> >& SD, CMATRIX& E, vector<double>& dE) = &nbra_energy_mat_arb;
+  def("nbra_energy_mat_arb", expt_nbra_energy_mat_arb_v1);
+
+  void (*expt_nbra_lowdin_v1)(CMATRIX& S, CMATRIX& S_i_half) = &nbra_lowdin;
+  def("nbra_lowdin", expt_nbra_lowdin_v1);
+
+  void (*expt_nbra_apply_normalization_v1)(vector<CMATRIX>& S, vector<CMATRIX>& St) = &nbra_apply_normalization;
+  def("nbra_apply_normalization", expt_nbra_apply_normalization_v1);
+
+  void (*expt_nbra_apply_state_reordering_v1)(vector<CMATRIX>& St, vector<CMATRIX>& E, int algo, double alpha) = &nbra_apply_state_reordering;
+  void (*expt_nbra_apply_state_reordering_v2)(vector<CMATRIX>& St, vector<CMATRIX>& E, int algo, double alpha, double tol) = &nbra_apply_state_reordering;
+  def("nbra_apply_state_reordering", expt_nbra_apply_state_reordering_v1);
+  def("nbra_apply_state_reordering", expt_nbra_apply_state_reordering_v2);
+
+  void (*expt_nbra_apply_phase_correction_v1)(vector<CMATRIX>& St) = &nbra_apply_phase_correction;
+  def("nbra_apply_phase_correction", expt_nbra_apply_phase_correction_v1);
+
+  CMATRIX (*expt_nbra_sac_matrix_v1)(CMATRIX& CI_basis, vector<vector<int> >& SD_basis, CMATRIX& S) = &nbra_sac_matrix;
+  def("nbra_sac_matrix", expt_nbra_sac_matrix_v1);
+
+  CMATRIX (*expt_nbra_compute_Hvib_v1)
+  (vector<vector<int> >& SD_basis, CMATRIX& St, CMATRIX& E, vector<double>& dE, double dt) = &nbra_compute_Hvib;
+  def("nbra_compute_Hvib", expt_nbra_compute_Hvib_v1);
+
+  CMATRIXMap (*expt_nbra_step3_v1)(CMATRIXMap& S, CMATRIXMap& St, CMATRIXMap& E,
+  vector<vector<int> >& SD_basis, vector<double>& SD_energy_corr, CMATRIX& CI_basis, bp::dict params) = &nbra_step3;
+  def("nbra_step3", expt_nbra_step3_v1);
+
+}
+
+void export_tsh_ensemble_stat_objects(){
+
+  //============= tsh_ensemble_stat.cpp ======================
+
+  MATRIX (*expt_compute_ensemble_stat_v1)
+  (CMATRIX& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx,
+   CMATRIX& dm_se, CMATRIX& dm_sh) = &compute_ensemble_stat;
+  MATRIX (*expt_compute_ensemble_stat_v2)
+  (vector<CMATRIX>& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx,
+   CMATRIX& dm_se, CMATRIX& dm_sh, int is_pop) = &compute_ensemble_stat;
+  def("compute_ensemble_stat", expt_compute_ensemble_stat_v1);
+  def("compute_ensemble_stat", expt_compute_ensemble_stat_v2);
+
+
+  MATRIX (tsh_ensemble_stat::*expt_update_v1)
+  (CMATRIX& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx) = &tsh_ensemble_stat::update;
+  MATRIX (tsh_ensemble_stat::*expt_update_v2)
+  (vector<CMATRIX>& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx, int is_pop) = &tsh_ensemble_stat::update;
+
+  class_<tsh_ensemble_stat>("tsh_ensemble_stat",init<int>())
+      .def("__copy__", &generic__copy__<tsh_ensemble_stat>)
+      .def("__deepcopy__", &generic__deepcopy__<tsh_ensemble_stat>)
+
+      .def_readonly("nst", &tsh_ensemble_stat::nst)
+      .def_readonly("nsamples", &tsh_ensemble_stat::nsamples)
+      .def_readonly("res", &tsh_ensemble_stat::res)
+      .def_readonly("dm_se", &tsh_ensemble_stat::dm_se)
+      .def_readonly("dm_sh", &tsh_ensemble_stat::dm_sh)
+      .def_readonly("res_sum", &tsh_ensemble_stat::res_sum)
+      .def_readonly("dm_se_sum", &tsh_ensemble_stat::dm_se_sum)
+      .def_readonly("dm_sh_sum", &tsh_ensemble_stat::dm_sh_sum)
+
+      .def("reset", &tsh_ensemble_stat::reset)
+      .def("update", expt_update_v1)
+      .def("update", expt_update_v2)
+      .def("get_res_ave", &tsh_ensemble_stat::get_res_ave)
+      .def("get_dm_se_ave", &tsh_ensemble_stat::get_dm_se_ave)
+      .def("get_dm_sh_ave", &tsh_ensemble_stat::get_dm_sh_ave)
+  ;
+
+}
+
+void export_hvib_store_objects(){
+
+  //============= hvib_store.cpp ======================
+
+  def("hvib_store_write", &hvib_store_write);
+  def("hvib_store_convert", &hvib_store_convert);
+
+
+  void (Hvib_store::*expt_get_frame_v1)(int d, int i, CMATRIX& out) const = &Hvib_store::get_frame;
+  CMATRIX (Hvib_store::*expt_get_frame_v2)(int d, int i) const = &Hvib_store::get_frame;
+
+  class_<Hvib_store>("Hvib_store",init<std::string>())
+      .def("__copy__", &generic__copy__<Hvib_store>)
+      .def("__deepcopy__", &generic__deepcopy__<Hvib_store>)
+
+      .def_readonly("nst", &Hvib_store::nst)
+      .def_readonly("ndata", &Hvib_store::ndata)
+      .def_readonly("is_sparse", &Hvib_store::is_sparse)
+      .def_readonly("threshold", &Hvib_store::threshold)
+      .def_readonly("nframes", &Hvib_store::nframes)
+
+      .def("get_nframes", &Hvib_store::get_nframes)
+      .def("get_frame", expt_get_frame_v1)
+      .def("get_frame", expt_get_frame_v2)
+      .def("get_frames", &Hvib_store::get_frames)
+  ;
+
+}
+
 void export_LZ_hopping_probabilities_objects(){
 
 
@@ -321,6 +444,23 @@ void export_permutation_objects(){
   def("Munkres_Kuhn_maximize", expt_Munkres_Kuhn_maximize_v1);  
 
 
+  vector<int> (*expt_Jonker_Volgenant_minimize_v1)(MATRIX& X, vector<int>& guess, int verbosity) = &Jonker_Volgenant_minimize;
+  vector<int> (*expt_Jonker_Volgenant_minimize_v2)(MATRIX& X, int verbosity) = &Jonker_Volgenant_minimize;
+  vector<int> (*expt_Jonker_Volgenant_maximize_v1)(MATRIX& X, vector<int>& guess, int verbosity) = &Jonker_Volgenant_maximize;
+  vector<int> (*expt_Jonker_Volgenant_maximize_v2)(MATRIX& X, int verbosity) = &Jonker_Volgenant_maximize;
+  vector<int> (*expt_Jonker_Volgenant_minimize_sparse_v1)(vector<vector<int> >& cols, vector<vector<double> >& costs,
+  vector<int>& guess, int verbosity) = &Jonker_Volgenant_minimize_sparse;
+  vector<int> (*expt_Jonker_Volgenant_maximize_sparse_v1)(MATRIX& X, double threshold, 
+  vector<int>& guess, int verbosity) = &Jonker_Volgenant_maximize_sparse;
+
+  def("Jonker_Volgenant_minimize", expt_Jonker_Volgenant_minimize_v1);  
+  def("Jonker_Volgenant_minimize", expt_Jonker_Volgenant_minimize_v2);  
+  def("Jonker_Volgenant_maximize", expt_Jonker_Volgenant_maximize_v1);  
+  def("Jonker_Volgenant_maximize", expt_Jonker_Volgenant_maximize_v2);  
+  def("Jonker_Volgenant_minimize_sparse", expt_Jonker_Volgenant_minimize_sparse_v1);  
+  def("Jonker_Volgenant_maximize_sparse", expt_Jonker_Volgenant_maximize_sparse_v1);  
+
+
 }
 
 void export_Energy_Forces_objects(){
@@ -410,6 +550,9 @@ void export_Dyn_objects(){
   export_dyn_hop_proposal_objects();
   export_dyn_methods_objects();
   export_dyn_projectors_objects();
+  export_dyn_nbra_objects();
+  export_tsh_ensemble_stat_objects();
+  export_hvib_store_objects();
 
   
   export_LZ_hopping_probabilities_objects();
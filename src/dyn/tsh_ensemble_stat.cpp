@@ -0,0 +1,329 @@
+/*********************************************************************************
+* Copyright (C) 2015-2019 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file tsh_ensemble_stat.cpp
+  \brief The file implements the computation of the ensemble-averaged populations, density
+  matrices, and energies for large TSH ensembles (the C++ version of the statistics functions
+  of nbra/step4.py and tsh_stat.py)
+
+*/
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "tsh_ensemble_stat.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libdyn namespace
+namespace libdyn{
+
+
+static MATRIX ensemble_stat_kernel(vector<complex<double>*>& c, int stride, int is_pop, vector<int>& act_states,
+  vector<CMATRIX>& Hvib, vector<int>& ham_indx, CMATRIX& dm_se, CMATRIX& dm_sh){
+/**
+  The common kernel of all the versions: c[tr][i*stride] is the amplitude (or the population, if is_pop = 1)
+  of the state i for the trajectory tr
+*/
+
+  int ntraj = c.size();
+  int nst = dm_se.n_rows;
+  int nframes = Hvib.size();
+  int tr, i, j;
+
+  if(ntraj==0){ cout<<"Error in compute_ensemble_stat: no trajectories\nExiting...\n"; exit(0); }
+
+  if(act_states.size()!=ntraj || ham_indx.size()!=ntraj){
+    cout<<"Error in compute_ensemble_stat: the sizes of the act_states ("<<act_states.size()<<") and ham_indx (";
+    cout<<ham_indx.size()<<") should be equal to the number of trajectories ("<<ntraj<<")\nExiting...\n"; exit(0);
+  }
+  for(i=0;i<nframes;i++){
+    if(Hvib[i].n_rows!=nst || Hvib[i].n_cols!=nst){
+      cout<<"Error in compute_ensemble_stat: the Hvib matrices should be "<<nst<<" x "<<nst<<"\nExiting...\n"; exit(0);
+    }
+  }
+  for(tr=0;tr<ntraj;tr++){
+    if(ham_indx[tr]<0 || ham_indx[tr]>=nframes){
+      cout<<"Error in compute_ensemble_stat: ham_indx["<<tr<<"] = "<<ham_indx[tr]<<" is out of range\nExiting...\n"; exit(0);
+    }
+    if(act_states[tr]<0 || act_states[tr]>=nst){
+      cout<<"Error in compute_ensemble_stat: act_states["<<tr<<"] = "<<act_states[tr]<<" is out of range\nExiting...\n"; exit(0);
+    }
+  }
+
+
+  // Ensemble sums
+  vector<complex<double> > dm(nst*nst, complex<double>(0.0, 0.0));
+  vector<double> ene(nst, 0.0);
+  vector<double> pop_sh(nst, 0.0);
+  double en_se = 0.0;
+  double en_sh = 0.0;
+
+  #pragma omp parallel private(i,j)
+  {
+    // Thread-local partial sums
+    vector<complex<double> > dm_t(nst*nst, complex<double>(0.0, 0.0));
+    vector<double> ene_t(nst, 0.0);
+    vector<double> pop_sh_t(nst, 0.0);
+    double en_se_t = 0.0;
+    double en_sh_t = 0.0;
+
+    #pragma omp for
+    for(int t=0; t<ntraj; t++){
+
+      const complex<double>* h = Hvib[ham_indx[t]].M;
+      const complex<double>* ct = c[t];
+      int a = act_states[t];
+
+      for(i=0;i<nst;i++){  ene_t[i] += h[i*nst+i].real();  }
+
+      // SH
+      pop_sh_t[a] += 1.0;
+      en_sh_t += h[a*nst+a].real();
+
+      // SE: Tr( Re(rho) * Re(H) )
+      if(is_pop){
+        for(i=0;i<nst;i++){
+          double p = ct[i*stride].real();
+          dm_t[i*nst+i] += p;
+          en_se_t += p * h[i*nst+i].real();
+        }
+      }
+      else{
+        for(i=0;i<nst;i++){
+          complex<double> ci = ct[i*stride];
+          for(j=0;j<nst;j++){
+            complex<double> rho_ij = ci * std::conj(ct[j*stride]);
+            dm_t[i*nst+j] += rho_ij;
+            en_se_t += rho_ij.real() * h[j*nst+i].real();
+          }
+        }
+      }
+
+    }// for t
+
+    #pragma omp critical
+    {
+      for(i=0;i<nst*nst;i++){ dm[i] += dm_t[i]; }
+      for(i=0;i<nst;i++){ ene[i] += ene_t[i];  pop_sh[i] += pop_sh_t[i]; }
+      en_se += en_se_t;
+      en_sh += en_sh_t;
+    }
+
+  }// omp parallel
+
+
+  double nrm = 1.0/double(ntraj);
+
+  dm_se = 0.0;
+  dm_sh = 0.0;
+  for(i=0;i<nst*nst;i++){  dm_se.M[i] = nrm * dm[i];  }
+  for(i=0;i<nst;i++){  dm_sh.M[i*nst+i] = nrm * pop_sh[i];  }
+
+  MATRIX res(1, 3*nst+4);
+  double tot_se = 0.0, tot_sh = 0.0;
+
+  for(i=0;i<nst;i++){
+    res.M[3*i+0] = nrm * ene[i];            // Energy of the state i
+    res.M[3*i+1] = dm_se.M[i*nst+i].real(); // SE population
+    res.M[3*i+2] = dm_sh.M[i*nst+i].real(); // SH population
+
+    tot_se += res.M[3*i+1];
+    tot_sh += res.M[3*i+2];
+  }
+
+  res.M[3*nst+0] = nrm * en_se;  // Average SE energy
+  res.M[3*nst+1] = nrm * en_sh;  // Average SH energy
+  res.M[3*nst+2] = tot_se;       // Total SE population
+  res.M[3*nst+3] = tot_sh;       // Total SH population
+
+  return res;
+}
+
+
+static void check_dm(CMATRIX& dm, int nst){
+
+  if(dm.n_rows!=nst || dm.n_cols!=nst){
+    cout<<"Error in compute_ensemble_stat: the density matrices should be "<<nst<<" x "<<nst<<"\nExiting...\n"; exit(0);
+  }
+
+}
+
+
+MATRIX compute_ensemble_stat(CMATRIX& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx,
+  CMATRIX& dm_se, CMATRIX& dm_sh){
+/**
+  \brief Compute the ensemble-averaged SE and SH populations, density matrices, and energies in one pass
+
+  \param[in] C The amplitudes of all trajectories: CMATRIX(nst, ntraj)
+  \param[in] act_states The active states of all trajectories
+  \param[in] Hvib The Hamiltonians (frames) used by the trajectories, e.g. Hvib[idata][it+i] for all
+             data sets and initial times of the NBRA calculations
+  \param[in] ham_indx The index of the Hamiltonian in Hvib used by each trajectory
+  \param[out] dm_se The ensemble-averaged SE density matrix: CMATRIX(nst, nst)
+  \param[out] dm_sh The ensemble-averaged SH density matrix: CMATRIX(nst, nst)
+
+  The SE energy is computed as Tr( Re(rho) * Re(H) ), the SH energy is H(a,a), where a is the active state.
+
+  Returns MATRIX(1, 3*nst+4) in the format of the nbra/step4.py:
+
+     E(0), P_SE(0), P_SH(0), ...,   E(nst-1), P_SE(nst-1), P_SH(nst-1), <E*P_SE>, <E*P_SH>, sum{P_SE}, sum{P_SH}
+*/
+
+  int nst = C.n_rows;
+  int ntraj = C.n_cols;
+
+  check_dm(dm_se, nst);
+  check_dm(dm_sh, nst);
+
+  vector<complex<double>*> c(ntraj);
+  for(int tr=0;tr<ntraj;tr++){  c[tr] = C.M + tr;  }
+
+  return ensemble_stat_kernel(c, ntraj, 0, act_states, Hvib, ham_indx, dm_se, dm_sh);
+
+}
+
+
+MATRIX compute_ensemble_stat(vector<CMATRIX>& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx,
+  CMATRIX& dm_se, CMATRIX& dm_sh, int is_pop){
+/**
+  \brief The version for the amplitudes (or populations) stored as a list of column vectors
+
+  \param[in] C The amplitudes (is_pop = 0) or the SE populations (is_pop = 1) of all trajectories:
+             ntraj CMATRIX(nst, 1) objects. With the populations, the SE density matrix is diagonal
+  \param[in] is_pop The selector of the meaning of C: 0 - amplitudes, 1 - populations
+
+  The rest of the parameters and the return value are the same as in the version with the amplitudes block
+*/
+
+  int ntraj = C.size();
+  if(ntraj==0){ cout<<"Error in compute_ensemble_stat: no trajectories\nExiting...\n"; exit(0); }
+
+  int nst = C[0].n_rows;
+
+  check_dm(dm_se, nst);
+  check_dm(dm_sh, nst);
+
+  vector<complex<double>*> c(ntraj);
+  for(int tr=0;tr<ntraj;tr++){
+    if(C[tr].n_rows!=nst || C[tr].n_cols!=1){
+      cout<<"Error in compute_ensemble_stat: all amplitudes should be "<<nst<<" x 1 matrices\nExiting...\n"; exit(0);
+    }
+    c[tr] = C[tr].M;
+  }
+
+  return ensemble_stat_kernel(c, 1, is_pop, act_states, Hvib, ham_indx, dm_se, dm_sh);
+
+}
+
+
+
+tsh_ensemble_stat::tsh_ensemble_stat(int nst_)
+  : nst(nst_), nsamples(0), res(1, 3*nst_+4), dm_se(nst_, nst_), dm_sh(nst_, nst_),
+    res_sum(1, 3*nst_+4), dm_se_sum(nst_, nst_), dm_sh_sum(nst_, nst_){
+/**
+  \brief Constructor
+
+  \param[in] nst_ The number of states
+*/
+
+}
+
+
+void tsh_ensemble_stat::reset(){
+/**
+  \brief Reset the running sums
+*/
+
+  nsamples = 0;
+  res_sum = 0.0;
+  dm_se_sum = 0.0;
+  dm_sh_sum = 0.0;
+
+}
+
+
+MATRIX tsh_ensemble_stat::update(CMATRIX& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx){
+/**
+  \brief Compute the statistics for the current step and add them to the running sums
+
+  See compute_ensemble_stat for the description of the parameters. Returns the results for the current step
+*/
+
+  res = compute_ensemble_stat(C, act_states, Hvib, ham_indx, dm_se, dm_sh);
+
+  res_sum += res;
+  dm_se_sum += dm_se;
+  dm_sh_sum += dm_sh;
+  nsamples++;
+
+  return res;
+}
+
+
+MATRIX tsh_ensemble_stat::update(vector<CMATRIX>& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx, int is_pop){
+/**
+  \brief Compute the statistics for the current step and add them to the running sums
+
+  See compute_ensemble_stat for the description of the parameters. Returns the results for the current step
+*/
+
+  res = compute_ensemble_stat(C, act_states, Hvib, ham_indx, dm_se, dm_sh, is_pop);
+
+  res_sum += res;
+  dm_se_sum += dm_se;
+  dm_sh_sum += dm_sh;
+  nsamples++;
+
+  return res;
+}
+
+
+MATRIX tsh_ensemble_stat::get_res_ave(){
+/**
+  \brief Returns the results averaged over all the steps processed since the last reset
+*/
+
+  if(nsamples==0){ return MATRIX(1, 3*nst+4); }
+
+  return res_sum / double(nsamples);
+}
+
+
+CMATRIX tsh_ensemble_stat::get_dm_se_ave(){
+/**
+  \brief Returns the SE density matrix averaged over all the steps processed since the last reset
+*/
+
+  if(nsamples==0){ return CMATRIX(nst, nst); }
+
+  return dm_se_sum / double(nsamples);
+}
+
+
+CMATRIX tsh_ensemble_stat::get_dm_sh_ave(){
+/**
+  \brief Returns the SH density matrix averaged over all the steps processed since the last reset
+*/
+
+  if(nsamples==0){ return CMATRIX(nst, nst); }
+
+  return dm_sh_sum / double(nsamples);
+}
+
+
+
+}// namespace libdyn
+}// liblibra
+
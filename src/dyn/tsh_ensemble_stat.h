@@ -0,0 +1,80 @@
+/*********************************************************************************
+* Copyright (C) 2015-2019 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file tsh_ensemble_stat.h
+  \brief The header for tsh_ensemble_stat.cpp
+
+*/
+
+#ifndef TSH_ENSEMBLE_STAT_H
+#define TSH_ENSEMBLE_STAT_H
+
+// External dependencies
+#include "../math_linalg/liblinalg.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+/// libdyn namespace
+namespace libdyn{
+
+
+MATRIX compute_ensemble_stat(CMATRIX& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx,
+  CMATRIX& dm_se, CMATRIX& dm_sh);
+MATRIX compute_ensemble_stat(vector<CMATRIX>& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx,
+  CMATRIX& dm_se, CMATRIX& dm_sh, int is_pop);
+
+
+class tsh_ensemble_stat{
+/**
+  The ensemble statistics of the TSH calculations at the current step and the running
+  sums of the statistics over all the steps processed so far.
+
+  The format of the results is the same as in the nbra/step4.py:
+
+     E(0), P_SE(0), P_SH(0), ...,   E(nst-1), P_SE(nst-1), P_SH(nst-1), <E*P_SE>, <E*P_SH>, sum{P_SE}, sum{P_SH}
+*/
+
+  public:
+
+  int nst;              ///< the number of states
+  int nsamples;         ///< the number of steps included in the running sums
+
+  MATRIX res;           ///< the results for the last step: MATRIX(1, 3*nst+4)
+  CMATRIX dm_se;        ///< the ensemble-averaged SE density matrix for the last step
+  CMATRIX dm_sh;        ///< the ensemble-averaged SH density matrix (diagonal) for the last step
+
+  MATRIX res_sum;       ///< the running sum of the results
+  CMATRIX dm_se_sum;    ///< the running sum of the SE density matrices
+  CMATRIX dm_sh_sum;    ///< the running sum of the SH density matrices
+
+
+  tsh_ensemble_stat(int nst_);
+
+  void reset();
+
+  MATRIX update(CMATRIX& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx);
+  MATRIX update(vector<CMATRIX>& C, vector<int>& act_states, vector<CMATRIX>& Hvib, vector<int>& ham_indx, int is_pop);
+
+  MATRIX get_res_ave();
+  CMATRIX get_dm_se_ave();
+  CMATRIX get_dm_sh_ave();
+
+};
+
+
+}// namespace libdyn
+}// liblibra
+
+#endif // TSH_ENSEMBLE_STAT_H
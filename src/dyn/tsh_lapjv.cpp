@@ -0,0 +1,413 @@
+/*********************************************************************************
+* Copyright (C) 2019 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file tsh_lapjv.cpp
+  \brief The file implements the Jonker-Volgenant (shortest augmenting path) solver
+  of the linear assignment problem used for the state tracking
+
+  R. Jonker, A. Volgenant, Computing 1987, 38, 325
+
+  The dual variables u (rows) and v (columns) are kept such that all the reduced
+  costs c_ij - u_i - v_j are non-negative and vanish on the assigned pairs.
+  The free rows are then assigned one by one along the shortest augmenting paths
+  (Dijkstra search in the reduced costs), so each augmentation is O(n^2) for the
+  dense matrices and the whole problem is O(n^3).
+
+  The initial assignment is taken from the user-provided guess (e.g. the permutation
+  of the previous step), keeping only the pairs that are tight after the column
+  reduction. If the guess is already optimal, no augmentations are needed at all.
+
+*/
+
+#include <queue>
+#include "Surface_Hopping.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libdyn namespace
+namespace libdyn{
+
+
+vector<int> Jonker_Volgenant_minimize(MATRIX& X, vector<int>& guess, int verbosity){
+/**
+  \brief Find the assignment (permutation) minimizing the total cost
+
+  \param[in] X [n x n] The cost matrix
+  \param[in] guess The initial assignment: row i -> column guess[i]. Can be empty
+  \param[in] verbosity 0 - no extra output, 1 - print the statistics of the solver
+
+  Returns: the permutation perm, such that the row i is assigned to the column perm[i],
+  the same convention as in Munkres_Kuhn_minimize
+*/
+
+  int n = X.n_cols;
+
+  if(X.n_rows!=n){
+    cout<<"Error in Jonker_Volgenant_minimize: the cost matrix must be square, but it is "
+        <<X.n_rows<<" x "<<n<<"\nExiting...\n";
+    exit(0);
+  }
+
+  int i,j,k;
+  double* c = X.M;
+
+  vector<double> u(n, 0.0);
+  vector<double> v(n, 0.0);
+  vector<int> x(n, -1);
+  vector<int> y(n, -1);
+  vector<int> argmin(n, 0);
+
+  // Column reduction
+  for(j=0;j<n;j++){
+    v[j] = c[j];
+    for(i=1;i<n;i++){  if(c[i*n+j]<v[j]){ v[j] = c[i*n+j]; argmin[j] = i; }   }
+  }
+
+  // Row reduction
+  for(i=0;i<n;i++){
+    u[i] = c[i*n] - v[0];
+    for(j=1;j<n;j++){ if(c[i*n+j]-v[j] < u[i]){ u[i] = c[i*n+j] - v[j]; } }
+  }
+
+  // Tight pairs from the guess, complemented by the column reduction pairs
+  if(guess.size()==n){
+    for(i=0;i<n;i++){
+      j = guess[i];
+      if(j<0 || j>=n || y[j]>=0){ continue; }
+      if(c[i*n+j] - u[i] - v[j] <= 0.0){  x[i] = j; y[j] = i;  }
+    }
+  }
+  for(j=0;j<n;j++){
+    i = argmin[j];
+    if(y[j]<0 && x[i]<0){  x[i] = j; y[j] = i;  }  // c_ij = v_j and u_i = 0, so the pair is tight
+  }
+
+  int nwarm = 0;
+  for(i=0;i<n;i++){ if(x[i]>=0){ nwarm++; } }
+
+
+  vector<double> d(n, 0.0);
+  vector<int> pred(n, 0);
+  vector<int> is_final(n, 0);
+  vector<int> scanned;
+
+  for(int f=0; f<n; f++){
+    if(x[f]>=0){ continue; }
+
+    // Shortest paths from the free row f to all the columns
+    for(j=0;j<n;j++){ d[j] = c[f*n+j] - u[f] - v[j]; pred[j] = f; is_final[j] = 0; }
+    scanned.clear();
+
+    int sink = -1;
+    while(sink<0){
+
+      // the closest non-final column, the free ones are preferred among the equal
+      int jmin = -1;
+      for(j=0;j<n;j++){
+        if(is_final[j]){ continue; }
+        if(jmin<0 || d[j]<d[jmin] || (d[j]==d[jmin] && y[j]<0 && y[jmin]>=0) ){ jmin = j; }
+      }
+
+      is_final[jmin] = 1;
+      scanned.push_back(jmin);
+
+      if(y[jmin]<0){ sink = jmin; }
+      else{
+        i = y[jmin];
+        double di = d[jmin] - c[i*n+jmin] + u[i] + v[jmin];  // reduced cost of the assigned pair is 0
+
+        for(k=0;k<n;k++){
+          if(is_final[k]){ continue; }
+          double dk = di + c[i*n+k] - u[i] - v[k];
+          if(dk<d[k]){ d[k] = dk; pred[k] = i; }
+        }
+      }
+    }// while
+
+    // Update the duals: all the reduced costs stay non-negative, the path becomes tight
+    double D = d[sink];
+    for(k=0;k<scanned.size();k++){
+      j = scanned[k];
+      v[j] += d[j] - D;
+      if(y[j]>=0){  u[y[j]] += D - d[j];  }
+    }
+    u[f] += D;
+
+    // Augment along the path
+    j = sink;
+    while(1){
+      i = pred[j];
+      y[j] = i;
+      int jn = x[i];
+      x[i] = j;
+      if(i==f){ break; }
+      j = jn;
+    }
+
+  }// for f
+
+  if(verbosity>0){
+    cout<<"Jonker_Volgenant_minimize: n = "<<n<<", warm-started rows = "<<nwarm
+        <<", augmentations = "<<n-nwarm<<"\n";
+  }
+
+  return x;
+
+}
+
+vector<int> Jonker_Volgenant_minimize(MATRIX& X, int verbosity){
+  vector<int> guess;
+  return Jonker_Volgenant_minimize(X, guess, verbosity);
+}
+
+
+vector<int> Jonker_Volgenant_maximize(MATRIX& X, vector<int>& guess, int verbosity){
+/**
+  \brief Find the assignment (permutation) maximizing the total score
+
+  The negative of the matrix is minimized, no shift is needed
+*/
+
+  MATRIX mX(X);
+  mX *= -1.0;
+
+  return Jonker_Volgenant_minimize(mX, guess, verbosity);
+
+}
+
+vector<int> Jonker_Volgenant_maximize(MATRIX& X, int verbosity){
+  vector<int> guess;
+  return Jonker_Volgenant_maximize(X, guess, verbosity);
+}
+
+
+
+vector<int> Jonker_Volgenant_minimize_sparse(vector<vector<int> >& cols, vector<vector<double> >& costs,
+                                             vector<int>& guess, int verbosity){
+/**
+  \brief Find the assignment (permutation) minimizing the total cost of a sparse cost matrix
+
+  \param[in] cols The column indices allowed for each row: cols[i] = [j0, j1, ...]
+  \param[in] costs The corresponding costs: costs[i][k] = c(i, cols[i][k])
+  \param[in] guess The initial assignment: row i -> column guess[i]. Can be empty
+  \param[in] verbosity 0 - no extra output, 1 - print the statistics of the solver
+
+  The shortest augmenting paths are found with the binary heap, so only the stored
+  entries are visited.
+
+  Returns: the permutation perm, such that the row i is assigned to the column perm[i], or
+  an empty list if no complete assignment exists within the allowed entries
+*/
+
+  int n = cols.size();
+  int i,j,k;
+
+  if(costs.size()!=n){
+    cout<<"Error in Jonker_Volgenant_minimize_sparse: the sizes of cols ("<<n
+        <<") and costs ("<<costs.size()<<") are different\nExiting...\n";
+    exit(0);
+  }
+
+  for(i=0;i<n;i++){
+    if(costs[i].size()!=cols[i].size()){
+      cout<<"Error in Jonker_Volgenant_minimize_sparse: the sizes of cols["<<i<<"] and costs["
+          <<i<<"] are different\nExiting...\n";
+      exit(0);
+    }
+    for(k=0;k<cols[i].size();k++){
+      if(cols[i][k]<0 || cols[i][k]>=n){
+        cout<<"Error in Jonker_Volgenant_minimize_sparse: column index "<<cols[i][k]
+            <<" of the row "<<i<<" is out of range [0, "<<n-1<<"]\nExiting...\n";
+        exit(0);
+      }
+    }
+  }
+
+  vector<int> empty;
+
+  vector<double> u(n, 0.0);
+  vector<double> v(n, 0.0);
+  vector<int> x(n, -1);
+  vector<int> y(n, -1);
+  vector<int> argmin(n, -1);
+
+  // Column reduction
+  for(i=0;i<n;i++){
+    if(cols[i].size()==0){ return empty; }
+    for(k=0;k<cols[i].size();k++){
+      j = cols[i][k];
+      if(argmin[j]<0 || costs[i][k]<v[j]){ v[j] = costs[i][k]; argmin[j] = i; }
+    }
+  }
+  for(j=0;j<n;j++){  if(argmin[j]<0){ return empty; }  }
+
+  // Row reduction
+  for(i=0;i<n;i++){
+    u[i] = costs[i][0] - v[cols[i][0]];
+    for(k=1;k<cols[i].size();k++){
+      if(costs[i][k] - v[cols[i][k]] < u[i]){ u[i] = costs[i][k] - v[cols[i][k]]; }
+    }
+  }
+
+  // Tight pairs from the guess, complemented by the column reduction pairs
+  if(guess.size()==n){
+    for(i=0;i<n;i++){
+      j = guess[i];
+      if(j<0 || j>=n || y[j]>=0){ continue; }
+      for(k=0;k<cols[i].size();k++){
+        if(cols[i][k]==j){
+          if(costs[i][k] - u[i] - v[j] <= 0.0){  x[i] = j; y[j] = i;  }
+          break;
+        }
+      }
+    }
+  }
+  for(j=0;j<n;j++){
+    i = argmin[j];
+    if(y[j]<0 && x[i]<0){  x[i] = j; y[j] = i;  }  // c_ij = v_j and u_i = 0, so the pair is tight
+  }
+
+  int nwarm = 0;
+  for(i=0;i<n;i++){ if(x[i]>=0){ nwarm++; } }
+
+
+  typedef std::pair<double, int> dist_col;
+  const double inf = std::numeric_limits<double>::max();
+
+  vector<double> d(n, inf);
+  vector<int> pred(n, 0);
+  vector<int> is_final(n, 0);
+  vector<int> touched;
+  vector<int> scanned;
+
+  for(int f=0; f<n; f++){
+    if(x[f]>=0){ continue; }
+
+    std::priority_queue<dist_col, vector<dist_col>, std::greater<dist_col> > heap;
+    touched.clear();
+    scanned.clear();
+
+    for(k=0;k<cols[f].size();k++){
+      j = cols[f][k];
+      double dj = costs[f][k] - u[f] - v[j];
+      if(d[j]==inf){ touched.push_back(j); }
+      if(dj<d[j]){ d[j] = dj; pred[j] = f; heap.push(dist_col(dj, j)); }
+    }
+
+    int sink = -1;
+    while(sink<0 && !heap.empty()){
+
+      dist_col top = heap.top();  heap.pop();
+      int jmin = top.second;
+      if(is_final[jmin] || top.first>d[jmin]){ continue; }
+
+      is_final[jmin] = 1;
+      scanned.push_back(jmin);
+
+      if(y[jmin]<0){ sink = jmin; }
+      else{
+        i = y[jmin];
+        for(k=0;k<cols[i].size();k++){
+          if(cols[i][k]==jmin){ break; }
+        }
+        double di = d[jmin] - costs[i][k] + u[i] + v[jmin];
+
+        for(k=0;k<cols[i].size();k++){
+          j = cols[i][k];
+          if(is_final[j]){ continue; }
+          double dj = di + costs[i][k] - u[i] - v[j];
+          if(d[j]==inf){ touched.push_back(j); }
+          if(dj<d[j]){ d[j] = dj; pred[j] = i; heap.push(dist_col(dj, j)); }
+        }
+      }
+    }// while
+
+    if(sink<0){
+      if(verbosity>0){
+        cout<<"Jonker_Volgenant_minimize_sparse: no complete assignment for the row "<<f<<"\n";
+      }
+      return empty;
+    }
+
+    double D = d[sink];
+    for(k=0;k<scanned.size();k++){
+      j = scanned[k];
+      v[j] += d[j] - D;
+      if(y[j]>=0){  u[y[j]] += D - d[j];  }
+    }
+    u[f] += D;
+
+    j = sink;
+    while(1){
+      i = pred[j];
+      y[j] = i;
+      int jn = x[i];
+      x[i] = j;
+      if(i==f){ break; }
+      j = jn;
+    }
+
+    for(k=0;k<touched.size();k++){  d[touched[k]] = inf;  is_final[touched[k]] = 0;  }
+
+  }// for f
+
+  if(verbosity>0){
+    cout<<"Jonker_Volgenant_minimize_sparse: n = "<<n<<", warm-started rows = "<<nwarm
+        <<", augmentations = "<<n-nwarm<<"\n";
+  }
+
+  return x;
+
+}
+
+
+vector<int> Jonker_Volgenant_maximize_sparse(MATRIX& X, double threshold, vector<int>& guess, int verbosity){
+/**
+  \brief Find the assignment (permutation) maximizing the total score, ignoring the small elements
+
+  \param[in] X [n x n] The score matrix, e.g. the squared time-overlaps
+  \param[in] threshold Only the elements X_ij > threshold (and the guess pairs) are considered
+  \param[in] guess The initial assignment: row i -> column guess[i]. Can be empty
+  \param[in] verbosity 0 - no extra output, 1 - print the statistics of the solver
+
+  If the retained elements do not allow a complete assignment, the dense problem is solved
+*/
+
+  int n = X.n_cols;
+  int i,j;
+
+  vector<vector<int> > cols(n, vector<int>());
+  vector<vector<double> > costs(n, vector<double>());
+
+  for(i=0;i<n;i++){
+    int g = (guess.size()==n) ? guess[i] : -1;
+    for(j=0;j<n;j++){
+      double val = X.M[i*n+j];
+      if(val>threshold || j==g){  cols[i].push_back(j); costs[i].push_back(-val);  }
+    }
+  }
+
+  vector<int> res = Jonker_Volgenant_minimize_sparse(cols, costs, guess, verbosity);
+
+  if(res.size()!=n){
+    if(verbosity>0){ cout<<"Jonker_Volgenant_maximize_sparse: switching to the dense solver\n"; }
+    res = Jonker_Volgenant_maximize(X, guess, verbosity);
+  }
+
+  return res;
+
+}
+
+
+
+}// namespace libdyn
+}// liblibra
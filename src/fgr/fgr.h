@@ -106,6 +106,42 @@ MATRIX NEFGRL_population(double omega_DA, double V,
                          int method, double beta, int type, double dtau, double tmax, double dt);
 
 
+///=============== In fgr_incremental.cpp ============================
+
+class NEFGRL_tau_grid{
+/**
+  The phases of the bath normal modes tabulated on the tau grid used to integrate the ACFs:
+  ch[n*nmodes + w] = cos(omega_nm[w]*n*dtau/2),  sh[n*nmodes + w] = sin(omega_nm[w]*n*dtau/2)
+*/
+
+  public:
+
+  int nmodes;              ///< the number of normal modes
+  int ntau;                ///< the number of tau points
+  double dtau;             ///< the tau grid step [a.u. of time]
+  vector<double> ch, sh;   ///< the tabulated phases
+
+  NEFGRL_tau_grid(vector<double>& omega_nm, double _dtau, int _ntau);
+
+};
+
+vector<double> NEFGRL_rates_incremental(NEFGRL_tau_grid& g, double omega_DA, double V,
+                   vector<double>& omega_nm, vector<double>& gamma_nm,
+                   vector<double>& req_nm, vector<double>& shift_NE,
+                   int method, double beta, int type, double tmax, double dt);
+
+MATRIX NEFGRL_population_incremental(double omega_DA, double V,
+                         vector<double>& omega_nm, vector<double>& gamma_nm,
+                         vector<double>& req_nm, vector<double>& shift_NE,
+                         int method, double beta, int type, double dtau, double tmax, double dt);
+
+vector<MATRIX> NEFGRL_population_scan(vector<double>& omega_DA, vector<double>& V, vector<double>& beta,
+                         vector<int>& method, vector<int>& bath,
+                         vector< vector<double> >& omega_nm, vector< vector<double> >& gamma_nm,
+                         vector< vector<double> >& req_nm, vector< vector<double> >& shift_NE,
+                         int type, double dtau, double tmax, double dt);
+
+
 }// namespace libfgr
 }// liblibra
 
@@ -0,0 +1,546 @@
+/*********************************************************************************
+* Copyright (C) 2019 Xiang Sun, Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file fgr_incremental.cpp
+  \brief This file implements the tabulated version of the nonequilibrium FGR rates and populations
+  (NEFGRL_rate / NEFGRL_population of fgr.cpp). All the trigonometric functions of the normal mode
+  phases are computed once on the tau grid, so the rate at every time t' costs only the arithmetic
+  over the normal modes and one complex exponent per tau point.
+*/
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "fgr.h"
+
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libivr namespace
+namespace libfgr{
+
+
+
+NEFGRL_tau_grid::NEFGRL_tau_grid(vector<double>& omega_nm, double _dtau, int _ntau){
+/**
+  \brief Tabulate cos(w*tau/2) and sin(w*tau/2) for all the normal modes w and tau = n * dtau, n = 0, ... ntau-1
+
+  \param[in] omega_nm  frequencies of the bath normal modes
+  \param[in] _dtau     the integration timestep [a.u. of time]
+  \param[in] _ntau     the number of tau points
+
+  The phases are propagated by the complex rotation exp(i*w*dtau/2), re-seeded every 64 points
+  to keep the round-off errors at the machine precision level.
+*/
+
+  nmodes = omega_nm.size();
+  ntau = _ntau;
+  dtau = _dtau;
+
+  ch = vector<double>(ntau*nmodes, 1.0);
+  sh = vector<double>(ntau*nmodes, 0.0);
+
+  for(int w=0; w<nmodes; w++){
+
+    complex<double> rot = std::polar(1.0, 0.5*omega_nm[w]*dtau);
+    complex<double> q(1.0, 0.0);
+
+    for(int n=0; n<ntau; n++){
+      if(n%64==0){  q = std::polar(1.0, 0.5*omega_nm[w]*n*dtau);  }
+      else{ q *= rot; }
+
+      ch[n*nmodes+w] = q.real();
+      sh[n*nmodes+w] = q.imag();
+    }
+  }
+
+}
+
+
+
+/// The per-mode data of the bath and the phases exp(i*k*w*t'), k = 1,2,3,4 at the current t'
+struct nefgrl_modes{
+
+  int n;
+  vector<double> w, req, shift, g2, coth;
+  vector<double> cp1, sp1, cp2, sp2, cp3, sp3, cp4, sp4;
+
+  nefgrl_modes(vector<double>& omega_nm, vector<double>& gamma_nm, vector<double>& req_nm, vector<double>& shift_NE, double beta){
+
+    n = omega_nm.size();
+    w = omega_nm;  req = req_nm;  shift = shift_NE;
+    g2 = vector<double>(n);  coth = vector<double>(n);
+
+    for(int i=0;i<n;i++){
+      g2[i] = gamma_nm[i]*gamma_nm[i];
+      coth[i] = 1.0/tanh(0.5*beta*w[i]);
+    }
+
+    cp1 = sp1 = cp2 = sp2 = cp3 = sp3 = cp4 = sp4 = vector<double>(n, 0.0);
+  }
+
+  void set_time(double tp){
+    for(int i=0;i<n;i++){
+      complex<double> p1 = std::polar(1.0, w[i]*tp);
+      complex<double> p2 = p1*p1;
+      complex<double> p3 = p2*p1;
+      complex<double> p4 = p2*p2;
+      cp1[i] = p1.real();  sp1[i] = p1.imag();
+      cp2[i] = p2.real();  sp2[i] = p2.imag();
+      cp3[i] = p3.real();  sp3[i] = p3.imag();
+      cp4[i] = p4.real();  sp4[i] = p4.imag();
+    }
+  }
+
+};
+
+
+/// Re( exp(argg) * ampl )
+static inline double nefgrl_re_acf(double a_re, double a_im, double l_re, double l_im){
+
+  return exp(a_re) * ( cos(a_im) * l_re - sin(a_im) * l_im );
+
+}
+
+
+
+static double nefgrl_sum_exact(int N, const NEFGRL_tau_grid& g, const nefgrl_modes& m, double omega_DA, double V, int type, int is_lsc){
+/**
+  sum_n Re C(t', n*dtau) for the Exact (is_lsc = 0) and LSC (is_lsc = 1) methods, see ACF_NE_exact and ACF_NE_LSC
+*/
+
+  int nm = m.n;
+  double k = 0.0;
+
+  for(int n=0; n<N; n++){
+
+    const double* CH = &g.ch[n*nm];
+    const double* SH = &g.sh[n*nm];
+
+    double a_re = 0.0, a_im = omega_DA * n * g.dtau;
+    double l_re = 0.0, l_im = 0.0;
+
+    #pragma omp simd reduction(+:a_re,a_im,l_re,l_im)
+    for(int w=0; w<nm; w++){
+
+      double ch = CH[w], sh = SH[w];
+      double c1 = ch*ch - sh*sh,  s1 = 2.0*sh*ch;
+      double cb = m.cp1[w]*c1 + m.sp1[w]*s1;     // cos(wt' - wt)
+      double sb = m.sp1[w]*c1 - m.cp1[w]*s1;     // sin(wt' - wt)
+      double pref = 0.5*m.w[w]*m.req[w]*m.req[w];
+      double coth = m.coth[w];
+
+      a_re += -pref*(1.0-c1)*coth;
+      a_im += -pref*s1 - m.w[w]*m.req[w]*m.shift[w]*(m.sp1[w] - sb);
+
+      if(type==1){
+        if(is_lsc==0){
+          double u2_re = m.req[w]*(1.0-c1);
+          double u2_im = m.req[w]*coth*s1;
+          double x = u2_re - 2.0*m.shift[w]*m.cp1[w];
+          double y = u2_re - 2.0*m.shift[w]*cb;
+
+          l_re += m.g2[w]*( 0.5/m.w[w]*coth*c1 + 0.25*x*y - 0.25*u2_im*u2_im );
+          l_im += m.g2[w]*( -0.5/m.w[w]*s1 + 0.25*(x + y)*u2_im );
+        }
+        else{
+          double c2 = c1*c1 - s1*s1,  s2 = 2.0*s1*c1;
+          double c15 = c1*ch - s1*sh,  s15 = s1*ch + c1*sh;
+          double c4 = m.cp4[w]*c2 + m.sp4[w]*s2;          // cos(4wt' - 2wt)
+          double s12 = m.sp1[w]*c2 - m.cp1[w]*s2;         // sin(wt' - 2wt)
+          double c3 = m.cp3[w]*c15 + m.sp3[w]*s15;        // cos(3wt' - 1.5wt)
+
+          l_re += m.g2[w]*( m.shift[w]*m.shift[w]*m.cp1[w]*cb + (coth/m.w[w])*0.5*c1
+                            - m.req[w]*m.req[w]*0.5*coth*coth*sh*sh*(c4 + c1) );
+          l_im += m.g2[w]*( 0.25*m.req[w]*m.shift[w]*coth*( (1.0-2.0*c1)*m.sp1[w] + s12 - 4.0*c3*sh ) );
+        }
+      }
+    }// for w
+
+    if(type==0){  l_re = V*V;  l_im = 0.0; }
+
+    k += nefgrl_re_acf(a_re, a_im, l_re, l_im);
+  }
+
+  return k;
+}
+
+
+
+static double nefgrl_sum_cav_cd(int N, const NEFGRL_tau_grid& g, const nefgrl_modes& m, double omega_DA, double V, int type, double beta, int is_cd){
+/**
+  sum_n Re C(t', n*dtau) for the CAV (is_cd = 0) and CD (is_cd = 1) methods, see ACF_NE_CAV and ACF_NE_CD
+*/
+
+  int nm = m.n;
+  double k = 0.0;
+
+  for(int n=0; n<N; n++){
+
+    const double* CH = &g.ch[n*nm];
+    const double* SH = &g.sh[n*nm];
+    double tau = n * g.dtau;
+
+    double a_re = 0.0, a_im = omega_DA * tau;
+    double l_re = 0.0, l_im = 0.0;
+
+    #pragma omp simd reduction(+:a_re,a_im,l_re,l_im)
+    for(int w=0; w<nm; w++){
+
+      double ch = CH[w], sh = SH[w];
+      double c1 = ch*ch - sh*sh,  s1 = 2.0*sh*ch;
+      double cb = m.cp1[w]*c1 + m.sp1[w]*s1;     // cos(wt' - wt)
+      double sb = m.sp1[w]*c1 - m.cp1[w]*s1;     // sin(wt' - wt)
+      double wb = m.w[w]*beta;
+
+      a_re += -(m.req[w]*m.req[w]/beta)*(1.0-c1);
+      if(is_cd==0){  a_im += -m.w[w]*m.req[w]*m.req[w]*0.5*s1;  }
+      else{          a_im += -0.5*m.w[w]*m.req[w]*m.req[w]*m.w[w]*tau;  }
+      a_im += -m.w[w]*m.req[w]*m.shift[w]*(m.sp1[w] - sb);
+
+      if(type==1){
+        if(is_cd==0){
+          double c2 = c1*c1 - s1*s1,  s2 = 2.0*s1*c1;
+          double c15 = c1*ch - s1*sh,  s15 = s1*ch + c1*sh;
+          double c4 = m.cp4[w]*c2 + m.sp4[w]*s2;          // cos(4wt' - 2wt)
+          double s12 = m.sp1[w]*c2 - m.cp1[w]*s2;         // sin(wt' - 2wt)
+          double c3 = m.cp3[w]*c15 + m.sp3[w]*s15;        // cos(3wt' - 1.5wt)
+
+          l_re += m.g2[w]*( m.shift[w]*m.shift[w]*m.cp1[w]*cb + 1.0/(wb*m.w[w])*c1
+                            - m.req[w]*m.req[w]*0.5/(0.25*wb*wb)*sh*sh*(c4 + c1) );
+          l_im += m.g2[w]*( 0.5*m.req[w]*m.shift[w]/wb*( (1.0-2.0*c1)*m.sp1[w] + s12 - 4.0*c3*sh ) );
+        }
+        else{
+          double x = m.req[w]*s1/wb;
+          double ca = m.cp1[w]*ch + m.sp1[w]*sh;          // cos(wt' - 0.5wt)
+
+          l_re += m.g2[w]*( m.shift[w]*m.shift[w]*m.cp1[w]*cb + c1/(wb*m.w[w]) - x*x );
+          l_im += m.g2[w]*( -4.0*m.shift[w]*m.req[w]/wb * ca * ch*ch * sh );
+        }
+      }
+    }// for w
+
+    if(type==0){  l_re = V*V;  l_im = 0.0; }
+
+    k += nefgrl_re_acf(a_re, a_im, l_re, l_im);
+  }
+
+  return k;
+}
+
+
+
+static double nefgrl_sum_w0_c0(int N, const NEFGRL_tau_grid& g, const nefgrl_modes& m, double omega_DA, double V, int type, double beta, int is_c0){
+/**
+  sum_n Re C(t', n*dtau) for the W0 (is_c0 = 0) and C0 (is_c0 = 1) methods, see ACF_NE_W0 and ACF_NE_C0.
+  These are polynomial in tau, so the tau tables are not needed
+*/
+
+  int nm = m.n;
+  double k = 0.0;
+
+  for(int n=0; n<N; n++){
+
+    double tau = n * g.dtau;
+
+    double a_re = 0.0, a_im = omega_DA * tau;
+    double l_re = 0.0, l_im = 0.0;
+
+    #pragma omp simd reduction(+:a_re,a_im,l_re,l_im)
+    for(int w=0; w<nm; w++){
+
+      double wt = m.w[w]*tau;
+      double pref = 0.5*m.w[w]*m.req[w]*m.req[w]*wt;
+
+      if(is_c0==0){  a_re += -pref*m.coth[w]*wt*wt*0.5;  }
+      else{          a_re += -pref*tau/beta;  }
+      a_im += -pref - m.w[w]*m.req[w]*m.shift[w]*m.cp1[w]*wt;
+
+      if(type==1){
+        double s2 = 0.5*m.shift[w]*m.shift[w]*(1.0 + m.cp2[w]);
+
+        if(is_c0==0){
+          double x = m.req[w]*tau*m.w[w];
+          double coth = m.coth[w];
+
+          l_re += m.g2[w]*( coth*0.5/m.w[w] + s2 - 0.25*x*x*coth*coth );
+          l_im += m.g2[w]*( -coth*x*m.shift[w]*m.cp1[w] );
+        }
+        else{
+          double x = m.req[w]*tau/beta;
+
+          l_re += m.g2[w]*( 1.0/(beta*m.w[w]*m.w[w]) + s2 - x*x );
+          l_im += m.g2[w]*( -2.0*x*m.shift[w]*m.cp1[w] );
+        }
+      }
+    }// for w
+
+    if(type==0){  l_re = V*V;  l_im = 0.0; }
+
+    k += nefgrl_re_acf(a_re, a_im, l_re, l_im);
+  }
+
+  return k;
+}
+
+
+
+static void nefgrl_check_method(int method){
+
+  if(method<0 || method>5){
+    cout<<"Method "<<method<<" is not available. Please choose from the following options:\n";
+    cout<<"0 - Exact\n";
+    cout<<"1 - LSC\n";
+    cout<<"2 - CAV\n";
+    cout<<"3 - CD\n";
+    cout<<"4 - W0\n";
+    cout<<"5 - C0\n";
+    cout<<"Exiting now...\n";
+    exit(0);
+  }
+
+}
+
+
+
+static double nefgrl_rate(const NEFGRL_tau_grid& g, nefgrl_modes& m, double tp, double omega_DA, double V,
+                          int method, double beta, int type){
+/**
+  The rate k(t') - same as NEFGRL_rate(t', ...), the method selection is done once here
+*/
+
+  int N = int(tp/g.dtau);   // same as in NEFGRL_rate
+
+  m.set_time(tp);
+
+  double sum = 0.0;
+  switch(method){
+    case 0: { sum = nefgrl_sum_exact(N, g, m, omega_DA, V, type, 0); } break;
+    case 1: { sum = nefgrl_sum_exact(N, g, m, omega_DA, V, type, 1); } break;
+    case 2: { sum = nefgrl_sum_cav_cd(N, g, m, omega_DA, V, type, beta, 0); } break;
+    case 3: { sum = nefgrl_sum_cav_cd(N, g, m, omega_DA, V, type, beta, 1); } break;
+    case 4: { sum = nefgrl_sum_w0_c0(N, g, m, omega_DA, V, type, beta, 0); } break;
+    case 5: { sum = nefgrl_sum_w0_c0(N, g, m, omega_DA, V, type, beta, 1); } break;
+  }
+
+  return 2.0*g.dtau*sum;
+
+}
+
+
+
+vector<double> NEFGRL_rates_incremental(NEFGRL_tau_grid& g, double omega_DA, double V,
+                   vector<double>& omega_nm, vector<double>& gamma_nm,
+                   vector<double>& req_nm, vector<double>& shift_NE,
+                   int method, double beta, int type, double tmax, double dt
+                  ){
+/**
+  Computes the nonequilibrium FGR rates k(t') for t' = 0, dt, ... tmax using the precomputed tau grid
+
+  \param[in] g  the tau grid tabulated for the same omega_nm and the integration step dtau, with at least
+                int(tmax/dtau) points
+
+  The rest of the parameters are as in NEFGRL_population.
+  Returns: the rates k(t') - same as NEFGRL_rate(t', ...) at every t'
+
+*/
+
+  nefgrl_check_method(method);
+
+  if(g.nmodes!=omega_nm.size()){
+    cout<<"Error in NEFGRL_rates_incremental: the tau grid is made for "<<g.nmodes<<" modes, but "<<omega_nm.size()<<" are given\n";
+    cout<<"Exiting now...\n";  exit(0);
+  }
+
+  int nsteps = (int)(tmax/dt)+1;
+  vector<double> k(nsteps, 0.0);
+
+  nefgrl_modes m0(omega_nm, gamma_nm, req_nm, shift_NE, beta);
+
+  if(int(((nsteps-1)*dt)/g.dtau) > g.ntau){
+    cout<<"Error in NEFGRL_rates_incremental: the tau grid has "<<g.ntau<<" points, but "<<int(((nsteps-1)*dt)/g.dtau)<<" are needed\n";
+    cout<<"Exiting now...\n";  exit(0);
+  }
+
+  // The cost of the step grows with t', so the steps are distributed dynamically
+  #pragma omp parallel
+  {
+    nefgrl_modes m(m0);
+
+    #pragma omp for schedule(dynamic, 1)
+    for(int step=0; step<nsteps; step++){
+
+      k[step] = nefgrl_rate(g, m, step*dt, omega_DA, V, method, beta, type);
+
+    }// for step
+  }// omp parallel
+
+  return k;
+
+}
+
+
+
+static void nefgrl_population(vector<double>& k, double dt, MATRIX& res){
+/**
+  Accumulate the donor population P(t') = exp(- int dt' k(t')) from the rates k(t') and
+  store the results in the format of NEFGRL_population: current time, instantaneous rate, population
+*/
+
+  double sum = 0.0; //probability of donor state
+
+  for(int step=0; step<k.size(); step++) {  // t'
+
+    sum += k[step] * dt;
+    double P = exp(-sum);  //exp(- int dt' k(t'))
+
+    res.set(step, 0, step*dt);
+    res.set(step, 1, k[step]);
+    res.set(step, 2, P);
+
+  }
+
+}
+
+
+
+MATRIX NEFGRL_population_incremental(double omega_DA, double V,
+                         vector<double>& omega_nm, vector<double>& gamma_nm,
+                         vector<double>& req_nm, vector<double>& shift_NE,
+                         int method, double beta, int type, double dtau, double tmax, double dt
+                        ){
+/**
+  Noneq FGR in Condon (type=0) and non-Condon (type=1) cases using normal modes - the same result as
+  the NEFGRL_population, but the tau-dependent phases of all normal modes are tabulated once, the choice
+  of the method is done once per time t', and the rates at different t' are computed in parallel.
+
+  The parameters are the same as in NEFGRL_population
+
+  Returns: the matrix with: current time, instantaneous rate, population on the donor state
+
+*/
+
+  int nsteps = (int)(tmax/dt)+1;
+
+  NEFGRL_tau_grid g(omega_nm, dtau, int(((nsteps-1)*dt)/dtau)+1);
+
+  vector<double> k = NEFGRL_rates_incremental(g, omega_DA, V, omega_nm, gamma_nm, req_nm, shift_NE, method, beta, type, tmax, dt);
+
+  MATRIX res(nsteps, 3);
+  nefgrl_population(k, dt, res);
+
+  return res;
+
+}
+
+
+
+vector<MATRIX> NEFGRL_population_scan(vector<double>& omega_DA, vector<double>& V, vector<double>& beta,
+                         vector<int>& method, vector<int>& bath,
+                         vector< vector<double> >& omega_nm, vector< vector<double> >& gamma_nm,
+                         vector< vector<double> >& req_nm, vector< vector<double> >& shift_NE,
+                         int type, double dtau, double tmax, double dt
+                        ){
+/**
+  Noneq FGR populations for a set of parameter points, e.g. a scan over the donor-acceptor gaps, couplings,
+  temperatures, methods, and bath discretizations, in one call.
+
+  \param[in] omega_DA  D-A electronic transition frequencies for all points [a.u.]
+  \param[in] V         D-A couplings for all points [a.u. of energy]
+  \param[in] beta      inverse thermal energies for all points [a.u.]
+  \param[in] method    the methods for all points (same meaning as in NEFGRL_population)
+  \param[in] bath      bath[ipt] - the index of the bath (in the lists below) used by the point ipt
+  \param[in] omega_nm  omega_nm[ibath] - frequencies of the normal modes of the bath ibath
+  \param[in] gamma_nm  gamma_nm[ibath] - couplings of the normal modes of the bath ibath to the primary mode
+  \param[in] req_nm    req_nm[ibath] - equilibrum position displacements of the normal modes of the bath ibath
+  \param[in] shift_NE  shift_NE[ibath] - non-equilibrium shifts of the normal modes of the bath ibath
+  \param[in] type, dtau, tmax, dt  same as in NEFGRL_population, common for all the points
+
+  The tau tables are computed once for every bath and are shared by all the points that use it.
+  All (point, time) pairs are independent and are distributed over the OpenMP threads.
+
+  Returns: the list of matrices, one per point, in the format of NEFGRL_population:
+  current time, instantaneous rate, population on the donor state
+
+*/
+
+  int npts = omega_DA.size();
+  int nbaths = omega_nm.size();
+  int ipt, ib;
+
+  if(V.size()!=npts || beta.size()!=npts || method.size()!=npts || bath.size()!=npts){
+    cout<<"Error in NEFGRL_population_scan: omega_DA, V, beta, method, and bath should all have the same size\n";
+    cout<<"Exiting now...\n";  exit(0);
+  }
+  if(gamma_nm.size()!=nbaths || req_nm.size()!=nbaths || shift_NE.size()!=nbaths){
+    cout<<"Error in NEFGRL_population_scan: omega_nm, gamma_nm, req_nm, and shift_NE should all have the same size\n";
+    cout<<"Exiting now...\n";  exit(0);
+  }
+  for(ipt=0; ipt<npts; ipt++){
+    nefgrl_check_method(method[ipt]);
+    if(bath[ipt]<0 || bath[ipt]>=nbaths){
+      cout<<"Error in NEFGRL_population_scan: bath["<<ipt<<"] = "<<bath[ipt]<<" is out of range\n";
+      cout<<"Exiting now...\n";  exit(0);
+    }
+  }
+
+  if(npts==0){ return vector<MATRIX>(); }
+
+  int nsteps = (int)(tmax/dt)+1;
+  int ntau = int(((nsteps-1)*dt)/dtau)+1;
+
+  // Bath preprocessing - once per bath
+  vector<NEFGRL_tau_grid> grids;
+  for(ib=0; ib<nbaths; ib++){
+    grids.push_back(NEFGRL_tau_grid(omega_nm[ib], dtau, ntau));
+  }
+
+  vector<nefgrl_modes> modes;
+  for(ipt=0; ipt<npts; ipt++){
+    ib = bath[ipt];
+    modes.push_back(nefgrl_modes(omega_nm[ib], gamma_nm[ib], req_nm[ib], shift_NE[ib], beta[ipt]));
+  }
+
+  vector< vector<double> > k(npts, vector<double>(nsteps, 0.0));
+
+  // The cost of the job grows with t', so the jobs are distributed dynamically
+  #pragma omp parallel private(ipt)
+  {
+    int last = -1;
+    nefgrl_modes m(modes[0]);
+
+    #pragma omp for schedule(dynamic, 1)
+    for(int job=0; job<npts*nsteps; job++){
+
+      ipt = job / nsteps;
+      int step = job % nsteps;
+
+      if(ipt!=last){  m = modes[ipt];  last = ipt; }
+
+      k[ipt][step] = nefgrl_rate(grids[bath[ipt]], m, step*dt, omega_DA[ipt], V[ipt], method[ipt], beta[ipt], type);
+
+    }// for job
+  }// omp parallel
+
+  vector<MATRIX> res(npts, MATRIX(nsteps, 3));
+  for(ipt=0; ipt<npts; ipt++){  nefgrl_population(k[ipt], dt, res[ipt]);  }
+
+  return res;
+
+}
+
+
+
+}/// namespace libfgr
+}/// namespace liblibra
+
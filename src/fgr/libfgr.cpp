@@ -179,6 +179,25 @@ void export_fgr_objects(){
   def("NEFGRL_population", expt_NEFGRL_population_v1);
 
 
+  MATRIX (*expt_NEFGRL_population_incremental_v1)
+  (double omega_DA, double V,
+   vector<double>& omega_nm, vector<double>& gamma_nm,
+   vector<double>& req_nm, vector<double>& shift_NE,
+   int method, double beta, int type, double dtau, double tmax, double dt) = &NEFGRL_population_incremental;
+
+  def("NEFGRL_population_incremental", expt_NEFGRL_population_incremental_v1);
+
+
+  vector<MATRIX> (*expt_NEFGRL_population_scan_v1)
+  (vector<double>& omega_DA, vector<double>& V, vector<double>& beta,
+   vector<int>& method, vector<int>& bath,
+   vector< vector<double> >& omega_nm, vector< vector<double> >& gamma_nm,
+   vector< vector<double> >& req_nm, vector< vector<double> >& shift_NE,
+   int type, double dtau, double tmax, double dt) = &NEFGRL_population_scan;
+
+  def("NEFGRL_population_scan", expt_NEFGRL_population_scan_v1);
+
+
 
 } // export_fgr_objects()
 
@@ -68,7 +68,7 @@ int ForceField::get_mb_parameters(map<string,double>& prms
 
   }// Ewald_3D
 
-  else if(mb_functional=="vdw_LJ"||mb_functional=="vdw_LJ1"||mb_functional=="LJ_Coulomb"){
+  else if(mb_functional=="vdw_LJ"||mb_functional=="vdw_LJ1"||mb_functional=="LJ_Coulomb"||mb_functional=="vdw_LJ1_vlist"){
 
     if((is_R_vdw_off==1)&&(is_R_vdw_on==1)){ is_cut = 1; R_off = R_vdw_off; R_on = R_vdw_on; }
     else if((is_R_vdw_off==0)&&(is_R_vdw_on==0)){}
@@ -96,6 +96,9 @@ int ForceField::get_mb_parameters(map<string,double>& prms
       status = 1;
     }
 
+    // Verlet list radius
+    if(is_R_vlist){  prms["R_vlist"] = R_vlist * Angst; }
+
   }// vdw_LJ
 
   prms["time"] = 0;
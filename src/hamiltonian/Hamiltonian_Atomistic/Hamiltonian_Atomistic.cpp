@@ -52,10 +52,14 @@ Hamiltonian_Atomistic::Hamiltonian_Atomistic(int _nelec, int _nnucl){
   \param[in] _nelec The number of electronic basis states 
   \param[in] _nnucl The number of nuclear DOF
 
-  This Hamiltonian_Atomistic constructor allocates internal memory for ham_dia, ham_adi, d1ham_dia, d1ham_adi, 
-  and d2ham_dia and populates them with zeroes. The default representation is selected, status flags are 
+  This Hamiltonian_Atomistic constructor allocates internal memory for ham_dia, ham_adi, d1ham_dia, d1ham_adi 
+  and populates them with zeroes. The default representation is selected, status flags are 
   set to zero (Hamiltonian is not up to date) and the hamiltonian types are initialized to 0 (meaning actual Hamiltonians
   are not initialized)
+
+  The second derivatives are not allocated here: the nnucl^2 blocks would be prohibitively large for
+  realistic systems. Instead, the d2ham_blocks object keeps only the blocks requested via request_d2ham 
+  or request_d2ham_bonded
 */
 
   _syst = NULL;
@@ -76,8 +80,7 @@ Hamiltonian_Atomistic::Hamiltonian_Atomistic(int _nelec, int _nnucl){
     d1ham_adi[i] = new MATRIX(nelec,nelec); *d1ham_adi[i] = 0.0; 
   }
 
-  d2ham_dia = vector<MATRIX*>(nnucl*nnucl);
-  for(i=0;i<nnucl*nnucl;i++){  d2ham_dia[i] = new MATRIX(nelec,nelec); *d2ham_dia[i] = 0.0;  }
+  d2ham_blocks.init(nelec, nnucl);
 
 
   rep = 1; // default representation is adiabatic  
@@ -196,7 +199,7 @@ void Hamiltonian_Atomistic::set_respa_types(std::string inter_type,std::string r
 
 Hamiltonian_Atomistic::~Hamiltonian_Atomistic(){
 /**
-  Destructor: Free memory occupied by ham_dia, ham_adi, d1ham_dia, d1ham_adi, d2ham_dia
+  Destructor: Free memory occupied by ham_dia, ham_adi, d1ham_dia, d1ham_adi (d2ham_blocks frees its own memory)
 */
 
   int i;
@@ -208,7 +211,6 @@ Hamiltonian_Atomistic::~Hamiltonian_Atomistic(){
     delete d1ham_dia[i];
     delete d1ham_adi[i];
   }
-  for(i=0;i<nnucl*nnucl;i++){  delete d2ham_dia[i]; }
 
   if(d1ham_dia.size()>0) { d1ham_dia.clear(); }
   if(d2ham_dia.size()>0) { d2ham_dia.clear(); }
@@ -437,8 +439,7 @@ void Hamiltonian_Atomistic::compute_diabatic(){
           d1ham_dia[3*i+2]->M[st*nelec+st] -= _syst->Atoms[i].Atom_RB.rb_force.z;
         }
 
-        // Second derivatives
-        for(i=0;i<nnucl*nnucl;i++){    d2ham_dia[i]->M[st*nelec+st] = 0.0;      }
+        // Second derivatives are not computed here - see compute_d2ham
 
       } // for i
 
@@ -1055,6 +1056,193 @@ MATRIX3x3 Hamiltonian_Atomistic::get_stress(std::string opt){
 }
 
 
+void Hamiltonian_Atomistic::request_d2ham(int n1, int n2){
+/**
+  \brief Allocate the block of second derivatives d2H/dq_n1 dq_n2 (and the symmetric one d2H/dq_n2 dq_n1)
+
+  Only the allocated blocks are computed by compute_d2ham, all other second derivatives are considered zero
+
+  \param[in] n1 The index of the first nuclear DOF
+  \param[in] n2 The index of the second nuclear DOF
+*/
+
+  d2ham_blocks.request(n1, n2);
+  d2ham_blocks.request(n2, n1);
+
+}
+
+
+void Hamiltonian_Atomistic::request_d2ham_bonded(){
+/**
+  \brief Allocate the second-derivative blocks for all pairs of atoms connected by the bonded MM interactions
+
+  For each bond, angle, dihedral and oop interaction, the 3 x 3 blocks for all pairs of atoms involved
+  (including the diagonal ones) are allocated. These are the only nonzero second derivatives of the 
+  bonded part of the force field, so the number of stored blocks grows linearly with the system size
+*/
+
+  if(ham_types[0]!=1){
+    cout<<"Error in Hamiltonian_Atomistic::request_d2ham_bonded: MM Hamiltonian is not initialized\n";
+    cout<<"Exiting...\n"; exit(0);
+  }
+  if(_syst==NULL){
+    cout<<"Error in Hamiltonian_Atomistic::request_d2ham_bonded: the system object is not set\nExiting...\n"; exit(0);
+  }
+
+  int sz = mm_ham->interactions.size();
+  for(int i=0;i<sz;i++){
+
+    int t = mm_ham->interactions[i].get_type();
+    if(t<0 || t>3){ continue; }
+
+    // The interactions keep the atom IDs, the blocks are indexed by the atom indices
+    vector<int> at = mm_ham->interactions[i].get_atom_ids();
+    for(int a=0;a<at.size();a++){  at[a] = _syst->get_atom_index_by_atom_id(at[a]);  }
+
+    for(int a=0;a<at.size();a++){
+      for(int b=0;b<at.size();b++){
+        for(int k1=0;k1<3;k1++){
+          for(int k2=0;k2<3;k2++){   d2ham_blocks.request(3*at[a]+k1, 3*at[b]+k2);   }
+        }
+      }// for b
+    }// for a
+
+  }// for i
+
+}
+
+
+MATRIX Hamiltonian_Atomistic::hessian_vector_product(MATRIX& dir, int st, double dq){
+/**
+  \brief Compute the product of the Hessian of the state st energy and a vector, without forming the Hessian
+
+  The product is computed by the central finite difference of the analytic gradients along the direction dir:
+  H * dir = [ dE_st/dq (q + dq*dir) - dE_st/dq (q - dq*dir) ] / (2*dq), which costs only 2 gradient calculations
+  irrespective of the number of DOFs. The gradients of the present representation (rep) are used.
+
+  \param[in] dir The direction in the space of nuclear DOFs: nnucl x 1 matrix
+  \param[in] st The index of the electronic state
+  \param[in] dq The finite-difference step (along dir, in the units of coordinates)
+
+  Returns the nnucl x 1 matrix. On exit the coordinates are restored to their original values, but the 
+  Hamiltonian is marked as not up to date
+*/
+
+  if(_syst==NULL){
+    cout<<"Error in Hamiltonian_Atomistic::hessian_vector_product: the system object is not set\nExiting...\n"; exit(0);
+  }
+  if(dir.n_rows!=nnucl){
+    cout<<"Error in Hamiltonian_Atomistic::hessian_vector_product: the size of the direction vector ("<<dir.n_rows;
+    cout<<") does not match the number of nuclear DOFs ("<<nnucl<<")\nExiting...\n"; exit(0);
+  }
+  if(st<0 || st>=nelec){
+    cout<<"Error in Hamiltonian_Atomistic::hessian_vector_product: the state index "<<st<<" is out of range\nExiting...\n"; exit(0);
+  }
+
+  int n;
+  vector<double> q0(nnucl, 0.0);  _syst->extract_atomic_q(q0);
+  vector<double> qx(q0);
+  vector<MATRIX*>& d1 = (rep==0) ? d1ham_dia : d1ham_adi;
+
+  MATRIX res(nnucl, 1);
+
+  for(int s=-1;s<=1;s+=2){
+    for(n=0;n<nnucl;n++){  qx[n] = q0[n] + s*dq*dir.M[n];  }
+    set_q(qx);
+    compute();
+    for(n=0;n<nnucl;n++){  res.M[n] += s * d1[n]->M[st*nelec+st];  }
+  }
+  res *= (0.5/dq);
+
+  set_q(q0);
+
+  return res;
+}
+
+
+void Hamiltonian_Atomistic::compute_d2ham(double dq){
+/**
+  \brief Compute all the allocated blocks of the second derivatives
+
+  The blocks are computed by the central finite differences of the analytic gradients (of the present
+  representation), one nuclear DOF n2 at a time, so only the DOFs that have at least one allocated
+  block d2H/dq_n1 dq_n2 are displaced. The cost is thus 2 gradient calculations per such DOF.
+
+  \param[in] dq The finite-difference step (in the units of coordinates)
+
+  On exit the coordinates are restored to their original values, but the Hamiltonian is marked as not up to date
+*/
+
+  if(_syst==NULL){
+    cout<<"Error in Hamiltonian_Atomistic::compute_d2ham: the system object is not set\nExiting...\n"; exit(0);
+  }
+
+  int n1;
+  vector<double> q0(nnucl, 0.0);  _syst->extract_atomic_q(q0);
+  vector<double> qx(q0);
+  vector<MATRIX*>& d1 = (rep==0) ? d1ham_dia : d1ham_adi;
+
+  vector<int> cols = d2ham_blocks.columns();
+
+  for(int c=0;c<cols.size();c++){
+    int n2 = cols[c];
+
+    // Forward step: keep the gradients directly in the blocks
+    qx[n2] = q0[n2] + dq;
+    set_q(qx);
+    compute();
+    for(n1=0;n1<nnucl;n1++){
+      MATRIX* blk = d2ham_blocks.find(n1, n2);
+      if(blk!=NULL){ *blk = *d1[n1]; }
+    }
+
+    // Backward step
+    qx[n2] = q0[n2] - dq;
+    set_q(qx);
+    compute();
+    for(n1=0;n1<nnucl;n1++){
+      MATRIX* blk = d2ham_blocks.find(n1, n2);
+      if(blk!=NULL){ *blk -= *d1[n1];  *blk *= (0.5/dq); }
+    }
+
+    qx[n2] = q0[n2];
+  }// for c
+
+  set_q(q0);
+
+}
+
+
+MATRIX Hamiltonian_Atomistic::compute_hessian(int st, double dq){
+/**
+  \brief Compute the full (dense) Hessian of the state st energy
+
+  The Hessian is assembled column by column from the Hessian-vector products with the unit vectors
+  (see hessian_vector_product) and is symmetrized at the end. This is meant for the normal-mode analysis of
+  moderately-sized systems - only the nnucl x nnucl matrix of numbers is stored.
+
+  \param[in] st The index of the electronic state
+  \param[in] dq The finite-difference step (in the units of coordinates)
+
+  Returns the nnucl x nnucl matrix
+*/
+
+  MATRIX res(nnucl, nnucl);
+  MATRIX dir(nnucl, 1);
+
+  for(int n2=0;n2<nnucl;n2++){
+    dir.M[n2] = 1.0;
+    MATRIX col = hessian_vector_product(dir, st, dq);
+    for(int n1=0;n1<nnucl;n1++){  res.M[n1*nnucl+n2] = col.M[n1];  }
+    dir.M[n2] = 0.0;
+  }
+
+  res = 0.5*(res + res.T());
+
+  return res;
+}
+
+
 
 
 }// namespace libhamiltonian_atomistic
@@ -19,6 +19,7 @@
 #define HAMILTONIAN_ATOMISTIC_H
 
 #include "../Hamiltonian_Generic/Hamiltonian.h"
+#include "../Hamiltonian_Generic/Hessian_Blocks.h"
 #include "../../chemobjects/libchemobjects.h"
 #include "../../calculators/libcalculators.h"
 #include "Hamiltonian_MM/libhamiltonian_mm.h"
@@ -60,6 +61,8 @@ public:
   listHamiltonian_MM*  mm_ham;   ///< mm part: type = 0 This is the list of classical (MM) Hamiltonians for the sub-systems (e.g. bonds, angles, etc.)
   listHamiltonian_QM*  qm_ham;   ///< qm part: type = 1 This is the list of quantum (QM) Hamiltonians for the sub-systems (e.g. fragments, blocks, etc)
 
+  Hessian_Blocks d2ham_blocks;   ///< sparse storage of the second derivatives: only the requested blocks are allocated
+
 
   /// Constructor: only allocates memory and sets up related variables
   Hamiltonian_Atomistic(int, int);
@@ -130,6 +133,17 @@ public:
   void compute_diabatic();
   void compute_adiabatic();
 
+  //--------- Second derivatives -----------
+  void request_d2ham(int n1, int n2);
+  void request_d2ham_bonded();
+  void clear_d2ham(){ d2ham_blocks.clear(); }          ///< Frees all the second-derivative blocks
+  int num_d2ham_blocks(){ return d2ham_blocks.num_blocks(); }  ///< The number of the allocated blocks
+  MATRIX get_d2ham(int n1, int n2){ return d2ham_blocks.get(n1, n2); }  ///< The block d2H/dq_n1 dq_n2 (zero if not allocated)
+
+  MATRIX hessian_vector_product(MATRIX& dir, int st, double dq);
+  void compute_d2ham(double dq);
+  MATRIX compute_hessian(int st, double dq);
+
 
 
 
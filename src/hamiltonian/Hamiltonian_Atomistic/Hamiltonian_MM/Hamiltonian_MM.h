@@ -148,6 +148,7 @@ class Hamiltonian_MM{
     vector< vector<triple> > images;  int is_images;
     vector<triple> central_translation; int is_central_translation;
     vector< vector<quartet> > at_neib;
+    VerletList vlist;  // persistent Verlet list (used by the vdw_LJ1_vlist functional)
     vector< vector<excl_scale> > excl_scales; 
     int time; // time since last recalculation of this pair
 
@@ -201,6 +202,7 @@ public:
   void deactivate(){ is_active = 0; }    ///< Makes this interaction inactive
   void set_pbc(MATRIX3x3*,int,int,int);
   int is_origin();
+  vector<int> get_atom_ids();
   void set_respa_type(int int_type_,int respa_type_){ 
     if(int_type_==int_type && respa_type>=0){ respa_type = respa_type_; is_respa_type = 1; }
   }
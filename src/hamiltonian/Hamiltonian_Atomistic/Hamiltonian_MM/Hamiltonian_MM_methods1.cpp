@@ -58,6 +58,35 @@ int Hamiltonian_MM::is_origin(){
   return ((kx==0) && (ky==0) && (kz==0));
 }
 
+vector<int> Hamiltonian_MM::get_atom_ids(){
+/**
+  Returns the IDs (Atom_id, not the indices in the System::Atoms list) of the atoms involved in this 
+  interaction (for the bonded - bond, angle, dihedral, oop - and the pairwise - vdw, elec, gay-berne - 
+  interactions). For other types the list is empty.
+  This is used, for instance, to set up the sparsity pattern of the second derivatives
+*/
+
+  vector<int> res;
+
+  if(int_type==0 && data_bond!=NULL){ res.push_back(data_bond->id1); res.push_back(data_bond->id2); }
+  else if(int_type==1 && data_angle!=NULL){ 
+    res.push_back(data_angle->id1); res.push_back(data_angle->id2); res.push_back(data_angle->id3);
+  }
+  else if(int_type==2 && data_dihedral!=NULL){
+    res.push_back(data_dihedral->id1); res.push_back(data_dihedral->id2); 
+    res.push_back(data_dihedral->id3); res.push_back(data_dihedral->id4);
+  }
+  else if(int_type==3 && data_oop!=NULL){
+    res.push_back(data_oop->id1); res.push_back(data_oop->id2); 
+    res.push_back(data_oop->id3); res.push_back(data_oop->id4);
+  }
+  else if(int_type==4 && data_vdw!=NULL){ res.push_back(data_vdw->id1); res.push_back(data_vdw->id2); }
+  else if(int_type==5 && data_elec!=NULL){ res.push_back(data_elec->id1); res.push_back(data_elec->id2); }
+  else if(int_type==7 && data_gay_berne!=NULL){ res.push_back(data_gay_berne->id1); res.push_back(data_gay_berne->id2); }
+
+  return res;
+}
+
 void Hamiltonian_MM::set_interaction_type_and_functional(std::string t,std::string f){
 /**
   Self-explanatory
@@ -93,6 +122,7 @@ void Hamiltonian_MM::set_interaction_type_and_functional(std::string t,std::stri
               vdw_LJ
               vdw_LJ1
               LJ_Coulomb
+              vdw_LJ1_vlist
   cg          Gay-Berne
   mb_excl     vdw_LJ1
            
@@ -140,6 +170,7 @@ void Hamiltonian_MM::set_interaction_type_and_functional(std::string t,std::stri
     else if(f=="vdw_LJ"){ functional = 1; is_functional = 1; } 
     else if(f=="vdw_LJ1"){ functional = 2; is_functional = 1; }
     else if(f=="LJ_Coulomb"){ functional = 3; is_functional = 1; }
+    else if(f=="vdw_LJ1_vlist"){ functional = 4; is_functional = 1; }
     else{ std::cout<<"Warning: Many-body potential "<<f<<" is not implemented\n"; }
   }
   else if(t=="cg"){ int_type = 7; is_int_type = 1; 
@@ -212,6 +243,7 @@ void Hamiltonian_MM::set_2a_interaction(std::string t,std::string f,
                            R_on2                  Square of R_on
                            R_off2                 Square of R_off
                            is_cutoff              The flag wheter the cutoff is used (if not - the full range is applied)
+                           R_vlist                The radius of the Verlet list (R_off + skin), only for vdw_LJ1_vlist
 
 */
 
@@ -461,6 +493,7 @@ void Hamiltonian_MM::set_mb_interaction(std::string t,std::string p,int sz, int*
                            R_on2                  Square of R_on
                            R_off2                 Square of R_off
                            is_cutoff              The flag wheter the cutoff is used (if not - the full range is applied)
+                           R_vlist                The radius of the Verlet list (R_off + skin), only for vdw_LJ1_vlist
 
 */
 
@@ -498,6 +531,26 @@ void Hamiltonian_MM::set_mb_interaction(std::string t,std::string p,int sz, int*
   }
   data_mb->time = 0;
 
+  // The Verlet list needs an explicit cutoff - a default one would silently truncate the interactions.
+  // The skin is R_vlist - R_off, the default is 2 Bohr
+  if(int_type==6 && functional==4){
+
+    if(params.find("is_cutoff")==params.end() || params.find("R_off")==params.end() || 
+       params["is_cutoff"]==0.0 || params["R_off"]<=0.0){
+      cout<<"Error in set_mb_interaction: vdw_LJ1_vlist requires the cutoff (is_cutoff = 1 and R_off > 0)\n";
+      cout<<"Set R_vdw_on and R_vdw_off in the force field, or use vdw_LJ1 for the full-range interactions\nExiting...\n";
+      exit(0);
+    }
+
+    double skin = 2.0;
+    if(params.find("R_vlist")!=params.end()){ 
+      skin = params["R_vlist"] - data_mb->R_off;
+      if(skin<0.0){ cout<<"Error in set_mb_interaction: R_vlist must not be smaller than R_off\n"; exit(0); }
+    }
+    data_mb->vlist.init(data_mb->R_off, skin);
+
+  }
+
 }
 
 void Hamiltonian_MM::set_2f_interaction(std::string t,std::string f,
@@ -1302,6 +1355,17 @@ double Hamiltonian_MM::calculate(int call_type,int& update_displ2){
 
     }
 
+    else if(functional==4){
+
+      if(Box==NULL){
+        cout<<"Error!: vdw_LJ1_vlist potential can only be used for periodic systems!\n";
+        exit(0);
+      }
+      en = Vdw_LJ2_vlist(r,g,m,f,at_st,fr_st,ml_st,sz,epsilon,sigma,Box,is_cutoff,R_on,R_off,data_mb->vlist,data_mb->excl_scales);
+      is_update = 1;
+
+    }
+
     else if(functional==3){
 
       if(Box!=NULL){
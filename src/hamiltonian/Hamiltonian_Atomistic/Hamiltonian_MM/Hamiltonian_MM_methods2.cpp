@@ -419,7 +419,7 @@ void listHamiltonian_MM::set_atom_interactions_for_atoms
       scale12 = 0.0; scale13 = 0.0; scale14 = 1.0; // default values
       if(int_type=="mb"){
         if(ff.mb_functional=="Ewald_3D"){ scale12 = ff.elec_scale12; scale13 = ff.elec_scale13; scale14 = ff.elec_scale14; }
-        else if(ff.mb_functional=="vdw_LJ"||ff.mb_functional=="vdw_LJ1"){ scale12 = ff.vdw_scale12; scale13 = ff.vdw_scale13; scale14 = ff.vdw_scale14; }
+        else if(ff.mb_functional=="vdw_LJ"||ff.mb_functional=="vdw_LJ1"||ff.mb_functional=="vdw_LJ1_vlist"){ scale12 = ff.vdw_scale12; scale13 = ff.vdw_scale13; scale14 = ff.vdw_scale14; }
 
         else if(ff.mb_functional=="LJ_Coulomb"){ 
           //!!! For now assume only vdw-based scaling factors
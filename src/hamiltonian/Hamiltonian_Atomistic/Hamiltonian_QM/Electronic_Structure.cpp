@@ -17,11 +17,13 @@
 
 #include "Electronic_Structure.h"
 #include "../../../calculators/libcalculators.h"
+#include "../../../math_specialfunctions/libspecialfunctions.h"
 
 /// liblibra namespace
 namespace liblibra{
 
 using namespace libcalculators;
+using namespace libspecialfunctions;
 
 /// libhamiltonian namespace
 namespace libhamiltonian{
@@ -66,6 +68,11 @@ Electronic_Structure::Electronic_Structure(const Electronic_Structure& obj){
     bands_bet = obj.bands_bet;
     occ_alp = obj.occ_alp;    
     occ_bet = obj.occ_bet;    
+
+    P_alp_hist = obj.P_alp_hist;
+    P_bet_hist = obj.P_bet_hist;
+    P_alp_aux = obj.P_alp_aux;
+    P_bet_aux = obj.P_bet_aux;
 
 }
 
@@ -113,6 +120,11 @@ Electronic_Structure::Electronic_Structure(Electronic_Structure* obj){
     occ_alp = obj->occ_alp;    
     occ_bet = obj->occ_bet;    
 
+    P_alp_hist = obj->P_alp_hist;
+    P_bet_hist = obj->P_bet_hist;
+    P_alp_aux = obj->P_alp_aux;
+    P_bet_aux = obj->P_bet_aux;
+
 }
 
 
@@ -245,6 +257,137 @@ void Electronic_Structure::excite_bet(int I, int J){
 
 }
 
+
+int Electronic_Structure::predict_density(std::string method, int order){
+/**
+  \param[in] method The prediction scheme: "aspc" or "xlbomd"
+  \param[in] order The order of the scheme - see Control_Parameters::dm_extrap_order
+
+  Sets P_alp, P_bet and P to the density matrices predicted for the present geometry from the history
+  accumulated by update_density_history() at the previous geometries (MD steps).
+  Returns 1 if the prediction is made and 0 if there is no history yet.
+
+  "aspc" - the always stable predictor of Kolafa [J. Comput. Chem. 25, 335 (2004)]:
+  P(n+1) = sum_{j=1}^{k+2} B_j * P(n+1-j),  B_j = (-1)^(j+1) * j * C(2k+4, k+2-j) / C(2k+2, k+1)
+  While the history is shorter than k+2, the lower orders are used
+
+  "xlbomd" - the auxiliary density of the extended Lagrangian propagation (see update_density_history())
+*/
+
+  if(method=="aspc"){
+
+    int n = P_alp_hist.size();
+    if(n==0){ return 0; }
+
+    int k = min(order, n-2);
+
+    if(k<0){ *P_alp = P_alp_hist[n-1];  *P_bet = P_bet_hist[n-1]; }
+    else{
+      *P_alp = 0.0;  *P_bet = 0.0;
+      for(int j=1;j<=k+2;j++){
+        double B = ((j%2)?1.0:-1.0) * j * BINOM(k+2-j, 2*k+4) / BINOM(k+1, 2*k+2);
+        *P_alp += B * P_alp_hist[n-j];
+        *P_bet += B * P_bet_hist[n-j];
+      }
+    }
+
+  }
+  else if(method=="xlbomd"){
+
+    if(P_alp_aux.size()==0){ return 0; }
+
+    *P_alp = P_alp_aux.back();
+    *P_bet = P_bet_aux.back();
+
+  }
+  else{ return 0; }
+
+  *P = *P_alp + *P_bet;
+
+  return 1;
+
+}
+
+
+void Electronic_Structure::update_density_history(std::string method, int order){
+/**
+  \param[in] method The prediction scheme: "aspc" or "xlbomd"
+  \param[in] order The order of the scheme - see Control_Parameters::dm_extrap_order
+
+  Adds the present (converged) density matrices P_alp and P_bet to the history used by predict_density()
+
+  "aspc" - the last order+2 converged density matrices are kept
+
+  "xlbomd" - the auxiliary density is propagated with the time-reversible Verlet integration plus a weak
+  dissipation of order K [Niklasson et al. J. Chem. Phys. 130, 214109 (2009)]:
+  X(n+1) = 2 X(n) - X(n-1) + kappa * (D(n) - X(n)) + alpha * sum_{k=0}^{K} c_k X(n-k)
+  where D(n) is the converged density at the present geometry. The auxiliary density only follows the converged
+  one through the harmonic term, so the errors of the SCF convergence do not accumulate along the trajectory.
+  At the first call the history is filled with D(n)
+*/
+
+  int i, k;
+
+  if(method=="aspc"){
+
+    P_alp_hist.push_back(*P_alp);
+    P_bet_hist.push_back(*P_bet);
+
+    while(P_alp_hist.size()>order+2){
+      P_alp_hist.erase(P_alp_hist.begin());
+      P_bet_hist.erase(P_bet_hist.begin());
+    }
+
+  }
+  else if(method=="xlbomd"){
+
+    // kappa, alpha and c_k for K = 3...7
+    const double kappa[5] = { 1.69, 1.75, 1.82, 1.84, 1.86 };
+    const double alpha[5] = { 0.150, 0.057, 0.018, 0.0055, 0.0016 };
+    const double c[5][8] = { { -2.0,   3.0,   0.0,  -1.0,   0.0,   0.0,  0.0,  0.0 },
+                             { -3.0,   6.0,  -2.0,  -2.0,   1.0,   0.0,  0.0,  0.0 },
+                             { -6.0,  14.0,  -8.0,  -3.0,   4.0,  -1.0,  0.0,  0.0 },
+                             { -14.0, 36.0, -27.0,  -2.0,  12.0,  -6.0,  1.0,  0.0 },
+                             { -36.0, 99.0, -88.0,  11.0,  32.0, -25.0,  8.0, -1.0 } };
+
+    int K = order;
+    if(K<3 || K>7){
+      cout<<"Error in Electronic_Structure::update_density_history: the order of the xlbomd scheme must be in the range 3...7\n";
+      exit(0);
+    }
+
+    if(P_alp_aux.size()!=K+1){
+      P_alp_aux = vector<MATRIX>(K+1, *P_alp);
+      P_bet_aux = vector<MATRIX>(K+1, *P_bet);
+    }
+
+    MATRIX X_alp(2.0*P_alp_aux[K] - P_alp_aux[K-1] + kappa[K-3]*(*P_alp - P_alp_aux[K]));
+    MATRIX X_bet(2.0*P_bet_aux[K] - P_bet_aux[K-1] + kappa[K-3]*(*P_bet - P_bet_aux[K]));
+
+    for(k=0;k<=K;k++){
+      X_alp += alpha[K-3] * c[K-3][k] * P_alp_aux[K-k];
+      X_bet += alpha[K-3] * c[K-3][k] * P_bet_aux[K-k];
+    }
+
+    for(i=0;i<K;i++){  P_alp_aux[i] = P_alp_aux[i+1];  P_bet_aux[i] = P_bet_aux[i+1];  }
+    P_alp_aux[K] = X_alp;
+    P_bet_aux[K] = X_bet;
+
+  }
+
+}
+
+
+void Electronic_Structure::reset_density_history(){
+/**
+  Forgets the history of the density matrices used by predict_density() - e.g. when a new trajectory is started
+*/
+
+  P_alp_hist.clear();  P_bet_hist.clear();
+  P_alp_aux.clear();   P_bet_aux.clear();
+
+}
+
 
 
 
@@ -229,6 +229,16 @@ class Electronic_Structure{
   vector<double> Mull_orb_pop_gross;    ///< Gross Mulliken populations for all (molecular) orbitals
 
 
+  // History of the density matrices at the previous geometries (MD steps) - for the prediction of the guess density
+  vector<MATRIX> P_alp_hist;            ///< Converged density matrices, alpha-channel (the most recent one is the last)
+  vector<MATRIX> P_bet_hist;            ///< Converged density matrices, beta-channel (the most recent one is the last)
+  vector<MATRIX> P_alp_aux;             ///< Auxiliary density matrices of the extended Lagrangian propagation, alpha-channel
+  vector<MATRIX> P_bet_aux;             ///< Auxiliary density matrices of the extended Lagrangian propagation, beta-channel
+  int predict_density(std::string method, int order);
+  void update_density_history(std::string method, int order);
+  void reset_density_history();
+
+
 
   void excite_alp(int I,int J);
   void excite_bet(int I,int J);
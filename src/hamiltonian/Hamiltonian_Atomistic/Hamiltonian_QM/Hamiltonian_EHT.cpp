@@ -13,6 +13,9 @@
   \brief The file implements functions for extended Huckel theory (EHT) calculations
 */
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 #include "Hamiltonian_EHT.h"
 
 /// liblibra namespace
@@ -115,51 +118,7 @@ void Hamiltonian_core_eht
           double delta = 0.13;
 
 
-          std::string elt_i = basis_ao[i].element;
-          std::string elt_j = basis_ao[j].element;
-          std::string sh_i  = basis_ao[i].ao_shell;
-          std::string sh_j  = basis_ao[j].ao_shell;
-
-
-          float n_i = modprms.PT[elt_i].Nquant[sh_i];
-          float n_j = modprms.PT[elt_j].Nquant[sh_j];
-          int nz_i  = modprms.PT[elt_i].Nzeta[sh_i];
-          int nz_j  = modprms.PT[elt_j].Nzeta[sh_j];
-
-          double ri, rj;  // radii
-
-          // for atom i 
-          if(nz_i==1){  ri = (n_i/modprms.PT[elt_i].zetas[sh_i][0]); }
-          else if(nz_i==2){
-            double z1 = modprms.PT[elt_i].zetas[sh_i][0];
-            double z2 = modprms.PT[elt_i].zetas[sh_i][1];
-            double c1 = modprms.PT[elt_i].coeffs[sh_i][0];
-            double c2 = modprms.PT[elt_i].coeffs[sh_i][1];
-
-            ri = n_i/(c1*c1*z1 + c2*c2*z2 + 
-                       ( pow(2.0,2.0*n_i)*pow(z1*z2, n_i+0.5)/pow((z1+z2),2.0*n_i)
-                       ) 
-                     ); 
-
-          }
-
-          // for atom j
-          if(nz_j==1){  rj = (n_j/modprms.PT[elt_j].zetas[sh_j][0]); }
-          else if(nz_j==2){
-            double z1 = modprms.PT[elt_j].zetas[sh_j][0];
-            double z2 = modprms.PT[elt_j].zetas[sh_j][1];
-            double c1 = modprms.PT[elt_j].coeffs[sh_j][0];
-            double c2 = modprms.PT[elt_j].coeffs[sh_j][1];
-
-            rj = n_j/(c1*c1*z1 + c2*c2*z2 + 
-                       ( pow(2.0,2.0*n_j)*pow(z1*z2, n_j+0.5)/pow((z1+z2),2.0*n_j)
-                       ) 
-                     ); 
-
-          }
-
-                                             
-          double d0 = ri + rj;    
+          double d0 = modprms.orb_params[i].radius + modprms.orb_params[j].radius;  // the radii are precomputed in set_PT_mapping
 
           K_const = 1.0 + (0.75 + delt2 - 0.75*delt4)*exp(-delta*(rab - d0));
         
@@ -378,49 +337,7 @@ void Hamiltonian_core_deriv_eht
             double delta = 0.13;
 
 
-            std::string elt_i = basis_ao[i].element;
-            std::string elt_j = basis_ao[j].element;
-            std::string sh_i  = basis_ao[i].ao_shell;
-            std::string sh_j  = basis_ao[j].ao_shell;
-
-
-            float n_i = modprms.PT[elt_i].Nquant[sh_i];
-            float n_j = modprms.PT[elt_j].Nquant[sh_j];
-            int nz_i  = modprms.PT[elt_i].Nzeta[sh_i];
-            int nz_j  = modprms.PT[elt_j].Nzeta[sh_j];
-
-            double ri, rj;  // radii
-
-            // for atom i 
-            if(nz_i==1){  ri = (n_i/modprms.PT[elt_i].zetas[sh_i][0]); }
-            else if(nz_i==2){
-              double z1 = modprms.PT[elt_i].zetas[sh_i][0];
-              double z2 = modprms.PT[elt_i].zetas[sh_i][1];
-              double c1 = modprms.PT[elt_i].coeffs[sh_i][0];
-              double c2 = modprms.PT[elt_i].coeffs[sh_i][1];
-
-              ri = n_i/(c1*c1*z1 + c2*c2*z2 + 
-                         ( pow(2.0,2.0*n_i)*pow(z1*z2, n_i+0.5)/pow((z1+z2),2.0*n_i)
-                         ) 
-                       ); 
-
-            }
-
-            // for atom j
-            if(nz_j==1){  rj = (n_j/modprms.PT[elt_j].zetas[sh_j][0]); }
-            else if(nz_j==2){
-              double z1 = modprms.PT[elt_j].zetas[sh_j][0];
-              double z2 = modprms.PT[elt_j].zetas[sh_j][1];
-              double c1 = modprms.PT[elt_j].coeffs[sh_j][0];
-              double c2 = modprms.PT[elt_j].coeffs[sh_j][1];
-
-              rj = n_j/(c1*c1*z1 + c2*c2*z2 + 
-                         ( pow(2.0,2.0*n_j)*pow(z1*z2, n_j+0.5)/pow((z1+z2),2.0*n_j)
-                         ) 
-                       ); 
-            }
-
-            double d0 = ri + rj;    
+            double d0 = modprms.orb_params[i].radius + modprms.orb_params[j].radius;  // the radii are precomputed in set_PT_mapping
 
             K_const = 1.0 + (0.75 + delt2 - 0.75*delt4)*exp(-delta*(rab - d0));
         
@@ -514,6 +431,330 @@ void Hamiltonian_core_deriv_eht
 
 
 
+double eht_overlap_bound_1d(int n, double x, double p){
+/**
+  \param[in] n The total power of the polynomial prefactors along this direction: n = l_a + l_b
+  \param[in] x The projection of the distance between the two centers on this direction
+  \param[in] p The sum of the Gaussian exponents: p = a + b
+
+  Upper bound on the 1D integral |int { (t + x_a)^l_a * (t + x_b)^l_b * exp(-p*t^2) } dt|, where t is counted from the 
+  center of the Gaussian product, so that |x_a|, |x_b| <= |x|:
+
+  sum_k { C(n,k) * |x|^(n-k) * int { |t|^k * exp(-p*t^2) } dt } = sum_k { C(n,k) * |x|^(n-k) * Gamma((k+1)/2) / p^((k+1)/2) }
+*/
+
+  double res = 0.0;
+  for(int k=0;k<=n;k++){
+    res += BINOM(k,n) * pow(fabs(x), n-k) * tgamma(0.5*(k+1)) * pow(p, -0.5*(k+1));
+  }
+  return res;
+}
+
+
+double eht_overlap_bound(AO& ao_i, AO& ao_j, VECTOR& rab){
+/**
+  \param[in] ao_i The first AO
+  \param[in] ao_j The second AO
+  \param[in] rab The vector connecting the centers of the two AOs
+
+  Upper bound on the overlap of the unnormalized contractions |sum_kl { c_ik * c_jl * <g_ik|g_jl> }|: 
+
+  sum_kl { |c_ik * c_jl| * exp(-mu_kl * R^2) * B_x * B_y * B_z }, mu_kl = a_k * a_l / (a_k + a_l)
+
+  where B_x, B_y, B_z are the bounds on the polynomial moments along each direction (see eht_overlap_bound_1d). 
+  Unlike exp(-mu * R^2) alone, this accounts for the polynomial prefactors of the p, d, ... primitives. 
+  Multiply by the AO normalization factors to get the bound on the normalized overlap
+*/
+
+  double res = 0.0;
+  double r2 = rab.length2();
+
+  for(int k=0;k<ao_i.expansion_size;k++){
+    PrimitiveG& gk = ao_i.primitives[k];
+
+    for(int l=0;l<ao_j.expansion_size;l++){
+      PrimitiveG& gl = ao_j.primitives[l];
+
+      double p = gk.alpha + gl.alpha;
+      double mu = gk.alpha * gl.alpha / p;
+
+      res += fabs(ao_i.coefficients[k] * ao_j.coefficients[l]) * exp(-mu*r2)
+           * eht_overlap_bound_1d(gk.x_exp + gl.x_exp, rab.x, p)
+           * eht_overlap_bound_1d(gk.y_exp + gl.y_exp, rab.y, p)
+           * eht_overlap_bound_1d(gk.z_exp + gl.z_exp, rab.z, p);
+    }// for l
+  }// for k
+
+  return res;
+}
+
+
+
+void Hamiltonian_core_eht_fused
+( System& syst, vector<AO>& basis_ao, 
+  Control_Parameters& prms, Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX* Hao, MATRIX* Sao, MATRIX* P, MATRIX* W, double ovlp_thresh,
+  vector<VECTOR>& dEdR
+){
+/**
+  \param[in] syst The object defining molecular structure of the chemical system
+  \param[in] basis_ao The vector of AO objects - it constitutes the atomic basis of the system
+  \param[in] prms The parameters controlling the quantum mechanical calculations
+  \param[in] modprms The parameters of the atomistic Hamiltonian
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[out] Hao The pointer to the matrix object in which the core Hamiltonian will be stored
+  \param[out] Sao The pointer to the matrix object in which the AO overlap matrix will be stored
+  \param[in] P The pointer to the total (alpha + beta) density matrix. If NULL - only Hao and Sao are computed
+  \param[in] W The pointer to the total energy-weighted density matrix: W = sum_k { n_k * E_k * C_k * C_k^T }
+  \param[in] ovlp_thresh The pairs of atoms whose AO overlaps are all bounded by this threshold are skipped. If 0 - no screening
+  \param[out] dEdR The derivatives of the electronic energy E = Tr(P*Hao) w.r.t. the coordinates of all atoms (if P is not NULL)
+
+  Compute the core EHT Hamiltonian, the AO overlap matrix and the gradients of the electronic energy in one pass over the
+  pairs of atoms. The overlaps and their derivatives are computed only once per pair of AOs, and the derivatives are 
+  directly contracted with the density matrices:
+
+  dE/dR = sum_ij { P_ij * dH_ij/dR - W_ij * dS_ij/dR }
+
+  so no derivative matrices are formed. The pairs of atoms are distributed over the threads (if built with OpenMP). 
+  The atoms A and B are skipped if the upper bound on the overlaps of all their AOs (see eht_overlap_bound), including
+  the normalization and the polynomial prefactors, is below ovlp_thresh - the matrix elements for such pairs are set to
+  zero, so the skipped overlaps are never larger than ovlp_thresh in magnitude.
+
+  Only the charge-independent part of the EHT energy is differentiated: the gradients are exact for
+  prms.eht_sce_formula == 0 and prms.eht_electrostatics == 0
+
+  Options:
+  prms.eht_formula == 0 - unweighted 
+  prms.eht_formula == 1 - weighted
+  prms.eht_formula == 2 - Calzaferi
+  prms.eht_formula == 3 - for the developments
+*/
+
+  int i,a,b;
+
+  int Natoms = syst.Number_of_atoms;
+  int Norb = basis_ao.size(); // how many AOs are included in this fragment
+  if(Norb!=Hao->n_cols || Norb!=Sao->n_cols){  
+    cout<<"In Hamiltonian_core_eht_fused: Dimension of input/output matrix is not compatible whith the number of the fragment-localized orbitals\n";
+    exit(0);
+  }
+
+  int is_grad = (P!=NULL && W!=NULL);
+
+  *Hao = 0.0;
+  *Sao = 0.0;
+  dEdR = vector<VECTOR>(Natoms, VECTOR(0.0, 0.0, 0.0));
+
+  // Diagonal elements = set to IPs
+  for(i=0;i<Norb;i++){  Hao->M[i*Norb+i] = modprms.orb_params[i].IP;  }
+
+
+  //============ The pairs of atoms with non-negligible overlaps ================
+  vector<double> nrm;
+  if(ovlp_thresh>0.0){
+    nrm = vector<double>(Norb, 0.0);
+    for(i=0;i<Norb;i++){  nrm[i] = basis_ao[i].normalization_factor();  }
+  }
+
+  vector< pair<int,int> > at_pairs;
+  for(a=0;a<Natoms;a++){
+    for(b=a;b<Natoms;b++){
+      if(b!=a && ovlp_thresh>0.0){
+        VECTOR rab = syst.Atoms[a].Atom_RB.rb_cm - syst.Atoms[b].Atom_RB.rb_cm;
+
+        // |S_ij| <= N_i * N_j * bound_ij for all AOs i on A and j on B
+        int is_negligible = 1;
+        for(int I=0;I<atom_to_ao_map[a].size() && is_negligible;I++){
+          int ii = atom_to_ao_map[a][I];
+          for(int J=0;J<atom_to_ao_map[b].size() && is_negligible;J++){
+            int jj = atom_to_ao_map[b][J];
+            if(nrm[ii]*nrm[jj]*eht_overlap_bound(basis_ao[ii], basis_ao[jj], rab) >= ovlp_thresh){ is_negligible = 0; }
+          }
+        }
+        if(is_negligible){ continue; }
+      }
+      at_pairs.push_back(pair<int,int>(a,b));
+    }// for b
+  }// for a
+
+  int npairs = at_pairs.size();
+
+
+  //============ Matrix elements and gradients, block by block ================
+  int nthreads = 1;
+#if defined(_OPENMP)
+  nthreads = omp_get_max_threads();
+#endif
+  vector< vector<VECTOR> > th_dEdR(nthreads, vector<VECTOR>(Natoms, VECTOR(0.0, 0.0, 0.0)));
+
+#pragma omp parallel num_threads(nthreads)
+  {
+    int tid = 0;
+#if defined(_OPENMP)
+    tid = omp_get_thread_num();
+#endif
+    vector<VECTOR>& g = th_dEdR[tid];
+
+    // Working memory of the overlap integrals
+    int n_aux = 20;
+    vector<double*> auxd(10);
+    for(int k=0;k<10;k++){ auxd[k] = new double[n_aux]; }
+
+#pragma omp for schedule(dynamic)
+    for(int n=0;n<npairs;n++){
+
+      int A = at_pairs[n].first;
+      int B = at_pairs[n].second;
+
+      VECTOR rab_vec = syst.Atoms[A].Atom_RB.rb_cm - syst.Atoms[B].Atom_RB.rb_cm;
+      double rab = rab_vec.length();
+
+      for(int I=0;I<atom_to_ao_map[A].size();I++){
+        int ii = atom_to_ao_map[A][I];
+
+        for(int J=0;J<atom_to_ao_map[B].size();J++){
+          int jj = atom_to_ao_map[B][J];
+
+          // Work with i < j; on the same atom - only the upper triangle
+          int i = ii, j = jj;
+          if(i>j){ i = jj; j = ii; }
+          if(A==B && ii>jj){ continue; }
+
+          VECTOR dSda, dSdb;
+          double sao_ij = gaussian_overlap(&basis_ao[i], &basis_ao[j], 1, (A!=B && is_grad), dSda, dSdb, auxd, n_aux);
+
+          Sao->M[i*Norb+j] = sao_ij;
+          Sao->M[j*Norb+i] = sao_ij;
+
+          if(i==j){ continue; }
+
+          double hii = Hao->M[i*Norb+i];
+          double hjj = Hao->M[j*Norb+j];
+          double K_const = modprms.meht_k.get_K_value(0, i,j);
+          double beta_ij = 0.0;
+          double dbeta = 0.0;   // d(beta_ij)/d(r_ab)
+
+          if(prms.eht_formula==0){  // Unweighted formula
+            beta_ij = 0.5*K_const*(hii + hjj);
+          }
+          else if(prms.eht_formula==1){  // Weighted formula
+            double delt = (hii - hjj)/(hii + hjj);
+            double delt2 = delt*delt;
+            double delt4 = delt2*delt2;
+            beta_ij = 0.5*(K_const + delt2 + (1.0 - K_const)*delt4)*(hii + hjj);
+          }
+          else if(prms.eht_formula==2){  // Calzaferi formula
+            double delt = (hii - hjj)/(hii + hjj);
+            double delt2 = delt*delt;
+            double delt4 = delt2*delt2;
+            double delta = 0.13;
+            double d0 = modprms.orb_params[i].radius + modprms.orb_params[j].radius;  // the radii are precomputed in set_PT_mapping
+
+            K_const = 1.0 + (0.75 + delt2 - 0.75*delt4)*exp(-delta*(rab - d0));
+            beta_ij = 0.5*K_const*(hii + hjj);
+            dbeta = -delta*0.5*(hii + hjj)*(K_const - 1.0);
+          }
+          else if(prms.eht_formula==3){       
+           // Add your options here and next
+          }// ==3
+
+          Hao->M[i*Norb+j] = beta_ij*sao_ij;
+          Hao->M[j*Norb+i] = Hao->M[i*Norb+j];
+
+          // The orbitals on the same atom move together - no gradients
+          if(is_grad && A!=B){
+
+            // dSda is w.r.t. the center of AO i, dSdb - of AO j
+            int a_i = ao_to_atom_map[i];
+            int a_j = ao_to_atom_map[j];
+
+            // Both (i,j) and (j,i) elements
+            double p = 2.0*P->M[i*Norb+j];
+            double w = 2.0*W->M[i*Norb+j];
+
+            VECTOR dbeta_di; dbeta_di = 0.0;
+            if(rab>0.0){ dbeta_di = (dbeta/rab) * (syst.Atoms[a_i].Atom_RB.rb_cm - syst.Atoms[a_j].Atom_RB.rb_cm); }
+
+            g[a_i] += (p*beta_ij - w)*dSda + (p*sao_ij)*dbeta_di;
+            g[a_j] += (p*beta_ij - w)*dSdb - (p*sao_ij)*dbeta_di;
+
+          }
+
+        }// for J
+      }// for I
+
+    }// for n
+
+    for(int k=0;k<10;k++){ delete [] auxd[k]; }
+
+  }// omp parallel
+
+
+  for(int t=0;t<nthreads;t++){
+    for(a=0;a<Natoms;a++){  dEdR[a] += th_dEdR[t][a];  }
+  }
+
+}
+
+
+void Hamiltonian_core_eht_fused
+( System& syst, vector<AO>& basis_ao, 
+  Control_Parameters& prms, Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX& Hao, MATRIX& Sao, MATRIX& P, MATRIX& W, double ovlp_thresh,
+  vector<VECTOR>& dEdR
+){
+/**
+  \param[in] syst The object defining molecular structure of the chemical system
+  \param[in] basis_ao The vector of AO objects - it constitutes the atomic basis of the system
+  \param[in] prms The parameters controlling the quantum mechanical calculations
+  \param[in] modprms The parameters of the atomistic Hamiltonian
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[out] Hao The matrix object in which the core Hamiltonian will be stored
+  \param[out] Sao The matrix object in which the AO overlap matrix will be stored
+  \param[in] P The total (alpha + beta) density matrix
+  \param[in] W The total energy-weighted density matrix: W = sum_k { n_k * E_k * C_k * C_k^T }
+  \param[in] ovlp_thresh The pairs of atoms whose AO overlaps are all bounded by this threshold are skipped. If 0 - no screening
+  \param[out] dEdR The derivatives of the electronic energy E = Tr(P*Hao) w.r.t. the coordinates of all atoms
+
+  Compute the core EHT Hamiltonian, the AO overlap matrix and the gradients of the electronic energy in one pass 
+  - Python-friendly version
+*/
+
+  Hamiltonian_core_eht_fused(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, &Hao, &Sao, &P, &W, ovlp_thresh, dEdR);
+
+}
+
+
+void Hamiltonian_core_eht_fused
+( System& syst, vector<AO>& basis_ao, 
+  Control_Parameters& prms, Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX& Hao, MATRIX& Sao, double ovlp_thresh
+){
+/**
+  \param[in] syst The object defining molecular structure of the chemical system
+  \param[in] basis_ao The vector of AO objects - it constitutes the atomic basis of the system
+  \param[in] prms The parameters controlling the quantum mechanical calculations
+  \param[in] modprms The parameters of the atomistic Hamiltonian
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[out] Hao The matrix object in which the core Hamiltonian will be stored
+  \param[out] Sao The matrix object in which the AO overlap matrix will be stored
+  \param[in] ovlp_thresh The pairs of atoms whose AO overlaps are all bounded by this threshold are skipped. If 0 - no screening
+
+  Compute the core EHT Hamiltonian and the AO overlap matrix in one pass, no gradients
+*/
+
+  vector<VECTOR> dEdR;
+  Hamiltonian_core_eht_fused(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, &Hao, &Sao, NULL, NULL, ovlp_thresh, dEdR);
+
+}
+
+
 void Hamiltonian_Fock_eht(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
                           Control_Parameters& prms, Model_Parameters& modprms,
                           vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map
@@ -608,8 +849,8 @@ void Hamiltonian_Fock_eht(Electronic_Structure* el, System& syst, vector<AO>& ba
       double Ai = 0.0;  // typically a positive number
       double Q = syst.Atoms[a].Atom_mull_charge_gross; // charge of the atom, on which i-th AO is sitting
 
-      if(Q>0){ Ai = modprms.PT[basis_ao[a].element].J_param1[basis_ao[a].ao_shell]; }
-      else{    Ai = modprms.PT[basis_ao[a].element].J_param2[basis_ao[a].ao_shell]; }
+      if(Q>0){ Ai = modprms.orb_params[i].J_param1; }
+      else{    Ai = modprms.orb_params[i].J_param2; }
 
       el->Fao_alp->M[i*Norb+i] = el->Hao->M[i*Norb+i] - (Ai * Q);
 
@@ -654,51 +895,7 @@ void Hamiltonian_Fock_eht(Electronic_Structure* el, System& syst, vector<AO>& ba
             double delta = 0.13;
   
   
-            std::string elt_i = basis_ao[i].element;
-            std::string elt_j = basis_ao[j].element;
-            std::string sh_i  = basis_ao[i].ao_shell;
-            std::string sh_j  = basis_ao[j].ao_shell;
-  
-  
-            float n_i = modprms.PT[elt_i].Nquant[sh_i];
-            float n_j = modprms.PT[elt_j].Nquant[sh_j];
-            int nz_i  = modprms.PT[elt_i].Nzeta[sh_i];
-            int nz_j  = modprms.PT[elt_j].Nzeta[sh_j];
-  
-            double ri, rj;  // radii
-  
-            // for atom i 
-            if(nz_i==1){  ri = (n_i/modprms.PT[elt_i].zetas[sh_i][0]); }
-            else if(nz_i==2){
-              double z1 = modprms.PT[elt_i].zetas[sh_i][0];
-              double z2 = modprms.PT[elt_i].zetas[sh_i][1];
-              double c1 = modprms.PT[elt_i].coeffs[sh_i][0];
-              double c2 = modprms.PT[elt_i].coeffs[sh_i][1];
-  
-              ri = n_i/(c1*c1*z1 + c2*c2*z2 + 
-                         ( pow(2.0,2.0*n_i)*pow(z1*z2, n_i+0.5)/pow((z1+z2),2.0*n_i)
-                         ) 
-                       ); 
-  
-            }
-  
-            // for atom j
-            if(nz_j==1){  rj = (n_j/modprms.PT[elt_j].zetas[sh_j][0]); }
-            else if(nz_j==2){
-              double z1 = modprms.PT[elt_j].zetas[sh_j][0];
-              double z2 = modprms.PT[elt_j].zetas[sh_j][1];
-              double c1 = modprms.PT[elt_j].coeffs[sh_j][0];
-              double c2 = modprms.PT[elt_j].coeffs[sh_j][1];
-  
-              rj = n_j/(c1*c1*z1 + c2*c2*z2 + 
-                         ( pow(2.0,2.0*n_j)*pow(z1*z2, n_j+0.5)/pow((z1+z2),2.0*n_j)
-                         ) 
-                       ); 
-  
-            }
-  
-                                               
-            double d0 = ri + rj;    
+            double d0 = modprms.orb_params[i].radius + modprms.orb_params[j].radius;  // the radii are precomputed in set_PT_mapping
   
             K_const = 1.0 + (0.75 + delt2 - 0.75*delt4)*exp(-delta*(rab - d0));
           
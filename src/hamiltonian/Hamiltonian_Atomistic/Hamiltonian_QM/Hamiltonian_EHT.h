@@ -71,6 +71,34 @@ void Hamiltonian_core_deriv_eht
 
 
 
+double eht_overlap_bound_1d(int n, double x, double p);
+double eht_overlap_bound(AO& ao_i, AO& ao_j, VECTOR& rab);
+
+void Hamiltonian_core_eht_fused
+( System& syst, vector<AO>& basis_ao, 
+  Control_Parameters& prms, Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX* Hao, MATRIX* Sao, MATRIX* P, MATRIX* W, double ovlp_thresh,
+  vector<VECTOR>& dEdR
+);
+
+void Hamiltonian_core_eht_fused
+( System& syst, vector<AO>& basis_ao, 
+  Control_Parameters& prms, Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX& Hao, MATRIX& Sao, MATRIX& P, MATRIX& W, double ovlp_thresh,
+  vector<VECTOR>& dEdR
+);
+
+void Hamiltonian_core_eht_fused
+( System& syst, vector<AO>& basis_ao, 
+  Control_Parameters& prms, Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX& Hao, MATRIX& Sao, double ovlp_thresh
+);
+
+
+
 void Hamiltonian_Fock_eht
 ( Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
   Control_Parameters& prms, Model_Parameters& modprms,
@@ -641,6 +641,10 @@ void indo_core_parameters
     }// for b
   }// for a
 
+  /// Precompute the integral tables for the Fock matrix builds
+
+  indo_fock_cache(syst, basis_ao, modprms, atom_to_ao_map, ao_to_atom_map);
+
   /// Compute their derivatives and store on the disk
 
   //compute_all_indo_core_parameters_derivs(syst, basis_ao, modprms, atom_to_ao_map, ao_to_atom_map, sorb_indx, opt);
@@ -1160,6 +1164,71 @@ void get_integrals(int i,int j,vector<AO>& basis_ao, double eri_aa, double G1, d
 }
 
 
+void indo_fock_cache
+( System& syst, vector<AO>& basis_ao, Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map
+){
+/**
+  \param[in] syst The object defining molecular structure of the chemical system
+  \param[in] basis_ao The vector of AO objects - it constitutes the atomic basis of the system
+  \param[in,out] modprms The parameters of the atomistic Hamiltonian
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+
+  Precomputes the integral tables used by the INDO (or CNDO/2) Fock matrix builds: the AO index ranges of all atoms,
+  the one-center Coulomb (ii|kk) and exchange (ik|ik) integrals packed into an n_a x n_a block per atom, and the
+  effective core charges. The two-center terms are taken from modprms.eri, which must be computed before this function
+  is called. The tables are rebuilt in indo_core_parameters, so they always correspond to the current geometry.
+*/
+
+  int a,i1,k1,i,k;
+  int sz = syst.Number_of_atoms;
+
+  if(modprms.eri.size()!=sz*sz){  cout<<"Error in indo_fock_cache: size of auxiliary eri array is not right\n"; exit(0);}
+
+  modprms.indo_ao.clear();
+  modprms.indo_ii_kk.clear();
+  modprms.indo_ik_ik.clear();
+  modprms.indo_ao_start = vector<int>(sz+1, 0);
+  modprms.indo_blk_start = vector<int>(sz+1, 0);
+  modprms.indo_Zeff = vector<double>(sz, 0.0);
+
+  for(a=0;a<sz;a++){
+
+    modprms.indo_ao_start[a] = modprms.indo_ao.size();
+    modprms.indo_blk_start[a] = modprms.indo_ii_kk.size();
+    modprms.indo_Zeff[a] = modprms.PT[syst.Atoms[a].Atom_element].Zeff;
+
+    int na = atom_to_ao_map[a].size();
+    double eri_aa = modprms.eri[a*sz + a];
+
+    for(i1=0;i1<na;i1++){
+      i = atom_to_ao_map[a][i1];
+      modprms.indo_ao.push_back(i);
+
+      // As in the Fock matrix construction, the Slater-Condon parameters of the first orbital are used
+      double G1 = modprms.PT[basis_ao[i].element].G1[basis_ao[i].ao_shell];
+      double F2 = modprms.PT[basis_ao[i].element].F2[basis_ao[i].ao_shell];
+
+      for(k1=0;k1<na;k1++){
+        k = atom_to_ao_map[a][k1];
+
+        double ii_kk, ik_ik; ii_kk = ik_ik = 0.0;
+        get_integrals(i,k,basis_ao,eri_aa,G1,F2,ii_kk,ik_ik);
+
+        modprms.indo_ii_kk.push_back(ii_kk);
+        modprms.indo_ik_ik.push_back(ik_ik);
+      }// for k1
+    }// for i1
+
+  }// for a
+
+  modprms.indo_ao_start[sz] = modprms.indo_ao.size();
+  modprms.indo_blk_start[sz] = modprms.indo_ii_kk.size();
+
+}
+
+
 void Hamiltonian_Fock_indo(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
                            Control_Parameters& prms, Model_Parameters& modprms,
                            vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map
@@ -1174,16 +1243,25 @@ void Hamiltonian_Fock_indo(Electronic_Structure* el, System& syst, vector<AO>& b
   \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
   
   Compute the INDO (or CNDO/2) Fock Hamiltonian. Unrestricted formulation
+
+  The integrals are taken from the tables precomputed by indo_fock_cache (built here if they are missing),
+  so the Fock matrix is assembled by the sweeps over the atomic blocks of the density matrix, without the
+  parameter look-ups. The potential of the other atoms on the diagonal terms is computed once per atom.
 */
 
 
-  int i,j,k,n,I,J,K,a,b,A,B;
+  int i,j,k,i1,j1,k1,a,b;
 
   int Norb = basis_ao.size(); // how many AOs are included in this fragment
   if(Norb!=el->Hao->n_cols){  
     cout<<"In Hamiltonian_Fock_indo: Dimension of input/output matrix is not compatible whith the number of the fragment-localized orbitals\n";
     exit(0);
   }
+  int sz = syst.Number_of_atoms;
+
+  if(modprms.indo_ao_start.size()!=sz+1 || modprms.indo_ao.size()!=Norb){
+    indo_fock_cache(syst, basis_ao, modprms, atom_to_ao_map, ao_to_atom_map);
+  }
 
 
   // Formation of the Fock matrix: Core part
@@ -1198,129 +1276,94 @@ void Hamiltonian_Fock_indo(Electronic_Structure* el, System& syst, vector<AO>& b
   update_Mull_orb_pop(el->P, el->Sao, el->Mull_orb_pop_gross, el->Mull_orb_pop_net);
 
 
-  vector<double> Zeff(syst.Number_of_atoms, 0.0);
-  vector<double> Mull_charges_gross(syst.Number_of_atoms, 0.0);
-  vector<double> Mull_charges_net(syst.Number_of_atoms, 0.0);
-
-  for(a=0;a<syst.Number_of_atoms;a++){ Zeff[a] = modprms.PT[syst.Atoms[a].Atom_element].Zeff; } // e.g. 4 for STO-3G C
+  vector<double> Mull_charges_gross(sz, 0.0);
+  vector<double> Mull_charges_net(sz, 0.0);
 
-  update_Mull_charges(ao_to_atom_map, Zeff, el->Mull_orb_pop_gross, el->Mull_orb_pop_net, Mull_charges_gross, Mull_charges_net);
+  update_Mull_charges(ao_to_atom_map, modprms.indo_Zeff, el->Mull_orb_pop_gross, el->Mull_orb_pop_net, Mull_charges_gross, Mull_charges_net);
 
-  for(a=0;a<syst.Number_of_atoms;a++){ 
+  for(a=0;a<sz;a++){ 
     syst.Atoms[a].Atom_mull_charge_gross = Mull_charges_gross[a]; 
     syst.Atoms[a].Atom_mull_charge_net = Mull_charges_net[a]; 
   }
 
 
+  // In the restricted open-shell case both spin densities are replaced by the half of the total density
+  double* P = el->P->M;
+  double* Pa = el->P_alp->M;
+  double* Pb = el->P_bet->M;
+  double s = 1.0;
+  if(prms.use_rosh){  Pa = Pb = P;  s = 0.5; }
 
-    
-  // Formation of the Fock matrix: add Coulomb and Exchange parts    
-  for(i=0;i<Norb;i++){
-    a = ao_to_atom_map[i];
-
-    for(j=0;j<Norb;j++){
-      b = ao_to_atom_map[j];
-
-      if(i==j){  // Diagonal terms
+  double* Fa = el->Fao_alp->M;
+  double* Fb = el->Fao_bet->M;
 
-//        cout<<"Diagonal terms, i= "<<i<<endl;
-//        cout<<"el->Fao_alp->M[i*Norb+i] = "<<el->Fao_alp->M[i*Norb+i]<<endl;
 
-        for(int kk=0;kk<atom_to_ao_map[a].size();kk++){    // for all orbitals on atom a
-          k = atom_to_ao_map[a][kk];                       // global orbital index of AO kk on atom a
+  // Potential due to the cores and the electrons of all other atoms - the same for all diagonal terms of given atom
+  vector<double> V_at(sz, 0.0);
+  for(a=0;a<sz;a++){
+    for(b=0;b<sz;b++){
+      if(b!=a){  V_at[a] += (modprms.indo_Zeff[b] - Mull_charges_net[b])*modprms.eri[a*sz+b];  }
+    }
+  }
 
+    
+  // Formation of the Fock matrix: add Coulomb and Exchange parts    
+  for(a=0;a<sz;a++){
 
-          double ii_kk, ik_ik; ii_kk = ik_ik = 0.0;
-          double G1 = modprms.PT[basis_ao[i].element].G1[basis_ao[i].ao_shell];
-          double F2 = modprms.PT[basis_ao[i].element].F2[basis_ao[i].ao_shell];
-          double eri_aa = modprms.eri[a*syst.Number_of_atoms + a];
+    int na = modprms.indo_ao_start[a+1] - modprms.indo_ao_start[a];
+    int* ao_a = &modprms.indo_ao[modprms.indo_ao_start[a]];
+    double* ii_kk = &modprms.indo_ii_kk[modprms.indo_blk_start[a]];
+    double* ik_ik = &modprms.indo_ik_ik[modprms.indo_blk_start[a]];
 
-          get_integrals(i,k,basis_ao,eri_aa,G1,F2,ii_kk,ik_ik);
+    // One-center terms: diagonal and the off-diagonal terms for the orbitals on the same atom
+    for(i1=0;i1<na;i1++){
+      i = ao_a[i1];
 
-/*
-          cout<<"kk= "<<kk<<" k= "<<k
-              <<" basis_ao[i].ao_shell_type= "<<basis_ao[i].ao_shell_type
-              <<" basis_ao[k].ao_shell_type= "<<basis_ao[k].ao_shell_type
-              <<"basis_ao[i].exponents = ("<<basis_ao[i].x_exp<<","<<basis_ao[i].y_exp<<","<<basis_ao[i].z_exp
-              <<"basis_ao[k].exponents = ("<<basis_ao[k].x_exp<<","<<basis_ao[k].y_exp<<","<<basis_ao[k].z_exp
-              <<" el->P->M[k*Norb+k]= "<<el->P->M[k*Norb+k]
-              <<" el->P_alp->M[k*Norb+k]= "<<el->P_alp->M[k*Norb+k]
-              <<" ii_kk= "<<ii_kk<<" ik_ik= "<<ik_ik
-              <<endl;
-*/
+      double fa = V_at[a];
+      double fb = V_at[a];
 
-          if(prms.use_rosh){ // Restricted open-shell
-            el->Fao_alp->M[i*Norb+i] += (el->P->M[k*Norb+k]*ii_kk - 0.5*el->P->M[k*Norb+k]*ik_ik);
-            el->Fao_bet->M[i*Norb+i] += (el->P->M[k*Norb+k]*ii_kk - 0.5*el->P->M[k*Norb+k]*ik_ik);
+      for(k1=0;k1<na;k1++){
+        k = ao_a[k1];
 
-          }
-          else{ // unrestricted
-            el->Fao_alp->M[i*Norb+i] += (el->P->M[k*Norb+k]*ii_kk - el->P_alp->M[k*Norb+k]*ik_ik);
-            el->Fao_bet->M[i*Norb+i] += (el->P->M[k*Norb+k]*ii_kk - el->P_bet->M[k*Norb+k]*ik_ik);
+        double g = ii_kk[i1*na+k1];
+        double x = ik_ik[i1*na+k1];
 
-          }
+        fa += P[k*Norb+k]*g - s*Pa[k*Norb+k]*x;
+        fb += P[k*Norb+k]*g - s*Pb[k*Norb+k]*x;
 
-//          cout<<"at this point el->Fao_bet->M[i*Norb+i]= "<<el->Fao_bet->M[i*Norb+i]<<endl;
-  
-        }// for kk - all orbitals on atom A
-  
+        if(k1!=i1){
+          int n = i*Norb+k;
+          Fa[n] += (2.0*P[n] - s*Pa[n])*x - s*Pa[n]*g;
+          Fb[n] += (2.0*P[n] - s*Pb[n])*x - s*Pb[n]*g;
+        }
+      }// for k1
 
-        // Contributions from all other atoms to the diagonal terms
-        // don't worry that b determined above will be rewritten - this is ok
-        for(b=0;b<syst.Number_of_atoms;b++){
+      Fa[i*Norb+i] += fa;
+      Fb[i*Norb+i] += fb;
 
-          if(b!=a){
+    }// for i1
 
-            // Compute density matrix due to all orbitals on atom b 
-            el->Fao_alp->M[i*Norb+i] += (Zeff[b] - syst.Atoms[b].Atom_mull_charge_net)*modprms.eri[a*syst.Number_of_atoms+b]; 
-            el->Fao_bet->M[i*Norb+i] += (Zeff[b] - syst.Atoms[b].Atom_mull_charge_net)*modprms.eri[a*syst.Number_of_atoms+b]; 
-          }
-        }// for b
-  
-  
-      }// i==j
-      else{      // Off-diagonal terms
-  
-        if(a==b){ // different orbitals are on the same atom
-          double ij_ij,ii_jj; ij_ij = ii_jj = 0.0;
 
-          double G1 = modprms.PT[basis_ao[i].element].G1[basis_ao[i].ao_shell];
-          double F2 = modprms.PT[basis_ao[i].element].F2[basis_ao[i].ao_shell];
-          double eri_aa = modprms.eri[a*syst.Number_of_atoms+a];
-          get_integrals(i,j,basis_ao,eri_aa,G1,F2,ii_jj,ij_ij);
+    // Two-center terms: the orbitals on different atoms
+    for(b=0;b<sz;b++){
+      if(b==a){ continue; }
 
-          //cout<<"i= "<<i<<" j= "<<j<<" ii_jj= "<<ii_jj<<", ij_ij= "<<ij_ij<<endl;
+      int nb = modprms.indo_ao_start[b+1] - modprms.indo_ao_start[b];
+      int* ao_b = &modprms.indo_ao[modprms.indo_ao_start[b]];
+      double g = s*modprms.eri[a*sz+b];
 
-          if(prms.use_rosh){
-            el->Fao_alp->M[i*Norb+j] += ( (2.0*el->P->M[i*Norb+j] - 0.5*el->P->M[i*Norb+j])*ij_ij - 0.5*el->P->M[i*Norb+j]*ii_jj );
-            el->Fao_bet->M[i*Norb+j] += ( (2.0*el->P->M[i*Norb+j] - 0.5*el->P->M[i*Norb+j])*ij_ij - 0.5*el->P->M[i*Norb+j]*ii_jj );
-          }
-          else{  
-            el->Fao_alp->M[i*Norb+j] += ( (2.0*el->P->M[i*Norb+j] - el->P_alp->M[i*Norb+j])*ij_ij - el->P_alp->M[i*Norb+j]*ii_jj );
-            el->Fao_bet->M[i*Norb+j] += ( (2.0*el->P->M[i*Norb+j] - el->P_bet->M[i*Norb+j])*ij_ij - el->P_bet->M[i*Norb+j]*ii_jj );
-          }
-  
-        }// a==b - different orbitals are on the same atom
-  
-        else{ // different orbitals are on different atoms
+      for(i1=0;i1<na;i1++){
+        i = ao_a[i1];
+        for(j1=0;j1<nb;j1++){
+          int n = i*Norb + ao_b[j1];
+          Fa[n] -= Pa[n]*g;
+          Fb[n] -= Pb[n]*g;
+        }// for j1
+      }// for i1
 
-          if(prms.use_rosh){
-            el->Fao_alp->M[i*Norb+j] -= 0.5*el->P->M[i*Norb+j]*modprms.eri[a*syst.Number_of_atoms+b]; 
-            el->Fao_bet->M[i*Norb+j] -= 0.5*el->P->M[i*Norb+j]*modprms.eri[a*syst.Number_of_atoms+b]; 
-          }
-          else{
-            el->Fao_alp->M[i*Norb+j] -= el->P_alp->M[i*Norb+j]*modprms.eri[a*syst.Number_of_atoms+b]; 
-            el->Fao_bet->M[i*Norb+j] -= el->P_bet->M[i*Norb+j]*modprms.eri[a*syst.Number_of_atoms+b]; 
-          }
+    }// for b
 
-        }
-  
-  
-      }// i!=j
-  
-  
-    }// for j
-  }// for i
+  }// for a
 
 }
 
@@ -95,6 +95,14 @@ void indo_core_parameters
 
 
 
+void indo_fock_cache
+( System& syst, vector<AO>& basis_ao, Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map
+);
+
+
+
+
 void Hamiltonian_core_indo
 ( System& syst, vector<AO>& basis_ao, 
   Control_Parameters& prms, Model_Parameters& modprms,
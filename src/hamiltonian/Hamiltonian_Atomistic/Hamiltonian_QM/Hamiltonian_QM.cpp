@@ -613,6 +613,167 @@ VECTOR force
 
 
 
+void forces
+( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+  Control_Parameters& prms,Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX& Hao, MATRIX& Sao, int Norb, vector<VECTOR>& F){
+/**
+  \param[in] el The object containing all information about electronic structure of the system
+  \param[in] syst The object defining molecular structure of the chemical system
+  \param[in] basis_ao The vector of AO objects - it constitutes the atomic basis of the system
+  \param[in] prms The parameters controlling the ab initio calculations
+  \param[in] modprms The parameters of the atomistic Hamiltonian
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[in] Hao The core Hamiltonian matrix 
+  \param[in] Sao The AO overlap matrix
+  \param[in] Norb The number of orbitals in the system
+  \param[out] F The electronic contributions to the forces acting on all atoms of the system
+
+  The version without the screening of the EHT overlaps
+*/
+
+  forces(el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, Hao, Sao, Norb, F, 0.0);
+
+}
+
+
+void forces
+( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+  Control_Parameters& prms,Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX& Hao, MATRIX& Sao, int Norb, vector<VECTOR>& F, double ovlp_thresh){
+/**
+  \param[in] el The object containing all information about electronic structure of the system
+  \param[in] syst The object defining molecular structure of the chemical system
+  \param[in] basis_ao The vector of AO objects - it constitutes the atomic basis of the system
+  \param[in] prms The parameters controlling the ab initio calculations
+  \param[in] modprms The parameters of the atomistic Hamiltonian
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[in] Hao The core Hamiltonian matrix 
+  \param[in] Sao The AO overlap matrix
+  \param[in] Norb The number of orbitals in the system
+  \param[out] F The electronic contributions to the forces acting on all atoms of the system
+  \param[in] ovlp_thresh The overlap threshold for the screening of the pairs of atoms in EHT (see Hamiltonian_core_eht_fused)
+
+  Same as force(), but for all atoms at once: the derivative matrices are allocated only once and the traces
+  Tr(P * dF) are computed element-wise, without forming the matrix products.
+
+  For EHT, the overlaps, the core Hamiltonian and their derivatives are computed in one pass over the pairs of atoms and 
+  contracted with the density and the energy-weighted density matrices: F = -Tr(P * dH) + Tr(W * dS).
+  The charge corrections (prms.eht_sce_formula != 0) and the additional electrostatics (prms.eht_electrostatics != 0)
+  are not differentiated: with these options, a warning is printed and only the forces due to the charge-independent
+  part of the EHT energy are returned
+*/
+
+  int i,j,n;
+
+  MATRIX* dHao_dx; dHao_dx = new MATRIX(Norb, Norb);
+  MATRIX* dHao_dy; dHao_dy = new MATRIX(Norb, Norb);
+  MATRIX* dHao_dz; dHao_dz = new MATRIX(Norb, Norb);
+
+  MATRIX* dSao_dx; dSao_dx = new MATRIX(Norb, Norb);
+  MATRIX* dSao_dy; dSao_dy = new MATRIX(Norb, Norb);
+  MATRIX* dSao_dz; dSao_dz = new MATRIX(Norb, Norb);
+
+  MATRIX* dFao_alp_dx; dFao_alp_dx = new MATRIX(Norb, Norb);
+  MATRIX* dFao_alp_dy; dFao_alp_dy = new MATRIX(Norb, Norb);
+  MATRIX* dFao_alp_dz; dFao_alp_dz = new MATRIX(Norb, Norb);
+
+  MATRIX* dFao_bet_dx; dFao_bet_dx = new MATRIX(Norb, Norb);
+  MATRIX* dFao_bet_dy; dFao_bet_dy = new MATRIX(Norb, Norb);
+  MATRIX* dFao_bet_dz; dFao_bet_dz = new MATRIX(Norb, Norb);
+
+  int DF = 0;
+
+  F = vector<VECTOR>(syst.Number_of_atoms, VECTOR(0.0, 0.0, 0.0));
+
+  if(prms.hamiltonian=="eht"){
+
+    if(prms.eht_sce_formula!=0 || prms.eht_electrostatics!=0){
+      cout<<"Warning in forces: the EHT forces are exact only for eht_sce_formula = 0 and eht_electrostatics = 0\n";
+      cout<<"eht_sce_formula = "<<prms.eht_sce_formula<<" eht_electrostatics = "<<prms.eht_electrostatics<<"\n";
+      cout<<"Only the forces due to the charge-independent part of the energy are computed\n";
+    }
+
+    // Energy-weighted density matrix: W = sum_k { n_k * E_k * C_k * C_k^T }, for both spin channels
+    MATRIX* W; W = new MATRIX(Norb, Norb);
+    MATRIX* Htmp; Htmp = new MATRIX(Norb, Norb);
+    MATRIX* Stmp; Stmp = new MATRIX(Norb, Norb);
+
+    for(n=0;n<el.occ_alp.size();n++){
+      int k = el.occ_alp[n].first;
+      double nE = el.occ_alp[n].second * el.E_alp->M[k*Norb+k];
+      if(nE==0.0){ continue; }
+      for(i=0;i<Norb;i++){
+        double x = nE * el.C_alp->M[i*Norb+k];
+        for(j=0;j<Norb;j++){  W->M[i*Norb+j] += x * el.C_alp->M[j*Norb+k];  }
+      }
+    }
+    for(n=0;n<el.occ_bet.size();n++){
+      int k = el.occ_bet[n].first;
+      double nE = el.occ_bet[n].second * el.E_bet->M[k*Norb+k];
+      if(nE==0.0){ continue; }
+      for(i=0;i<Norb;i++){
+        double x = nE * el.C_bet->M[i*Norb+k];
+        for(j=0;j<Norb;j++){  W->M[i*Norb+j] += x * el.C_bet->M[j*Norb+k];  }
+      }
+    }
+
+    *el.P = *el.P_alp + *el.P_bet;
+
+    vector<VECTOR> dEdR;
+    Hamiltonian_core_eht_fused(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, Htmp, Stmp, el.P, W, ovlp_thresh, dEdR);
+
+    for(n=0;n<syst.Number_of_atoms;n++){  F[n] = -1.0 * dEdR[n];  }
+
+    delete W;  delete Htmp;  delete Stmp;
+
+  }// eht
+
+
+  for(n=0;n<syst.Number_of_atoms;n++){
+
+    if(prms.hamiltonian=="indo"){
+
+      Hamiltonian_core_deriv_indo(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, Hao, Sao, DF, n, *dHao_dx, *dHao_dy, *dHao_dz, *dSao_dx, *dSao_dy, *dSao_dz );
+      Hamiltonian_Fock_derivs_indo(el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, n, *dHao_dx, *dHao_dy, *dHao_dz, *dFao_alp_dx, *dFao_alp_dy, *dFao_alp_dz, *dFao_bet_dx, *dFao_bet_dy, *dFao_bet_dz);
+
+      // Tr(P * X) = sum_ij P_ij * X_ji
+      double fx, fy, fz; fx = fy = fz = 0.0;
+      for(i=0;i<Norb;i++){
+        for(j=0;j<Norb;j++){
+          double pa = el.P_alp->M[i*Norb+j];
+          double pb = el.P_bet->M[i*Norb+j];
+          int ji = j*Norb+i;
+
+          fx += pa * (dHao_dx->M[ji] + dFao_alp_dx->M[ji]) + pb * (dHao_dx->M[ji] + dFao_bet_dx->M[ji]);
+          fy += pa * (dHao_dy->M[ji] + dFao_alp_dy->M[ji]) + pb * (dHao_dy->M[ji] + dFao_bet_dy->M[ji]);
+          fz += pa * (dHao_dz->M[ji] + dFao_alp_dz->M[ji]) + pb * (dHao_dz->M[ji] + dFao_bet_dz->M[ji]);
+        }// for j
+      }// for i
+
+      F[n].x = -0.5 * fx;
+      F[n].y = -0.5 * fy;
+      F[n].z = -0.5 * fz;
+
+    }
+
+  }// for n
+
+
+  //================= Clean up - delete temporary memory blocks ==============
+  delete dHao_dx;  delete dHao_dy;  delete dHao_dz;
+  delete dSao_dx;  delete dSao_dy;  delete dSao_dz;
+  delete dFao_alp_dx;  delete dFao_alp_dy;  delete dFao_alp_dz;
+  delete dFao_bet_dx;  delete dFao_bet_dy;  delete dFao_bet_dz;
+
+}
+
+
+
 VECTOR force_extended
 ( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
   Control_Parameters& prms,Model_Parameters& modprms,
@@ -924,6 +1085,40 @@ double energy_and_forces
   \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
   \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
 
+  The version that starts from the core Hamiltonian guess and recomputes all the overlaps
+*/
+
+  vector< pair<int,int> > ovlp_pairs;
+
+  return energy_and_forces(el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, 0, ovlp_pairs, 0.0, 0.0);
+
+}
+
+
+double energy_and_forces
+( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+  Control_Parameters& prms,Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  int reuse_dm, vector< pair<int,int> >& ovlp_pairs, double ovlp_thresh, double ovlp_skin
+){
+/**
+  \param[in,out] el The object containing all information about electronic structure of the system
+  \param[in,out] syst The object defining molecular structure of the chemical system
+  \param[in,out] basis_ao The vector of AO objects - it constitutes the atomic basis of the system
+  \param[in] prms The parameters controlling the ab initio calculations
+  \param[in,out] modprms The parameters of the atomistic Hamiltonian
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[in] reuse_dm If 1 - the density matrices stored in el (e.g. from the previous geometry) are used as the SCF guess,
+  otherwise the guess is built from the core Hamiltonian. Both are overridden by the density predicted from the history
+  of the previous geometries, if prms.dm_extrap is not "none"
+  \param[in,out] ovlp_pairs The list of the AO pairs with non-negligible overlaps. If empty and ovlp_skin > 0, it is built here,
+  if not empty and ovlp_skin > 0 - only these overlaps are recomputed. The caller is responsible for clearing the list once
+  the atoms have moved by more than ovlp_skin/2 since it was built
+  \param[in] ovlp_thresh The threshold for the overlaps defining the pair list. For EHT without the pair list (ovlp_skin = 0) - 
+  the threshold for the screening of the pairs of atoms (see Hamiltonian_core_eht_fused)
+  \param[in] ovlp_skin The skin of the pair list [Bohr]. If 0 - all overlaps are recomputed
+
   Compute the energy and forces (corresponding to the electronic structure given by el object) acting on all atoms
   of the system. Returns the total electronic + nuclear energy. The forces are returned into the corresponding variables 
   of the syst object.
@@ -969,11 +1164,30 @@ double energy_and_forces
   /// Update the AO overlap matrix
 
   MATRIX* Sao; Sao = new MATRIX(el.Norb, el.Norb);
+  MATRIX* Hao; Hao = new MATRIX(el.Norb, el.Norb);
+  int is_core = 0;  // 1 - the core Hamiltonian is computed together with the overlaps
 
   int x_period = 0;    int y_period = 0;    int z_period = 0;
   VECTOR t1,t2,t3;
 
-  update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, *Sao);
+  // EHT: the overlaps and the core Hamiltonian are computed in one (screened) pass over the pairs of atoms
+  if(prms.hamiltonian=="eht" && ovlp_skin<=0.0){
+    Hamiltonian_core_eht_fused(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, *Hao, *Sao, ovlp_thresh);
+    is_core = 1;
+  }
+
+  // INDO uses the unit overlap matrix (see below), so there is nothing to compute
+  else if(prms.hamiltonian!="indo"){
+
+    if(ovlp_skin>0.0 && ovlp_pairs.size()>0){
+      update_overlap_matrix(basis_ao, *Sao, ovlp_pairs);
+    }
+    else{
+      update_overlap_matrix(x_period, y_period, z_period, t1, t2, t3, basis_ao, *Sao);
+      if(ovlp_skin>0.0){  overlap_pairs(basis_ao, *Sao, ovlp_thresh, ovlp_skin, ovlp_pairs);  }
+    }
+
+  }
 
 
   //=========== STEP 4: Parameters ================
@@ -998,17 +1212,32 @@ double energy_and_forces
   double etol = 0.0001;
   int pop_opt = prms.pop_opt; //  #  0 -  integer populations,  1 - Fermi distribution              
 
-  MATRIX* Hao; Hao = new MATRIX(el.Norb, el.Norb);
+  if(!is_core){
+    Hamiltonian_core(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, *Hao,  *Sao, debug);  
+  }
 
-  Hamiltonian_core(syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, *Hao,  *Sao, debug);  
+  // Compute guess density: predict it from the previous geometries (MD steps), or reuse the one
+  // of the previous geometry, or start from the core Hamiltonian
+  int is_predicted = 0;
+  if(prms.dm_extrap!="none"){  is_predicted = el.predict_density(prms.dm_extrap, prms.dm_extrap_order);  }
 
-  // Compute guess density
-  Fock_to_P(Hao, Sao, el.Nocc_alp, degen, kT, etol, pop_opt, el.E_alp, el.C_alp, el.P_alp, el.bands_alp, el.occ_alp); 
-  Fock_to_P(Hao, Sao, el.Nocc_bet, degen, kT, etol, pop_opt, el.E_bet, el.C_bet, el.P_bet, el.bands_bet, el.occ_bet);
+  if(!is_predicted && !reuse_dm){
+    Fock_to_P(Hao, Sao, el.Nocc_alp, degen, kT, etol, pop_opt, el.E_alp, el.C_alp, el.P_alp, el.bands_alp, el.occ_alp); 
+    Fock_to_P(Hao, Sao, el.Nocc_bet, degen, kT, etol, pop_opt, el.E_bet, el.C_bet, el.P_bet, el.bands_bet, el.occ_bet);
+  }
 
   *el.Hao = *Hao;
   *el.Sao = *Sao;
 
+  // The extrapolated density is not idempotent, so it is only used to build the Fock matrix,
+  // the guess density is then obtained from this Fock matrix
+  if(is_predicted){
+    Hamiltonian_Fock(el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map);
+    Fock_to_P(el.Fao_alp, el.Sao, el.Nocc_alp, degen, kT, etol, pop_opt, el.E_alp, el.C_alp, el.P_alp, el.bands_alp, el.occ_alp); 
+    Fock_to_P(el.Fao_bet, el.Sao, el.Nocc_bet, degen, kT, etol, pop_opt, el.E_bet, el.C_bet, el.P_bet, el.bands_bet, el.occ_bet);
+    *el.P = *el.P_alp + *el.P_bet;
+  }
+
 
   // Compute guess Fock matrix
   Hamiltonian_Fock(el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map);
@@ -1017,12 +1246,20 @@ double energy_and_forces
   //==============  STEP 6: SCF iterations =======================
   /// Perform SCF iterations to get molecular orbitals and electronic energy
 
-  double E = scf(el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, 0);
+  // The predicted guess is close to the converged density, so the robust (but slow) ODA iterations
+  // at the beginning of the DIIS-SCF are not needed
+  Control_Parameters prms_scf(prms);
+  if(is_predicted){  prms_scf.diis_start_iter = 0;  }
+
+  double E = scf(el, syst, basis_ao, prms_scf, modprms, atom_to_ao_map, ao_to_atom_map, 0);
 
   // Update Fock matrix at the converged density:
   Fock_to_P(el.Fao_alp, el.Sao, el.Nocc_alp, degen, kT, etol, pop_opt, el.E_alp, el.C_alp, el.P_alp, el.bands_alp, el.occ_alp); 
   Fock_to_P(el.Fao_bet, el.Sao, el.Nocc_bet, degen, kT, etol, pop_opt, el.E_bet, el.C_bet, el.P_bet, el.bands_bet, el.occ_bet);
 
+  // Store the converged density for the prediction at the next geometry
+  if(prms.dm_extrap!="none"){  el.update_density_history(prms.dm_extrap, prms.dm_extrap_order);  }
+
 
   /*  
   cout<<"Fao_alp = \n"; el.Fao_alp->show_matrix();
@@ -1037,16 +1274,10 @@ double energy_and_forces
   // - electronic contributions
   /// Compute electronic contributions to forces for all atoms
 
-  for(int n=0;n<syst.Number_of_atoms;n++){
+  vector<VECTOR> F_el;
+  forces(el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, *Hao, *Sao, el.Norb, F_el, ovlp_thresh);
 
-    syst.Atoms[n].Atom_RB.rb_force = 
- 
-    force(el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map, *Hao, *Sao,
-          el.Norb, n, x_period, y_period, z_period, t1, t2, t3);
-
-    //cout<<"Force "<<n<<" = "<<syst.Atoms[n].Atom_RB.rb_force<<endl;
-
-  }// for n
+  for(int n=0;n<syst.Number_of_atoms;n++){  syst.Atoms[n].Atom_RB.rb_force = F_el[n];  }
 
 
   // - nuclear-nuclear repulsion
@@ -1095,6 +1326,13 @@ listHamiltonian_QM::listHamiltonian_QM(const listHamiltonian_QM& ob){   ///< Cop
   //============ Excited states ================
   basis_ex = ob.basis_ex;  ///< Excitations for this sub-system -  may be the same as in prms, but may be different  
 
+  //============ Geometry updates ================
+  dm_reuse = ob.dm_reuse;
+  ovlp_thresh = ob.ovlp_thresh;
+  ovlp_skin = ob.ovlp_skin;
+  ovlp_pairs = ob.ovlp_pairs;
+  ovlp_R0 = ob.ovlp_R0;
+
 }
 
 void listHamiltonian_QM::operator=(const listHamiltonian_QM& ob){   ///< Copying one listHamiltonian_QM into the other one
@@ -1114,6 +1352,13 @@ void listHamiltonian_QM::operator=(const listHamiltonian_QM& ob){   ///< Copying
   //============ Excited states ================
   basis_ex = ob.basis_ex;  ///< Excitations for this sub-system -  may be the same as in prms, but may be different  
 
+  //============ Geometry updates ================
+  dm_reuse = ob.dm_reuse;
+  ovlp_thresh = ob.ovlp_thresh;
+  ovlp_skin = ob.ovlp_skin;
+  ovlp_pairs = ob.ovlp_pairs;
+  ovlp_R0 = ob.ovlp_R0;
+
 }
 
 
@@ -1142,6 +1387,10 @@ listHamiltonian_QM::listHamiltonian_QM(std::string ctrl_filename,System& syst){
 */
 
 
+  dm_reuse = 0;
+  ovlp_thresh = 0.0;
+  ovlp_skin = 0.0;
+
   init(ctrl_filename, syst);
   add_excitation(0,1,0,1);
 
@@ -1440,9 +1689,33 @@ double listHamiltonian_QM::energy_and_forces(System& syst){
   in the end of this calculation.
 
   Computes energy and forces (inclding excited state) for quantum part of the chemical system (given by syst)
+
+  If dm_reuse is 1, the SCF starts from the density matrix of the previous calculation. If ovlp_skin > 0, only the
+  overlaps of the AO pairs from the screened list are recomputed; the list is rebuilt once any atom has moved by
+  more than ovlp_skin/2 since the list was built
 */
 
-  return libhamiltonian_qm::energy_and_forces(*el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map );
+  if(ovlp_skin>0.0){
+
+    // Check whether the AO pair list is still valid
+    int is_valid = (ovlp_pairs.size()>0 && ovlp_R0.size()==syst.Number_of_atoms);
+    for(int n=0;n<syst.Number_of_atoms && is_valid;n++){
+      if((syst.Atoms[n].Atom_RB.rb_cm - ovlp_R0[n]).length() > 0.5*ovlp_skin){  is_valid = 0; }
+    }
+
+    if(!is_valid){
+      ovlp_pairs.clear();
+      ovlp_R0.clear();
+      for(int n=0;n<syst.Number_of_atoms;n++){  ovlp_R0.push_back(syst.Atoms[n].Atom_RB.rb_cm);  }
+    }
+
+  }
+
+  // The density matrix is only reused if it has been computed before
+  int reuse = (dm_reuse && el->P_alp->tr()!=0.0);
+
+  return libhamiltonian_qm::energy_and_forces(*el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map,
+                                              reuse, ovlp_pairs, ovlp_thresh, ovlp_skin);
 
 }
 
@@ -75,6 +75,13 @@ double energy_and_forces
   vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map
 );
 
+double energy_and_forces
+( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+  Control_Parameters& prms,Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  int reuse_dm, vector< pair<int,int> >& ovlp_pairs, double ovlp_thresh, double ovlp_skin
+);
+
 
 void derivative_couplings
 ( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
@@ -119,6 +126,20 @@ VECTOR force
   int x_period, int y_period, int z_period, VECTOR& t1, VECTOR& t2, VECTOR& t3
 );
 
+void forces
+( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+  Control_Parameters& prms,Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX& Hao, MATRIX& Sao, int Norb, vector<VECTOR>& F
+);
+
+void forces
+( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+  Control_Parameters& prms,Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+  MATRIX& Hao, MATRIX& Sao, int Norb, vector<VECTOR>& F, double ovlp_thresh
+);
+
 
 
 // Excitations.cpp
@@ -140,7 +161,7 @@ class listHamiltonian_QM{
 public:
 
     // Constructors
-    listHamiltonian_QM(){ add_excitation(0,1,0,1); }
+    listHamiltonian_QM(){ dm_reuse = 0; ovlp_thresh = 0.0; ovlp_skin = 0.0; add_excitation(0,1,0,1); }
     listHamiltonian_QM(std::string ctrl_filename,System& syst);
     listHamiltonian_QM(const listHamiltonian_QM&);   ///< Copy constructor;
     ~listHamiltonian_QM();
@@ -163,6 +184,13 @@ public:
     //============ Excited states ================
     vector<excitation> basis_ex;  ///< Excitations for this sub-system -  may be the same as in prms, but may be different
 
+    //============ Geometry updates ================
+    int dm_reuse;         ///< If 1 - energy_and_forces() starts the SCF from the density matrix of the previous geometry
+    double ovlp_thresh;   ///< The threshold for the AO overlaps that define the screened AO pair list; 0 - no screening (default)
+    double ovlp_skin;     ///< The skin of the AO pair list [Bohr]; 0 - all overlaps are recomputed at every geometry
+    vector< pair<int,int> > ovlp_pairs;  ///< The AO pairs with non-negligible overlaps
+    vector<VECTOR> ovlp_R0;              ///< The atomic positions at which the AO pair list was built
+
     
 
     // Methods
@@ -176,6 +204,7 @@ public:
     void compute_overlap(System& syst);
     void compute_core_Hamiltonian(System& syst);
     double energy_and_forces(System& syst);
+    double optimize_geometry(System& syst, int max_steps, double grad_tol, double max_step, int n_hist);
 
     void add_excitation(int f_o, int f_s, int t_o, int t_s);
 
@@ -0,0 +1,257 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Hamiltonian_QM_opt.cpp
+  \brief The file implements the geometry optimization of the QM sub-system: the limited-memory BFGS steps
+  accelerated by the direct inversion in the iterative subspace (GDIIS)
+
+*/
+
+#include "Hamiltonian_QM.h"
+#include "../../../solvers/libsolvers.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace libsolvers;
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_atomistic namespace
+namespace libhamiltonian_atomistic{
+
+/// libhamiltonian_qm namespace
+namespace libhamiltonian_qm{
+
+
+
+double dot_prod(vector<double>& a, vector<double>& b){
+/**
+  The scalar product of two vectors
+*/
+  double res = 0.0;
+  for(int i=0;i<a.size();i++){  res += a[i]*b[i];  }
+  return res;
+}
+
+
+double max_displacement(vector<double>& d){
+/**
+  The largest displacement of an atom, for the vector d of the 3*Nat Cartesian displacements
+*/
+  double res = 0.0;
+  for(int i=0;i<d.size()/3;i++){
+    double r = sqrt(d[3*i+0]*d[3*i+0] + d[3*i+1]*d[3*i+1] + d[3*i+2]*d[3*i+2]);
+    if(r>res){ res = r; }
+  }
+  return res;
+}
+
+
+void lbfgs_step(vector<double>& g, vector< vector<double> >& s, vector< vector<double> >& y, vector<double>& d){
+/**
+  \param[in] g The gradient at the present point
+  \param[in] s The history of the steps (the oldest one first)
+  \param[in] y The history of the corresponding gradient changes
+  \param[out] d The quasi-Newton step: d = -H * g
+
+  The L-BFGS two-loop recursion, with the initial inverse Hessian H0 = (s*y)/(y*y) of the last pair.
+  If the history is empty, the steepest descent step is returned
+*/
+
+  int i,k;
+  int n = g.size();
+  int m = s.size();
+  vector<double> alpha(m, 0.0);
+
+  d = g;
+
+  for(k=m-1;k>=0;k--){
+    alpha[k] = dot_prod(s[k], d) / dot_prod(y[k], s[k]);
+    for(i=0;i<n;i++){  d[i] -= alpha[k] * y[k][i];  }
+  }
+
+  if(m>0){
+    double gamma = dot_prod(s[m-1], y[m-1]) / dot_prod(y[m-1], y[m-1]);
+    for(i=0;i<n;i++){  d[i] *= gamma;  }
+  }
+
+  for(k=0;k<m;k++){
+    double beta = dot_prod(y[k], d) / dot_prod(y[k], s[k]);
+    for(i=0;i<n;i++){  d[i] += (alpha[k] - beta) * s[k][i];  }
+  }
+
+  for(i=0;i<n;i++){  d[i] = -d[i];  }
+
+}
+
+
+
+double listHamiltonian_QM::optimize_geometry(System& syst, int max_steps, double grad_tol, double max_step, int n_hist){
+/**
+  \param[in,out] syst The object containing structural information about system. On exit, it contains the optimized
+  geometry and the forces at this geometry
+  \param[in] max_steps The maximal number of the optimization steps
+  \param[in] grad_tol The convergence criterion: the largest component of the gradient [Ha/Bohr]
+  \param[in] max_step The largest displacement of an atom in one step [Bohr]
+  \param[in] n_hist The length of the L-BFGS and GDIIS histories
+
+  Optimizes the geometry of the QM sub-system by calling energy_and_forces() directly. The step is the L-BFGS step,
+  replaced by the GDIIS extrapolation of the predicted geometries whenever the latter is within the trust radius
+  and points downhill. If the energy goes up, the step is halved and the histories are reset. If the energy still
+  goes up after 5 halvings, the step is rejected: the previous geometry is restored and the optimization continues
+  from the steepest descent direction, or stops, if that was already the steepest descent step.
+  Starting from the second geometry, the SCF is started from the density matrix of the previous geometry.
+  The trial geometries do not form a trajectory, so the density history used by prms.dm_extrap is discarded
+  and the extrapolation is turned off during the optimization.
+
+  Returns the energy at the final geometry
+*/
+
+  int i, step, trial;
+  int ndof = 3*syst.Number_of_atoms;
+  int dm_reuse0 = dm_reuse;
+  std::string dm_extrap0 = prms.dm_extrap;
+
+  vector<double> x(ndof, 0.0);      // coordinates
+  vector<double> g(ndof, 0.0);      // gradient
+  vector<double> d(ndof, 0.0);      // step
+  vector<double> x_new(ndof, 0.0);
+  vector<double> g_new(ndof, 0.0);
+  vector< vector<double> > s, y;    // L-BFGS history
+
+  MATRIX X(ndof, 1);   MATRIX err(ndof, 1);   MATRIX X_ext(ndof, 1);
+  DIIS* gdiis; gdiis = new DIIS(n_hist, ndof, 1);
+
+
+  el->reset_density_history();
+  prms.dm_extrap = "none";
+
+  //=========== Initial point: cold SCF start ================
+  syst.extract_atomic_q(x);
+  double E = energy_and_forces(syst);
+  syst.extract_atomic_f(g);
+  for(i=0;i<ndof;i++){  g[i] = -g[i];  }
+
+  dm_reuse = 1;
+
+
+  for(step=0;step<max_steps;step++){
+
+    double g_max = 0.0;
+    for(i=0;i<ndof;i++){  g_max = max(g_max, fabs(g[i]));  }
+    if(g_max<grad_tol){ break; }
+
+    //=========== L-BFGS step, within the trust radius ================
+    lbfgs_step(g, s, y, d);
+
+    // Not a descent direction (e.g. the curvature information is spoiled) - restart from the steepest descent
+    if(dot_prod(d, g)>=0.0){
+      s.clear(); y.clear();
+      for(i=0;i<ndof;i++){  d[i] = -g[i];  }
+    }
+
+    double dmax = max_displacement(d);
+    if(dmax>max_step){  for(i=0;i<ndof;i++){  d[i] *= max_step/dmax;  }  }
+
+    //=========== GDIIS: extrapolate the predicted geometries x + d with the errors d ================
+    for(i=0;i<ndof;i++){  X.M[i] = x[i] + d[i];  err.M[i] = d[i];  }
+    gdiis->add_diis_matrices(X, err);
+
+    if(s.size()>0){
+      gdiis->extrapolate_matrix(X_ext);
+
+      vector<double> d_diis(ndof, 0.0);
+      for(i=0;i<ndof;i++){  d_diis[i] = X_ext.M[i] - x[i];  }
+
+      if(max_displacement(d_diis)<=max_step && dot_prod(d_diis, d)>0.0){  d = d_diis;  }
+    }
+
+    //=========== Take the step; halve it if the energy goes up ================
+    double E_new = E;
+    int is_reset = 0;
+    int is_accepted = 0;
+
+    for(trial=0;trial<=5;trial++){
+
+      for(i=0;i<ndof;i++){  x_new[i] = x[i] + d[i];  }
+      syst.set_atomic_q(x_new);
+      E_new = energy_and_forces(syst);
+
+      if(E_new<=E){ is_accepted = 1; break; }
+
+      for(i=0;i<ndof;i++){  d[i] *= 0.5;  }
+      is_reset = 1;
+
+    }// for trial
+
+    // Even the shortest step goes uphill - reject it and restart from the steepest descent at the old geometry
+    if(!is_accepted){
+
+      int is_sd = (s.size()==0);  // the rejected step was already the steepest descent one
+
+      s.clear(); y.clear();
+      delete gdiis;  gdiis = new DIIS(n_hist, ndof, 1);
+
+      syst.set_atomic_q(x);
+      E = energy_and_forces(syst);
+      syst.extract_atomic_f(g);
+      for(i=0;i<ndof;i++){  g[i] = -g[i];  }
+
+      if(is_sd){
+        cout<<"Warning in optimize_geometry: no downhill step along the steepest descent direction at step "<<step<<"\n";
+        cout<<"Stopping the optimization at the present geometry\n";
+        break;
+      }
+      continue;
+    }
+
+    syst.extract_atomic_f(g_new);
+    for(i=0;i<ndof;i++){  g_new[i] = -g_new[i];  }
+
+    if(is_reset){
+      s.clear(); y.clear();
+      delete gdiis;  gdiis = new DIIS(n_hist, ndof, 1);
+    }
+
+    //=========== Update the L-BFGS history ================
+    vector<double> s_k(ndof, 0.0);
+    vector<double> y_k(ndof, 0.0);
+    for(i=0;i<ndof;i++){  s_k[i] = x_new[i] - x[i];  y_k[i] = g_new[i] - g[i];  }
+
+    if(dot_prod(s_k, y_k)>1e-10){
+      s.push_back(s_k);  y.push_back(y_k);
+      if(s.size()>n_hist){  s.erase(s.begin());  y.erase(y.begin());  }
+    }
+
+    x = x_new;
+    g = g_new;
+    E = E_new;
+
+  }// for step
+
+
+  delete gdiis;
+  dm_reuse = dm_reuse0;
+  prms.dm_extrap = dm_extrap0;
+
+  return E;
+
+}
+
+
+
+}// namespace libhamiltonian_qm
+}// namespace libhamiltonian_atomistic
+}// namespace libhamiltonian
+}// liblibra
+
@@ -12,7 +12,7 @@
   \file SCF.cpp
   \brief The file implements the self-consistent field (SCF) algorithm for solving 
   stationary Schrodinger's equation - the particular selection of the method is controlled
-  by the input parameters. Options: SCF_none, SCF_oda, SCF_oda_disk
+  by the input parameters. Options: SCF_none, SCF_oda, SCF_oda_disk, SCF_diis_fock, SCF_diis_dm
     
 */
 
@@ -38,7 +38,7 @@ double scf(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
            vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM
 ){
 /**
-  This function implements the SCF with the choice of algorithms: SCF_none, SCF_oda, SCF_oda_disk
+  This function implements the SCF with the choice of algorithms: SCF_none, SCF_oda, SCF_oda_disk, SCF_diis_fock, SCF_diis_dm
   The choice is controlled by the parameter prms
 
   \param[in,out] el The pointer to the object containing all the electronic structure information (MO-LCAO coefficients, 
@@ -69,14 +69,12 @@ double scf(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
       res = scf_oda(el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map, BM);
     }
   }
-/*
   else if(prms.scf_algo=="diis_fock"){
-    res = scf_diis_fock(el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map);
+    res = scf_diis_fock(el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map, BM);
   }
   else if(prms.scf_algo=="diis_dm"){
-    res = scf_diis_dm(el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map);
+    res = scf_diis_dm(el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map, BM);
   }
-*/
   return res;
 
 }
@@ -87,7 +85,7 @@ double scf(Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
 ){
 /**
   Python-friendly version
-  This function implements the SCF with the choice of algorithms: SCF_none, SCF_oda, SCF_oda_disk
+  This function implements the SCF with the choice of algorithms: SCF_none, SCF_oda, SCF_oda_disk, SCF_diis_fock, SCF_diis_dm
   The choice is controlled by the parameter prms
 
   \param[in,out] el The object containing all the electronic structure information (MO-LCAO coefficients, 
@@ -108,6 +106,40 @@ double scf(Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
 }
 
 
+void Fock_to_P_scf(Control_Parameters& prms, int Norb, int Nocc, int degen, double Nel, std::string eigen_method, int pop_opt,
+                   MATRIX* Fao, MATRIX* Sao, MATRIX* C, MATRIX* E,
+                   vector< pair<int,double> >& bands, vector< pair<int,double> >& occ,
+                   MATRIX* P, vector<Timer>& bench_t){
+/**
+  Computes the density matrix from the Fock matrix within the SCF iterations, using the method selected
+  by prms.dm_method: "diag" - diagonalization (see the libcalculators Fock_to_P), "mcweeny", "trs4", "sp2" -
+  density matrix purification, "foe" - Fermi operator expansion (see Fock_to_P_purify). With the
+  diagonalization-free methods, C, E, bands and occ are not updated and pop_opt is ignored.
+
+  \param[in] prms The object that contains all the parameters controlling the simulation
+  \param[in] Norb The number of orbitals
+  \param[in] Nocc The number of occupied orbitals
+  \param[in] degen The degeneracy of each orbital (1 or 2)
+  \param[in] Nel The number of electrons
+  See the libcalculators Fock_to_P for the meaning of the rest of the parameters
+
+  Time of the purification/FOE goes into bench_t[3]
+*/
+
+  if(prms.dm_method=="diag"){
+    Fock_to_P(Norb, Nocc, degen, Nel, eigen_method, pop_opt, Fao, Sao, C, E, bands, occ, P, bench_t);
+  }
+  else{
+    bench_t[3].start();
+    Fock_to_P_purify(prms.dm_method, Fao, Sao, Nel/(double)degen, prms.dm_thresh, prms.dm_tol, prms.dm_max_iter,
+                     prms.foe_kT, prms.foe_order, P);
+    if(degen!=1){  *P *= (double)degen;  }
+    bench_t[3].stop();
+  }
+
+}
+
+
 
 }// namespace libhamiltonian_qm
 }// namespace libhamiltonian_atomistic
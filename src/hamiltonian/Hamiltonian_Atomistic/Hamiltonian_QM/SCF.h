@@ -20,6 +20,7 @@
 #define SCF_H
 
 #include "Hamiltonian_QM.h"
+#include "SCF_store.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -36,6 +37,11 @@ namespace libhamiltonian_qm{
 
 
 
+void Fock_to_P_scf(Control_Parameters& prms, int Norb, int Nocc, int degen, double Nel, std::string eigen_method, int pop_opt,
+                   MATRIX* Fao, MATRIX* Sao, MATRIX* C, MATRIX* E,
+                   vector< pair<int,double> >& bands, vector< pair<int,double> >& occ,
+                   MATRIX* P, vector<Timer>& bench_t);
+
 double scf(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
            Control_Parameters& prms,Model_Parameters& modprms,
            vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM);
@@ -66,14 +72,19 @@ double scf_none(Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
            vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM);
 
 
-/*
 double scf_diis_fock(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
            Control_Parameters& prms,Model_Parameters& modprms,
            vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM);
+double scf_diis_fock(Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+           Control_Parameters& prms,Model_Parameters& modprms,
+           vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM);
+
 double scf_diis_dm(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
            Control_Parameters& prms,Model_Parameters& modprms,
            vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM);
-*/
+double scf_diis_dm(Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+           Control_Parameters& prms,Model_Parameters& modprms,
+           vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM);
 
 
 }// namespace libhamiltonian_qm
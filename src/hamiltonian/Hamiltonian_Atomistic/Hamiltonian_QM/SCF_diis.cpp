@@ -0,0 +1,496 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file SCF_diis.cpp
+  \brief The file implements the self-consistent field (SCF) algorithm for solving
+  stationary Schrodinger's equation using the Pulay's direct inversion in the iterative
+  subspace (DIIS) extrapolation of either the Fock or the density matrices
+
+*/
+
+#include "SCF.h"
+#include "../../../solvers/libsolvers.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace libsolvers;
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_atomistic namespace
+namespace libhamiltonian_atomistic{
+
+/// libhamiltonian_qm namespace
+namespace libhamiltonian_qm{
+
+
+
+void diis_pack(MATRIX* X_alp, MATRIX* X_bet, MATRIX* X){
+/**
+  Assembles the block-diagonal matrix X = diag(X_alp, X_bet), so that both spin channels
+  are extrapolated with the same set of DIIS coefficients
+
+  \param[in] X_alp The alpha-spin matrix (Norb x Norb)
+  \param[in] X_bet The beta-spin matrix (Norb x Norb)
+  \param[out] X The block-diagonal matrix (2*Norb x 2*Norb) - must be allocated
+*/
+
+  int Norb = X_alp->n_rows;
+  int N = 2*Norb;
+
+  *X = 0.0;
+  for(int i=0;i<Norb;i++){
+    for(int j=0;j<Norb;j++){
+      X->M[i*N+j] = X_alp->M[i*Norb+j];
+      X->M[(Norb+i)*N+(Norb+j)] = X_bet->M[i*Norb+j];
+    }
+  }
+
+}
+
+void diis_unpack(MATRIX* X, MATRIX* X_alp, MATRIX* X_bet){
+/**
+  The inverse of diis_pack: extracts the diagonal blocks of X
+
+  \param[in] X The block-diagonal matrix (2*Norb x 2*Norb)
+  \param[out] X_alp The alpha-spin block (Norb x Norb) - must be allocated
+  \param[out] X_bet The beta-spin block (Norb x Norb) - must be allocated
+*/
+
+  int Norb = X_alp->n_rows;
+  int N = 2*Norb;
+
+  for(int i=0;i<Norb;i++){
+    for(int j=0;j<Norb;j++){
+      X_alp->M[i*Norb+j] = X->M[i*N+j];
+      X_bet->M[i*Norb+j] = X->M[(Norb+i)*N+(Norb+j)];
+    }
+  }
+
+}
+
+
+void commutator_error(MATRIX* F, MATRIX* P, MATRIX* S, MATRIX* temp, MATRIX* err){
+/**
+  Computes the DIIS error matrix: err = F*P*S - S*P*F, which vanishes at self-consistency
+
+  \param[in] F The Fock matrix
+  \param[in] P The density matrix
+  \param[in] S The AO overlap matrix
+  \param[out] temp The temporary matrix of the same size - must be allocated
+  \param[out] err The error matrix - must be allocated
+*/
+
+  *temp = *F * *P;
+  *err = *temp * *S;      // F*P*S
+  *temp = err->T();       // S*P*F, since all the matrices are symmetric
+  *err -= *temp;
+
+}
+
+
+void level_shift(MATRIX* F, MATRIX* P, MATRIX* S, double shift, MATRIX* temp, MATRIX* F_ls){
+/**
+  Applies the level shift to the Fock matrix: F_ls = F + shift * (S - S*P*S)
+  The occupied orbitals (of the spin-resolved density P) are unaffected, while the virtual ones
+  are raised by the amount "shift", which damps the occupied-virtual mixing
+
+  \param[in] F The Fock matrix
+  \param[in] P The density matrix of a given spin
+  \param[in] S The AO overlap matrix
+  \param[in] shift The magnitude of the level shift [a.u.]
+  \param[out] temp The temporary matrix of the same size - must be allocated
+  \param[out] F_ls The shifted Fock matrix - must be allocated
+*/
+
+  *temp = *S * *P * *S;
+  *F_ls = *F + shift * (*S - *temp);
+
+}
+
+
+double scf_diis(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
+           Control_Parameters& prms,Model_Parameters& modprms,
+           vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM, int extrapolate_dm){
+/**
+  The common driver for the DIIS-accelerated SCF. At every iteration, the Fock matrix F(P) of the current
+  density P is built and the commutator error e = FPS - SPF is computed. The pair of the extrapolated
+  quantity X and e is added to the DIIS history:
+
+  extrapolate_dm = 0:  X = F(P), the extrapolated Fock matrix is diagonalized to get the next density
+  extrapolate_dm = 1:  X = D(F(P)), the output density of the diagonalization, the extrapolated density is used as the next one
+
+  The first prms.diis_start_iter iterations are done with the ODA (optimal damping) steps, which are robust
+  far from convergence, the DIIS history is accumulated during these steps as well.
+  If prms.use_level_shift == 1, the Fock matrix is shifted by prms.shift_magnitude before the diagonalization.
+
+  See more details in:
+  [1] Pulay, P. Chem. Phys. Lett. 73, 393 (1980)
+  [2] Pulay, P. J. Comput. Chem. 3, 556 (1982)
+  [3] Kudin K.N.; Scuseria, G.E.; Cances, E. J. Chem. Phys. 116, 8255 (2002)
+
+  Returns the converged total electronic energy
+*/
+
+  int i;
+  double lamb_min;
+
+  std::string eigen_method="generalized";
+
+  //----------- Control parameters ---------
+  int iter = 0;
+  int Niter = prms.Niter;
+
+  int Norb = el->Norb;
+  int Nocc_alp = el->Nocc_alp;
+  int Nocc_bet = el->Nocc_bet;
+
+  double den_tol = prms.den_tol;
+  double den_err = 2.0*den_tol;
+  double comm_err = 2.0*den_tol;
+
+  double ene_tol = prms.etol;
+  double Eelec_prev = 0.0;
+  double Eelec = 0.0;
+  double dE = 2.0*ene_tol;
+
+  vector<Timer> bench_t(10); // timers for different type of operations
+  vector<Timer> bench_t2(4);
+
+
+  if(BM){ bench_t[5].start(); }
+  MATRIX* temp;         temp        = new MATRIX(Norb,Norb);
+  MATRIX* P_old_alp;    P_old_alp   = new MATRIX(Norb,Norb);
+  MATRIX* P_old_bet;    P_old_bet   = new MATRIX(Norb,Norb);
+  MATRIX* P_alp;        P_alp       = new MATRIX(Norb,Norb);  // D(F), the output density
+  MATRIX* P_bet;        P_bet       = new MATRIX(Norb,Norb);
+  MATRIX* Fao_alp;      Fao_alp     = new MATRIX(Norb,Norb);  // the Fock matrix to diagonalize
+  MATRIX* Fao_bet;      Fao_bet     = new MATRIX(Norb,Norb);
+  MATRIX* err_alp;      err_alp     = new MATRIX(Norb,Norb);
+  MATRIX* err_bet;      err_bet     = new MATRIX(Norb,Norb);
+
+  MATRIX* X;            X           = new MATRIX(2*Norb,2*Norb);  // spin-blocked matrices for DIIS
+  MATRIX* X_err;        X_err       = new MATRIX(2*Norb,2*Norb);
+  MATRIX* X_ext;        X_ext       = new MATRIX(2*Norb,2*Norb);
+
+  DIIS diis(prms.diis_max, 2*Norb);
+
+  Electronic_Structure* el_tmp;   el_tmp = new Electronic_Structure(el);  // for the ODA line search
+  if(BM){ bench_t[5].stop(); }
+
+
+  // Initialization: F_0 = F(D_0), E_0, e_0
+  if(BM){ bench_t[1].start(); }
+  Hamiltonian_Fock(el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map);
+  if(BM){ bench_t[1].stop(); }
+
+  if(BM){ bench_t[0].start(); }
+  Eelec_prev = energy_elec(el->P_alp,el->P_bet, el->Hao, el->Hao, el->Fao_alp, el->Fao_bet,
+               el->dFao_alp_dP_alp,el->dFao_alp_dP_bet,el->dFao_bet_dP_alp,el->dFao_bet_dP_bet,
+               temp);
+  if(BM){ bench_t[0].stop(); }
+
+  if(BM){ bench_t[6].start(); }
+  commutator_error(el->Fao_alp, el->P_alp, el->Sao, temp, err_alp);
+  commutator_error(el->Fao_bet, el->P_bet, el->Sao, temp, err_bet);
+  comm_err = max(err_alp->max_elt(), err_bet->max_elt());
+  if(BM){ bench_t[6].stop(); }
+
+
+  //=========================== Now enter main SCF cycle ===========================================
+  cout<<"----------------------- Entering main DIIS-SCF cycle --------------------\n";
+
+  do{
+
+    int use_oda = (iter < prms.diis_start_iter);
+
+    *P_old_alp = *el->P_alp;
+    *P_old_bet = *el->P_bet;
+
+
+    //---------- Fock matrix to be diagonalized: F(P) or its DIIS extrapolation -------------------
+    if(BM){ bench_t[6].start(); }
+    if(!extrapolate_dm){
+      diis_pack(el->Fao_alp, el->Fao_bet, X);
+      diis_pack(err_alp, err_bet, X_err);
+      diis.add_diis_matrices(X, X_err);
+    }
+
+    if(!extrapolate_dm && !use_oda){
+      diis.extrapolate_matrix(X_ext);
+      diis_unpack(X_ext, Fao_alp, Fao_bet);
+    }
+    else{
+      *Fao_alp = *el->Fao_alp;
+      *Fao_bet = *el->Fao_bet;
+    }
+
+    if(prms.use_level_shift){
+      level_shift(Fao_alp, el->P_alp, el->Sao, prms.shift_magnitude, temp, Fao_alp);
+      level_shift(Fao_bet, el->P_bet, el->Sao, prms.shift_magnitude, temp, Fao_bet);
+    }
+    if(BM){ bench_t[6].stop(); }
+
+
+    //---------- Diagonalization: D = D(F) ------------------------
+    if(BM){ bench_t[2].start(); }
+    Fock_to_P_scf(prms, Norb, Nocc_alp, 1, Nocc_alp, eigen_method, prms.pop_opt, Fao_alp, el->Sao, el->C_alp, el->E_alp, el->bands_alp, el->occ_alp, P_alp, bench_t2);
+    Fock_to_P_scf(prms, Norb, Nocc_bet, 1, Nocc_bet, eigen_method, prms.pop_opt, Fao_bet, el->Sao, el->C_bet, el->E_bet, el->bands_bet, el->occ_bet, P_bet, bench_t2);
+    if(BM){ bench_t[2].stop(); }
+
+
+    //---------- The next density matrix --------------------------
+    if(extrapolate_dm){
+      if(BM){ bench_t[6].start(); }
+      diis_pack(P_alp, P_bet, X);
+      diis_pack(err_alp, err_bet, X_err);
+      diis.add_diis_matrices(X, X_err);
+      if(BM){ bench_t[6].stop(); }
+    }
+
+    if(use_oda){
+      // Line search on the segment P(lamb) = (1-lamb)*P_old + lamb*D, the energy is interpolated
+      // by a parabola through lamb = 0, 1/2 and 1 - the same as in scf_oda
+      double en[3];
+      double lamb[3] = {0.0, 0.5, 1.0};
+      en[0] = Eelec_prev;
+
+      for(i=1;i<3;i++){
+        *el_tmp->P_alp = (1.0 - lamb[i]) * (*P_old_alp) + lamb[i] * (*P_alp);
+        *el_tmp->P_bet = (1.0 - lamb[i]) * (*P_old_bet) + lamb[i] * (*P_bet);
+        *el_tmp->P     = *el_tmp->P_alp + *el_tmp->P_bet;
+
+        if(BM){ bench_t[1].start(); }
+        Hamiltonian_Fock(el_tmp, syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map);
+        if(BM){ bench_t[1].stop(); }
+
+        if(BM){ bench_t[0].start(); }
+        en[i] = energy_elec(el_tmp->P_alp,el_tmp->P_bet, el_tmp->Hao, el_tmp->Hao, el_tmp->Fao_alp, el_tmp->Fao_bet,
+                el_tmp->dFao_alp_dP_alp,el_tmp->dFao_alp_dP_bet,el_tmp->dFao_bet_dP_alp,el_tmp->dFao_bet_dP_bet,
+                temp);
+        if(BM){ bench_t[0].stop(); }
+      }
+
+      double _c = en[0];
+      double _b = 4.0*en[1] - en[2] - 3.0*en[0];
+      double _a = en[2] - en[0] - _b;
+
+      lamb_min = 0.0;
+      if(fabs(_a)>1e-10){ lamb_min = -_b/(2.0*_a); }
+      if(!(0<lamb_min && lamb_min<1)){  lamb_min = (en[0]<en[2])?0.0:1.0;  }
+
+      cout<<"ODA step: lamb_min = "<<lamb_min<<endl;
+
+      *el->P_alp = (1.0 - lamb_min) * (*P_old_alp) + lamb_min * (*P_alp);
+      *el->P_bet = (1.0 - lamb_min) * (*P_old_bet) + lamb_min * (*P_bet);
+    }
+    else if(extrapolate_dm){
+      if(BM){ bench_t[6].start(); }
+      diis.extrapolate_matrix(X_ext);
+      diis_unpack(X_ext, el->P_alp, el->P_bet);
+      if(BM){ bench_t[6].stop(); }
+    }
+    else{
+      *el->P_alp = *P_alp;
+      *el->P_bet = *P_bet;
+    }
+    *el->P = *el->P_alp + *el->P_bet;
+
+    den_err = fabs((*el->P_alp - *P_old_alp).max_elt()) + fabs((*el->P_bet - *P_old_bet).max_elt());
+
+
+    //---------- F(P), energy and the commutator error of the new density -------------
+    if(BM){ bench_t[1].start(); }
+    Hamiltonian_Fock(el, syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map);
+    if(BM){ bench_t[1].stop(); }
+
+    if(BM){ bench_t[0].start(); }
+    Eelec = energy_elec(el->P_alp,el->P_bet, el->Hao, el->Hao, el->Fao_alp, el->Fao_bet,
+            el->dFao_alp_dP_alp,el->dFao_alp_dP_bet,el->dFao_bet_dP_alp,el->dFao_bet_dP_bet,
+            temp);
+    if(BM){ bench_t[0].stop(); }
+
+    if(BM){ bench_t[6].start(); }
+    commutator_error(el->Fao_alp, el->P_alp, el->Sao, temp, err_alp);
+    commutator_error(el->Fao_bet, el->P_bet, el->Sao, temp, err_bet);
+    comm_err = max(err_alp->max_elt(), err_bet->max_elt());
+    if(BM){ bench_t[6].stop(); }
+
+    dE = Eelec - Eelec_prev;
+    Eelec_prev = Eelec;
+
+    cout<<"Iteration "<<iter<<(use_oda?" (ODA)":" (DIIS)")<<" e_err = "<<fabs(dE)<<" d_err = "<<den_err
+        <<" comm_err = "<<comm_err<<" E_el = "<<Eelec<<endl;
+
+    iter++;
+
+  }while(iter<Niter && (den_err>den_tol || fabs(dE)>ene_tol || comm_err>den_tol) );
+
+
+  if(den_err>den_tol || fabs(dE)>ene_tol || comm_err>den_tol){
+    cout<<"Convergence is not achieved in "<<Niter<<" iterations\n";
+  }
+  else{
+    cout<<"Success: Convergence is achieved\n";
+    cout<<"Electronic energy = "<<Eelec<<endl;
+  }
+
+
+  if(prms.do_annihilate==1){
+    annihilate(Nocc_alp,Nocc_bet,el->P_alp,el->P_bet);
+    *el->P = *el->P_alp + *el->P_bet;
+
+    if(BM){ bench_t[1].start(); }
+    Hamiltonian_Fock(el, syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map);
+    if(BM){ bench_t[1].stop(); }
+  }
+
+  // Update eigenvalues and eigenvectors of the final (unshifted) Fock matrix, but do not modify the density matrix:
+  if(BM){ bench_t[2].start(); }
+  Fock_to_P(Norb, Nocc_alp, 1, Nocc_alp, eigen_method, prms.pop_opt, el->Fao_alp, el->Sao, el->C_alp, el->E_alp, el->bands_alp, el->occ_alp, P_alp, bench_t2);
+  Fock_to_P(Norb, Nocc_bet, 1, Nocc_bet, eigen_method, prms.pop_opt, el->Fao_bet, el->Sao, el->C_bet, el->E_bet, el->bands_bet, el->occ_bet, P_bet, bench_t2);
+  if(BM){ bench_t[2].stop(); }
+
+  if(BM){ bench_t[0].start(); }
+  Eelec = energy_elec(el->P_alp,el->P_bet, el->Hao, el->Hao, el->Fao_alp, el->Fao_bet,
+          el->dFao_alp_dP_alp,el->dFao_alp_dP_bet,el->dFao_bet_dP_alp,el->dFao_bet_dP_bet,
+          temp);
+  if(BM){ bench_t[0].stop(); }
+
+
+  // Clean up the memory
+  if(BM){ bench_t[5].start(); }
+  delete temp;
+  delete P_old_alp;  delete P_old_bet;
+  delete P_alp;      delete P_bet;
+  delete Fao_alp;    delete Fao_bet;
+  delete err_alp;    delete err_bet;
+  delete X;          delete X_err;       delete X_ext;
+  delete el_tmp;
+  if(BM){ bench_t[5].stop(); }
+
+
+  if(BM){
+    cout<<"Time to compute energies = "<<bench_t[0].show()<<endl;
+    cout<<"Time to build Fock matrices = "<<bench_t[1].show()<<endl;
+    cout<<"Time to diagonalize Fock matrices = "<<bench_t[2].show()<<endl;
+    cout<<"Time to allocate/free memory = "<<bench_t[5].show()<<endl;
+    cout<<"Time for DIIS operations = "<<bench_t[6].show()<<endl;
+  }
+
+  return Eelec;
+
+}
+
+
+
+double scf_diis_fock(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
+           Control_Parameters& prms,Model_Parameters& modprms,
+           vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM){
+/**
+  This function implements the SCF with the DIIS extrapolation of the Fock matrices
+
+  \param[in,out] el The pointer to the object containing all the electronic structure information (MO-LCAO coefficients,
+  density matrix, Fock, etc)
+  \param[in,out] syst The reference to the object containing all the nuclear information - geometry and atomic types
+  \param[in] basis_ao The vector of AO objects - the AO basis for given calculations
+  \param[in] prms The object that contains all the parameters controlling the simulation - all settings, flags, etc.
+  \param[in,out] modprms The object that contains all the Hamiltonian parameters for given system and method choice
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[in] BM Benchmark flag - if =1 - do some benchmarking, if =0 - don't do it
+
+  Returns the converged total electronic energy
+*/
+
+  return scf_diis(el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map, BM, 0);
+}
+
+double scf_diis_fock(Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+           Control_Parameters& prms,Model_Parameters& modprms,
+           vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM){
+/**
+  Python-friendly version
+  This function implements the SCF with the DIIS extrapolation of the Fock matrices
+
+  \param[in,out] el The object containing all the electronic structure information (MO-LCAO coefficients,
+  density matrix, Fock, etc)
+  \param[in,out] syst The reference to the object containing all the nuclear information - geometry and atomic types
+  \param[in] basis_ao The vector of AO objects - the AO basis for given calculations
+  \param[in] prms The object that contains all the parameters controlling the simulation - all settings, flags, etc.
+  \param[in,out] modprms The object that contains all the Hamiltonian parameters for given system and method choice
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[in] BM Benchmark flag - if =1 - do some benchmarking, if =0 - don't do it
+
+  Returns the converged total electronic energy
+*/
+
+  return scf_diis(&el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map, BM, 0);
+}
+
+
+
+double scf_diis_dm(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
+           Control_Parameters& prms,Model_Parameters& modprms,
+           vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM){
+/**
+  This function implements the SCF with the DIIS extrapolation of the density matrices
+
+  \param[in,out] el The pointer to the object containing all the electronic structure information (MO-LCAO coefficients,
+  density matrix, Fock, etc)
+  \param[in,out] syst The reference to the object containing all the nuclear information - geometry and atomic types
+  \param[in] basis_ao The vector of AO objects - the AO basis for given calculations
+  \param[in] prms The object that contains all the parameters controlling the simulation - all settings, flags, etc.
+  \param[in,out] modprms The object that contains all the Hamiltonian parameters for given system and method choice
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[in] BM Benchmark flag - if =1 - do some benchmarking, if =0 - don't do it
+
+  Returns the converged total electronic energy
+*/
+
+  return scf_diis(el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map, BM, 1);
+}
+
+double scf_diis_dm(Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+           Control_Parameters& prms,Model_Parameters& modprms,
+           vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM){
+/**
+  Python-friendly version
+  This function implements the SCF with the DIIS extrapolation of the density matrices
+
+  \param[in,out] el The object containing all the electronic structure information (MO-LCAO coefficients,
+  density matrix, Fock, etc)
+  \param[in,out] syst The reference to the object containing all the nuclear information - geometry and atomic types
+  \param[in] basis_ao The vector of AO objects - the AO basis for given calculations
+  \param[in] prms The object that contains all the parameters controlling the simulation - all settings, flags, etc.
+  \param[in,out] modprms The object that contains all the Hamiltonian parameters for given system and method choice
+  \param[in] atom_to_ao_map The mapping from the atomic indices to the lists of the indices of AOs localized on given atom
+  \param[in] ao_to_atom_map The mapping from the AO index to the index of atoms on which given AO is localized
+  \param[in] BM Benchmark flag - if =1 - do some benchmarking, if =0 - don't do it
+
+  Returns the converged total electronic energy
+*/
+
+  return scf_diis(&el,syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map, BM, 1);
+}
+
+
+
+
+}// namespace libhamiltonian_qm
+}// namespace libhamiltonian_atomistic
+}// namespace libhamiltonian
+}// liblibra
+
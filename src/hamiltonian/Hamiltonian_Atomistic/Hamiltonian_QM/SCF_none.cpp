@@ -93,8 +93,8 @@ double scf_none(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
   while(run){
     
 
-    Fock_to_P(Norb, Nocc_alp, 1, Nocc_alp, eigen_method, prms.pop_opt, el->Fao_alp, el->Sao, el->C_alp, el->E_alp, el->bands_alp, el->occ_alp, el->P_alp, bench_t2);
-    Fock_to_P(Norb, Nocc_bet, 1, Nocc_bet, eigen_method, prms.pop_opt, el->Fao_bet, el->Sao, el->C_bet, el->E_bet, el->bands_bet, el->occ_bet, el->P_bet, bench_t2);
+    Fock_to_P_scf(prms, Norb, Nocc_alp, 1, Nocc_alp, eigen_method, prms.pop_opt, el->Fao_alp, el->Sao, el->C_alp, el->E_alp, el->bands_alp, el->occ_alp, el->P_alp, bench_t2);
+    Fock_to_P_scf(prms, Norb, Nocc_bet, 1, Nocc_bet, eigen_method, prms.pop_opt, el->Fao_bet, el->Sao, el->C_bet, el->E_bet, el->bands_bet, el->occ_bet, el->P_bet, bench_t2);
     *el->P = *el->P_alp + *el->P_bet;
 
     Hamiltonian_Fock(el, syst, basis_ao, prms, modprms, atom_to_ao_map, ao_to_atom_map);
@@ -178,8 +178,8 @@ double scf_oda(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
     // ODA Step 1: Diagonalize F~_k, assemble D_{k+1} via aufbau (so forcibly set prms.pop_opt = 0) 
     if(BM){ bench_t[2].start(); }
     if(prms.use_damping==0){  // Here we use normal ODA algorithm
-      Fock_to_P(Norb, Nocc_alp, 1, Nocc_alp, eigen_method, 0, Fao_til_alp, el_tmp->Sao, el_tmp->C_alp, el_tmp->E_alp, el_tmp->bands_alp, el_tmp->occ_alp, P_alp, bench_t2);
-      Fock_to_P(Norb, Nocc_bet, 1, Nocc_bet, eigen_method, 0, Fao_til_bet, el_tmp->Sao, el_tmp->C_bet, el_tmp->E_bet, el_tmp->bands_bet, el_tmp->occ_bet, P_bet, bench_t2);
+      Fock_to_P_scf(prms, Norb, Nocc_alp, 1, Nocc_alp, eigen_method, 0, Fao_til_alp, el_tmp->Sao, el_tmp->C_alp, el_tmp->E_alp, el_tmp->bands_alp, el_tmp->occ_alp, P_alp, bench_t2);
+      Fock_to_P_scf(prms, Norb, Nocc_bet, 1, Nocc_bet, eigen_method, 0, Fao_til_bet, el_tmp->Sao, el_tmp->C_bet, el_tmp->E_bet, el_tmp->bands_bet, el_tmp->occ_bet, P_bet, bench_t2);
       *P = *P_alp + *P_bet;
     }
     else if(prms.use_damping==1){
@@ -187,8 +187,8 @@ double scf_oda(Electronic_Structure* el, System& syst, vector<AO>& basis_ao,
       // dFao_alp_dP_alp
 
 //  This is original!!!
-      Fock_to_P(Norb, Nocc_alp, 1, Nocc_alp, eigen_method, prms.pop_opt, Fao_til_alp, el_tmp->Sao, el_tmp->C_alp, el_tmp->E_alp, el_tmp->bands_alp, el_tmp->occ_alp, P_alp, bench_t2);
-      Fock_to_P(Norb, Nocc_bet, 1, Nocc_bet, eigen_method, prms.pop_opt, Fao_til_bet, el_tmp->Sao, el_tmp->C_bet, el_tmp->E_bet, el_tmp->bands_bet, el_tmp->occ_bet, P_bet, bench_t2);
+      Fock_to_P_scf(prms, Norb, Nocc_alp, 1, Nocc_alp, eigen_method, prms.pop_opt, Fao_til_alp, el_tmp->Sao, el_tmp->C_alp, el_tmp->E_alp, el_tmp->bands_alp, el_tmp->occ_alp, P_alp, bench_t2);
+      Fock_to_P_scf(prms, Norb, Nocc_bet, 1, Nocc_bet, eigen_method, prms.pop_opt, Fao_til_bet, el_tmp->Sao, el_tmp->C_bet, el_tmp->E_bet, el_tmp->bands_bet, el_tmp->occ_bet, P_bet, bench_t2);
 
       // This is corrected
 //      *temp->Fao_alp = *Fao_til_alp + P_til_alp * el_tmp->dFao_alp_dP_alp + P_til_bet * el_tmp->dFao_alp_dP_bet;
@@ -42,9 +42,10 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
   [1] Kudin K.N.; Scuseria, G.E.; Cances, E. J. Chem. Phys. 116, 8255 (2002)
   [2] Cances J. Chem. Phys. 114, 10616 (2001) 
 
-  In this version we will try using as few temporary matrices as possible, the rest will be stored on the disk via I/O
-  This is good for large systems, when you run out of RAM, but may be slower than non-disk version, especially if the
-  disk access is slow.
+  In this version we will try using as few temporary matrices as possible, the rest are kept in the SCF_store
+  with the memory budget of prms.scf_mem_cap MB. Past the budget, the matrices are kept in single precision
+  (if prms.scf_mem_single == 1) or written to a per-job scratch directory created in prms.scf_scratch_dir.
+  This is good for large systems, when you run out of RAM.
 
   When the optimization step is fixed, this method becomes the density mixing scheme
   Also note that for spin-polarized calculations the present implementation may or may not work - we still need
@@ -101,6 +102,9 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
   MATRIX* aux2;          aux2 = new MATRIX(Norb,Norb);
   MATRIX* aux3;          aux3 = new MATRIX(Norb,Norb);
 
+  // The rest of the working matrices
+  SCF_store store(prms.scf_mem_cap*1048576.0, prms.scf_mem_single, prms.scf_scratch_dir);
+
 /*
   MATRIX* dP;           dP          = new MATRIX(Norb,Norb);  // dP = P_k+1 - P_k
   MATRIX* temp;         temp        = new MATRIX(Norb,Norb);
@@ -131,40 +135,28 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
 
 
   // Interface
-  el->P->bin_dump("job__P.bin");             
+  store.put("P", el->P);             
   //*P = *el->P;
 
-  el->P_alp->bin_dump("job__P_alp.bin");     
+  store.put("P_alp", el->P_alp);     
   //*P_alp = *el->P_alp;
 
-  el->P_bet->bin_dump("job__P_bet.bin");     
+  store.put("P_bet", el->P_bet);     
   //*P_bet = *el->P_bet;
-
-  el->Fao_alp->bin_dump("job__Fao_alp.bin"); 
-  //*Fao_alp = *el->Fao_alp;
-
-  el->Fao_bet->bin_dump("job__Fao_bet.bin"); 
-  //*Fao_bet = *el->Fao_bet;
   
   // Old
-  el->P_alp->bin_dump("job__P_old_alp.bin"); 
-  //*P_old_alp = *P_alp;
-
-  el->P_bet->bin_dump("job__P_old_bet.bin"); 
-  //*P_old_bet = *P_bet;
-
-  el->P->bin_dump("job__P_old.bin");         
+  store.put("P_old", el->P);         
   //*P_old = *P;
 
   // Tilda
   // D~_0 = D_0
-  el->P_alp->bin_dump("job__P_til_alp.bin"); 
+  store.put("P_til_alp", el->P_alp); 
   //*P_til_alp = *P_alp;
 
-  el->P_bet->bin_dump("job__P_til_bet.bin"); 
+  store.put("P_til_bet", el->P_bet); 
   //*P_til_bet = *P_bet;
 
-  el->P->bin_dump("job__P_til.bin");         
+  store.put("P_til", el->P);         
   //*P_til = *P;
   
 
@@ -173,10 +165,10 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
   if(BM){ bench_t[1].start(); }
     Hamiltonian_Fock(el_tmp, syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map);
   if(BM){ bench_t[1].stop(); }
-  el_tmp->Fao_alp->bin_dump("job__Fao_til_alp.bin"); 
+  store.put("Fao_til_alp", el_tmp->Fao_alp); 
   //*Fao_til_alp = *el_tmp->Fao_alp;
 
-  el_tmp->Fao_bet->bin_dump("job__Fao_til_bet.bin"); 
+  store.put("Fao_til_bet", el_tmp->Fao_bet); 
   //*Fao_til_bet = *el_tmp->Fao_bet;
 
   if(BM){ bench_t[0].start(); }
@@ -213,33 +205,34 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
     if(BM){ bench_t[2].start(); }
     if(prms.use_damping==0){
 /*
-      Fock_to_P(Norb, Nocc_alp, 1, Nocc_alp, eigen_method, 0, Fao_til_alp, el_tmp->Sao, el_tmp->C_alp, el_tmp->E_alp, el_tmp->bands_alp, el_tmp->occ_alp, P_alp, bench_t2);
-      Fock_to_P(Norb, Nocc_bet, 1, Nocc_bet, eigen_method, 0, Fao_til_bet, el_tmp->Sao, el_tmp->C_bet, el_tmp->E_bet, el_tmp->bands_bet, el_tmp->occ_bet, P_bet, bench_t2);
+      Fock_to_P_scf(prms, Norb, Nocc_alp, 1, Nocc_alp, eigen_method, 0, Fao_til_alp, el_tmp->Sao, el_tmp->C_alp, el_tmp->E_alp, el_tmp->bands_alp, el_tmp->occ_alp, P_alp, bench_t2);
+      Fock_to_P_scf(prms, Norb, Nocc_bet, 1, Nocc_bet, eigen_method, 0, Fao_til_bet, el_tmp->Sao, el_tmp->C_bet, el_tmp->E_bet, el_tmp->bands_bet, el_tmp->occ_bet, P_bet, bench_t2);
       *P = *P_alp + *P_bet;
 */
+      cout<<"Error in scf_oda_disk: only the density mixing (use_damping = 1) is implemented\nExiting...\n";
       exit(0);
     }
     else if(prms.use_damping==1){
 
 
-      aux1->bin_load("job__Fao_til_alp.bin");
-//      aux2->bin_load("job__P_alp.bin");
+      store.get("Fao_til_alp", aux1);
+//      store.get("P_alp", aux2);
 //      *Fao_til_alp = *aux1;
 //      *aux1 = *Fao_til_alp;
-      Fock_to_P(Norb, Nocc_alp, 1, Nocc_alp, eigen_method, prms.pop_opt, aux1, el_tmp->Sao, el_tmp->C_alp, el_tmp->E_alp, el_tmp->bands_alp, el_tmp->occ_alp, aux2, bench_t2);
-      aux2->bin_dump("job__P_alp.bin");
+      Fock_to_P_scf(prms, Norb, Nocc_alp, 1, Nocc_alp, eigen_method, prms.pop_opt, aux1, el_tmp->Sao, el_tmp->C_alp, el_tmp->E_alp, el_tmp->bands_alp, el_tmp->occ_alp, aux2, bench_t2);
+      store.put("P_alp", aux2);
 //      Fock_to_P(Norb, Nocc_alp, 1, Nocc_alp, eigen_method, prms.pop_opt, Fao_til_alp, el_tmp->Sao, el_tmp->C_alp, el_tmp->E_alp, el_tmp->bands_alp, el_tmp->occ_alp, P_alp, bench_t2);
 
 
-      aux1->bin_load("job__Fao_til_bet.bin");
-//      aux3->bin_load("job__P_bet.bin");
-      Fock_to_P(Norb, Nocc_bet, 1, Nocc_bet, eigen_method, prms.pop_opt, aux1, el_tmp->Sao, el_tmp->C_bet, el_tmp->E_bet, el_tmp->bands_bet, el_tmp->occ_bet, aux3, bench_t2);
-      aux3->bin_dump("job__P_bet.bin");
+      store.get("Fao_til_bet", aux1);
+//      store.get("P_bet", aux3);
+      Fock_to_P_scf(prms, Norb, Nocc_bet, 1, Nocc_bet, eigen_method, prms.pop_opt, aux1, el_tmp->Sao, el_tmp->C_bet, el_tmp->E_bet, el_tmp->bands_bet, el_tmp->occ_bet, aux3, bench_t2);
+      store.put("P_bet", aux3);
 //      Fock_to_P(Norb, Nocc_bet, 1, Nocc_bet, eigen_method, prms.pop_opt, Fao_til_bet, el_tmp->Sao, el_tmp->C_bet, el_tmp->E_bet, el_tmp->bands_bet, el_tmp->occ_bet, P_bet, bench_t2);
 
 
       *aux2 += *aux3;
-      aux2->bin_dump("job__P.bin");
+      store.put("P", aux2);
 //      *P = *P_alp + *P_bet;
 
 
@@ -256,8 +249,8 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
     if(BM){ bench_t[3].start(); }
 
 
-    aux1->bin_load("job__P.bin");    cout<<"Pmax = "<<aux1->max_elt()<<endl;
-    aux2->bin_load("job__P_old.bin");cout<<"Pold_max = "<<aux2->max_elt()<<endl;
+    store.get("P", aux1);    cout<<"Pmax = "<<aux1->max_elt()<<endl;
+    store.get("P_old", aux2);cout<<"Pold_max = "<<aux2->max_elt()<<endl;
     *aux1 -= *aux2;
     den_err = fabs(aux1->max_elt());
 
@@ -273,13 +266,8 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
 
 
     if(BM){ bench_t[3].start(); }
-    aux1->bin_load("job__P_alp.bin"); aux1->bin_dump("job__P_old_alp.bin");  
-    //*P_old_alp = *P_alp;
-
-    aux1->bin_load("job__P_bet.bin"); aux1->bin_dump("job__P_old_bet.bin");  
-    //*P_old_bet = *P_bet;
 
-    aux1->bin_load("job__P.bin");     aux1->bin_dump("job__P_old.bin");      
+    store.get("P", aux1);     store.put("P_old", aux1);      
     //*P_old = *P;
     if(BM){ bench_t[3].stop(); }
 
@@ -291,20 +279,14 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
 
       if(BM){ bench_t[3].start(); }
 
-      aux1->bin_load("job__P.bin");
-      aux2->bin_load("job__P_til.bin");
-      *aux1 -= *aux2;
-      aux1->bin_dump("job__dP.bin");
-//      *dP = *P - *P_til;
-
       // ODA Step 3: Assemble F_{k+1} = F(D_{k+1})
-      el_tmp->P_alp->bin_load("job__P_alp.bin");  
+      store.get("P_alp", el_tmp->P_alp);  
       //*el_tmp->P_alp = *P_alp;
 
-      el_tmp->P_bet->bin_load("job__P_bet.bin");  
+      store.get("P_bet", el_tmp->P_bet);  
       //*el_tmp->P_bet = *P_bet;
 
-      el_tmp->P->bin_load("job__P.bin");          
+      store.get("P", el_tmp->P);          
       //*el_tmp->P = *P;
       if(BM){ bench_t[3].stop(); }
 
@@ -313,15 +295,6 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
       Hamiltonian_Fock(el_tmp, syst,basis_ao, prms,modprms, atom_to_ao_map,ao_to_atom_map);
       if(BM){ bench_t[1].stop(); }
 
-
-      if(BM){ bench_t[3].start(); }
-      el_tmp->Fao_alp->bin_dump("job__Fao_alp.bin"); 
-      //*Fao_alp = *el_tmp->Fao_alp;   
-
-      el_tmp->Fao_bet->bin_dump("job__Fao_bet.bin"); 
-      //*Fao_bet = *el_tmp->Fao_bet;
-      if(BM){ bench_t[3].stop(); }
-
   
       // ODA Step 4: Solve the line search problem (via interpolation) or use fixed step
       lamb_min = 0.0;
@@ -434,26 +407,26 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
       // D~{k+1} = D~{k} + lamb_min * d_k = (1 - lamb_min)*D~_k + lamb_min * D_{k+1}
       if(BM){ bench_t[3].start(); }
 
-      aux1->bin_load("job__P_til_alp.bin"); *aux1 *= (1.0 - lamb_min);
-      aux2->bin_load("job__P_alp.bin"); *aux2 *= lamb_min;
+      store.get("P_til_alp", aux1); *aux1 *= (1.0 - lamb_min);
+      store.get("P_alp", aux2); *aux2 *= lamb_min;
       *aux1 += *aux2;
-      aux1->bin_dump("job__P_til_alp.bin");
+      store.put("P_til_alp", aux1);
 
 //      *P_til_alp   = (1.0 - lamb_min) * (*P_til_alp) + lamb_min * (*P_alp);
 
 
-      aux1->bin_load("job__P_til_bet.bin"); *aux1 *= (1.0 - lamb_min);
-      aux2->bin_load("job__P_bet.bin"); *aux2 *= lamb_min;
+      store.get("P_til_bet", aux1); *aux1 *= (1.0 - lamb_min);
+      store.get("P_bet", aux2); *aux2 *= lamb_min;
       *aux1 += *aux2;
-      aux1->bin_dump("job__P_til_bet.bin");
+      store.put("P_til_bet", aux1);
 
 //      *P_til_bet   = (1.0 - lamb_min) * (*P_til_bet) + lamb_min * (*P_bet);    
 
 
-      aux1->bin_load("job__P_til_alp.bin"); 
-      aux2->bin_load("job__P_til_bet.bin");
+      store.get("P_til_alp", aux1); 
+      store.get("P_til_bet", aux2);
       *aux1 += *aux2;
-      aux1->bin_dump("job__P_til.bin");
+      store.put("P_til", aux1);
 
 //      *P_til       = *P_til_alp + *P_til_bet;
 
@@ -463,13 +436,13 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
 
 
       // in fact, F~{k+1} = F(D~_{k+1})  - this is more general approach
-      el_tmp->P->bin_load("job__P_til.bin");
+      store.get("P_til", el_tmp->P);
       //*el_tmp->P     = *P_til;    
 
-      el_tmp->P_alp->bin_load("job__P_til_alp.bin");
+      store.get("P_til_alp", el_tmp->P_alp);
       //*el_tmp->P_alp = *P_til_alp;
 
-      el_tmp->P_bet->bin_load("job__P_til_bet.bin");
+      store.get("P_til_bet", el_tmp->P_bet);
       //*el_tmp->P_bet = *P_til_bet;
       if(BM){ bench_t[3].stop(); }
 
@@ -479,10 +452,10 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
       if(BM){ bench_t[1].stop(); }
 
 
-      el_tmp->Fao_alp->bin_dump("job__Fao_til_alp.bin"); 
+      store.put("Fao_til_alp", el_tmp->Fao_alp); 
 //      *Fao_til_alp = *el_tmp->Fao_alp;
 
-      el_tmp->Fao_bet->bin_dump("job__Fao_til_bet.bin"); 
+      store.put("Fao_til_bet", el_tmp->Fao_bet); 
 //      *Fao_til_bet = *el_tmp->Fao_bet;
 
 
@@ -492,13 +465,13 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
    
     // Recompute current energy using extrapolated density matrix
     if(BM){ bench_t[3].start(); }
-    el_tmp->P->bin_load("job__P_til.bin");  
+    store.get("P_til", el_tmp->P);  
     //*el_tmp->P     = *P_til;//     + lamb_min * *dP;
 
-    el_tmp->P_alp->bin_load("job__P_til_alp.bin");
+    store.get("P_til_alp", el_tmp->P_alp);
     //*el_tmp->P_alp = *P_til_alp;// + lamb_min * (0.5* *dP);
 
-    el_tmp->P_bet->bin_load("job__P_til_bet.bin");
+    store.get("P_til_bet", el_tmp->P_bet);
     //*el_tmp->P_bet = *P_til_bet;// + lamb_min * (0.5* *dP);
     if(BM){ bench_t[3].stop(); }
 
@@ -559,20 +532,20 @@ double scf_oda_disk(Electronic_Structure* el, System& syst, vector<AO>& basis_ao
 
 
   if(prms.do_annihilate==1){ 
-    aux1->bin_load("job__P_til_alp.bin");
-    aux2->bin_load("job__P_til_bet.bin");
+    store.get("P_til_alp", aux1);
+    store.get("P_til_bet", aux2);
     annihilate(Nocc_alp,Nocc_bet,aux1,aux2);
     //annihilate(Nocc_alp,Nocc_bet,P_til_alp,P_til_bet);
   }
 
   if(BM){ bench_t[3].start(); }
 
-  el->P_alp->bin_load("job__P_til_alp.bin");  //*el->P_alp = *P_til_alp;
-  el->P_bet->bin_load("job__P_til_bet.bin");  //*el->P_bet = *P_til_bet;
+  store.get("P_til_alp", el->P_alp);  //*el->P_alp = *P_til_alp;
+  store.get("P_til_bet", el->P_bet);  //*el->P_bet = *P_til_bet;
   *el->P     = *el->P_alp + *el->P_bet;
 
-  el->Fao_alp->bin_load("job__Fao_til_alp.bin"); //*el->Fao_alp = *Fao_til_alp;
-  el->Fao_bet->bin_load("job__Fao_til_bet.bin"); //*el->Fao_bet = *Fao_til_bet;
+  store.get("Fao_til_alp", el->Fao_alp); //*el->Fao_alp = *Fao_til_alp;
+  store.get("Fao_til_bet", el->Fao_bet); //*el->Fao_bet = *Fao_til_bet;
   if(BM){ bench_t[3].stop(); }
 
 
@@ -716,9 +689,10 @@ double scf_oda_disk(Electronic_Structure& el, System& syst, vector<AO>& basis_ao
   [1] Kudin K.N.; Scuseria, G.E.; Cances, E. J. Chem. Phys. 116, 8255 (2002)
   [2] Cances J. Chem. Phys. 114, 10616 (2001) 
 
-  In this version we will try using as few temporary matrices as possible, the rest will be stored on the disk via I/O
-  This is good for large systems, when you run out of RAM, but may be slower than non-disk version, especially if the
-  disk access is slow.
+  In this version we will try using as few temporary matrices as possible, the rest are kept in the SCF_store
+  with the memory budget of prms.scf_mem_cap MB. Past the budget, the matrices are kept in single precision
+  (if prms.scf_mem_single == 1) or written to a per-job scratch directory created in prms.scf_scratch_dir.
+  This is good for large systems, when you run out of RAM.
 
   When the optimization step is fixed, this method becomes the density mixing scheme
   Also note that for spin-polarized calculations the present implementation may or may not work - we still need
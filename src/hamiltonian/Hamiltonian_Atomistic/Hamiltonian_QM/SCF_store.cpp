@@ -0,0 +1,194 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file SCF_store.cpp
+  \brief The file implements the SCF_store class - a memory-budgeted storage of the working
+  matrices of the SCF procedures
+
+*/
+
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "SCF_store.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_atomistic namespace
+namespace libhamiltonian_atomistic{
+
+/// libhamiltonian_qm namespace
+namespace libhamiltonian_qm{
+
+
+
+SCF_store::SCF_store(double _mem_cap, int _use_single, std::string _scratch_root){
+/**
+  \param[in] _mem_cap The memory budget for the stored matrices [bytes]. If 0 or negative - all matrices are kept in RAM
+  \param[in] _use_single If 1 - the matrices that do not fit into the budget in double precision are kept in single precision
+  \param[in] _scratch_root The directory in which the per-job scratch directory is created, if needed
+*/
+
+  mem_cap = _mem_cap;
+  mem_used = 0.0;
+  use_single = _use_single;
+  scratch_root = _scratch_root;
+  scratch_dir = "";
+
+}
+
+
+SCF_store::~SCF_store(){
+/**
+  Removes the spilled files and the scratch directory
+*/
+
+  for(int i=0;i<filename.size();i++){
+    if(mode[i]==2){  remove(filename[i].c_str());  }
+  }
+  if(scratch_dir!=""){  rmdir(scratch_dir.c_str());  }
+
+}
+
+
+int SCF_store::add_entry(std::string name, int nr, int nc){
+/**
+  Registers a new matrix and chooses its storage type according to the memory budget
+*/
+
+  double sz = (double)nr * (double)nc;
+  int m = 0;
+
+  if(mem_cap<=0.0 || mem_used + sz*sizeof(double) <= mem_cap){  m = 0; }
+  else if(use_single && mem_used + sz*sizeof(float) <= mem_cap){  m = 1; }
+  else{ m = 2; }
+
+  int i = mode.size();
+  index[name] = i;
+  mode.push_back(m);
+  n_rows.push_back(nr);
+  n_cols.push_back(nc);
+  data_d.push_back(vector<double>());
+  data_f.push_back(vector<float>());
+  filename.push_back("");
+
+  if(m==0){  data_d[i] = vector<double>(nr*nc, 0.0);  mem_used += sz*sizeof(double);  }
+  else if(m==1){  data_f[i] = vector<float>(nr*nc, 0.0);  mem_used += sz*sizeof(float);  }
+  else{
+
+    if(scratch_dir==""){
+      // Unique per process and per store, so several jobs may share the working directory
+      std::stringstream ss;
+      ss<<scratch_root<<"/scf_scratch_"<<getpid()<<"_"<<this;
+      scratch_dir = ss.str();
+
+      if(mkdir(scratch_dir.c_str(), 0700)!=0){
+        cout<<"Error in SCF_store: can not create the scratch directory "<<scratch_dir<<"\nExiting...\n";
+        exit(0);
+      }
+    }
+    filename[i] = scratch_dir + "/" + name + ".bin";
+
+  }
+
+  return i;
+
+}
+
+
+void SCF_store::put(std::string name, MATRIX* x){
+/**
+  Stores a copy of the matrix x under the given name (overwrites the previous one, if any)
+
+  \param[in] name The name of the matrix
+  \param[in] x The matrix to store
+*/
+
+  int i;
+  std::map<std::string, int>::iterator it = index.find(name);
+
+  if(it==index.end()){  i = add_entry(name, x->n_rows, x->n_cols);  }
+  else{
+    i = it->second;
+    if(n_rows[i]!=x->n_rows || n_cols[i]!=x->n_cols){
+      cout<<"Error in SCF_store::put: the matrix "<<name<<" has changed its dimensions\nExiting...\n";
+      exit(0);
+    }
+  }
+
+  int sz = x->n_elts;
+
+  if(mode[i]==0){  for(int n=0;n<sz;n++){  data_d[i][n] = x->M[n];  }    }
+  else if(mode[i]==1){  for(int n=0;n<sz;n++){  data_f[i][n] = (float)x->M[n];  }    }
+  else{  x->bin_dump(filename[i]);  }
+
+}
+
+void SCF_store::put(std::string name, MATRIX& x){  put(name, &x); }
+
+
+void SCF_store::get(std::string name, MATRIX* x){
+/**
+  Retrieves the matrix stored under the given name
+
+  \param[in] name The name of the matrix
+  \param[out] x The matrix to be filled in - must be allocated and have the same dimensions as the stored matrix
+*/
+
+  std::map<std::string, int>::iterator it = index.find(name);
+
+  if(it==index.end()){
+    cout<<"Error in SCF_store::get: the matrix "<<name<<" has not been stored\nExiting...\n";
+    exit(0);
+  }
+
+  int i = it->second;
+  if(n_rows[i]!=x->n_rows || n_cols[i]!=x->n_cols){
+    cout<<"Error in SCF_store::get: the dimensions of the matrix "<<name<<" do not match the output\nExiting...\n";
+    exit(0);
+  }
+
+  int sz = x->n_elts;
+
+  if(mode[i]==0){  for(int n=0;n<sz;n++){  x->M[n] = data_d[i][n];  }    }
+  else if(mode[i]==1){  for(int n=0;n<sz;n++){  x->M[n] = (double)data_f[i][n];  }    }
+  else{  x->bin_load(filename[i]);  }
+
+}
+
+void SCF_store::get(std::string name, MATRIX& x){  get(name, &x); }
+
+
+int SCF_store::get_mode(std::string name){
+/**
+  Returns the storage type of the matrix: 0 - double in RAM, 1 - float in RAM, 2 - file; -1 if not stored
+*/
+
+  std::map<std::string, int>::iterator it = index.find(name);
+  if(it==index.end()){ return -1; }
+  return mode[it->second];
+
+}
+
+
+
+}// namespace libhamiltonian_qm
+}// namespace libhamiltonian_atomistic
+}// namespace libhamiltonian
+}// liblibra
+
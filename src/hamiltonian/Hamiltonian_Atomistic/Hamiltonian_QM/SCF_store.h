@@ -0,0 +1,88 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file SCF_store.h
+  \brief The file describes the SCF_store class - a memory-budgeted storage of the working
+  matrices of the SCF procedures
+
+*/
+
+#ifndef SCF_STORE_H
+#define SCF_STORE_H
+
+#include <map>
+#include "../../../math_linalg/liblinalg.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace liblinalg;
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_atomistic namespace
+namespace libhamiltonian_atomistic{
+
+/// libhamiltonian_qm namespace
+namespace libhamiltonian_qm{
+
+
+
+class SCF_store{
+/**
+  This class keeps named copies of the SCF matrices. The matrices are stored in RAM in double precision
+  as long as the total size fits into the memory budget. Past the budget, the new matrices are stored
+  in single precision (if allowed) and, if even that does not fit, are written to the per-job scratch directory.
+  The storage type of a matrix is chosen when it is stored for the first time, so the matrices that are
+  stored first should be the ones accessed most often.
+*/
+
+  std::map<std::string, int> index;   ///< name -> index of the stored matrix
+  vector<int> mode;                   ///< storage type: 0 - double in RAM, 1 - float in RAM, 2 - file
+  vector<int> n_rows;                 ///< the dimensions of the stored matrices
+  vector<int> n_cols;
+  vector< vector<double> > data_d;    ///< the data of the matrices stored in double precision
+  vector< vector<float> > data_f;     ///< the data of the matrices stored in single precision
+  vector<std::string> filename;       ///< the files of the spilled matrices
+
+  std::string scratch_root;           ///< where to create the scratch directory
+
+  int add_entry(std::string name, int nr, int nc);
+
+public:
+
+  double mem_cap;                     ///< memory budget [bytes], 0 - no limit
+  double mem_used;                    ///< memory currently used by the in-RAM matrices [bytes]
+  int use_single;                     ///< 1 - use single precision for the matrices that do not fit in double precision
+  std::string scratch_dir;            ///< the per-job scratch directory (created when the first matrix is spilled)
+
+  SCF_store(double _mem_cap, int _use_single, std::string _scratch_root);   ///< Constructor
+  ~SCF_store();                                                               ///< Destructor - removes the scratch files
+
+  void put(std::string name, MATRIX* x);
+  void put(std::string name, MATRIX& x);
+  void get(std::string name, MATRIX* x);
+  void get(std::string name, MATRIX& x);
+
+  int get_mode(std::string name);
+
+};
+
+
+
+}// namespace libhamiltonian_qm
+}// namespace libhamiltonian_atomistic
+}// namespace libhamiltonian
+}// liblibra
+
+
+#endif // SCF_STORE_H
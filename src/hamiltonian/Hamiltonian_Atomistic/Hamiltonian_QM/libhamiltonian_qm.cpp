@@ -117,6 +117,10 @@ void export_Hamiltonian_QM_objects(){
       .def("get_E_alp", &Electronic_Structure::get_E_alp)
       .def("get_E_bet", &Electronic_Structure::get_E_bet)
 
+      .def("predict_density", &Electronic_Structure::predict_density)
+      .def("update_density_history", &Electronic_Structure::update_density_history)
+      .def("reset_density_history", &Electronic_Structure::reset_density_history)
+
 
 
   ;
@@ -147,6 +151,10 @@ void export_Hamiltonian_QM_objects(){
   vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
   int opt, int DF) = &indo_core_parameters;
 
+  void (*expt_indo_fock_cache_v1)
+  ( System& syst, vector<AO>& basis_ao, Model_Parameters& modprms,
+  vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map) = &indo_fock_cache;
+
 
 
   void (*expt_Hamiltonian_core_indo_v1)
@@ -192,6 +200,7 @@ void export_Hamiltonian_QM_objects(){
   def("compute_indo_core_parameters", expt_compute_indo_core_parameters_v1);
   def("compute_indo_core_parameters_derivs", expt_compute_indo_core_parameters_derivs_v1);
   def("indo_core_parameters", expt_indo_core_parameters_v1);
+  def("indo_fock_cache", expt_indo_fock_cache_v1);
 
   def("Hamiltonian_core_indo", expt_Hamiltonian_core_indo_v1);
   def("Hamiltonian_core_deriv_indo", expt_Hamiltonian_core_deriv_indo_v1);
@@ -226,9 +235,26 @@ void export_Hamiltonian_QM_objects(){
     vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map
   ) = &Hamiltonian_Fock_eht;
 
+  void (*expt_Hamiltonian_core_eht_fused_v1)
+  ( System& syst, vector<AO>& basis_ao, 
+    Control_Parameters& prms, Model_Parameters& modprms,
+    vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+    MATRIX& Hao, MATRIX& Sao, MATRIX& P, MATRIX& W, double ovlp_thresh,
+    vector<VECTOR>& dEdR
+  ) = &Hamiltonian_core_eht_fused;
+
+  void (*expt_Hamiltonian_core_eht_fused_v2)
+  ( System& syst, vector<AO>& basis_ao, 
+    Control_Parameters& prms, Model_Parameters& modprms,
+    vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+    MATRIX& Hao, MATRIX& Sao, double ovlp_thresh
+  ) = &Hamiltonian_core_eht_fused;
+
   def("Hamiltonian_core_eht", expt_Hamiltonian_core_eht_v1);
   def("Hamiltonian_core_deriv_eht", expt_Hamiltonian_core_deriv_eht_v1);
   def("Hamiltonian_Fock_eht", expt_Hamiltonian_Fock_eht_v1);
+  def("Hamiltonian_core_eht_fused", expt_Hamiltonian_core_eht_fused_v1);
+  def("Hamiltonian_core_eht_fused", expt_Hamiltonian_core_eht_fused_v2);
 
 
 
@@ -320,6 +346,20 @@ void export_Hamiltonian_QM_objects(){
     int x_period, int y_period, int z_period, VECTOR& t1, VECTOR& t2, VECTOR& t3
   ) = &force;
 
+  void (*expt_forces_v1)
+  ( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+    Control_Parameters& prms,Model_Parameters& modprms,
+    vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+    MATRIX& Hao, MATRIX& Sao, int Norb, vector<VECTOR>& F
+  ) = &forces;
+
+  void (*expt_forces_v2)
+  ( Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+    Control_Parameters& prms,Model_Parameters& modprms,
+    vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map,
+    MATRIX& Hao, MATRIX& Sao, int Norb, vector<VECTOR>& F, double ovlp_thresh
+  ) = &forces;
+
 
 
 
@@ -330,6 +370,8 @@ void export_Hamiltonian_QM_objects(){
   def("derivative_couplings", expt_derivative_couplings_v2);
   def("derivative_couplings", expt_derivative_couplings_v3);
   def("force", expt_force_v1);
+  def("forces", expt_forces_v1);
+  def("forces", expt_forces_v2);
   def("energy_and_forces", expt_energy_and_forces_v1);
 
 
@@ -354,10 +396,37 @@ void export_Hamiltonian_QM_objects(){
            Control_Parameters& prms,Model_Parameters& modprms,
            vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM) = &scf_oda_disk;
 
+  double (*expt_scf_diis_fock_v1)
+  (Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+   Control_Parameters& prms,Model_Parameters& modprms,
+   vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM) = &scf_diis_fock;
+
+  double (*expt_scf_diis_dm_v1)
+  (Electronic_Structure& el, System& syst, vector<AO>& basis_ao,
+   Control_Parameters& prms,Model_Parameters& modprms,
+   vector< vector<int> >& atom_to_ao_map, vector<int>& ao_to_atom_map, int BM) = &scf_diis_dm;
+
   def("scf", expt_scf_v1);
   def("scf_none", expt_scf_none_v1);
   def("scf_oda", expt_scf_oda_v1);
   def("scf_oda_disk", expt_scf_oda_disk_v1);
+  def("scf_diis_fock", expt_scf_diis_fock_v1);
+  def("scf_diis_dm", expt_scf_diis_dm_v1);
+
+
+  void (SCF_store::*expt_SCF_store_put_v1)(std::string name, MATRIX& x) = &SCF_store::put;
+  void (SCF_store::*expt_SCF_store_get_v1)(std::string name, MATRIX& x) = &SCF_store::get;
+
+  class_<SCF_store, boost::noncopyable>("SCF_store",init<double, int, std::string>())
+      .def_readwrite("mem_cap", &SCF_store::mem_cap)
+      .def_readonly("mem_used", &SCF_store::mem_used)
+      .def_readwrite("use_single", &SCF_store::use_single)
+      .def_readonly("scratch_dir", &SCF_store::scratch_dir)
+
+      .def("put", expt_SCF_store_put_v1)
+      .def("get", expt_SCF_store_get_v1)
+      .def("get_mode", &SCF_store::get_mode)
+  ;
 
 
 
@@ -374,6 +443,9 @@ void export_Hamiltonian_QM_objects(){
       .def_readwrite("basis_ao", &listHamiltonian_QM::basis_ao)
       .def_readwrite("atom_to_ao_map", &listHamiltonian_QM::atom_to_ao_map)
       .def_readwrite("ao_to_atom_map", &listHamiltonian_QM::ao_to_atom_map)
+      .def_readwrite("dm_reuse", &listHamiltonian_QM::dm_reuse)
+      .def_readwrite("ovlp_thresh", &listHamiltonian_QM::ovlp_thresh)
+      .def_readwrite("ovlp_skin", &listHamiltonian_QM::ovlp_skin)
 
 
       .def("init", &listHamiltonian_QM::init)
@@ -384,6 +456,7 @@ void export_Hamiltonian_QM_objects(){
       .def("compute_overlap", &listHamiltonian_QM::compute_overlap)
       .def("compute_core_Hamiltonian", &listHamiltonian_QM::compute_core_Hamiltonian)
       .def("energy_and_forces", &listHamiltonian_QM::energy_and_forces)
+      .def("optimize_geometry", &listHamiltonian_QM::optimize_geometry)
 
       .def("excite_alp", &listHamiltonian_QM::excite_alp)
       .def("excite_bet", &listHamiltonian_QM::excite_bet)
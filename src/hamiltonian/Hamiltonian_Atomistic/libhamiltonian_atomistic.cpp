@@ -109,6 +109,16 @@ void export_hamiltonian_atomistic_objects(){
 
       .def("get_stress", &Hamiltonian_Atomistic::get_stress)
 
+      .def_readwrite("d2ham_blocks", &Hamiltonian_Atomistic::d2ham_blocks)
+      .def("request_d2ham", &Hamiltonian_Atomistic::request_d2ham)
+      .def("request_d2ham_bonded", &Hamiltonian_Atomistic::request_d2ham_bonded)
+      .def("clear_d2ham", &Hamiltonian_Atomistic::clear_d2ham)
+      .def("num_d2ham_blocks", &Hamiltonian_Atomistic::num_d2ham_blocks)
+      .def("get_d2ham", &Hamiltonian_Atomistic::get_d2ham)
+      .def("hessian_vector_product", &Hamiltonian_Atomistic::hessian_vector_product)
+      .def("compute_d2ham", &Hamiltonian_Atomistic::compute_d2ham)
+      .def("compute_hessian", &Hamiltonian_Atomistic::compute_hessian)
+
 /*
       .def("H", &Hamiltonian_Atomistic::H)
       .def("dHdq", &Hamiltonian_Atomistic::dHdq)
@@ -0,0 +1,266 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Hessian_Blocks.cpp
+  \brief The file implements the sparse, lazily-allocated storage of the Hamiltonian second derivatives
+
+*/
+
+#include "Hessian_Blocks.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_generic namespace
+namespace libhamiltonian_generic{
+
+
+Hessian_Blocks::Hessian_Blocks(const Hessian_Blocks& x){
+/**
+  Copy constructor: makes a deep copy of all the allocated blocks
+*/
+  nelec = 0; nnucl = 0;
+  *this = x;
+}
+
+
+Hessian_Blocks& Hessian_Blocks::operator=(const Hessian_Blocks& x){
+/**
+  Assignment operator: makes a deep copy of all the allocated blocks
+*/
+
+  if(this==&x){ return *this; }
+
+  clear();
+  nelec = x.nelec;
+  nnucl = x.nnucl;
+
+  for(std::map<long, MATRIX*>::const_iterator it=x.blocks.begin(); it!=x.blocks.end(); it++){
+    blocks[it->first] = new MATRIX(*it->second);
+  }
+
+  return *this;
+}
+
+
+Hessian_Blocks::~Hessian_Blocks(){
+/**
+  Destructor: free the memory of all the allocated blocks
+*/
+  clear();
+}
+
+
+void Hessian_Blocks::init(int nelec_, int nnucl_){
+/**
+  \brief Set up the dimensions and remove all the allocated blocks
+
+  \param[in] nelec_ The number of electronic states - the size of each block
+  \param[in] nnucl_ The number of nuclear DOFs
+*/
+
+  clear();
+  nelec = nelec_;
+  nnucl = nnucl_;
+
+}
+
+
+void Hessian_Blocks::clear(){
+/**
+  \brief Free all the allocated blocks - all the second derivatives become zero
+*/
+
+  for(std::map<long, MATRIX*>::iterator it=blocks.begin(); it!=blocks.end(); it++){ delete it->second; }
+  blocks.clear();
+
+}
+
+
+void Hessian_Blocks::zero(){
+/**
+  \brief Set all the allocated blocks to zero, but keep them allocated (the sparsity pattern is kept)
+*/
+
+  for(std::map<long, MATRIX*>::iterator it=blocks.begin(); it!=blocks.end(); it++){ *it->second = 0.0; }
+
+}
+
+
+void Hessian_Blocks::check_index(int n1, int n2) const{
+
+  if(n1<0 || n1>=nnucl || n2<0 || n2>=nnucl){
+    cout<<"Error in Hessian_Blocks: the index ("<<n1<<", "<<n2<<") is out of range [0, "<<nnucl<<")\n";
+    cout<<"Exiting...\n"; exit(0);
+  }
+
+}
+
+
+int Hessian_Blocks::is_allocated(int n1, int n2) const{
+/**
+  \brief Returns 1 if the block d2H/dq_n1 dq_n2 is allocated, 0 otherwise
+*/
+
+  return (blocks.find(key(n1,n2))!=blocks.end());
+
+}
+
+
+MATRIX* Hessian_Blocks::request(int n1, int n2){
+/**
+  \brief Returns the pointer to the block d2H/dq_n1 dq_n2, allocating it (with zeroes) if needed
+
+  \param[in] n1 The index of the first nuclear DOF
+  \param[in] n2 The index of the second nuclear DOF
+*/
+
+  check_index(n1, n2);
+
+  long k = key(n1,n2);
+  std::map<long, MATRIX*>::iterator it = blocks.find(k);
+  if(it!=blocks.end()){ return it->second; }
+
+  MATRIX* x; x = new MATRIX(nelec, nelec);  *x = 0.0;
+  blocks[k] = x;
+
+  return x;
+}
+
+
+MATRIX* Hessian_Blocks::find(int n1, int n2) const{
+/**
+  \brief Returns the pointer to the block d2H/dq_n1 dq_n2 or NULL, if this block is not allocated (zero)
+*/
+
+  std::map<long, MATRIX*>::const_iterator it = blocks.find(key(n1,n2));
+  if(it==blocks.end()){ return NULL; }
+
+  return it->second;
+}
+
+
+MATRIX Hessian_Blocks::get(int n1, int n2) const{
+/**
+  \brief Returns the copy of the block d2H/dq_n1 dq_n2 (a zero matrix if the block is not allocated)
+*/
+
+  check_index(n1, n2);
+
+  MATRIX* x = find(n1,n2);
+  if(x!=NULL){ return *x; }
+
+  MATRIX res(nelec, nelec);
+  return res;
+}
+
+
+void Hessian_Blocks::set(int n1, int n2, MATRIX& x){
+/**
+  \brief Set the block d2H/dq_n1 dq_n2, allocating it if needed
+
+  \param[in] n1 The index of the first nuclear DOF
+  \param[in] n2 The index of the second nuclear DOF
+  \param[in] x The nelec x nelec matrix of the second derivatives
+*/
+
+  if(x.n_rows!=nelec || x.n_cols!=nelec){
+    cout<<"Error in Hessian_Blocks::set: the block must be a "<<nelec<<" x "<<nelec<<" matrix\nExiting...\n"; exit(0);
+  }
+
+  *request(n1, n2) = x;
+
+}
+
+
+vector<int> Hessian_Blocks::columns() const{
+/**
+  \brief Returns the sorted list of the indices n2 for which at least one block d2H/dq_n1 dq_n2 is allocated
+*/
+
+  vector<int> res;
+  vector<int> is_col(nnucl, 0);
+
+  for(std::map<long, MATRIX*>::const_iterator it=blocks.begin(); it!=blocks.end(); it++){
+    is_col[it->first % nnucl] = 1;
+  }
+  for(int n=0;n<nnucl;n++){  if(is_col[n]){ res.push_back(n); }  }
+
+  return res;
+}
+
+
+void Hessian_Blocks::multiply(MATRIX& v, vector<MATRIX>& res) const{
+/**
+  \brief Hessian-vector product: res[n1] = sum_n2 { d2H/dq_n1 dq_n2 * v[n2] }
+
+  Only the allocated blocks are visited, so the cost is proportional to the number of
+  the stored blocks.
+
+  \param[in] v The vector in the space of nuclear DOFs: nnucl x 1 matrix
+  \param[out] res The nnucl matrices nelec x nelec each - the derivatives of the matrices dH/dq_n1 along v
+*/
+
+  if(v.n_rows!=nnucl){
+    cout<<"Error in Hessian_Blocks::multiply: the size of the vector ("<<v.n_rows<<") does not match ";
+    cout<<"the number of nuclear DOFs ("<<nnucl<<")\nExiting...\n"; exit(0);
+  }
+
+  res = vector<MATRIX>(nnucl, MATRIX(nelec, nelec));
+
+  for(std::map<long, MATRIX*>::const_iterator it=blocks.begin(); it!=blocks.end(); it++){
+    int n1 = it->first / nnucl;
+    int n2 = it->first % nnucl;
+    res[n1] += v.get(n2, 0) * (*it->second);
+  }
+
+}
+
+
+MATRIX Hessian_Blocks::multiply(MATRIX& v, int st) const{
+/**
+  \brief Hessian-vector product for a single state: res[n1] = sum_n2 { d2H_st,st/dq_n1 dq_n2 * v[n2] }
+
+  \param[in] v The vector in the space of nuclear DOFs: nnucl x 1 matrix
+  \param[in] st The index of the state (the diagonal element of the blocks) to use
+
+  Returns the nnucl x 1 matrix
+*/
+
+  if(v.n_rows!=nnucl){
+    cout<<"Error in Hessian_Blocks::multiply: the size of the vector ("<<v.n_rows<<") does not match ";
+    cout<<"the number of nuclear DOFs ("<<nnucl<<")\nExiting...\n"; exit(0);
+  }
+  if(st<0 || st>=nelec){
+    cout<<"Error in Hessian_Blocks::multiply: the state index "<<st<<" is out of range\nExiting...\n"; exit(0);
+  }
+
+  MATRIX res(nnucl, 1);
+
+  for(std::map<long, MATRIX*>::const_iterator it=blocks.begin(); it!=blocks.end(); it++){
+    int n1 = it->first / nnucl;
+    int n2 = it->first % nnucl;
+    res.M[n1] += it->second->M[st*nelec+st] * v.get(n2, 0);
+  }
+
+  return res;
+}
+
+
+
+}// namespace libhamiltonian_generic
+}// namespace libhamiltonian
+}// liblibra
+
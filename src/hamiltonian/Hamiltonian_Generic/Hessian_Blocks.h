@@ -0,0 +1,85 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file Hessian_Blocks.h
+  \brief The file describes the sparse, lazily-allocated storage of the Hamiltonian second derivatives
+
+*/
+
+#ifndef HESSIAN_BLOCKS_H
+#define HESSIAN_BLOCKS_H
+
+#include <map>
+#include "../../math_linalg/liblinalg.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+
+/// libhamiltonian namespace
+namespace libhamiltonian{
+
+/// libhamiltonian_generic namespace
+namespace libhamiltonian_generic{
+
+
+using namespace liblinalg;
+
+class Hessian_Blocks{
+/**
+  Sparse storage of the second derivatives of a Hamiltonian matrix w.r.t. the nuclear DOFs:
+
+  d2H/dq_n1 dq_n2 is a nelec x nelec matrix (a block). Only the blocks that have been requested
+  are allocated, so the memory is proportional to the number of such blocks (e.g. only the pairs
+  of DOFs belonging to bonded atoms) rather than to nnucl^2. The blocks that are not allocated are
+  considered to be zero.
+*/
+
+  int nelec;                          ///< the size of each block
+  int nnucl;                          ///< the number of nuclear DOFs
+  std::map<long, MATRIX*> blocks;     ///< allocated blocks, the key is n1*nnucl + n2
+
+  long key(int n1, int n2) const { return (long)n1*(long)nnucl + (long)n2; }
+  void check_index(int n1, int n2) const;
+
+public:
+
+  Hessian_Blocks(){ nelec = 0; nnucl = 0; }
+  Hessian_Blocks(int nelec_, int nnucl_){ nelec = nelec_; nnucl = nnucl_; }
+  Hessian_Blocks(const Hessian_Blocks&);
+  Hessian_Blocks& operator=(const Hessian_Blocks&);
+ ~Hessian_Blocks();
+
+  void init(int nelec_, int nnucl_);
+  void clear();
+  void zero();
+
+  int is_allocated(int n1, int n2) const;
+  int num_blocks() const { return blocks.size(); }  ///< the number of the allocated blocks
+
+  MATRIX* request(int n1, int n2);
+  MATRIX* find(int n1, int n2) const;
+  MATRIX get(int n1, int n2) const;
+  void set(int n1, int n2, MATRIX& x);
+
+  vector<int> columns() const;
+
+  void multiply(MATRIX& v, vector<MATRIX>& res) const;
+  MATRIX multiply(MATRIX& v, int st) const;
+
+};
+
+
+}// namespace libhamiltonian_generic
+}// namespace libhamiltonian
+}// liblibra
+
+#endif // HESSIAN_BLOCKS_H
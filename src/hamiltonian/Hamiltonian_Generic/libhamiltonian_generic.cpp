@@ -80,6 +80,27 @@ void export_hamiltonian_generic_objects(){
   ;
 
 
+  MATRIX (Hessian_Blocks::*expt_multiply_v1)(MATRIX& v, int st) const = &Hessian_Blocks::multiply;
+  void (Hessian_Blocks::*expt_multiply_v2)(MATRIX& v, vector<MATRIX>& res) const = &Hessian_Blocks::multiply;
+
+  class_<Hessian_Blocks>("Hessian_Blocks",init<>())
+      .def(init<int,int>())
+      .def(init<const Hessian_Blocks&>())
+      .def("__copy__", &generic__copy__<Hessian_Blocks>)
+      .def("__deepcopy__", &generic__deepcopy__<Hessian_Blocks>)
+
+      .def("init", &Hessian_Blocks::init)
+      .def("clear", &Hessian_Blocks::clear)
+      .def("zero", &Hessian_Blocks::zero)
+      .def("is_allocated", &Hessian_Blocks::is_allocated)
+      .def("num_blocks", &Hessian_Blocks::num_blocks)
+      .def("get", &Hessian_Blocks::get)
+      .def("set", &Hessian_Blocks::set)
+      .def("multiply", expt_multiply_v1)
+      .def("multiply", expt_multiply_v2)
+  ;
+
+
 }
 
 
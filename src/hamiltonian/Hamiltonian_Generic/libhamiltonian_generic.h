@@ -19,6 +19,7 @@
 
 
 #include "Hamiltonian.h"
+#include "Hessian_Blocks.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -19,6 +19,7 @@
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
 #include "libnhamiltonian_generic.h"
+#include "../../math_ann/libann.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -117,6 +118,13 @@ void export_nhamiltonian_generic_objects(){
   void (nHamiltonian::*expt_compute_diabatic_v4)(bp::object py_funct, bp::object q, bp::object params)
   = &nHamiltonian::compute_diabatic;
 
+  // for ANN surrogate models
+  void (nHamiltonian::*expt_compute_diabatic_v5)(libann::NeuralNetwork& ann, const MATRIX& q, int lvl)
+  = &nHamiltonian::compute_diabatic;
+
+  void (nHamiltonian::*expt_compute_diabatic_v6)(libann::NeuralNetwork& ann, const MATRIX& q)
+  = &nHamiltonian::compute_diabatic;
+
 
 
   void (nHamiltonian::*expt_update_ordering_v1)(vector<int>& perm_t, int lvl) = &nHamiltonian::update_ordering;
@@ -394,6 +402,8 @@ void export_nhamiltonian_generic_objects(){
       .def("compute_diabatic", expt_compute_diabatic_v2)
       .def("compute_diabatic", expt_compute_diabatic_v3)
       .def("compute_diabatic", expt_compute_diabatic_v4)
+      .def("compute_diabatic", expt_compute_diabatic_v5)
+      .def("compute_diabatic", expt_compute_diabatic_v6)
 
 
       .def("update_ordering", expt_update_ordering_v1)
@@ -23,6 +23,9 @@
 /// liblibra namespace
 namespace liblibra{
 
+/// libann namespace
+namespace libann{  class NeuralNetwork;  }
+
 
 /// libhamiltonian namespace
 namespace libhamiltonian{
@@ -396,6 +399,9 @@ public:
   void compute_diabatic(bp::object py_funct, bp::object q, bp::object params, int lvl); // for models defined in Python
   void compute_diabatic(bp::object py_funct, bp::object q, bp::object params); // for models defined in Python
 
+  void compute_diabatic(libann::NeuralNetwork& ann, const MATRIX& q, int lvl); // for ANN surrogate models
+  void compute_diabatic(libann::NeuralNetwork& ann, const MATRIX& q); // for ANN surrogate models
+
 
   ///< In nHamiltonian_compute_ETHD.cpp
 
@@ -20,6 +20,7 @@
 #include "nHamiltonian.h"
 #include "../Hamiltonian_Model/libhamiltonian_model.h"
 #include "../../io/libio.h"
+#include "../../math_ann/libann.h"
 
 /// liblibra namespace
 namespace liblibra{
@@ -233,6 +234,158 @@ void nHamiltonian::compute_diabatic(bp::object py_funct, bp::object q, bp::objec
 }
 
 
+static void ann_compute_diabatic_block(libann::NeuralNetwork& ann, const MATRIX& q, vector<nHamiltonian*>& nodes){
+/**
+  Evaluates the ANN surrogate for all the Hamiltonians in `nodes` with one call of the
+  batched ANN propagation. The node with id = i uses the coordinates in the column i of q.
+*/
+
+  int nnodes = nodes.size();
+  if(nnodes==0){ return; }
+
+  int ndia  = nodes[0]->ndia;
+  int nnucl = nodes[0]->nnucl;
+  int nout  = ndia*(ndia+1)/2;
+  int c, i, j, k, n;
+
+  if(ann.sz_x!=nnucl){
+    cout<<"Error in nHamiltonian::compute_diabatic: the ANN has "<<ann.sz_x<<" inputs, but the Hamiltonian has "
+        <<nnucl<<" nuclear DOFs\nExiting...\n"; exit(0);
+  }
+  if(ann.sz_y!=nout){
+    cout<<"Error in nHamiltonian::compute_diabatic: the ANN has "<<ann.sz_y<<" outputs, but the upper triangle of the "
+        <<ndia<<" x "<<ndia<<" diabatic Hamiltonian has "<<nout<<" elements\nExiting...\n"; exit(0);
+  }
+  if(q.n_rows!=nnucl){
+    cout<<"Error in nHamiltonian::compute_diabatic: the coordinates matrix has "<<q.n_rows<<" rows, but "
+        <<nnucl<<" are expected\nExiting...\n"; exit(0);
+  }
+
+  for(c=0;c<nnodes;c++){
+    if(nodes[c]->id>=q.n_cols){
+      cout<<"Error in nHamiltonian::compute_diabatic: the Hamiltonian with id = "<<nodes[c]->id<<" needs the column "
+          <<nodes[c]->id<<" of the coordinates matrix, but the matrix has only "<<q.n_cols<<" columns\nExiting...\n"; exit(0);
+    }
+    if(nodes[c]->ham_dia_mem_status==0){ cout<<"Error in compute_diabatic(): the diabatic Hamiltonian matrix is not allocated \
+    but it is used to collect the results of the calculations\n"; exit(0); }
+
+    for(n=0;n<nnucl;n++){
+      if(nodes[c]->d1ham_dia_mem_status[n]==0){ cout<<"Error in compute_diabatic(): the derivatives of the diabatic Hamiltonian \
+      are not allocated but they are used to collect the results of the calculations\n"; exit(0); }
+    }
+  }// for c
+
+
+  // Gather the coordinates of all the nodes and evaluate the ANN for all of them at once
+  MATRIX x(nnucl, nnodes);
+  MATRIX y(nout, nnodes);
+  MATRIX dy(nout*nnucl, nnodes);
+
+  for(c=0;c<nnodes;c++){
+    for(n=0;n<nnucl;n++){  x.M[n*nnodes + c] = q.M[n*q.n_cols + nodes[c]->id];  }
+  }
+
+  ann.Propagate_batch(x, y, dy);
+
+
+  // Distribute the results
+  for(c=0;c<nnodes;c++){
+
+    nHamiltonian* node = nodes[c];
+
+    k = 0;
+    for(i=0;i<ndia;i++){
+      for(j=i;j<ndia;j++){
+
+        double h = y.M[k*nnodes + c];
+        node->ham_dia->set(i,j, h, 0.0);
+        node->ham_dia->set(j,i, h, 0.0);
+
+        for(n=0;n<nnucl;n++){
+          double dh = dy.M[(k*nnucl + n)*nnodes + c];
+          node->d1ham_dia[n]->set(i,j, dh, 0.0);
+          node->d1ham_dia[n]->set(j,i, dh, 0.0);
+        }
+
+        k++;
+      }// for j
+    }// for i
+
+    // The diabatic basis of the surrogate is orthonormal and does not depend on q
+    if(node->ovlp_dia_mem_status){  node->ovlp_dia->identity();  }
+
+    for(n=0;n<node->dc1_dia.size();n++){
+      if(node->dc1_dia_mem_status[n]){  *node->dc1_dia[n] = 0.0;  }
+    }
+
+  }// for c
+
+}
+
+
+void nHamiltonian::compute_diabatic(libann::NeuralNetwork& ann, const MATRIX& q){
+/**
+  Performs the diabatic properties calculation at the top-most level of the Hamiltonians 
+  hierarchy. See the description of the more general function prototype for more info.
+*/ 
+
+  compute_diabatic(ann, q, 0);
+
+}
+
+
+void nHamiltonian::compute_diabatic(libann::NeuralNetwork& ann, const MATRIX& q, int lvl){
+/**
+  This function computes the diabatic Hamiltonian and its first-order derivatives using a
+  trained ANN as the surrogate of the diabatic PES - the C++ alternative to the Python-function 
+  version above.
+
+  ann - the ANN with nnucl inputs (the nuclear coordinates) and ndia*(ndia+1)/2 outputs: the upper 
+  triangle of the real symmetric diabatic Hamiltonian, row by row:
+  H(0,0), H(0,1), ..., H(0,ndia-1), H(1,1), ..., H(ndia-1,ndia-1)
+  The inputs and outputs are transformed with the scaling set up during the training, the same
+  way as in ANN.Propagate, and the derivatives of the outputs w.r.t. the inputs give d1ham_dia.
+
+  q - [nnucl x ntraj] the coordinates of nuclei. Like in the Python version, the Hamiltonian with 
+  id = i uses the i-th column of q, so the children of the top-level Hamiltonian are the trajectories
+
+  lvl - is the level of the Hamiltonians in the hierarchy of Hamiltonians to be executed by this call.
+  All the Hamiltonians of this level that have the same parent are evaluated with a single batched 
+  call of the ANN (see NeuralNetwork::Propagate_batch)
+
+  The overlap of the diabatic states is set to the identity and the derivative couplings to zero.
+*/
+
+  if(level==lvl){
+
+    vector<nHamiltonian*> nodes(1, this);
+    ann_compute_diabatic_block(ann, q, nodes);
+
+  }
+
+  else if(lvl==level+1){
+
+    ann_compute_diabatic_block(ann, q, children);
+
+  }
+
+  else if(lvl>level){
+  
+    for(int i=0;i<children.size();i++){
+      children[i]->compute_diabatic(ann, q, lvl);
+    }
+
+  }
+
+  else{
+    cout<<"WARNING in nHamiltonian::compute_diabatic\n"; 
+    cout<<"Can not run evaluation of function in the parent Hamiltonian from the\
+     child node\n";    
+  }
+
+}
+
+
 
 
 }// namespace libhamiltonian_generic
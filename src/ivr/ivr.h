@@ -97,12 +97,14 @@ vector<MATRIX> ivr_Husimi(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, Random& rnd,
 MATRIX ivr_LSC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, Random& rnd);
 vector<MATRIX> ivr_LSC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, Random& rnd, int sample_size);
 
+MATRIX ivr_DHK(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, vector<double>& ksi);
 MATRIX ivr_DHK(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, Random& rnd);
 vector<MATRIX> ivr_DHK(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, Random& rnd, int sample_size);
 
 MATRIX ivr_FB_MQC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, int flag, Random& rnd);
 vector<MATRIX> ivr_FB_MQC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, int flag, Random& rnd, int sample_size);
 
+MATRIX ivr_FF_MQC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, vector<double>& ksi);
 MATRIX ivr_FF_MQC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, Random& rnd);
 vector<MATRIX> ivr_FF_MQC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, Random& rnd, int sample_size);
 
@@ -131,15 +133,51 @@ vector<complex<double> > DHK_prefactor
 (vector<CMATRIX>& Mfwd, vector<CMATRIX>& Mbck, ivr_params& prms);
 
 
+///============ Potentials  ===========================
+///  In ivr_driver.cpp
+
+/// The potential v, its gradient dv (Ndof x 1), and Hessian d2v (Ndof x Ndof) at the point q
+typedef void (*ivr_vdv_fn)(MATRIX& q, double& v, MATRIX& dv, MATRIX& d2v, vector<double>& params);
+
+void ivr_register_potential(std::string name, ivr_vdv_fn vdv);
+ivr_vdv_fn ivr_get_potential(std::string name);
+double ivr_vdv(std::string name, MATRIX& q, MATRIX& dv, MATRIX& d2v, vector<double>& params);
+
+
 ///============ Propagators  ===========================
 ///  In ivr_propagators.cpp
 void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt);
+void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, std::string potential, vector<double>& pot_params);
+void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, ivr_vdv_fn vdv, vector<double>& pot_params);
 
 
 
 ///============ TCF calculators  ===========================
 ///  In ivr_timecorr.cpp
 
+class ivr_tcf_pair{
+/**
+  The on-the-fly TCF contributions of a pair of trajectories: the initial overlaps and
+  normalization are computed once, the Maslov indices are tracked along the trajectories
+*/
+
+  ivr_params* prms;                 ///< parameters of CSs
+  int ivr_opt;                      ///< 0 (FF_MQC), 1 (DHK)
+  double normC;                     ///< normalization of the FF_MQC
+  complex<double> OverlapR;         ///< the initial overlap ratio
+  vector<int> Maslov;               ///< Maslov indices
+  vector<complex<double> > prev;    ///< prefactors at the previous time
+
+public:
+
+  ivr_tcf_pair(ivr_params& prms_, MATRIX& q0, MATRIX& p0, MATRIX& qp0, MATRIX& pp0, int ivr_opt_);
+
+  complex<double> contribution(MATRIX& q, MATRIX& p, double action, vector<MATRIX>& Mono,
+                               MATRIX& qp, MATRIX& pp, double actionp, int observable_type, int observable_label);
+
+};
+
+
 void compute_tcf(vector< complex<double> >& TCF, vector<int>& MCnum,
                  vector<MATRIX>& q, vector<MATRIX>& p, vector<int>& status,
                  int ivr_opt, int observable_type, int observable_label);
@@ -154,6 +192,15 @@ void compute_tcf(vector< complex<double> >& TCF, vector<int>& MCnum,
 
 void normalize_tcf(vector< complex<double> >& TCF, vector<int>& MCnum);
 
+
+///============ Driver  ===========================
+///  In ivr_driver.cpp
+
+void ivr_run_tcf(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms, MATRIX& mass,
+                 std::string potential, vector<double>& pot_params,
+                 int ivr_opt, int observable_type, int observable_label,
+                 double dt, int nsteps_per_point, int num_samples, int seed, double tol);
+
 }// namespace libivr
 }// liblibra
 
@@ -0,0 +1,349 @@
+/*********************************************************************************
+* Copyright (C) 2018 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file ivr_driver.cpp
+  \brief The registry of the model potentials and the parallel driver that samples the initial
+  conditions, propagates the trajectories with the monodromy matrices, and accumulates the TCF
+  on the fly
+
+*/
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+#include <map>
+#include <random>
+
+#include "ivr.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+/// libivr namespace
+namespace libivr{
+
+
+
+static void ivr_pot_params(std::string name, vector<double>& params, int Ndof, int npar){
+/**
+  Check that there are either npar parameters (same for all DOFs) or npar * Ndof (per DOF)
+*/
+
+  if(params.size()!=npar && params.size()!=npar*Ndof){
+    cout<<"Error in the \""<<name<<"\" potential: expected "<<npar<<" or "<<npar*Ndof<<" parameters, but got "
+        <<params.size()<<"\n";
+    exit(0);
+  }
+
+}
+
+
+static void ivr_harmonic(MATRIX& q, double& v, MATRIX& dv, MATRIX& d2v, vector<double>& params){
+/**
+  \brief Harmonic potential: V = sum_i 0.5 * k_i * q_i^2
+
+  params = [k] (same for all DOFs) or [k_0, k_1, ...]
+*/
+
+  int Ndof = q.n_rows;
+  ivr_pot_params("harmonic", params, Ndof, 1);
+
+  v = 0.0;  dv = 0.0;  d2v = 0.0;
+
+  for(int i=0; i<Ndof; i++){
+    double k = params[ params.size()==1 ? 0 : i ];
+    double x = q.get(i,0);
+
+    v += 0.5 * k * x * x;
+    dv.set(i, 0, k * x);
+    d2v.set(i, i, k);
+  }
+
+}
+
+
+static void ivr_morse(MATRIX& q, double& v, MATRIX& dv, MATRIX& d2v, vector<double>& params){
+/**
+  \brief Morse potential: V = sum_i D_i * (1 - exp(-alpha_i * (q_i - q0_i)))^2
+
+  params = [D, alpha, q0] (same for all DOFs) or [D_0, alpha_0, q0_0, D_1, alpha_1, q0_1, ...]
+*/
+
+  int Ndof = q.n_rows;
+  ivr_pot_params("morse", params, Ndof, 3);
+
+  v = 0.0;  dv = 0.0;  d2v = 0.0;
+
+  for(int i=0; i<Ndof; i++){
+    int indx = (params.size()==3) ? 0 : 3*i;
+    double D = params[indx];
+    double alp = params[indx+1];
+    double e = exp(-alp * (q.get(i,0) - params[indx+2]));
+
+    v += D * (1.0 - e) * (1.0 - e);
+    dv.set(i, 0, 2.0 * D * alp * e * (1.0 - e));
+    d2v.set(i, i, 2.0 * D * alp * alp * e * (2.0 * e - 1.0));
+  }
+
+}
+
+
+static void ivr_anharmonic(MATRIX& q, double& v, MATRIX& dv, MATRIX& d2v, vector<double>& params){
+/**
+  \brief Anharmonic potential: V = sum_i ( 0.5 * k_i * q_i^2 + a3_i * q_i^3 + a4_i * q_i^4 )
+
+  params = [k, a3, a4] (same for all DOFs) or [k_0, a3_0, a4_0, k_1, a3_1, a4_1, ...]
+*/
+
+  int Ndof = q.n_rows;
+  ivr_pot_params("anharmonic", params, Ndof, 3);
+
+  v = 0.0;  dv = 0.0;  d2v = 0.0;
+
+  for(int i=0; i<Ndof; i++){
+    int indx = (params.size()==3) ? 0 : 3*i;
+    double k = params[indx];
+    double a3 = params[indx+1];
+    double a4 = params[indx+2];
+    double x = q.get(i,0);
+
+    v += x * x * (0.5 * k + x * (a3 + a4 * x));
+    dv.set(i, 0, x * (k + x * (3.0 * a3 + 4.0 * a4 * x)));
+    d2v.set(i, i, k + x * (6.0 * a3 + 12.0 * a4 * x));
+  }
+
+}
+
+
+static std::map<std::string, ivr_vdv_fn>& ivr_potentials(){
+/**
+  The registry of the potentials, initialized with the built-in models on the first use
+*/
+
+  static std::map<std::string, ivr_vdv_fn> reg = {
+    {"harmonic", &ivr_harmonic}, {"morse", &ivr_morse}, {"anharmonic", &ivr_anharmonic}
+  };
+
+  return reg;
+}
+
+
+void ivr_register_potential(std::string name, ivr_vdv_fn vdv){
+/**
+  \brief Make a C++ potential available to the Integrator and the driver under a given name
+  \param[in] name - the name of the potential; an existing entry is replaced
+  \param[in] vdv - the function computing the potential, its gradient, and Hessian
+
+  Register the potentials before the parallel calculations start
+*/
+
+  ivr_potentials()[name] = vdv;
+
+}
+
+
+ivr_vdv_fn ivr_get_potential(std::string name){
+/**
+  \brief Find the registered potential by its name
+  \param[in] name - the name of the potential: "harmonic", "morse", "anharmonic", or a user-registered one
+*/
+
+  std::map<std::string, ivr_vdv_fn>::iterator it = ivr_potentials().find(name);
+
+  if(it==ivr_potentials().end()){
+    cout<<"Error in ivr_get_potential: the potential \""<<name<<"\" is not registered\n";
+    exit(0);
+  }
+
+  return it->second;
+
+}
+
+
+double ivr_vdv(std::string name, MATRIX& q, MATRIX& dv, MATRIX& d2v, vector<double>& params){
+/**
+  \brief Evaluate the registered potential
+  \param[in] name - the name of the potential
+  \param[in] q - coordinates (Ndof x 1 matrix)
+  \param[out] dv - the gradient (Ndof x 1 matrix)
+  \param[out] d2v - the Hessian (Ndof x Ndof matrix)
+  \param[in] params - parameters of the potential
+
+  Returns the potential energy
+*/
+
+  double v = 0.0;
+  ivr_get_potential(name)(q, v, dv, d2v, params);
+
+  return v;
+
+}
+
+
+
+static double ivr_energy(MATRIX& q, MATRIX& p, MATRIX& mass, ivr_vdv_fn vdv, vector<double>& pot_params,
+                         MATRIX& dv, MATRIX& d2v){
+/**
+  The total energy of the trajectory; mass is diagonal, as in the Integrator
+*/
+
+  double v = 0.0;
+  vdv(q, v, dv, d2v, pot_params);
+
+  for(int i=0; i<q.n_rows; i++){  v += 0.5 * p.M[i] * p.M[i] / mass.get(i,i);  }
+
+  return v;
+
+}
+
+
+void ivr_run_tcf(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms, MATRIX& mass,
+                 std::string potential, vector<double>& pot_params,
+                 int ivr_opt, int observable_type, int observable_label,
+                 double dt, int nsteps_per_point, int num_samples, int seed, double tol){
+/**
+  \brief Compute the unnormalized TCF by the Monte Carlo sampling of the pairs of trajectories
+
+  Each sample draws a pair of the initial phase space points (ivr_FF_MQC or ivr_DHK), propagates both
+  trajectories with the monodromy matrices in the registered potential, and adds its contribution
+  to the TCF at every time point. Trajectories are not stored. The samples run in parallel, each with
+  its own random number stream, so the same samples are drawn for a given seed regardless of the
+  number of threads.
+
+  \param[in/out] TCF - the storage for the unnormalized TCF; its size defines the number of time points
+  \param[in/out] MCnum - a counter of the successful trajectory pairs at every time point
+  \param[in] prms - parameters of CSs
+  \param[in] mass - masses of all DOFs, a Ndof x Ndof matrix
+  \param[in] potential - the name of the registered potential (see ivr_register_potential)
+  \param[in] pot_params - parameters of the potential
+  \param[in] ivr_opt - option for slection of the type of the IVR: 0 (FF_MQC),  1 (DHK)
+  \param[in] observable_type - a selector of the observable type: 0 - coordinates, 1 - momenta
+  \param[in] observable_label - a selector of a specific DOF
+  \param[in] dt - integration timestep
+  \param[in] nsteps_per_point - the number of integration steps between the consecutive time points
+  \param[in] num_samples - the number of Monte Carlo samples (pairs of trajectories)
+  \param[in] seed - the seed of the random number streams
+  \param[in] tol - a trajectory is discarded from the time point when its energy drift exceeds
+             tol * max(1, |E0|) or the symplecticity of its monodromy matrix is violated by more than tol
+
+*/
+
+  int Ntime = TCF.size();
+  int Ndof = prms.Ndof;
+
+  if(MCnum.size()!=Ntime){
+    cout<<"Error in ivr_run_tcf: the sizes of TCF ("<<Ntime<<") and MCnum ("<<MCnum.size()<<") differ\n";
+    exit(0);
+  }
+  if(ivr_opt!=0 && ivr_opt!=1){
+    cout<<"Error in ivr_run_tcf: ivr_opt = "<<ivr_opt<<" is not supported, use 0 (FF_MQC) or 1 (DHK)\n";
+    exit(0);
+  }
+
+  ivr_vdv_fn vdv = ivr_get_potential(potential);
+
+  MATRIX qIn(prms.get_qIn());
+  MATRIX pIn(prms.get_pIn());
+  MATRIX Width0(prms.get_Width0());
+  MATRIX TuningQ(prms.get_TuningQ());
+  MATRIX TuningP(prms.get_TuningP());
+
+
+  #pragma omp parallel
+  {
+    vector< complex<double> > tcf(Ntime, complex<double>(0.0, 0.0));
+    vector<int> mcnum(Ntime, 0);
+
+    MATRIX I(Ndof, Ndof);  I.Init_Unit_Matrix(1.0);
+    MATRIX dv(Ndof, 1);
+    MATRIX d2v(Ndof, Ndof);
+    MATRIX S(Ndof, Ndof);
+    vector<double> ksi(4*Ndof);
+
+    vector<MATRIX> q(2, MATRIX(Ndof, 1)), p(2, MATRIX(Ndof, 1));
+    vector< vector<MATRIX> > Mono(2, vector<MATRIX>(4, MATRIX(Ndof, Ndof)));
+    vector<double> action(2), E0(2);
+
+
+    #pragma omp for schedule(dynamic)
+    for(int sample=0; sample<num_samples; sample++){
+
+      std::seed_seq sseq{seed, sample};
+      std::mt19937_64 gen(sseq);
+      std::normal_distribution<double> normal(0.0, 1.0);
+
+      for(int i=0; i<4*Ndof; i++){  ksi[i] = normal(gen);  }
+
+      MATRIX x0(Ndof, 4);
+      if(ivr_opt==0){  x0 = ivr_FF_MQC(qIn, pIn, Width0, TuningQ, TuningP, ksi);  }
+      else{  x0 = ivr_DHK(qIn, pIn, Width0, ksi);  }
+
+      for(int k=0; k<2; k++){
+        for(int i=0; i<Ndof; i++){
+          q[k].set(i, 0, x0.get(i, 2*k));
+          p[k].set(i, 0, x0.get(i, 2*k+1));
+        }
+        Mono[k][0] = I;  Mono[k][1] = 0.0;  Mono[k][2] = 0.0;  Mono[k][3] = I;
+        action[k] = 0.0;
+
+        E0[k] = ivr_energy(q[k], p[k], mass, vdv, pot_params, dv, d2v);
+      }
+
+      ivr_tcf_pair pair(prms, q[0], p[0], q[1], p[1], ivr_opt);
+
+      for(int t=0; t<Ntime; t++){
+
+        if(t>0){
+          for(int k=0; k<2; k++){
+            for(int n=0; n<nsteps_per_point; n++){
+              double ds = 0.0;
+              Integrator(q[k], p[k], Mono[k], ds, mass, dt, vdv, pot_params);
+              action[k] += ds;
+            }
+          }
+        }
+
+        // Stop following the pair once either trajectory goes bad
+        int status = 1;
+        for(int k=0; k<2; k++){
+          double E = ivr_energy(q[k], p[k], mass, vdv, pot_params, dv, d2v);
+          if(!(fabs(E - E0[k]) <= tol * std::max(1.0, fabs(E0[k])))){  status = 0;  }
+
+          S = Mono[k][0].T() * Mono[k][3] - Mono[k][2].T() * Mono[k][1] - I;
+          if(!(S.max_elt() <= tol)){  status = 0;  }
+        }
+        if(status==0){  break;  }
+
+        mcnum[t] += 1;
+        tcf[t] += pair.contribution(q[0], p[0], action[0], Mono[0], q[1], p[1], action[1], observable_type, observable_label);
+
+      }// for t
+
+    }// for sample
+
+
+    #pragma omp critical
+    {
+      for(int t=0; t<Ntime; t++){
+        TCF[t] += tcf[t];
+        MCnum[t] += mcnum[t];
+      }
+    }
+
+  }// omp parallel
+
+}
+
+
+
+}/// namespace libivr
+}/// liblibra
+
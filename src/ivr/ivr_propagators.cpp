@@ -57,6 +57,27 @@ MATRIX divm(MATRIX& M, MATRIX& mass){
 
 
 void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt){
+/**
+  \brief Symplectic integrator for the free particle (no potential) - see the version with the potential
+*/
+
+  vector<double> pot_params;
+  Integrator(q, p, M, action, mass, dt, NULL, pot_params);
+
+}
+
+
+void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, std::string potential, vector<double>& pot_params){
+/**
+  \brief Symplectic integrator with the potential registered under the name `potential` (see ivr_register_potential)
+*/
+
+  Integrator(q, p, M, action, mass, dt, ivr_get_potential(potential), pot_params);
+
+}
+
+
+void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, ivr_vdv_fn vdv, vector<double>& pot_params){
 /**
   \brief Symplectic integrator
 
@@ -67,7 +88,11 @@ void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX&
   \param[in/out] action - action 
   \param[in] mass - massed associated with all DOFs, a Ndof x Ndof matrix
   \param[in] dt - integration timestep
+  \param[in] vdv - the function computing the potential, its gradient, and Hessian at given q;
+             NULL - free particle
+  \param[in] pot_params - parameters of the potential, passed to vdv
 
+  Returns the action accumulated over this step in `action`
 
 */
   int Ndof = q.n_rows;
@@ -93,8 +118,7 @@ void Integrator(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX&
   for(int j=0;j<4;j++){ 
 
    if(j>0){
-      ///   call vdv(q,v,dv,d2v)  !!! FIXME: Need to connect to the 
-      ///                         potential/derivative calculation                                 
+      if(vdv!=NULL){  vdv(q, v, dv, d2v, pot_params);  }
 
       action   = action - b[j] * v;
       p   = p - b[j] * dv;
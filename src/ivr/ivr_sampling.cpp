@@ -178,15 +178,45 @@ MATRIX ivr_DHK(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, Random& rnd){
   
   int Ndof = qIn.n_rows;
 
+  vector<double> ksi(4*Ndof);
+  for(int i=0; i<4*Ndof; i++){  ksi[i] = rnd.normal();  }
+
+  return ivr_DHK(qIn, pIn, Width0, ksi);
+
+}
+
+
+MATRIX ivr_DHK(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, vector<double>& ksi){
+/**
+  \brief Multi-dimensional  DHK-IVR MonteCarlo with the externally-generated random numbers
+  \param[in] qIn - initial coordinates (Ndof x 1 matrix)
+  \param[in] pIn - initial momenta (Ndof x 1 matrix)
+  \param[in] Width0 - a Ndof x Ndof matrix with the width parameters of coherent states (CS) 
+  \param[in] ksi - 4*Ndof standard normal random numbers, used in the order: q0, p0, q0', p0' for each DOF
+
+  This is the same as the version with the Random object, but the caller controls the random
+  number stream (e.g. one stream per Monte Carlo sample in the parallel calculations)
+
+  Return value: a Ndof x 4 matrix with q (column 0) and p (column 1), q' (column 2), p' (column 3)
+
+*/
+
+  int Ndof = qIn.n_rows;
+
+  if(ksi.size()<4*Ndof){
+    cout<<"Error in ivr_DHK: need "<<4*Ndof<<" random numbers, but only "<<ksi.size()<<" are given\n";
+    exit(0);
+  }
+
   MATRIX res(Ndof,4);  
 
   for(int i=0; i<Ndof; i++){
 
     double s = sqrt(Width0.get(i,i));
-    res.set(i, 0, (1.0/s) * rnd.normal() + qIn.get(i,0) );  // q0
-    res.set(i, 1,    s    * rnd.normal() + pIn.get(i,0) );  // p0
-    res.set(i, 2, (1.0/s) * rnd.normal() + qIn.get(i,0) );  // q0'
-    res.set(i, 3,    s    * rnd.normal() + pIn.get(i,0) );  // p0'
+    res.set(i, 0, (1.0/s) * ksi[4*i+0] + qIn.get(i,0) );  // q0
+    res.set(i, 1,    s    * ksi[4*i+1] + pIn.get(i,0) );  // p0
+    res.set(i, 2, (1.0/s) * ksi[4*i+2] + qIn.get(i,0) );  // q0'
+    res.set(i, 3,    s    * ksi[4*i+3] + pIn.get(i,0) );  // p0'
 
 
   }// for i
@@ -376,6 +406,38 @@ MATRIX ivr_FF_MQC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MAT
   
   int Ndof = qIn.n_rows;
 
+  vector<double> ksi(4*Ndof);
+  for(int i=0; i<4*Ndof; i++){  ksi[i] = rnd.normal();  }
+
+  return ivr_FF_MQC(qIn, pIn, Width0, TuningQ, TuningP, ksi);
+
+}
+
+
+MATRIX ivr_FF_MQC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, vector<double>& ksi){
+/**
+  \brief Multi-dimensional  FF-MQC-IVR MonteCarlo with the externally-generated random numbers
+  \param[in] qIn - initial coordinates (Ndof x 1 matrix)
+  \param[in] pIn - initial momenta (Ndof x 1 matrix)
+  \param[in] Width0 - a Ndof x Ndof matrix with the width parameters of coherent states (CS) 
+  \param[in] TuningQ - a Ndof x Ndof matrix , cq,  see theory
+  \param[in] TuningP - a Ndof x Ndof matrix , cp, see theory
+  \param[in] ksi - 4*Ndof standard normal random numbers, used in the order: qav, pav, Dq0, Dp0 for each DOF
+
+  This is the same as the version with the Random object, but the caller controls the random
+  number stream (e.g. one stream per Monte Carlo sample in the parallel calculations)
+
+  Return value: a Ndof x 4 matrix with q0, p0, q0', p0'
+
+*/
+
+  int Ndof = qIn.n_rows;
+
+  if(ksi.size()<4*Ndof){
+    cout<<"Error in ivr_FF_MQC: need "<<4*Ndof<<" random numbers, but only "<<ksi.size()<<" are given\n";
+    exit(0);
+  }
+
   MATRIX res(Ndof,4);  
 
   for(int i=0; i<Ndof; i++){
@@ -384,10 +446,10 @@ MATRIX ivr_FF_MQC(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MAT
     double sq = 1.0/sqrt(TuningQ.get(i,i));
     double sp = 1.0/sqrt(TuningP.get(i,i));
 
-    double qav = (1.0/s) * rnd.normal() + qIn.get(i,0);
-    double pav = s * rnd.normal() + pIn.get(i,0);
-    double Dq0 = sq    * rnd.normal();
-    double Dp0 = sp    * rnd.normal();
+    double qav = (1.0/s) * ksi[4*i+0] + qIn.get(i,0);
+    double pav = s * ksi[4*i+1] + pIn.get(i,0);
+    double Dq0 = sq    * ksi[4*i+2];
+    double Dp0 = sp    * ksi[4*i+3];
 
     res.set(i, 0,  qav - 0.5 * Dq0);  // q0
     res.set(i, 1,  pav - 0.5 * Dp0);  // p0
@@ -138,154 +138,168 @@ void compute_tcf(vector< complex<double> >& TCF, vector<int>& MCnum,  ivr_params
 
 */
 
-  int i;
-  int Ndof = q[0].n_rows;
   int Ntime = TCF.size();
 
-  for(i = 0; i < Ntime; i++){   MCnum[i] += status[i] * statusp[i];     }
+  for(int i = 0; i < Ntime; i++){   MCnum[i] += status[i] * statusp[i];     }
 
+  ivr_tcf_pair pair(prms, q[0], p[0], qp[0], pp[0], ivr_opt);
 
-  MATRIX qIn(prms.get_qIn());
-  MATRIX pIn(prms.get_pIn());
-  MATRIX Width0(prms.get_Width0()); 
-  MATRIX invWidth0(prms.get_invWidth0());
-  MATRIX WidthT(prms.get_WidthT()); 
-  MATRIX invWidthT(prms.get_invWidthT());
-  MATRIX TuningQ(prms.get_TuningQ());
-  MATRIX invTuningQ(prms.get_invTuningQ());
-  MATRIX TuningP(prms.get_TuningP());
-  MATRIX invTuningP(prms.get_invTuningP());
+  for(int i = 0; i < Ntime; i++){  
 
+    if(status[i]==1 && statusp[i]==1){
 
+      TCF[i] = TCF[i] + pair.contribution(q[i], p[i], action[i], Mono[i], qp[i], pp[i], actionp[i], observable_type, observable_label);
 
-  if(ivr_opt==0){  /// FF_MQC
+    }
+  } // for i
 
+}
 
-    MATRIX norm(Ndof, Ndof); norm  = invTuningQ * invTuningP;
-    double normC = 1.0;
-    for(i = 0; i<Ndof; i++){   normC = normC * norm.get(i,i);   }
-    normC = sqrt(normC);
 
 
-    MATRIX qav(Ndof, 1); qav = 0.5*(q[0] + qp[0]);
-    MATRIX pav(Ndof, 1); pav = 0.5*(p[0] + pp[0]);
+ivr_tcf_pair::ivr_tcf_pair(ivr_params& prms_, MATRIX& q0, MATRIX& p0, MATRIX& qp0, MATRIX& pp0, int ivr_opt_){
+/**
+  \brief Prepare the TCF contributions of a pair of trajectories started at (q0, p0) and (qp0, pp0)
 
-    complex<double> ovlp = CS_overlap(qav, pav, qIn, pIn, Width0, invWidth0);
-    double sampling = (std::conj(ovlp) * ovlp).real();
+  \param[in] prms_ - parameters of CSs
+  \param[in] q0, p0 - initial phase space point of the first trajectory
+  \param[in] qp0, pp0 - initial phase space point of the second ("primed") trajectory
+  \param[in] ivr_opt_ - option for slection of the type of the IVR: 0 (FF_MQC),  1 (DHK)
 
+*/
 
-    // INITIAL COHERENT STATE OVERLAPS
-    ovlp  = CS_overlap(q[0],  p[0],  qIn, pIn, Width0, invWidth0);
-    complex<double> ovlpp = CS_overlap(qp[0], pp[0], qIn, pIn, Width0, invWidth0);
+  prms = &prms_;
+  ivr_opt = ivr_opt_;
 
-    // OVERLAP RATIO
-    complex<double> OverlapR = (std::conj(ovlpp) * ovlp)/sampling;
+  int Ndof = q0.n_rows;
 
+  MATRIX qIn(prms->get_qIn());
+  MATRIX pIn(prms->get_pIn());
+  MATRIX Width0(prms->get_Width0()); 
+  MATRIX invWidth0(prms->get_invWidth0());
 
-    int Maslov  = 0;
-    complex<double> prev(1.0, 0.0);
+  Maslov = vector<int>(2, 0);
+  prev = vector<complex<double> >(2, complex<double>(1.0, 0.0));
+  normC = 1.0;
+  OverlapR = complex<double>(0.0, 0.0);
 
-    for(i = 0; i < Ntime; i++){  
 
-      if(status[i]==1 && statusp[i]==1){
+  if(ivr_opt==0){  /// FF_MQC
 
+    MATRIX norm(Ndof, Ndof); norm  = prms->get_invTuningQ() * prms->get_invTuningP();
+    for(int i = 0; i<Ndof; i++){   normC = normC * norm.get(i,i);   }
+    normC = sqrt(normC);
 
-        // POSITION MATRIX ELEMENT AT TIME t
-        complex<double> posn = mat_elt_FF_B(q[i], p[i], qp[i], pp[i], WidthT, invWidthT, observable_type, observable_label);
 
-        // MONODROMY MATRICES FOR PREFACTOR
-        vector<CMATRIX> Mfwd(4);  
-        Mfwd[0] = CMATRIX(Mono[i][0]);
-        Mfwd[1] = CMATRIX(Mono[i][1]);
-        Mfwd[2] = CMATRIX(Mono[i][2]);
-        Mfwd[3] = CMATRIX(Mono[i][3]);
+    MATRIX qav(Ndof, 1); qav = 0.5*(q0 + qp0);
+    MATRIX pav(Ndof, 1); pav = 0.5*(p0 + pp0);
 
-        vector<CMATRIX> Mbck(4);  
-        Mbck[0] = CMATRIX(Mono[i][3]).T();
-        Mbck[1] =-1.0 * CMATRIX(Mono[i][1]).T();
-        Mbck[2] =-1.0 * CMATRIX(Mono[i][2]).T();
-        Mbck[3] = CMATRIX(Mono[i][0]).T();
+    complex<double> ovlp = CS_overlap(qav, pav, qIn, pIn, Width0, invWidth0);
+    double sampling = (std::conj(ovlp) * ovlp).real();
 
-        // CALCULATE PREFACTOR
-        complex<double> pref;
-        pref = MQC_prefactor_FF_G( Mfwd, Mbck, prms);
 
+    // INITIAL COHERENT STATE OVERLAPS
+    ovlp  = CS_overlap(q0,  p0,  qIn, pIn, Width0, invWidth0);
+    complex<double> ovlpp = CS_overlap(qp0, pp0, qIn, pIn, Width0, invWidth0);
 
-        // TRACK MASLOV INDEX
-        if ((std::abs(pref)<0.0) && (pref.imag()*prev.imag()<0.0) ) { Maslov = Maslov + 1; }
-        prev  = pref;
+    // OVERLAP RATIO
+    OverlapR = (std::conj(ovlpp) * ovlp)/sampling;
 
-        // CALCULATE TCF
-        double argg = action[i] - actionp[i];
-        TCF[i] = TCF[i] + normC * OverlapR * pow(-1.0, Maslov) * posn * sqrt(pref) * complex<double>(cos(argg), sin(argg));
+  }/// FF_QMC
 
-      }
-    } // for i
+  else if(ivr_opt==1){  /// DHK
 
-  }/// FF_QMC
+    // INITIAL COHERENT STATE OVERLAPS
+    complex<double> ovlp  = CS_overlap(q0,  p0,  qIn, pIn, Width0, invWidth0);
+    complex<double> ovlpp = CS_overlap(qp0, pp0, qIn, pIn, Width0, invWidth0);
 
+    // OVERLAP RATIO
+    OverlapR = 1.0/(std::conj(ovlpp) * ovlp);
 
-  if(ivr_opt==1){  /// DHK
+  }// DHK
 
-    vector<int> Maslov(2, 0);
-    vector<complex<double> > pref(2, complex<double>(1.0, 0.0)); 
-    vector<complex<double> > prev(2, complex<double>(1.0, 0.0)); 
+}
 
 
-    // INITIAL COHERENT STATE OVERLAPS
-    complex<double> ovlp  = CS_overlap(q[0],  p[0],  qIn, pIn, Width0, invWidth0);
-    complex<double> ovlpp = CS_overlap(qp[0], pp[0], qIn, pIn, Width0, invWidth0);
+complex<double> ivr_tcf_pair::contribution(MATRIX& q, MATRIX& p, double action, vector<MATRIX>& Mono,
+                                           MATRIX& qp, MATRIX& pp, double actionp, int observable_type, int observable_label){
+/**
+  \brief The contribution of the pair of trajectories to the unnormalized TCF at the current time
 
-    // OVERLAP RATIO
-    complex<double> OverlapR = 1.0/(std::conj(ovlpp) * ovlp);
+  \param[in] q, p - the current phase space point of the first trajectory
+  \param[in] action - the current action of the first trajectory
+  \param[in] Mono - the current monodromy matrix of the first trajectory (Mqq, Mqp, Mpq, Mpp)
+  \param[in] qp, pp - the current phase space point of the second trajectory
+  \param[in] actionp - the current action of the second trajectory
+  \param[in] observable_type - a selector of the observable type: 0 - coordinates, 1 - momenta
+  \param[in] observable_label - a selector of a specific DOF 
 
+  Must be called for the consecutive times, since the Maslov index is tracked along the trajectories
+*/
 
+  if(ivr_opt!=0 && ivr_opt!=1){ return complex<double>(0.0, 0.0); }
 
-    for(i = 0; i < Ntime; i++){  
+  int Ndof = q.n_rows;
 
-      if(status[i]==1 && statusp[i]==1){
+  MATRIX WidthT(prms->get_WidthT()); 
+  MATRIX invWidthT(prms->get_invWidthT());
 
-        // POSITION MATRIX ELEMENT AT TIME t
-        complex<double> posn = mat_elt_FF_B(q[i], p[i], qp[i], pp[i], WidthT, invWidthT, observable_type, observable_label);
+  // POSITION MATRIX ELEMENT AT TIME t
+  complex<double> posn = mat_elt_FF_B(q, p, qp, pp, WidthT, invWidthT, observable_type, observable_label);
 
-        // MONODROMY MATRICES FOR PREFACTOR
-        vector<CMATRIX> Mfwd(4);  
-        Mfwd[0] = CMATRIX(Mono[i][0]);
-        Mfwd[1] = CMATRIX(Mono[i][1]);
-        Mfwd[2] = CMATRIX(Mono[i][2]);
-        Mfwd[3] = CMATRIX(Mono[i][3]);
+  // MONODROMY MATRICES FOR PREFACTOR
+  vector<CMATRIX> Mfwd(4, CMATRIX(Ndof, Ndof));
+  Mfwd[0] = CMATRIX(Mono[0]);
+  Mfwd[1] = CMATRIX(Mono[1]);
+  Mfwd[2] = CMATRIX(Mono[2]);
+  Mfwd[3] = CMATRIX(Mono[3]);
 
-        vector<CMATRIX> Mbck(4);  
-        Mbck[0] = CMATRIX(Mono[i][3]).T();
-        Mbck[1] =-1.0 * CMATRIX(Mono[i][1]).T();
-        Mbck[2] =-1.0 * CMATRIX(Mono[i][2]).T();
-        Mbck[3] = CMATRIX(Mono[i][0]).T();
+  vector<CMATRIX> Mbck(4, CMATRIX(Ndof, Ndof));
+  Mbck[0] = CMATRIX(Mono[3]).T();
+  Mbck[1] =-1.0 * CMATRIX(Mono[1]).T();
+  Mbck[2] =-1.0 * CMATRIX(Mono[2]).T();
+  Mbck[3] = CMATRIX(Mono[0]).T();
 
-        // CALCULATE PREFACTOR
-        pref = DHK_prefactor(Mfwd, Mbck, prms);
+  double argg = action - actionp;
+  complex<double> res(0.0, 0.0);
 
-        // TRACK MASLOV INDEX
-        if ((std::abs(pref[0])<0.0) && (pref[0].imag()*prev[0].imag()<0.0) ) { Maslov[0] = Maslov[0] + 1; }
-        if ((std::abs(pref[1])<0.0) && (pref[1].imag()*prev[1].imag()<0.0) ) { Maslov[1] = Maslov[1] + 1; }
-        prev  = pref;
+  if(ivr_opt==0){  /// FF_MQC
 
+    // CALCULATE PREFACTOR
+    complex<double> pref;
+    pref = MQC_prefactor_FF_G( Mfwd, Mbck, *prms);
 
-        // CALCULATE TCF
-        double argg = action[i] - actionp[i];
-        TCF[i] = TCF[i] + OverlapR * pow(-1.0, Maslov[0]+Maslov[1]) * posn * sqrt(pref[0]*pref[1]) * complex<double>(cos(argg), sin(argg));
+    // TRACK MASLOV INDEX
+    if ((std::abs(pref)<0.0) && (pref.imag()*prev[0].imag()<0.0) ) { Maslov[0] = Maslov[0] + 1; }
+    prev[0]  = pref;
 
+    // CALCULATE TCF
+    res = normC * OverlapR * pow(-1.0, Maslov[0]) * posn * sqrt(pref) * complex<double>(cos(argg), sin(argg));
 
-      }// if trajectories are included
+  }/// FF_QMC
 
-    }// for i
+  else if(ivr_opt==1){  /// DHK
 
-  }// DHK
+    // CALCULATE PREFACTOR
+    vector<complex<double> > pref = DHK_prefactor(Mfwd, Mbck, *prms);
 
+    // TRACK MASLOV INDEX
+    if ((std::abs(pref[0])<0.0) && (pref[0].imag()*prev[0].imag()<0.0) ) { Maslov[0] = Maslov[0] + 1; }
+    if ((std::abs(pref[1])<0.0) && (pref[1].imag()*prev[1].imag()<0.0) ) { Maslov[1] = Maslov[1] + 1; }
+    prev  = pref;
 
+    // CALCULATE TCF
+    res = OverlapR * pow(-1.0, Maslov[0]+Maslov[1]) * posn * sqrt(pref[0]*pref[1]) * complex<double>(cos(argg), sin(argg));
+
+  }// DHK
+
+  return res;
 
 }
 
 
+
+
 void normalize_tcf(vector< complex<double> >& TCF, vector<int>& MCnum){
 /**
   \brief A generic routine to normalized TCF
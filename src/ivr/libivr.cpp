@@ -89,9 +89,11 @@ void export_ivr_objects(){
 
   MATRIX (*expt_ivr_DHK_v1)(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, Random& rnd) = &ivr_DHK;
   vector<MATRIX> (*expt_ivr_DHK_v2)(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, Random& rnd, int sample_size) = &ivr_DHK;
+  MATRIX (*expt_ivr_DHK_v3)(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, vector<double>& ksi) = &ivr_DHK;
 
   def("ivr_DHK", expt_ivr_DHK_v1);
   def("ivr_DHK", expt_ivr_DHK_v2);
+  def("ivr_DHK", expt_ivr_DHK_v3);
 
 
   MATRIX (*expt_ivr_FB_MQC_v1)(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, int flag, Random& rnd) = &ivr_FB_MQC;
@@ -103,9 +105,11 @@ void export_ivr_objects(){
 
   MATRIX (*expt_ivr_FF_MQC_v1)(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, Random& rnd) = &ivr_FF_MQC;
   vector<MATRIX> (*expt_ivr_FF_MQC_v2)(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, Random& rnd, int sample_size) = &ivr_FF_MQC;
+  MATRIX (*expt_ivr_FF_MQC_v3)(MATRIX& qIn, MATRIX& pIn, MATRIX& Width0, MATRIX& TuningQ, MATRIX& TuningP, vector<double>& ksi) = &ivr_FF_MQC;
 
   def("ivr_FF_MQC", expt_ivr_FF_MQC_v1);
   def("ivr_FF_MQC", expt_ivr_FF_MQC_v2);
+  def("ivr_FF_MQC", expt_ivr_FF_MQC_v3);
 
 
   ///============ Matrix Elements and Overlaps ===========================
@@ -163,7 +167,16 @@ void export_ivr_objects(){
   ///============ Propagators  ===========================
   ///  In ivr_propagators.cpp
   void (*expt_Integrator_v1)(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt) = &Integrator;
+  void (*expt_Integrator_v2)(MATRIX& q, MATRIX& p, vector<MATRIX>& M, double& action, MATRIX& mass, double dt, 
+                             std::string potential, vector<double>& pot_params) = &Integrator;
   def("Integrator", expt_Integrator_v1);
+  def("Integrator", expt_Integrator_v2);
+
+
+  ///============ Potentials  ===========================
+  ///  In ivr_driver.cpp
+  double (*expt_ivr_vdv_v1)(std::string name, MATRIX& q, MATRIX& dv, MATRIX& d2v, vector<double>& params) = &ivr_vdv;
+  def("ivr_vdv", expt_ivr_vdv_v1);
 
 
 
@@ -188,6 +201,15 @@ void export_ivr_objects(){
   def("normalize_tcf", expt_normalize_tcf_v1);
 
 
+  ///============ Driver  ===========================
+  ///  In ivr_driver.cpp
+  void (*expt_ivr_run_tcf_v1)(vector< complex<double> >& TCF, vector<int>& MCnum, ivr_params& prms, MATRIX& mass,
+                 std::string potential, vector<double>& pot_params,
+                 int ivr_opt, int observable_type, int observable_label,
+                 double dt, int nsteps_per_point, int num_samples, int seed, double tol) = &ivr_run_tcf;
+  def("ivr_run_tcf", expt_ivr_run_tcf_v1);
+
+
 
 } // export_ivr_objects()
 
@@ -548,6 +548,12 @@ def run_dynamics(_q, _p, _iM, _Cdia, _Cadi, _projectors, _states, _dyn_params, c
                 in the coordinate space, that is   ~exp(-alpha*(P-P0)^2 ) [ default: 0.0 ]
 
 
+            * **dyn_params["is_nbra"]** ( int ): whether all trajectories share the same vibronic Hamiltonian (NBRA):
+
+                - 0: no, each trajectory is propagated with its own Hamiltonian [ default ]
+                - 1: yes, the electronic propagator is computed once per step and applied to all trajectories at once
+
+
             * **dyn_params["decoherence_algo"]** ( int ): selector of the method to incorporate decoherence:
 
                 - -1: no decoherence [ default ]
@@ -659,7 +665,7 @@ def run_dynamics(_q, _p, _iM, _Cdia, _Cadi, _projectors, _states, _dyn_params, c
                        "decoherence_times_type":0, "decoherence_C_param":1.0, 
                        "decoherence_eps_param":0.1, "dephasing_informed":0,
                        "ave_gaps":AG, "instantaneous_decoherence_variant":1, "collapse_option":0,
-                       "ensemble":0, "thermostat_params":{},
+                       "ensemble":0, "thermostat_params":{}, "is_nbra":0,
                        "dt":1.0*units.fs2au, "nsteps":1, 
                        "hdf5_output_level":-1, "prefix":"out"
                      }
@@ -926,6 +932,12 @@ def run_dynamics_old(_q, _p, _iM, _Cdia, _Cadi, _projectors, _states, _dyn_param
                 in the coordinate space, that is   ~exp(-alpha*(P-P0)^2 ) [ default: 0.0 ]
 
 
+            * **dyn_params["is_nbra"]** ( int ): whether all trajectories share the same vibronic Hamiltonian (NBRA):
+
+                - 0: no, each trajectory is propagated with its own Hamiltonian [ default ]
+                - 1: yes, the electronic propagator is computed once per step and applied to all trajectories at once
+
+
             * **dyn_params["decoherence_algo"]** ( int ): selector of the method to incorporate decoherence:
 
                 - -1: no decoherence [ default ]
@@ -1048,7 +1060,7 @@ def run_dynamics_old(_q, _p, _iM, _Cdia, _Cadi, _projectors, _states, _dyn_param
                        "decoherence_times_type":0, "decoherence_C_param":1.0, 
                        "decoherence_eps_param":0.1, "dephasing_informed":0,
                        "ave_gaps":AG, "instantaneous_decoherence_variant":1, "collapse_option":0,
-                       "ensemble":0, "thermostat_params":{},
+                       "ensemble":0, "thermostat_params":{}, "is_nbra":0,
                        "dt":1.0*units.fs2au, "nsteps":1, 
                        "output_level":-1, "file_output_level":-1, "prefix":"tmp"
                      }
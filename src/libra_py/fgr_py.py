@@ -121,14 +121,13 @@ def run_NEFGRL_populations(omega_DA, V, omega_nm, gamma_nm, req_nm, shift_NE, pa
         f = open(filename, "w"); f.close()
 
 
+    # All the rates k(t') and populations exp(- int dt' k(t')) in one C++ call
+    res = NEFGRL_population_incremental(omega_DA, V, omega_nm, gamma_nm, req_nm, shift_NE, method, beta, dyn_type, dtau, tmax, dt)
+
     for step in range(0,nsteps):
         t = step*dt
-
-        # k = k(t')
-        k = NEFGRL_rate(t, omega_DA, V, omega_nm, gamma_nm, req_nm, shift_NE, method, beta, dyn_type, dtau)
-
-        summ += k * dt;
-        P = math.exp(-summ)  # exp(- int dt' k(t'))
+        k = res.get(step, 1)
+        P = res.get(step, 2)
 
         if do_output:
             f = open(filename, "a")
@@ -144,6 +143,71 @@ def run_NEFGRL_populations(omega_DA, V, omega_nm, gamma_nm, req_nm, shift_NE, pa
 
 
 
+def run_NEFGRL_scan(omega_DA, V, T, method, bath, baths, params):
+    """
+
+    Noneq FGR populations for a whole grid of parameters (e.g. a scan over the donor-acceptor gaps,
+    couplings, temperatures, methods, and bath discretizations) computed in one multi-threaded C++ call.
+    The bath preprocessing is done once per bath and is shared by all the points that use it.
+
+    Args:
+        omega_DA ( list of doubles ): energy gaps between donor and acceptor states for all points [units: a.u.]
+        V ( list of doubles ): electronic couplings for all points [units: a.u.]
+        T ( list of doubles ): bath temperatures for all points [units: K]
+        method ( list of ints ): the methods for all points, see ```run_NEFGRL_populations```
+        bath ( list of ints ): the index of the bath in ```baths``` used by every point
+        baths ( list of tuples ): the baths - tuples (omega_nm, gamma_nm, req_nm, shift_NE), with
+            the same meaning as the arguments of ```run_NEFGRL_populations```
+
+        params ( dictionary ): parameters controlling the execution of the calculations
+
+            * **params["tmax"]**, **params["dt"]**, **params["dtau"]**, **params["dyn_type"]**
+                - same as in ```run_NEFGRL_populations```, common for all points
+
+    Returns: 
+        list of tuples: (time, rate, pop) - for every point, same as returned by ```run_NEFGRL_populations```
+
+    Example:
+        Populations for 3 temperatures and 2 couplings for the same Ohmic bath:
+
+        >>> omega_nm, gamma_nm, req_nm, shift_NE = ... # e.g. from S_omega_ohmic and compute_req
+        >>> T, V = [], []
+        >>> for t in [100.0, 200.0, 300.0]:
+        >>>     for v in [0.001, 0.002]:
+        >>>         T.append(t); V.append(v)
+        >>> res = run_NEFGRL_scan([0.01]*6, V, T, [0]*6, [0]*6, [(omega_nm, gamma_nm, req_nm, shift_NE)], params)
+
+    """
+
+    critical_params = [  ] 
+    default_params = {  "dyn_type":0, 
+                        "dtau":0.02 * units.fs2au, "tmax":10.0 * units.fs2au, "dt":0.1 * units.fs2au
+                     }
+    comn.check_input(params, default_params, critical_params)
+
+    beta = [ 1.0 / (units.kB * t) for t in T ]
+
+    omega_nm, gamma_nm, req_nm, shift_NE = doubleList2(), doubleList2(), doubleList2(), doubleList2()
+    for b in baths:
+        omega_nm.append(Py2Cpp_double(list(b[0])))
+        gamma_nm.append(Py2Cpp_double(list(b[1])))
+        req_nm.append(Py2Cpp_double(list(b[2])))
+        shift_NE.append(Py2Cpp_double(list(b[3])))
+
+    res = NEFGRL_population_scan(Py2Cpp_double(list(omega_DA)), Py2Cpp_double(list(V)), Py2Cpp_double(beta),
+                                 Py2Cpp_int(list(method)), Py2Cpp_int(list(bath)),
+                                 omega_nm, gamma_nm, req_nm, shift_NE,
+                                 params["dyn_type"], params["dtau"], params["tmax"], params["dt"])
+
+    out = []
+    for r in res:
+        nsteps = r.num_of_rows
+        out.append( ( [ r.get(i,0) for i in range(nsteps) ], [ r.get(i,1) for i in range(nsteps) ], [ r.get(i,2) for i in range(nsteps) ] ) )
+
+    return out
+
+
+
 def run_NEFRG_acf(t, omega_DA, V, omega_nm, gamma_nm, req_nm, shift_NE, params):
     """
 
@@ -538,6 +538,50 @@ def compute_dynmat(R, D, M, E, params):
  
 
 
+def compute_dynmat_ham(ham, R, M, E, params):
+    """
+
+    Computes the normal modes of an atomistic Hamiltonian at its present geometry. The Hessian
+    is not stored in the Hamiltonian object: it is assembled from the Hessian-vector products
+    (finite differences of the analytic gradients), one per DOF, and then mass-weighted to 
+    give the dynamic matrix:   D_ij = [1/sqrt(m_i * m_j)]  d^2E/dR_i dR_j
+
+    Args:
+        ham ( Hamiltonian_Atomistic ): the Hamiltonian bound to the system at the geometry of interest
+        R ( MATRIX(ndof x nsteps-1) ): coordinates of all DOFs (only used for visualization)
+        M ( MATRIX(ndof x 1) ): masses of all DOFs
+        E ( list of ndof/3 strings): atom names (elements) of all atoms
+        params ( dictionary ): parameters controlling the computations, in addition to those of 
+            the compute_dynmat function, it can contain:
+
+            * **params["state"]** ( int ): index of the electronic state whose energy Hessian is used [ default: 0 ]
+            * **params["dq"]** ( double ): finite-difference step for the Hessian-vector products, Bohr [ default: 0.001 ]
+
+    Returns:
+        tuple: (w, w_inv_cm, U_a), see the description of the compute_dynmat function
+
+    """
+
+    st = 0
+    if "state" in params:
+        st = params["state"]
+    dq = 0.001
+    if "dq" in params:
+        dq = params["dq"]
+
+    ndof = M.num_of_rows
+
+    H = ham.compute_hessian(st, dq)
+
+    D = MATRIX(ndof, ndof)
+    for i in range(0,ndof):
+        for j in range(0,ndof):
+            D.set(i, j, H.get(i,j) / math.sqrt(M.get(i,0) * M.get(j,0)) )
+
+    return compute_dynmat(R, D, M, E, params)
+
+
+
 def get_xyz(E, R, M, U, mode):
     """
 
@@ -289,15 +289,19 @@ def compute_dm(ham, Cdia, Cadi, projectors, rep, lvl):
 
             #c.permute_rows(iM)
             dm_tmp = c * c.H()
-            dm_adi = dm_adi + dm_tmp
 
             S = ham.get_ovlp_dia(indx)
             U = ham.get_basis_transform(indx)     
             # correct_phase(U) 7/20/2019 - I don't think this does anything
             su = S * U
             dm_dia = dm_dia + su * dm_tmp * su.H()
-    
-    dm_dia = dm_dia / float(ntraj)        
+
+    if rep==1:
+        # The adiabatic density matrix does not need any transformations, so it is
+        # computed for all trajectories at once: sum_traj { c * c^+ } = Cadi * Cadi^+
+        dm_adi = Cadi * Cadi.H()
+
+    dm_dia = dm_dia / float(ntraj)
     dm_adi = dm_adi / float(ntraj)
 
     return dm_dia, dm_adi
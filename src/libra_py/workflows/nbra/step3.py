@@ -224,17 +224,22 @@ def apply_state_reordering(St, E, params):
                 Available options:
                     - 1: older version developed by Kosuke Sato, may not the working all the times
                     - 2: Munkres-Kuhn (Hungarian) method [default]
+                    - 4: Jonker-Volgenant method - the same assignment as in 2, found faster
+                    - 5: Munkres-Kuhn method applied to the blocks of strongly overlapping states only
 
             * **params["state_reordering_alpha"]** ( double ): a parameter that controls how 
                 many states will be included in the reordering
 
+            * **params["state_reordering_tol"]** ( double ): the overlap threshold defining the blocks
+                of states for the option 5 [default: 0.01]
+
     Returns:
         None: but changes the input St object
 
     """
 
     critical_params = [ ]
-    default_params = { "do_state_reordering":2, "state_reordering_alpha":0.0 }
+    default_params = { "do_state_reordering":2, "state_reordering_alpha":0.0, "state_reordering_tol":0.01 }
     comn.check_input(params, default_params, critical_params)
 
     nsteps = len(St)
@@ -243,6 +248,8 @@ def apply_state_reordering(St, E, params):
     alp = list(range(0,nstates))
     bet = list(range(nstates, 2*nstates))
 
+    perm_id = Py2Cpp_int(list(range(0,nstates)))
+
     # Initialize the cumulative permutation as the identity permutation
     perm_cum_aa = intList() # cumulative permutation for alpha spatial orbitals
     perm_cum_bb = intList() # cumulative permutation for beta  spatial orbtials
@@ -286,9 +293,10 @@ def apply_state_reordering(St, E, params):
             E[i].permute_rows(perm_cum)
 
 
-        elif params["do_state_reordering"]==2:
+        elif params["do_state_reordering"] in [2, 4, 5]:
             """
-            The Hungarian approach
+            The Hungarian approach (2), and the same assignment problem solved with the 
+            Jonker-Volgenant algorithm (4) or for each block of strongly overlapping states (5)
             """
 
             pop_submatrix(St[i], aa, alp, alp); pop_submatrix(St[i], ab, alp, bet)
@@ -302,20 +310,34 @@ def apply_state_reordering(St, E, params):
             ba.permute_rows(perm_t_bb);   bb.permute_rows(perm_t_bb)
 
 
-            # compute the cost matrices for diagonal blocks
-            cost_mat_aa = make_cost_mat(aa, en_mat_aa, params["state_reordering_alpha"])
-            cost_mat_bb = make_cost_mat(bb, en_mat_bb, params["state_reordering_alpha"])          
+            if params["do_state_reordering"]==2:
+                # compute the cost matrices for diagonal blocks
+                cost_mat_aa = make_cost_mat(aa, en_mat_aa, params["state_reordering_alpha"])
+                cost_mat_bb = make_cost_mat(bb, en_mat_bb, params["state_reordering_alpha"])          
 
-            # Solve the optimal assignment problem for diagonal blocks
-            res_aa = hungarian.maximize(cost_mat_aa)
-            res_bb = hungarian.maximize(cost_mat_bb)
+                # Solve the optimal assignment problem for diagonal blocks
+                res_aa = hungarian.maximize(cost_mat_aa)
+                res_bb = hungarian.maximize(cost_mat_bb)
    
 
-            # Convert the list of lists into the permutation object
-            for ra in res_aa:
-                perm_t_aa[ra[0]] = ra[1]  # for < alpha | alpha > this becomes a new value: perm_t = P_{n+1}
-            for rb in res_bb:
-                perm_t_bb[rb[0]] = rb[1]  # for < beta | beta > this becomes a new value: perm_t = P_{n+1}   
+                # Convert the list of lists into the permutation object
+                for ra in res_aa:
+                    perm_t_aa[ra[0]] = ra[1]  # for < alpha | alpha > this becomes a new value: perm_t = P_{n+1}
+                for rb in res_bb:
+                    perm_t_bb[rb[0]] = rb[1]  # for < beta | beta > this becomes a new value: perm_t = P_{n+1}   
+
+            else:
+                # The rows are already permuted with P_n, so the identity is the guess for P_{n+1}
+                if params["do_state_reordering"]==4:
+                    res_aa = Jonker_Volgenant(aa, en_mat_aa, params["state_reordering_alpha"], perm_id, 0)
+                    res_bb = Jonker_Volgenant(bb, en_mat_bb, params["state_reordering_alpha"], perm_id, 0)
+                else:
+                    res_aa = get_block_reordering(aa, en_mat_aa, params["state_reordering_alpha"], params["state_reordering_tol"])
+                    res_bb = get_block_reordering(bb, en_mat_bb, params["state_reordering_alpha"], params["state_reordering_tol"])
+
+                for a in range(0,nstates):
+                    perm_t_aa[a] = res_aa[a]
+                    perm_t_bb[a] = res_bb[a]
 
             # Permute the blocks by col
             aa.permute_cols(perm_t_aa);  ab.permute_cols(perm_t_bb)
@@ -670,12 +692,17 @@ def run(S_dia_ks, St_dia_ks, E_dia_ks, params):
                 - 0: no state reordering - same as in Pyxaid
                 - 1: older method (is not robust, may or may not work) 
                 - 2: Hungarian algorithm [default]
+                - 4: Jonker-Volgenant algorithm - the same assignment as in 2
+                - 5: Hungarian algorithm for each block of strongly overlapping states only
 
             * **params["state_reordering_alpha"]** ( double ): the parameter that controls the width of 
                 the energy interval within wich the state reordering is in effect. Zero value means all 
                 available orbitals, larger positive value decreases the width of the window. This parameter
                 is not in effect unless the Hungarian algorithm is selected [default: 0.0]
 
+            * **params["state_reordering_tol"]** ( double ): the overlap threshold defining the blocks of 
+                states for do_state_reordering = 5 [default: 0.01]
+
             * **params["do_phase_correction"]** ( int ): option to do the phase correction
 
                 - 0 - don't do 
@@ -695,6 +722,12 @@ def run(S_dia_ks, St_dia_ks, E_dia_ks, params):
             * **params["Hvib_im_suffix"]** ( string ): common suffix of the output files with imaginary part of the vibronic 
                 Hamiltonian at all times [default: "_im"]
 
+            * **params["use_cpp_engine"]** ( int ): whether to do the processing with the C++ implementation
+                (```nbra_step3```), which handles all the data sets and timesteps in one call and in parallel:
+
+                - 0: use the Python functions of this module [default]
+                - 1: use the C++ implementation
+
     Returns:
         list of lists of CMATRIX(N,N): Hvib, such that:
             Hvib[idata][istep] is a CMATRIX(N,N) containing the vibronic Hamiltonian for the 
@@ -709,12 +742,12 @@ def run(S_dia_ks, St_dia_ks, E_dia_ks, params):
     critical_params = [ "SD_basis", "SD_energy_corr", "CI_basis", "output_set_paths" ]
     default_params = { "dt":1.0*units.fs2au, 
                        "do_orthogonalization":0,
-                       "do_state_reordering":2, "state_reordering_alpha":0.0,
+                       "do_state_reordering":2, "state_reordering_alpha":0.0, "state_reordering_tol":0.01,
                        "do_phase_correction":1,
                        "do_output":0,
                        "Hvib_re_prefix":"Hvib_", "Hvib_im_prefix":"Hvib_",
                        "Hvib_re_suffix":"_re", "Hvib_im_suffix":"_im",
-
+                       "use_cpp_engine":0
                      }
     comn.check_input(params, default_params, critical_params)
  
@@ -742,31 +775,74 @@ def run(S_dia_ks, St_dia_ks, E_dia_ks, params):
     #====== Calculations  ===============
     H_vib = []
 
+    if params["use_cpp_engine"]==1:
+
+        # Do all the stages 1 - 5 (see below) for all data sets in C++
+        S_map, St_map, E_map = CMATRIXMap(), CMATRIXMap(), CMATRIXMap()
+        for idata in range(0,ndata):
+            S_map.append(Py2Cpp_CMATRIX(S_dia_ks[idata]))
+            St_map.append(Py2Cpp_CMATRIX(St_dia_ks[idata]))
+            E_map.append(Py2Cpp_CMATRIX(E_dia_ks[idata]))
+
+        sd_basis = intList2()
+        for sd in params["SD_basis"]:
+            sd_basis.append(Py2Cpp_int(sd))
+
+        n_chi = len(params["CI_basis"])
+        n_phi = len(params["CI_basis"][0])
+        CI_basis = CMATRIX(n_phi, n_chi)
+        for j in range(0,n_chi):
+            for i in range(0,n_phi):
+                CI_basis.set(i, j, params["CI_basis"][j][i]*(1.0+0.0j) )
+
+        cpp_params = { "dt":dt, "do_orthogonalization":do_orthogonalization,
+                       "do_state_reordering":do_state_reordering,
+                       "state_reordering_alpha":params["state_reordering_alpha"],
+                       "state_reordering_tol":params["state_reordering_tol"],
+                       "do_phase_correction":do_phase_correction }
+
+        hvib_map = nbra_step3(S_map, St_map, E_map, sd_basis, Py2Cpp_double(params["SD_energy_corr"]), CI_basis, cpp_params)
+
+        # Keep the in-place changes of the input, the same way the Python version does
+        for idata in range(0,ndata):
+            for i in range(0,len(St_dia_ks[idata])):
+                St_dia_ks[idata][i] = CMATRIX(St_map[idata][i])
+                E_dia_ks[idata][i] = CMATRIX(E_map[idata][i])
+
+            H_vib.append( [ CMATRIX(hvib_map[idata][i]) for i in range(0,nsteps) ] )
+
+
     for idata in range(0,ndata):
 
-        # 1. Do the KS orbitals orthogonalization 
-        if do_orthogonalization > 0:
-            apply_normalization(S_dia_ks[idata], St_dia_ks[idata])
+        if params["use_cpp_engine"]==1:
+            Hvib = H_vib[idata]
 
-        # 2. Apply state reordering to KS
-        if do_state_reordering > 0:
-            apply_state_reordering(St_dia_ks[idata], E_dia_ks[idata], params)
+        else:
+            # 1. Do the KS orbitals orthogonalization 
+            if do_orthogonalization > 0:
+                apply_normalization(S_dia_ks[idata], St_dia_ks[idata])
+
+            # 2. Apply state reordering to KS
+            if do_state_reordering > 0:
+                apply_state_reordering(St_dia_ks[idata], E_dia_ks[idata], params)
+
+            # 3. Apply phase correction to KS
+            if do_phase_correction > 0:
+                apply_phase_correction(St_dia_ks[idata])
 
-        # 3. Apply phase correction to KS
-        if do_phase_correction > 0:
-            apply_phase_correction(St_dia_ks[idata])
-       
-        
-        Hvib = []
-        for i in range(0,nsteps):
-        
-            # 4. Construct the Hvib in the basis of Slater determinants (SDs)
-            hvib_sd = compute_Hvib(params["SD_basis"], St_dia_ks[idata][i], E_dia_ks[idata][i], params["SD_energy_corr"], dt) 
-      
-            # 5. Convert the Hvib to the basis of symmery-adapted configurations (SAC)
-            SD2CI = sac_matrices(params["CI_basis"], params["SD_basis"], S_dia_ks[idata][i])
-            hvib_ci = SD2CI.H() * hvib_sd * SD2CI
-            Hvib.append( hvib_ci )
+
+            Hvib = []
+            for i in range(0,nsteps):
+
+                # 4. Construct the Hvib in the basis of Slater determinants (SDs)
+                hvib_sd = compute_Hvib(params["SD_basis"], St_dia_ks[idata][i], E_dia_ks[idata][i], params["SD_energy_corr"], dt) 
+
+                # 5. Convert the Hvib to the basis of symmery-adapted configurations (SAC)
+                SD2CI = sac_matrices(params["CI_basis"], params["SD_basis"], S_dia_ks[idata][i])
+                hvib_ci = SD2CI.H() * hvib_sd * SD2CI
+                Hvib.append( hvib_ci )
+
+            H_vib.append(Hvib)
 
 
         if do_output:
@@ -777,9 +853,6 @@ def run(S_dia_ks, St_dia_ks, E_dia_ks, params):
                 Hvib[i].real().show_matrix(re_filename)
                 Hvib[i].imag().show_matrix(im_filename)
 
-
-        H_vib.append(Hvib)        
-        
     return H_vib
 
 
@@ -175,6 +175,108 @@ def get_Hvib2(params):
     return H_vib
 
 
+def convert_Hvib2(params):
+    """Converts several sets of vibronic Hamiltonian text files into a single binary Hvib store
+
+    The files are read one at a time, so the conversion doesn't need to keep the whole data in memory.
+    The resulting file can be opened with :func:`load_Hvib_store`
+
+    Args:
+        params ( dictionary ): parameters controlling the function execution
+
+            Required parameter keys:
+
+            * **params["Hvib_store_file"]** ( string ): the name of the binary file to create [Required!]
+            * **params["Hvib_store_sparse"]** ( int ): the storage format of the Hvib matrices [default: 0]
+
+                - 0: dense - all the matrix elements are stored
+                - 1: sparse - the diagonal and only the off-diagonal elements (NACs) with the absolute
+                     values larger than params["Hvib_store_threshold"] are stored
+
+            * **params["Hvib_store_threshold"]** ( double ): the threshold for keeping the off-diagonal
+                elements in the sparse format [ units: same as Hvib, default: 0.0 ]
+
+            .. note::
+                In addition, requires parameters described in
+                :func:`libra_py.workflows.nbra.step4.get_Hvib2`
+
+    Example:
+
+        >>> params["Hvib_store_file"] = "Hvib.bin"
+        >>> convert_Hvib2(params)
+        >>> Hvib = load_Hvib_store("Hvib.bin")
+        >>> run(Hvib, params)
+
+    """
+
+    critical_params = [ "data_set_paths", "nstates", "nfiles", "Hvib_re_prefix", "Hvib_im_prefix", "Hvib_store_file" ]
+    default_params = { "Hvib_re_suffix":"_re", "Hvib_im_suffix":"_im", "active_space":range(params["nstates"]),
+                       "Hvib_store_sparse":0, "Hvib_store_threshold":0.0 }
+    comn.check_input(params, default_params, critical_params)
+
+    paths = StringList()
+    for path in params["data_set_paths"]:
+        paths.append(path)
+
+    hvib_store_convert(params["Hvib_store_file"], paths,
+                       params["Hvib_re_prefix"], params["Hvib_re_suffix"],
+                       params["Hvib_im_prefix"], params["Hvib_im_suffix"],
+                       params["nstates"], params["nfiles"], Py2Cpp_int(list(params["active_space"])),
+                       params["Hvib_store_sparse"], params["Hvib_store_threshold"])
+
+
+class Hvib_store_frames:
+    """The read-only sequence of the Hvib matrices of one data set of the binary Hvib store.
+    The frames are read from the memory-mapped file on demand, so hvib[time] behaves as in
+    the list of CMATRIX objects returned by :func:`get_Hvib`
+    """
+
+    def __init__(self, store, idata):
+        self.store = store
+        self.idata = idata
+        self.nframes = store.get_nframes(idata)
+
+    def __len__(self):
+        return self.nframes
+
+    def __getitem__(self, i):
+        if isinstance(i, slice):
+            return [ self[k] for k in range(*i.indices(self.nframes)) ]
+        if i < 0:
+            i += self.nframes
+        if i < 0 or i >= self.nframes:
+            raise IndexError("Hvib_store_frames index out of range")
+        return self.store.get_frame(self.idata, i)
+
+    def __iter__(self):
+        for i in range(self.nframes):
+            yield self.store.get_frame(self.idata, i)
+
+
+def load_Hvib_store(filename):
+    """Opens the binary Hvib store created by :func:`convert_Hvib2` (or by the C++ hvib_store_write function)
+
+    Args:
+        filename ( string ): the name of the binary Hvib store file
+
+    Returns:
+        list of Hvib_store_frames: Hvib:
+            the read-only time series of Hvib matrices for all data sets, such that
+            Hvib[idata][time] is a CMATRIX for the data set indexed by `idata`
+            at time `time` - same as returned by :func:`get_Hvib2`, but the matrices
+            are read from the memory-mapped file only when accessed.
+
+    .. note::
+        The returned object can be used with :func:`run`, but not with :func:`transform_data`,
+        which modifies the Hvib matrices in place
+
+    """
+
+    store = Hvib_store(filename)
+
+    return [ Hvib_store_frames(store, idata) for idata in range(store.ndata) ]
+
+
 
 def traj_statistics(i, Coeff, istate, Hvib, itimes):
     """Compute the averages over the TSH-ensembles
@@ -375,64 +477,17 @@ def traj_statistics2_fast(i, Pop, istate, Hvib, itimes):
     nitimes = len(itimes)            # how many initial times
     ntraj = int(Ntraj/(ndata * nitimes))  # how many stochastic SH trajectories per data set/initial condition
 
-
-    E_adi_ave =  MATRIX(nstates, 1) # E for each state averaged over the data sets/initial times
-    ave_pop_sh = MATRIX(nstates, 1) # SH populations averaged over the data sets/initial times
-    ave_pop_se = MATRIX(nstates, 1) # SE populations averaged over the data sets/initial times
-    ave_en_sh = 0.0  # SH-population-weighted energy
-    ave_en_se = 0.0  # SE-population-weighted energy
-
-
-    # Temporary
-    ene = MATRIX(nstates, 1)
-    pop = MATRIX(nstates, 1)
-
+    # The Hamiltonians for all data sets/initial times and the index of the one used by each trajectory
+    frames = []
     for idata in range(0,ndata):
         for it_indx in range(0,nitimes):
-            it = itimes[it_indx]
-
-            for st in range(nstates):
-                ene.set(st, 0, Hvib[idata][it+i].get(st, st).real )
-
-            E_adi_ave += ene
-
-            for tr in range(0,ntraj):                
-                Tr = idata*(nitimes*ntraj) + it_indx*(ntraj) + tr
-
-                ave_pop_sh.add(istate[Tr], 0, 1.0) 
-                ave_en_sh += ene.get(istate[Tr], 0)
-
-                pop = Pop[Tr].real()
-                ave_pop_se += pop
-                ave_en_se += (ene.T() * pop).get(0,0)
-                
-
-    nrm1 = (1.0/float(ndata * nitimes))
-    nrm2 = nrm1/float(ntraj)
-
-    E_adi_ave *= nrm1
-    ave_pop_sh *= nrm2
-    ave_pop_se *= nrm2
-    ave_en_sh *= nrm2
-    ave_en_se *= nrm2
-
+            frames.append(Hvib[idata][itimes[it_indx]+i])
 
-    # Save the computed data into a matrix to be output
-    res = MATRIX(1, 3*nstates+4) 
-   
-    tot_sh, tot_se = 0.0, 0.0
-    for j in range(0,nstates):
-        res.set(0, 3*j+0, E_adi_ave.get(j,0))   # Energy of the state j
-        res.set(0, 3*j+1, ave_pop_se.get(j,0))  # SE population
-        res.set(0, 3*j+2, ave_pop_sh.get(j,0))  # SH population
+    ham_indx = Py2Cpp_int( [ int(Tr/ntraj) for Tr in range(0,Ntraj) ] )
 
-        tot_se += ave_pop_se.get(j,0)
-        tot_sh += ave_pop_sh.get(j,0)
-
-    res.set(0, 3*nstates+0, ave_en_se)  # Average SE energy
-    res.set(0, 3*nstates+1, ave_en_sh)  # Average SH energy
-    res.set(0, 3*nstates+2, tot_se)     # Total SE population
-    res.set(0, 3*nstates+3, tot_sh)     # Total SH population
+    # All the averaging is done in C++ in one pass over the ensemble
+    dm_se, dm_sh = CMATRIX(nstates, nstates), CMATRIX(nstates, nstates)
+    res = compute_ensemble_stat(Py2Cpp_CMATRIX(Pop), Py2Cpp_int(istate), Py2Cpp_CMATRIX(frames), ham_indx, dm_se, dm_sh, 1)
 
     return res
 
@@ -539,6 +594,24 @@ def run(H_vib, params):
             * **params["outfile"]** ( string ): the name of the file where to print populations
                 and energies of states [default: "_out.txt"]    
 
+            * **params["batched_tdse"]** ( int ): how to propagate the TD-SE amplitudes:
+
+                - 0 - each stochastic trajectory separately [ default ]
+                - 1 - the propagator exp(-i*Hvib*dt) is computed once per Hvib frame and applied to the amplitudes
+                    of all stochastic trajectories of a given data set and initial time as a single matrix-matrix 
+                    product. Only used with ```params["tdse_Ham"] == 0```, since the Boltzmann-corrected Hamiltonian 
+                    depends on the amplitudes of each trajectory
+
+            * **params["cache_propagators"]** ( int ): whether to keep the propagators computed in the batched mode,
+                so they are reused when the same Hvib frame is visited again (e.g. for overlapping initial times):
+
+                - 0 - don't keep them [ default ]
+                - 1 - keep them in memory (nstates x nstates complex numbers for each visited frame)
+
+            * **params["propagator_cache"]** ( dictionary ): an external storage for the cached propagators. Pass the same
+                dictionary to several calls of this function to reuse the propagators across the repeated runs over the
+                same Hvib data. The keys are (idata, frame, dt) [default: None - a new storage is created for each call]
+
     Returns: 
         MATRIX(nsteps, 3*nstates+5): the trajectory (and initial-condition)-averaged observables for every timesteps,
             the assumed format is: 
@@ -555,7 +628,8 @@ def run(H_vib, params):
     default_params = { "T":300.0, "ntraj":1,
                        "tdse_Ham":0, "sh_method":1, "decoherence_constants": 0, "decoherence_method":0, "dt":41.0, "Boltz_opt":3,
                        "Hvib_type":1,
-                       "istate":0, "init_times":[0], "outfile":"_out.txt" }
+                       "istate":0, "init_times":[0], "outfile":"_out.txt",
+                       "batched_tdse":0, "cache_propagators":0, "propagator_cache":None }
     comn.check_input(params, default_params, critical_params)
 
 
@@ -576,6 +650,13 @@ def run(H_vib, params):
 
     res = MATRIX(nsteps, 3*nstates+5)
 
+    # Batched propagation of the amplitudes
+    is_batched = (params["batched_tdse"]==1 and tdse_Ham==0)
+    U_cache = params["propagator_cache"]
+    if U_cache is None:
+        U_cache = {}
+    st_indx = Py2Cpp_int(list(range(nstates)))
+
 
     #========== Compute PARAMETERS  ===============
     # Decoherence times
@@ -611,6 +692,10 @@ def run(H_vib, params):
         tau_m.append(MATRIX(nstates,1))  
 
            
+    # Ensemble statistics: trajectory Tr uses the Hamiltonian of its data set/initial time
+    ens_stat = tsh_ensemble_stat(nstates)
+    ham_indx = Py2Cpp_int( [ int(Tr/ntraj) for Tr in range(0,Ntraj) ] )
+
     # Prepare the output file
     f = open(params["outfile"],"w"); f.close()
 
@@ -619,8 +704,14 @@ def run(H_vib, params):
 
 
         #============== Analysis of the Dynamics  =================
-        # Compute the averages
-        res_i = traj_statistics(i, Coeff, istate, H_vib, params["init_times"])
+        # Compute the averages - same as traj_statistics(i, Coeff, istate, H_vib, params["init_times"]),
+        # but in one C++ pass over the whole ensemble
+        frames = []
+        for idata in range(0,ndata):
+            for it in params["init_times"]:
+                frames.append(H_vib[idata][it+i])
+
+        res_i = ens_stat.update(Py2Cpp_CMATRIX(Coeff), Py2Cpp_int(istate), Py2Cpp_CMATRIX(frames), ham_indx, 0)
 
         # Print out into a file
         printout(i*dt, res_i, params["outfile"])
@@ -637,6 +728,24 @@ def run(H_vib, params):
 
                 it = params["init_times"][it_indx]
 
+                if is_batched:
+                    # All stochastic trajectories see the same Hvib: one matrix-matrix product for all of them
+                    key = (idata, it+i, dt)
+                    if key in U_cache:
+                        U = U_cache[key]
+                    else:
+                        U = compute_propagator(dt, H_vib[idata][it+i])
+                        if params["cache_propagators"]==1:
+                            U_cache[key] = U
+
+                    Tr0 = idata*(nitimes*ntraj) + it_indx*(ntraj)
+                    C_block = CMATRIX(nstates, ntraj)
+                    for tr in range(0,ntraj):
+                        push_submatrix(C_block, Coeff[Tr0+tr], st_indx, Py2Cpp_int([tr]))
+                    C_block = U * C_block
+                    for tr in range(0,ntraj):
+                        pop_submatrix(C_block, Coeff[Tr0+tr], st_indx, Py2Cpp_int([tr]))
+
                 for tr in range(0,ntraj):  # over all stochastic trajectories
 
                     Tr = idata*(nitimes*ntraj) + it_indx*(ntraj) + tr
@@ -650,7 +759,8 @@ def run(H_vib, params):
                     elif tdse_Ham==1:
                         Heff = tsh.Boltz_corr_Ham(H_vib[idata][it+i], Coeff[Tr], params["T"], params["Hvib_type"])
 
-                    propagate_electronic(dt, Coeff[Tr], Heff)   # propagate the electronic DOFs
+                    if not is_batched:
+                        propagate_electronic(dt, Coeff[Tr], Heff)   # propagate the electronic DOFs
 
         
                     # Surface hopping 
@@ -169,6 +169,9 @@ public:
   int Propagate(const MATRIX& input, MATRIX& result);
   int Propagate(boost::python::list input, boost::python::list& result, boost::python::list& derivs);
   int Propagate(const MATRIX& input, MATRIX& result, MATRIX& derivs);  
+  int Propagate_batch(const MATRIX& input, MATRIX& result);
+  int Propagate_batch(const MATRIX& input, MATRIX& result, MATRIX& derivs);
+  void AccumulateGradients(const vector<int>& patterns);
   void LearningHistory(std::string filename,std::string data_flag);
 
 
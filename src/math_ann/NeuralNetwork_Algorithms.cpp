@@ -315,38 +315,10 @@ void NeuralNetwork::ANNTrain(){
 
 
   //----------- Auxiliary variables ----------------
-  int i,j,L;
+  int i,L;
 
   vector<int> rperm;   // a random permutation
 
-  MATRIX X(sz_x,1);
-  MATRIX Target(sz_y,1);
-  MATRIX Tangent(sz_d,1);
-  MATRIX derivs(sz_y,sz_x);
-
-  vector<MATRIX> D2; // Second derivatives
-  vector<MATRIX> Tau;   // Delta(already have) and Tau 
-  vector<MATRIX> gamma,ksi; // "Conjugate" variables, ksi[L] - is basically dx[L]/dx[0]
-  MATRIX interm1(Npe[NL],Npe[NL]);
-
-  MATRIX d(3,1); d = 0.0;
-  D2.push_back(d);
-  Tau.push_back(d);
-
-  MATRIX g(sz_x,sz_x); g.Init_Unit_Matrix(1.0);
-  gamma.push_back(g);
-  ksi.push_back(g); // thus ksi[0] = I - unity matrix of size sz_x - by - sz_x
-
-  for(L=1;L<=NL;L++){
-    MATRIX d1(Npe[L],sz_x); d1 = 0.0;
-    MATRIX d2(Npe[L],Npe[L]); d2 = 0.0;
- 
-    Tau.push_back(d1);
-    D2.push_back(d2);
- 
-    gamma.push_back(d1);
-    ksi.push_back(d1);
-  }// for L  
 
 
 
@@ -460,124 +432,9 @@ void NeuralNetwork::ANNTrain(){
     // in this eapoch to train the ANN
     randperm(epoch_size,num_of_patterns,rperm);
 
-    // Initialize total gradients (summ over epoch size)
-    for (L=1;L<=NL;L++){
-      dWcurr[L] = 0.0;
-      dBcurr[L] = 0.0;
-    }
-
-    // Iterate over all subset patterns
-    for(int ep=0;ep<epoch_size;ep++){
-
-      // Pick a single pattern - inputs, outputs, and may be derivatives
-      int indx = rperm[ep];
-//      cout<<"Iteration = "<<Iteration<<" ep = "<<ep<<" indx = "<<indx<<endl;
-      
-      for(j=0;j<sz_x;j++){ X.M[j]       = Inputs[j].Data[indx];  }
-      for(j=0;j<sz_y;j++){ Target.M[j]  = Outputs[j].Data[indx]; }
-
-      if(derivs_flag){
-        for(j=0;j<sz_d;j++){ Tangent.M[j] = Derivs[j].Data[indx];  }
-      }else{
-        for(j=0;j<sz_d;j++){ Tangent.M[j] = 0.0;}
-      }
-
-      //------------------------------------
-      // Propagate forward - compute the inputs to all intermediate layers
-      // and store them in the vector Y, layer by layer:
-      // Y[0] - input layer, Y[1] - input to the first hidden layer, etc.
-      // We will also compute the derivatives of these inputs w.r.t. to 
-      // previous inputs (actually, to the previous NETs)
-      vector<MATRIX> Y;  
-
-      // 0-th item == input	
-      Y.push_back(X);
-
-      for(L=1;L<=NL;L++){
-
-        MATRIX NET(Npe[L],1);
-        MATRIX   y(Npe[L],1);
-
-        NET = W[L]*Y[L-1] + B[L];
-    
-        /**
-          Y[j] = tanh( NET[j] )    tanh(x) = ( exp(x) - exp(-x) ) / (exp(x) + exp(-x) )
-
-          dY[j]/dNET[j] = ...
-        */
-
-        D[L] = 0.0;   // first derivatives of the transfer function ( tanh(net) ) 
-        D2[L]= 0.0;   // second derivarives
-       
-        for(j=0;j<Npe[L];j++){
-
-	  y.M[j]=tanh(NET.M[j]);  
-          D[L].M[j*Npe[L]+j] = (1.0 - y.M[j]*y.M[j]); 
-          D2[L].M[j*Npe[L]+j] = -2.0*y.M[j]*D[L].M[j*Npe[L]+j]; 
-
-        }// for j
-        
-        Y.push_back(y);
-          
-        gamma[L] = W[L]*ksi[L-1];
-        ksi[L]   = D[L]*gamma[L];
-              
-    }// for L
-    
-    // Calculate the error - at the output layer
-    MATRIX e(Npe[NL],1);      e = 0.0;      // error in value
-    MATRIX tau(Npe[NL],sz_x); tau = 0.0;    // error in the derivatives
-
-
-    // Error for last (output) layer
-    for (j=0;j<Npe[NL];j++){ 
-      e.M[j]=pow((Target.M[j]-Y[NL].M[j]),(2.0*norm_exp+1));
-
-      // Also, take the derivatives into account
-      if(derivs_flag){
-        for(i=0;i<sz_x;i++){
-          tau.M[j*sz_x+i] = grad_weight*pow((Tangent.M[j*sz_x+i]-ksi[NL].M[j*sz_x+i]),(2.0*norm_exp+1));
-        }//for i
-      }              
-    }// for j
-
-
-        
-    Delta[NL] = D[NL] * e;
-    Tau[NL]   = D[NL] * tau;         
-    interm1 = (tau * (gamma[NL].T()));
-    for(i=0;i<Npe[NL];i++){Delta[NL].M[i] +=  interm1.M[i*Npe[NL]+i]*D2[NL].M[Npe[NL]*i+i]; }
-
-
-    // Calculate deltas (derivatives)
-    for(L=NL-1;L>=1;L--){
-
-      MATRIX dEdx(Npe[L],1);
-      MATRIX dEdksi(Npe[L],sz_x);
-      MATRIX interm(Npe[L],Npe[L]);
-
-      dEdx = (W[L+1].T() * Delta[L+1]);
-      dEdksi = (W[L+1].T() * Tau[L+1]);
-
-      Tau[L]   = D[L] * dEdksi;
-      Delta[L] = D[L] * dEdx;
-
-      interm = (dEdksi * (gamma[L].T()));
-
-      for(i=0;i<Npe[L];i++){Delta[L].M[i] +=  interm.M[i*Npe[L]+i]*D2[L].M[Npe[L]*i+i] ; }
-
-    }// for L
-
-    // Calculate total gradient over all training patterns in epoch
-    for (L=1;L<=NL;L++){
-
-      // These are the negative gradients
-      dWcurr[L] += learning_rate*(Delta[L]*(Y[L-1].T()) + Tau[L]*(ksi[L-1].T()) - weight_decay[L]*W[L]);
-      dBcurr[L] += learning_rate*Delta[L];
-
-    }
-
-  }// for ep - for all patterns in 1 epoch
+    // Compute the total gradients (sum over the epoch_size patterns). The patterns are
+    // propagated forward and backward in blocks, see NeuralNetwork_Batch.cpp
+    AccumulateGradients(rperm);
 
   // Now add momentum term (if it is not zero)
   if(learning_method=="BackProp"){
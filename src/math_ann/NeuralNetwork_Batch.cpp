@@ -0,0 +1,496 @@
+/*********************************************************************************
+* Copyright (C) 2015-2017 Alexey V. Akimov
+*
+* This file is distributed under the terms of the GNU General Public License
+* as published by the Free Software Foundation, either version 2 of
+* the License, or (at your option) any later version.
+* See the file LICENSE in the root directory of this distribution
+* or <http://www.gnu.org/licenses/>.
+*
+*********************************************************************************/
+/**
+  \file NeuralNetwork_Batch.cpp
+  \brief Batched forward and backward passes of the ANN: a block of patterns is pushed
+  through every layer as one matrix-matrix product, and the blocks are distributed over
+  the OpenMP threads
+
+*/
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+#include "NeuralNetwork.h"
+
+/// liblibra namespace
+namespace liblibra{
+
+using namespace boost;
+
+/// libann namespace
+namespace libann{
+
+
+/// The number of patterns processed together by one thread
+static const int ann_chunk_size = 32;
+
+
+//------------------ Row-major kernels on the raw storage ---------------------
+
+static void ann_gemm_nn(int n, int k, int m, const double* A, const double* B, double* C){
+/**  C(n x m) = A(n x k) * B(k x m)  */
+
+  for(int i=0;i<n;i++){
+    double* c = C + i*m;
+    for(int p=0;p<m;p++){ c[p] = 0.0; }
+
+    for(int l=0;l<k;l++){
+      double a = A[i*k+l];
+      const double* b = B + l*m;
+      for(int p=0;p<m;p++){ c[p] += a*b[p]; }
+    }
+  }// for i
+}
+
+static void ann_gemm_tn(int n, int k, int m, const double* A, const double* B, double* C){
+/**  C(n x m) = A^T * B,  where A is k x n and B is k x m  */
+
+  for(int i=0;i<n*m;i++){ C[i] = 0.0; }
+
+  for(int l=0;l<k;l++){
+    const double* b = B + l*m;
+    for(int i=0;i<n;i++){
+      double a = A[l*n+i];
+      double* c = C + i*m;
+      for(int p=0;p<m;p++){ c[p] += a*b[p]; }
+    }
+  }// for l
+}
+
+static void ann_gemm_nt_add(int n, int k, int m, const double* A, const double* B, double* C){
+/**  C(n x m) += A * B^T,  where A is n x k and B is m x k  */
+
+  for(int i=0;i<n;i++){
+    const double* a = A + i*k;
+    for(int j=0;j<m;j++){
+      const double* b = B + j*k;
+      double s = 0.0;
+      for(int l=0;l<k;l++){ s += a[l]*b[l]; }
+      C[i*m+j] += s;
+    }
+  }// for i
+}
+
+
+
+/**
+  Per-thread storage of the layer variables for a block of up to ann_chunk_size patterns.
+  The patterns are the fastest index: Y[L] is Npe[L] x nb, and the "conjugate" variables
+  ksi[L], gamma[L], Tau[L] are Npe[L] x (sz_x * nb) with the element (j, a, p) stored at
+  (j*sz_x + a)*nb + p, so the propagation of ksi through a layer is a single product with W[L].
+  The matrices are allocated once and reused for every block the thread processes.
+*/
+class ANNBatchWorkspace{
+
+public:
+  int nb;       ///< the number of patterns in the current block
+  int derivs;   ///< whether ksi, gamma and Tau are used
+
+  vector<MATRIX> Y;
+  vector<MATRIX> D;     ///< 1 - y^2
+  vector<MATRIX> D2;    ///< -2 y (1 - y^2)
+  vector<MATRIX> Delta;
+  vector<MATRIX> ksi;
+  vector<MATRIX> gamma;
+  vector<MATRIX> Tau;
+
+  ANNBatchWorkspace(const vector<int>& Npe, int sz_x, int _derivs){
+
+    int L, NL = Npe.size() - 1;
+
+    nb = ann_chunk_size;
+    derivs = _derivs;
+
+    for(L=0;L<=NL;L++){
+      Y.push_back(MATRIX(Npe[L], nb));
+      D.push_back(MATRIX(Npe[L], nb));
+      D2.push_back(MATRIX(Npe[L], nb));
+      Delta.push_back(MATRIX(Npe[L], nb));
+
+      if(derivs){
+        ksi.push_back(MATRIX(Npe[L], sz_x*nb));
+        gamma.push_back(MATRIX(Npe[L], sz_x*nb));
+        Tau.push_back(MATRIX(Npe[L], sz_x*nb));
+      }
+    }// for L
+  }
+
+};
+
+
+
+static void ann_batch_forward(const NeuralNetwork& ann, ANNBatchWorkspace& ws){
+/**  Forward propagation of the block stored in ws.Y[0]. Computes Y, D and D2 for all layers
+  and, if the workspace is set up for it, also ksi[L] = dY[L]/dY[0] and gamma[L] = W[L]*ksi[L-1]
+*/
+
+  int NL = ann.Nlayers - 1;
+  int sz_x = ann.Npe[0];
+  int nb = ws.nb;
+  int i, j, a, p, L;
+
+  if(ws.derivs){
+    // ksi[0] is the unit matrix for every pattern
+    double* k0 = ws.ksi[0].M;
+    for(i=0;i<sz_x*sz_x*nb;i++){ k0[i] = 0.0; }
+    for(a=0;a<sz_x;a++){
+      for(p=0;p<nb;p++){  k0[(a*sz_x + a)*nb + p] = 1.0; }
+    }
+  }
+
+  for(L=1;L<=NL;L++){
+
+    int n = ann.Npe[L];
+    int k = ann.Npe[L-1];
+    double* y  = ws.Y[L].M;
+    double* d  = ws.D[L].M;
+    double* d2 = ws.D2[L].M;
+
+    ann_gemm_nn(n, k, nb, ann.W[L].M, ws.Y[L-1].M, y);
+
+    for(j=0;j<n;j++){
+      double b = ann.B[L].M[j];
+      double* yj = y + j*nb;
+      for(p=0;p<nb;p++){ yj[p] = tanh(yj[p] + b); }
+    }
+
+    for(i=0;i<n*nb;i++){
+      d[i]  = 1.0 - y[i]*y[i];
+      d2[i] = -2.0*y[i]*d[i];
+    }
+
+    if(ws.derivs){
+      double* g  = ws.gamma[L].M;
+      double* ks = ws.ksi[L].M;
+
+      ann_gemm_nn(n, k, sz_x*nb, ann.W[L].M, ws.ksi[L-1].M, g);
+
+      for(j=0;j<n;j++){
+        for(a=0;a<sz_x;a++){
+          int off = (j*sz_x + a)*nb;
+          for(p=0;p<nb;p++){ ks[off+p] = d[j*nb+p]*g[off+p]; }
+        }
+      }
+    }// derivs
+
+  }// for L
+
+}
+
+
+
+static double ann_output_transform(const NeuralNetwork& ann, int i, double tmp){
+/**  Converts the i-th output of the ANN to the external units - the same transformation
+  as used in the single-pattern Propagate
+*/
+
+  if(ann.scale_method=="normalize_and_transform"){
+    if(tmp>=0.99){ tmp = 0.99; }
+    else if(tmp<=-0.99) { tmp = -0.99; }
+
+    tmp = 0.5*log((1.0+tmp)/(1.0-tmp));
+  }
+
+  if(ann.Outputs[i].scale_factor!=0.0){
+    tmp = (1.0/ann.Outputs[i].scale_factor)*(tmp - ann.Outputs[i].shift_amount);
+  }
+
+  return tmp;
+}
+
+
+
+static void ann_propagate_batch(NeuralNetwork& ann, const MATRIX& input, MATRIX& result, MATRIX* derivs){
+
+  int NL = ann.Nlayers - 1;
+  int sz_x = ann.sz_x;
+  int sz_y = ann.sz_y;
+  int npatt = input.n_cols;
+  int nchunks = (npatt + ann_chunk_size - 1)/ann_chunk_size;
+  int do_derivs = (derivs!=NULL);
+
+  if(input.n_rows!=sz_x){
+    std::cout<<"Error in Propagate_batch: Size of the input "<<input.n_rows
+    <<" does not match the ANN architecture "<<sz_x<<std::endl;
+    exit(0);
+  }
+  if(result.n_rows!=sz_y || result.n_cols!=npatt){
+    std::cout<<"Error in Propagate_batch: the result matrix should be "<<sz_y<<" x "<<npatt
+    <<", but it is "<<result.n_rows<<" x "<<result.n_cols<<std::endl;
+    exit(0);
+  }
+  if(do_derivs){
+    if(derivs->n_rows!=sz_y*sz_x || derivs->n_cols!=npatt){
+      std::cout<<"Error in Propagate_batch: the derivs matrix should be "<<sz_y*sz_x<<" x "<<npatt
+      <<", but it is "<<derivs->n_rows<<" x "<<derivs->n_cols<<std::endl;
+      exit(0);
+    }
+  }
+
+
+#pragma omp parallel
+  {
+    ANNBatchWorkspace ws(ann.Npe, sz_x, do_derivs);
+
+#pragma omp for schedule(dynamic, 1)
+    for(int ic=0;ic<nchunks;ic++){
+
+      int p0 = ic*ann_chunk_size;
+      int nb = (p0 + ann_chunk_size <= npatt) ? ann_chunk_size : npatt - p0;
+      int i, j, p;
+
+      ws.nb = nb;
+
+      //---------- Use the same linear transformation of input as during the training ----------
+      double* x = ws.Y[0].M;
+      for(i=0;i<sz_x;i++){
+        double sc = ann.Inputs[i].scale_factor;
+        double sh = ann.Inputs[i].shift_amount;
+        for(p=0;p<nb;p++){  x[i*nb+p] = sc * input.M[i*npatt + p0 + p] + sh; }
+      }
+
+      ann_batch_forward(ann, ws);
+
+      //------- Transformation of the output ----------------
+      const double* y = ws.Y[NL].M;
+      for(i=0;i<sz_y;i++){
+        for(p=0;p<nb;p++){  result.M[i*npatt + p0 + p] = ann_output_transform(ann, i, y[i*nb+p]); }
+      }
+
+      //--------- Linear transform of the derivatives ----------------
+      // The factors are the same as 1/Derivs[].scale_factor, but do not need the Derivs data,
+      // which is absent if the ANN was trained on the function values only
+      if(do_derivs){
+        const double* ks = ws.ksi[NL].M;
+        for(i=0;i<sz_y;i++){
+          double fy = (ann.Outputs[i].scale_factor!=0.0) ? 1.0/ann.Outputs[i].scale_factor : 1.0;
+          for(j=0;j<sz_x;j++){
+            double f = fy * ann.Inputs[j].scale_factor;
+            int off = (i*sz_x + j);
+            for(p=0;p<nb;p++){  derivs->M[off*npatt + p0 + p] = f*ks[off*nb+p]; }
+          }
+        }
+      }// do_derivs
+
+    }// for ic
+
+  }// omp parallel
+
+}
+
+
+int NeuralNetwork::Propagate_batch(const MATRIX& input, MATRIX& result){
+/**  Propagates a block of patterns through the ANN
+
+  input - sz_x x npatt matrix, each column is an input pattern (in external units)
+  result - sz_y x npatt matrix, each column is the corresponding output (in external units)
+
+  The patterns are processed in blocks of ann_chunk_size, each block with one matrix-matrix
+  product per layer. The blocks are distributed over the OpenMP threads.
+*/
+
+  ann_propagate_batch(*this, input, result, NULL);
+
+  return 0;
+}
+
+
+int NeuralNetwork::Propagate_batch(const MATRIX& input, MATRIX& result, MATRIX& derivs){
+/**  Same as above, but also computes the derivatives of the outputs w.r.t. the inputs
+
+  derivs - (sz_y*sz_x) x npatt matrix. Column p contains dY_i/dX_j of the p-th pattern at
+  the row sz_x*i + j, that is the same ordering as the derivs matrix of the single-pattern
+  Propagate
+*/
+
+  ann_propagate_batch(*this, input, result, &derivs);
+
+  return 0;
+}
+
+
+
+void NeuralNetwork::AccumulateGradients(const vector<int>& patterns){
+/**  Computes the negative gradients dWcurr and dBcurr of the error summed over the
+  training patterns listed in `patterns`. This is the minibatch version of the per-pattern
+  back-propagation of ANNTrain: the patterns are split into blocks that are handled by the
+  OpenMP threads, each thread accumulates its own partial gradients and these are summed
+  in the thread order at the end.
+*/
+
+  int NL = Nlayers - 1;
+  int npatt = patterns.size();
+  int nchunks = (npatt + ann_chunk_size - 1)/ann_chunk_size;
+  int L;
+
+  double pw = 2.0*norm_exp + 1.0;
+
+  int nthreads = 1;
+#if defined(_OPENMP)
+  nthreads = omp_get_max_threads();
+#endif
+
+  vector< vector<MATRIX> > th_dW(nthreads);
+  vector< vector<MATRIX> > th_dB(nthreads);
+
+#pragma omp parallel num_threads(nthreads)
+  {
+    int tid = 0;
+#if defined(_OPENMP)
+    tid = omp_get_thread_num();
+#endif
+
+    vector<MATRIX>& gW = th_dW[tid];
+    vector<MATRIX>& gB = th_dB[tid];
+    ANNBatchWorkspace ws(Npe, sz_x, derivs_flag);
+
+    gW.push_back(MATRIX(1,1));
+    gB.push_back(MATRIX(1,1));
+    for(int l=1;l<=NL;l++){
+      gW.push_back(MATRIX(Npe[l], Npe[l-1]));
+      gB.push_back(MATRIX(Npe[l], 1));
+    }
+
+#pragma omp for schedule(dynamic, 1)
+    for(int ic=0;ic<nchunks;ic++){
+
+      int p0 = ic*ann_chunk_size;
+      int nb = (p0 + ann_chunk_size <= npatt) ? ann_chunk_size : npatt - p0;
+      int i, j, a, p, l;
+      int ncol = sz_x*nb;
+
+      ws.nb = nb;
+
+      // Pick the patterns of this block - inputs are already in the internal units
+      double* x = ws.Y[0].M;
+      for(i=0;i<sz_x;i++){
+        for(p=0;p<nb;p++){  x[i*nb+p] = Inputs[i].Data[patterns[p0+p]]; }
+      }
+
+      ann_batch_forward(*this, ws);
+
+
+      //------------- Error at the output layer ---------------
+      double* y     = ws.Y[NL].M;
+      double* d     = ws.D[NL].M;
+      double* d2    = ws.D2[NL].M;
+      double* delta = ws.Delta[NL].M;
+
+      for(j=0;j<Npe[NL];j++){
+        for(p=0;p<nb;p++){
+          double e = Outputs[j].Data[patterns[p0+p]] - y[j*nb+p];
+          if(pw!=1.0){ e = pow(e, pw); }
+          delta[j*nb+p] = d[j*nb+p]*e;
+        }
+      }
+
+      if(derivs_flag){
+        double* ks  = ws.ksi[NL].M;
+        double* g   = ws.gamma[NL].M;
+        double* tau = ws.Tau[NL].M;
+
+        for(j=0;j<Npe[NL];j++){
+          for(a=0;a<sz_x;a++){
+            int off = (j*sz_x + a)*nb;
+            for(p=0;p<nb;p++){
+              double t = Derivs[j*sz_x+a].Data[patterns[p0+p]] - ks[off+p];
+              if(pw!=1.0){ t = pow(t, pw); }
+              t *= grad_weight;
+
+              // the diagonal of tau * gamma^T enters the value error
+              delta[j*nb+p] += d2[j*nb+p]*t*g[off+p];
+              tau[off+p] = d[j*nb+p]*t;
+            }
+          }
+        }
+      }// derivs_flag
+
+
+      //------------- Back-propagation of the errors ---------------
+      for(l=NL-1;l>=1;l--){
+
+        int n = Npe[l];
+        int k = Npe[l+1];
+        double* dl  = ws.D[l].M;
+        double* d2l = ws.D2[l].M;
+        double* del = ws.Delta[l].M;
+
+        // dE/dx = W[l+1]^T * Delta[l+1] is accumulated directly in Delta[l]
+        ann_gemm_tn(n, k, nb, W[l+1].M, ws.Delta[l+1].M, del);
+        for(i=0;i<n*nb;i++){ del[i] *= dl[i]; }
+
+        if(derivs_flag){
+          double* g   = ws.gamma[l].M;
+          double* tau = ws.Tau[l].M;
+
+          // and dE/dksi = W[l+1]^T * Tau[l+1] - in Tau[l]
+          ann_gemm_tn(n, k, ncol, W[l+1].M, ws.Tau[l+1].M, tau);
+
+          for(j=0;j<n;j++){
+            for(a=0;a<sz_x;a++){
+              int off = (j*sz_x + a)*nb;
+              for(p=0;p<nb;p++){
+                del[j*nb+p] += d2l[j*nb+p]*tau[off+p]*g[off+p];
+                tau[off+p] *= dl[j*nb+p];
+              }
+            }
+          }
+        }// derivs_flag
+
+      }// for l
+
+
+      //------------- Gradients summed over the block ---------------
+      for(l=1;l<=NL;l++){
+
+        ann_gemm_nt_add(Npe[l], nb, Npe[l-1], ws.Delta[l].M, ws.Y[l-1].M, gW[l].M);
+
+        if(derivs_flag){
+          ann_gemm_nt_add(Npe[l], ncol, Npe[l-1], ws.Tau[l].M, ws.ksi[l-1].M, gW[l].M);
+        }
+
+        const double* del = ws.Delta[l].M;
+        for(j=0;j<Npe[l];j++){
+          double s = 0.0;
+          for(p=0;p<nb;p++){ s += del[j*nb+p]; }
+          gB[l].M[j] += s;
+        }
+      }// for l
+
+    }// for ic
+
+  }// omp parallel
+
+
+  // Sum the partial gradients, add the weight decay and convert to the negative gradients
+  for(L=1;L<=NL;L++){
+
+    dWcurr[L] = 0.0;
+    dBcurr[L] = 0.0;
+
+    for(int t=0;t<nthreads;t++){
+      if(th_dW[t].size()==0){ continue; }  // the thread was not started
+      dWcurr[L] += th_dW[t][L];
+      dBcurr[L] += th_dB[t][L];
+    }
+
+    dWcurr[L] = learning_rate*(dWcurr[L] - (npatt*weight_decay[L-1])*W[L]);
+    dBcurr[L] = learning_rate*dBcurr[L];
+
+  }// for L
+
+}
+
+
+}// namespace libann
+}// namespace liblibra
+
@@ -414,6 +414,7 @@ int NeuralNetwork::SetTrainingData(object obj,int der_flag){
   }
 
   }// if derivs_flag
+  else{ sz_d = sz_x*sz_y; }
 
 
 
@@ -469,7 +470,8 @@ int NeuralNetwork::SetTrainingData(object obj,int der_flag){
           vector<double> tmp2;
 
           for(int p=0;p<num_of_patterns;p++){
-              tmp2.push_back(TrainData[p].Derivs[sz_x*i+j]);
+              // without the derivatives data, keep the zero placeholders (only the scaling is used then)
+              tmp2.push_back( derivs_flag ? TrainData[p].Derivs[sz_x*i+j] : 0.0 );
           }
 
           DATA d2(tmp2);
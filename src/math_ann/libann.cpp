@@ -34,6 +34,8 @@ int (NeuralNetwork::*Propagate1)(const MATRIX&, MATRIX&)
 int (NeuralNetwork::*Propagate2)(boost::python::list,boost::python::list&)        = &NeuralNetwork::Propagate;
 int (NeuralNetwork::*Propagate3)(const MATRIX&, MATRIX&, MATRIX&)                          = &NeuralNetwork::Propagate;
 int (NeuralNetwork::*Propagate4)(boost::python::list,boost::python::list&,boost::python::list&)        = &NeuralNetwork::Propagate;
+int (NeuralNetwork::*Propagate_batch1)(const MATRIX&, MATRIX&)                            = &NeuralNetwork::Propagate_batch;
+int (NeuralNetwork::*Propagate_batch2)(const MATRIX&, MATRIX&, MATRIX&)                   = &NeuralNetwork::Propagate_batch;
 
 
 //---------------------------------------------------------------------
@@ -188,13 +190,19 @@ ExportANN_docstring += tmp;
         .def("Propagate",Propagate2)
         .def("Propagate",Propagate3)
         .def("Propagate",Propagate4)
+        .def("Propagate_batch",Propagate_batch1)
+        .def("Propagate_batch",Propagate_batch2)
         .def("ANNTrain",&NeuralNetwork::ANNTrain)
+        .def("AccumulateGradients",&NeuralNetwork::AccumulateGradients)
         .def("LearningHistory",&NeuralNetwork::LearningHistory)
 
 
         .def_readwrite("Inputs",&NeuralNetwork::Inputs)
         .def_readwrite("Outputs",&NeuralNetwork::Outputs)
         .def_readwrite("B",&NeuralNetwork::B)
+        .def_readwrite("W",&NeuralNetwork::W)
+        .def_readwrite("dBcurr",&NeuralNetwork::dBcurr)
+        .def_readwrite("dWcurr",&NeuralNetwork::dWcurr)
          
     ;
 
@@ -361,19 +361,15 @@ void mEHT_K::set_mapping(EHT_K& eht_k, const vector<AO>& basis_ao){
 
   \param[in] eht_k The object containing the EHT parameters for generic orbital pairs, but without knowing actual orbital pairs of the
                    system.
-  \param[in] basis_ao The list of AOs of the particular system - the parameters for all pairs of these AOs will be precomputed and
-                   stored internally in the mEHT_K object
+  \param[in] basis_ao The list of AOs of the particular system - the parameters for all pairs of the orbital types present
+                   in this basis will be precomputed and stored internally in the mEHT_K object, and each AO is assigned
+                   the index of its type, so the parameters of any pair of AOs are found by integer indexing
 */
   int k;
   cout<<"In mEHT_K::set_mapping...\n";
 
   size = basis_ao.size();
 
-  for(k=0;k<5;k++){
-    eht_K[k].reserve(size*size);   eht_K[k].resize(size*size,  0.0);
-    eht_C[k].reserve(size*size);   eht_C[k].resize(size*size,  0.0);
-  }
-
   //========================= Part 1 =======================================
   map<pair<string,string>,int> at_types;
   map<pair<string,string>,int>::iterator it_type,it_type2;
@@ -401,9 +397,12 @@ void mEHT_K::set_mapping(EHT_K& eht_k, const vector<AO>& basis_ao){
 
 
   //========================= Part 2 =======================================
-  int ntyp = at_types.size(); // number of distinct orbital types
-  vector<vector<vector<double> > > k_vals(5,vector<vector<double> >(ntyp,vector<double>(ntyp,0.0)) );
-  vector<vector<vector<double> > > c_vals(5,vector<vector<double> >(ntyp,vector<double>(ntyp,0.0)) );
+  ntyp = at_types.size(); // number of distinct orbital types
+
+  for(k=0;k<5;k++){
+    eht_K[k] = vector<double>(ntyp*ntyp, 0.0);
+    eht_C[k] = vector<double>(ntyp*ntyp, 0.0);
+  }
 
   for(it_type=at_types.begin();it_type!=at_types.end();it_type++){
 
@@ -418,35 +417,23 @@ void mEHT_K::set_mapping(EHT_K& eht_k, const vector<AO>& basis_ao){
       int i2 = it_type2->second; // index of this AO type
 
       for(k=0;k<5;k++){
-        k_vals[k][i1][i2]  = eht_k.get_K_value(k,at1,sh1,at2,sh2);
-        c_vals[k][i1][i2]  = eht_k.get_C_value(k,at1,sh1,at2,sh2);
+        eht_K[k][i1*ntyp+i2]  = eht_k.get_K_value(k,at1,sh1,at2,sh2);
+        eht_C[k][i1*ntyp+i2]  = eht_k.get_C_value(k,at1,sh1,at2,sh2);
       }
 
-      //cout<<"i1= "<<i1<<" i2= "<<i2<<" at1= "<<at1<<" sh1= "<<sh1<<" at2= "<<at2<<" sh2= "<<sh2<<" k_vals[0][i1][i2]= "<<k_vals[0][i1][i2]<<endl;
+      //cout<<"i1= "<<i1<<" i2= "<<i2<<" at1= "<<at1<<" sh1= "<<sh1<<" at2= "<<at2<<" sh2= "<<sh2<<" eht_K[0][i1*ntyp+i2]= "<<eht_K[0][i1*ntyp+i2]<<endl;
 
     }// it_type2
   }// it_type
 
 
   //========================= Part 3 =======================================
+  // The types of all orbitals - this is all that is needed to find the parameters for any pair of AOs
 
+  orb_type = vector<int>(size, 0);
   for(int I=0;I<size;I++){
-
-    int i1 = at_types[std::pair<std::string,std::string>(basis_ao[I].element,basis_ao[I].ao_shell)];
-
-    for(int J=0;J<size;J++){
-
-      // New procedure
-      int i2 = at_types[std::pair<std::string,std::string>(basis_ao[J].element,basis_ao[J].ao_shell)];
-
-      //cout<<"I= "<<I<<" i1= "<<i1<<" J= "<<J<<" i2= "<<i2<<" k_vals[i1][i2]= "<<k_vals[0][i1][i2]<<endl;
-
-      for(k=0;k<5;k++){
-        eht_K[k][I*size+J]  = k_vals[k][i1][i2];
-        eht_C[k][I*size+J]  = c_vals[k][i1][i2];
-      }
-    }// for j
-  }// for i
+    orb_type[I] = at_types[std::pair<std::string,std::string>(basis_ao[I].element,basis_ao[I].ao_shell)];
+  }// for I
 
 }
 
@@ -616,17 +603,35 @@ void set_default_elements(map<std::string, pElement>& PT){
 
 
 void Model_Parameters::set_PT_mapping(const vector<AO>& basis_ao){
+/**
+  Maps the element- and shell-resolved parameters in PT onto the orbital-resolved array orb_params, so the
+  Hamiltonian builds can access the parameters of the AO i as orb_params[i], without any string look-ups.
+  The parameters are collected only once for each distinct (element, shell) pair.
+
+  \param[in] basis_ao The list of AOs of the particular system
+*/
+
 // map PT to mPT
   int size = basis_ao.size();
  
   orb_params.reserve(size);  orb_params.resize(size);
 
+  map<pair<string,string>,int> orb_types;  // (element, shell) -> the first AO of this type
+  map<pair<string,string>,int>::iterator it_type;
+
   for(int i=0;i<size;i++){
 
     std::string elt = basis_ao[i].element;
     std::string sh  = basis_ao[i].ao_shell;
 
-    pElement Elt = PT[elt];
+    std::pair<std::string,std::string> pr(elt,sh);
+    it_type = orb_types.find(pr);
+
+    if(it_type!=orb_types.end()){  orb_params[i] = orb_params[it_type->second];  continue; }
+    orb_types[pr] = i;
+
+
+    pElement& Elt = PT[elt];
     
 
     OrbParams op;
@@ -648,6 +653,23 @@ void Model_Parameters::set_PT_mapping(const vector<AO>& basis_ao){
     op.beta0 = Elt.beta0[sh];
 
 
+    // The orbital radius for the Calzaferi formula
+    double n = op.Nquant;
+    op.radius = 0.0;
+    if(op.Nzeta==1){  op.radius = n/op.zetas[0]; }
+    else if(op.Nzeta==2){
+      double z1 = op.zetas[0];
+      double z2 = op.zetas[1];
+      double c1 = op.coeffs[0];
+      double c2 = op.coeffs[1];
+
+      op.radius = n/(c1*c1*z1 + c2*c2*z2 + 
+                     ( pow(2.0,2.0*n)*pow(z1*z2, n+0.5)/pow((z1+z2),2.0*n)
+                     ) 
+                    ); 
+    }
+
+
     orb_params[i] = op;
 
   }// for i
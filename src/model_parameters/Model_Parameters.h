@@ -258,14 +258,17 @@ class mEHT_K{
 /**
   This is an efficient version of the EHT_K class - tuned for actual calculations. The efficiency is gained
   due to 1-integer index access, which is much faster than the one using 4 strings.
-  The drawback is that the storage requirements are increased - about O(N^2) with N being the number of 
-  orbitals. The data for all orbital pairs will be stored.
+  The parameters are stored for all pairs of the distinct orbital types (element + shell) present in the system,
+  and each AO keeps the index of its type (assigned in set_mapping, when the basis is known). So the storage
+  is O(Ntyp^2), with Ntyp being the number of distinct orbital types, and a look-up is a couple of array accesses.
 */
 
 public:
-  int size; ///< is the size of the matrix (N below - number of AOs in the basis)
-  vector< vector<double> > eht_K;  ///< eht_K[k_indx][I*N+J] = is the k_indx-type parameter for pair of orbitals I and J - each of special type and on special atom
-  vector< vector<double> > eht_C;  ///< eht_C[c_indx][I*N+J] = is the parameter for pair of orbitals I and J - each of special type and on special atom
+  int size; ///< is the number of AOs in the basis
+  int ntyp; ///< is the number of distinct orbital types (element + shell) in the basis
+  vector<int> orb_type;            ///< orb_type[I] = the index of the type of the AO I
+  vector< vector<double> > eht_K;  ///< eht_K[k_indx][t1*ntyp+t2] = is the k_indx-type parameter for pair of orbital types t1 and t2
+  vector< vector<double> > eht_C;  ///< eht_C[c_indx][t1*ntyp+t2] = is the parameter for pair of orbital types t1 and t2
 
     
   // Atomic-orbital pseudopotential variables
@@ -279,10 +282,13 @@ public:
 
   mEHT_K(){  
     size = -1;
+    ntyp = 1;
+    orb_type = vector<int>(1, 0);
     eht_K = vector<vector<double> >(5, vector<double>(1, 0.0));
     eht_C = vector<vector<double> >(5, vector<double>(1, 0.0));
   }
   mEHT_K(const mEHT_K& ob){
+    size = ob.size;  ntyp = ob.ntyp;  orb_type = ob.orb_type;
     eht_K   = ob.eht_K; 
     eht_C   = ob.eht_C; 
     eht_PPa = ob.eht_PPa; eht_PP0 = ob.eht_PP0;  eht_PP1 = ob.eht_PP1;  eht_PP2 = ob.eht_PP2;
@@ -291,12 +297,14 @@ public:
   void set_mapping(EHT_K& k, const vector<AO>& basis);
   void set_mapping1(EHT_K& k, int nat, vector<std::string>& mol_at_types);
 
-  inline double get_K_value(int indx, int I,int J){ return eht_K[indx][I*size+J];  }
-  inline double get_C_value(int indx, int I,int J){ return eht_C[indx][I*size+J];  }
+  inline double get_K_value(int indx, int I,int J){ return eht_K[indx][orb_type[I]*ntyp+orb_type[J]];  }
+  inline double get_C_value(int indx, int I,int J){ return eht_C[indx][orb_type[I]*ntyp+orb_type[J]];  }
 
   friend bool operator == (const mEHT_K& m1, const mEHT_K& m2){
     // Equal
     int res = m1.size==m2.size;
+    res *= (m1.ntyp==m2.ntyp);
+    res *= (m1.orb_type==m2.orb_type);
 
     for(int k=0;k<5;k++){
       res *= (m1.eht_K[k]==m2.eht_K[k]);  
@@ -465,12 +473,16 @@ class OrbParams{
   double G1,F2;          ///< Slater-Condon factors
   double beta0;          ///< proportionality constants for off-diagonal matrix elements
 
+  // EHT
+  double radius;         ///< the radius of the orbital used in the Calzaferi formula, computed from Nquant and zetas
+
   
   OrbParams(){}
   OrbParams(const OrbParams& ob){
     IP = ob.IP;
     EA = ob.EA;
     Nquant = ob.Nquant;
+    Nzeta = ob.Nzeta;
     zetas = ob.zetas;
     coeffs = ob.coeffs;
     J_param1 = ob.J_param1;
@@ -479,6 +491,7 @@ class OrbParams{
     J_param4 = ob.J_param4;
 
     G1 = ob.G1; F2 = ob.F2; beta0 = ob.beta0;
+    radius = ob.radius;
   }
 
   ~OrbParams(){ 
@@ -505,6 +518,7 @@ class OrbParams{
     res *= (m1.G1==m2.G1);  
     res *= (m1.F2==m2.F2);  
     res *= (m1.beta0==m2.beta0);  
+    res *= (m1.radius==m2.radius);  
 
 
     return  res;  
@@ -559,6 +573,14 @@ public:
   vector<double> eri;  ///< precomputed electron repulsion integrals (only (ss|ss) type between all pairs of atoms)
   vector<double> V_AB; ///< precomputed core-core repulsion terms for all pairs of atoms
 
+  // INDO/CNDO/CNDO2 integral tables for the Fock matrix builds - see indo_fock_cache
+  vector<int> indo_ao;           ///< AO indices grouped by atom: indo_ao[indo_ao_start[a]], ..., indo_ao[indo_ao_start[a+1]-1] are on atom a
+  vector<int> indo_ao_start;     ///< offsets of the atomic groups in indo_ao (Number_of_atoms + 1 entries)
+  vector<int> indo_blk_start;    ///< offsets of the one-center blocks of all atoms in indo_ii_kk and indo_ik_ik
+  vector<double> indo_ii_kk;     ///< one-center Coulomb integrals (ii|kk), a row-major n_a x n_a block per atom
+  vector<double> indo_ik_ik;     ///< one-center exchange integrals (ik|ik), same layout
+  vector<double> indo_Zeff;      ///< effective core charges of all atoms
+
   
   //-------------- Constructor --------------
   Model_Parameters(){  
@@ -576,6 +598,12 @@ public:
     indo_opt = ob.indo_opt;
     eri = ob.eri;
     V_AB = ob.V_AB;
+    indo_ao = ob.indo_ao;
+    indo_ao_start = ob.indo_ao_start;
+    indo_blk_start = ob.indo_blk_start;
+    indo_ii_kk = ob.indo_ii_kk;
+    indo_ik_ik = ob.indo_ik_ik;
+    indo_Zeff = ob.indo_Zeff;
   }
 
 
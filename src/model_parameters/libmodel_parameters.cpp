@@ -76,6 +76,8 @@ void export_Model_Parameters_objects(){
   class_<mEHT_K>("mEHT_K",init<>())
 
       .def_readwrite("size",   &mEHT_K::size)
+      .def_readwrite("ntyp",   &mEHT_K::ntyp)
+      .def_readwrite("orb_type",   &mEHT_K::orb_type)
 //      .def_readwrite("eht_K",  &mEHT_K::eht_K)
 //      .def_readwrite("eht_C",  &mEHT_K::eht_C)
       .def_readwrite("eht_PPa", &mEHT_K::eht_PPa)
@@ -166,6 +168,7 @@ void export_Model_Parameters_objects(){
       .def_readwrite("G1",   &OrbParams::G1)
       .def_readwrite("F2",   &OrbParams::F2)
       .def_readwrite("beta0",   &OrbParams::beta0)
+      .def_readwrite("radius",   &OrbParams::radius)
 
   ;
 
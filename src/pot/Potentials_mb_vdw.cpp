@@ -1095,6 +1095,160 @@ double Vdw_LJ2_no_excl(VECTOR* r,
   return energy;
 }
 
+double Vdw_LJ2_vlist(VECTOR* r,                                               /* Inputs */
+                     VECTOR* g,
+                     VECTOR* m,
+                     VECTOR* f,
+                     MATRIX3x3& at_stress, MATRIX3x3& fr_stress, MATRIX3x3& ml_stress, /* Outputs*/
+                     int sz,double* epsilon, double* sigma,
+                     MATRIX3x3* box,
+                     int is_cutoff, double R_on, double R_off,
+                     VerletList& vlist, vector< vector<excl_scale> >& excl_scales
+                    ){
+/**********************************************************************************
+ This function computes the same interactions as Vdw_LJ2_no_excl, but instead of
+ constructing the cell list on every call it uses the persistent Verlet list <vlist>.
+ The list is built with the radius R_off + vlist.skin and is only rebuilt when some
+ atom has moved by more than vlist.skin/2 since the last rebuild, so in a typical MD
+ run most of the calls are reduced to a single pass over the stored pairs.
+
+ excl_scales - the scaling constants for exclusion interactions for all atoms,
+ organized as in Vdw_LJ2_no_excl
+
+**********************************************************************************/
+
+  int i,k,excl;
+  double SW,sig,eps,en;
+  VECTOR dSW;
+  double energy;
+  VECTOR rij,gij,f1,f2,f12;
+  VECTOR t1,t2,t3,tv;
+  MATRIX3x3 tp;
+  double scl_const = 1.0;
+  double tscale = 1.0;
+  double Roff2 = R_off * R_off;
+
+  box->get_vectors(t1,t2,t3);
+
+  // The list must contain all the pairs within R_off
+  if(fabs(vlist.Roff - R_off)>1e-10){ vlist.init(R_off, vlist.skin); }
+  vlist.update(sz, r, *box);
+
+  // Index of the exclusion row for each atom (-1 if there are no exclusions for this atom)
+  vector<int> excl_row(sz,-1);
+  for(excl=0;excl<excl_scales.size();excl++){
+    if(excl_scales[excl].size()>0){
+      int at_indx1 = excl_scales[excl][0].at_indx1;
+      if(at_indx1>=0 && at_indx1<sz){ excl_row[at_indx1] = excl; }
+    }
+  }
+
+  //------------------ Initialize forces and stress -----------------
+  energy = 0.0;
+  for(i=0;i<sz;i++){ f[i] = 0.0; }
+  at_stress = 0.0;
+  fr_stress = 0.0;
+  ml_stress = 0.0;
+
+
+  for(int at_indx1=0;at_indx1<sz;at_indx1++){
+
+    int excl_indx = excl_row[at_indx1];
+
+    for(k=vlist.begin(at_indx1);k<vlist.end(at_indx1);k++){
+
+      quartet& qt = vlist.neib[k];
+      int at_indx2 = qt.j;
+
+      if((qt.is_central==1) && (at_indx1==at_indx2)){ continue; } // singular case - self-interaction
+
+      tv = (qt.n1*t1 + qt.n2*t2 + qt.n3*t3);
+      rij = r[at_indx1] - r[at_indx2] - tv;
+
+      // The list is built with the skin, so only a part of the pairs is within the cutoff
+      if(rij.length2()>Roff2){ continue; }
+
+      //============ Calculate scaling ========================  
+      double scl1 = scl_const;
+      if(qt.is_central && excl_indx>-1){ 
+        for(excl=0;excl<excl_scales[excl_indx].size();excl++){
+          if(excl_scales[excl_indx][excl].at_indx2==at_indx2){
+            scl1 = scl_const * excl_scales[excl_indx][excl].scale; break;
+          }
+        }
+      }
+
+      //============= Calculation part =========================
+      if(scl1*scl1>0.0){
+
+        gij = g[at_indx1] - g[at_indx2] - tv;
+
+        SW = 1.0; dSW = 0.0;
+        VECTOR rj = r[at_indx2]+tv;
+        if(is_cutoff){ SWITCH(r[at_indx1],rj,R_on,R_off,SW,dSW); }
+        if(SW>0.0){
+          f1 = f2 = 0.0;
+          sig = (sigma[at_indx1]*sigma[at_indx2]);
+          eps = (epsilon[at_indx1]*epsilon[at_indx2]);
+          en = Vdw_LJ(r[at_indx1],rj,f1,f2,sig,scl1*eps);
+          energy += SW*en;
+          f12 = (SW*f1 - en*dSW);
+          f[at_indx1] += f12;
+          f[at_indx2] -= f12;
+
+          tp.tensor_product(rij , f12);   at_stress += tscale*tp;
+          tp.tensor_product(gij , f12);   fr_stress += tscale*tp;
+        }
+
+      }// scl1>0.0
+
+    }// for k - all neighbors of at_indx1
+  }// for at_indx1
+
+
+  return energy;
+}
+
+
+double Vdw_LJ2_no_excl(vector<VECTOR>& r, vector<double>& epsilon, vector<double>& sigma, MATRIX3x3& box, /* Inputs */
+                       vector<VECTOR>& f, MATRIX3x3& at_stress, MATRIX3x3& fr_stress,               /* Outputs*/
+                       int is_cutoff, double R_on, double R_off                                      /* Parameters */
+                      ){
+/**
+  Python-friendly version of Vdw_LJ2_no_excl: no exclusions, the atomic positions are also
+  used as the group and molecular centers
+*/
+
+  int sz = r.size();
+  f = vector<VECTOR>(sz, VECTOR(0.0, 0.0, 0.0));
+  MATRIX3x3 ml_stress;
+  vector< vector<excl_scale> > excl_scales;
+  int tim = 0;
+
+  return Vdw_LJ2_no_excl(&r[0], &r[0], &r[0], &f[0], at_stress, fr_stress, ml_stress, sz, &epsilon[0], &sigma[0],
+                         0, NULL, NULL, NULL, &box, 0, 0, 0.0, is_cutoff, R_on, R_off, tim, excl_scales);
+}
+
+
+double Vdw_LJ2_vlist(vector<VECTOR>& r, vector<double>& epsilon, vector<double>& sigma, MATRIX3x3& box, /* Inputs */
+                     vector<VECTOR>& f, MATRIX3x3& at_stress, MATRIX3x3& fr_stress,                 /* Outputs*/
+                     int is_cutoff, double R_on, double R_off, VerletList& vlist                     /* Parameters */
+                    ){
+/**
+  Python-friendly version of Vdw_LJ2_vlist: no exclusions, the atomic positions are also
+  used as the group and molecular centers. The list vlist is kept between the calls
+*/
+
+  int sz = r.size();
+  f = vector<VECTOR>(sz, VECTOR(0.0, 0.0, 0.0));
+  MATRIX3x3 ml_stress;
+  vector< vector<excl_scale> > excl_scales;
+
+  return Vdw_LJ2_vlist(&r[0], &r[0], &r[0], &f[0], at_stress, fr_stress, ml_stress, sz, &epsilon[0], &sigma[0],
+                       &box, is_cutoff, R_on, R_off, vlist, excl_scales);
+}
+
+
 double Vdw_LJ2_excl(VECTOR* r,                                               /* Inputs */
                     VECTOR* g,
                     VECTOR* m,
@@ -103,6 +103,27 @@ double Vdw_LJ2_no_excl(VECTOR* r,
                        int& time,vector< vector<excl_scale> >& excl_scales
                       );
 
+double Vdw_LJ2_vlist(VECTOR* r,                                               /* Inputs */
+                     VECTOR* g,
+                     VECTOR* m,
+                     VECTOR* f,
+                     MATRIX3x3& at_stress, MATRIX3x3& fr_stress, MATRIX3x3& ml_stress, /* Outputs*/
+                     int sz,double* epsilon, double* sigma,
+                     MATRIX3x3* box,
+                     int is_cutoff, double R_on, double R_off,
+                     VerletList& vlist, vector< vector<excl_scale> >& excl_scales
+                    );
+
+double Vdw_LJ2_no_excl(vector<VECTOR>& r, vector<double>& epsilon, vector<double>& sigma, MATRIX3x3& box, /* Inputs */
+                       vector<VECTOR>& f, MATRIX3x3& at_stress, MATRIX3x3& fr_stress,               /* Outputs*/
+                       int is_cutoff, double R_on, double R_off                                      /* Parameters */
+                      );
+
+double Vdw_LJ2_vlist(vector<VECTOR>& r, vector<double>& epsilon, vector<double>& sigma, MATRIX3x3& box, /* Inputs */
+                     vector<VECTOR>& f, MATRIX3x3& at_stress, MATRIX3x3& fr_stress,                 /* Outputs*/
+                     int is_cutoff, double R_on, double R_off, VerletList& vlist                     /* Parameters */
+                    );
+
 double Vdw_LJ2_excl(VECTOR* r,                                               /* Inputs */
                     VECTOR* g,
                     VECTOR* m,
@@ -116,6 +116,20 @@ double (*expt_VdW_Ewald3D_v2)(vector<VECTOR>& r, vector<double>& q, MATRIX3x3& b
   def("VdW_Ewald3D", expt_VdW_Ewald3D_v2);
 
 
+  double (*expt_Vdw_LJ2_no_excl_v1)(vector<VECTOR>& r, vector<double>& epsilon, vector<double>& sigma, MATRIX3x3& box,
+                       vector<VECTOR>& f, MATRIX3x3& at_stress, MATRIX3x3& fr_stress,
+                       int is_cutoff, double R_on, double R_off
+                      ) = &Vdw_LJ2_no_excl;
+
+  double (*expt_Vdw_LJ2_vlist_v1)(vector<VECTOR>& r, vector<double>& epsilon, vector<double>& sigma, MATRIX3x3& box,
+                       vector<VECTOR>& f, MATRIX3x3& at_stress, MATRIX3x3& fr_stress,
+                       int is_cutoff, double R_on, double R_off, VerletList& vlist
+                      ) = &Vdw_LJ2_vlist;
+
+  def("Vdw_LJ2_no_excl", expt_Vdw_LJ2_no_excl_v1);
+  def("Vdw_LJ2_vlist", expt_Vdw_LJ2_vlist_v1);
+
+
 //  def("Vdw_LJ", Vdw_LJ_2);
 //  def("Vdw_LJ1", Vdw_LJ1);
 //  def("Vdw_LJ2_no_excl", Vdw_LJ2_no_excl);
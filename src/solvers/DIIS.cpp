@@ -10,8 +10,8 @@
 *********************************************************************************/
 /**
  \file DIIS.cpp
- \brief The file implements the DIIS class and related functions 
-        
+ \brief The file implements the DIIS class and related functions
+
 */
 
 #include "DIIS.h"
@@ -34,14 +34,9 @@ namespace libsolvers{
 
 
 
-DIIS::DIIS(int _N_diis_max,int Norb){
+void DIIS::init(int _N_diis_max, int n_rows, int n_cols){
 /**
-  The constructor of the DIIS handler 
-
-  \param[in] _N_diis_max The maximal length of DIIS history - how many matrixes to store 
-  \param[in] Norb The size of the DIIS matrices. Well the name is a bit misleading. This is because
-  I initially implemented it with the SCF convergence in mind, but in reality this is pretty general
-  algorithm, so Norb is just the size of the problem
+  Sets up the parameters and allocates the history - this is the only place where the history matrices are allocated
 */
 
   int n;
@@ -50,210 +45,228 @@ DIIS::DIIS(int _N_diis_max,int Norb){
   N_diis = 0;
   N_diis_eff = 0;
   N_diis_max = _N_diis_max;
-
-  // Clear memory if used
-  if(diis_X.size()>0){ diis_X.clear(); }
-  if(diis_err.size()>0){ diis_err.clear(); }
-
+  diis_head = 0;
 
   // Allocate memory
   diis_c = vector<double>(N_diis_max,0.0);
   for(n=0;n<N_diis_max;n++){
-    MATRIX* x; x = new MATRIX(Norb,Norb); *x = 0.0;
+    MATRIX* x; x = new MATRIX(n_rows,n_cols); *x = 0.0;
     diis_X.push_back(x);
   }
   for(n=0;n<N_diis_max;n++){
-    MATRIX* x; x = new MATRIX(Norb,Norb); *x = 0.0;
+    MATRIX* x; x = new MATRIX(n_rows,n_cols); *x = 0.0;
     diis_err.push_back(x);
   }
+  diis_B = new MATRIX(N_diis_max,N_diis_max);
 
-}// DIIS::DIIS(int _N_diis_max)
-
+}
 
 
-void DIIS::update_diis_coefficients(){
+DIIS::DIIS(int _N_diis_max,int Norb){
 /**
-  General case - holds true for both N_diis<N_diis_max and for N_diis==N_diis_max (after preliminary corrections )
-  Starting at this point we compute the extrapolation coefficients:
-  Solving Ax = b, where b - are the errors, x - are the changes of the parameter space, A contain the extrapolation coefficients
+  The constructor of the DIIS handler
+
+  \param[in] _N_diis_max The maximal length of DIIS history - how many matrixes to store
+  \param[in] Norb The size of the DIIS matrices. Well the name is a bit misleading. This is because
+  I initially implemented it with the SCF convergence in mind, but in reality this is pretty general
+  algorithm, so Norb is just the size of the problem
 */
 
-  int N_diis_curr;
-  int rank;
-  int i,j;
-  int debug_flag = 0;
-  double diis_damp = 0.0; // see [Hamilton,Pulay, JCP 84, 5728 (1986) ] - scale diagonal element of B matrix by (1+diis_damp) to
-                          // avoid numerical problems associated with large diis coefficents
+  init(_N_diis_max, Norb, Norb);
 
+}// DIIS::DIIS(int _N_diis_max)
 
-  MatrixXd* A;  // will be of size N_diis+2
-  VectorXd* b; //(N_diis+2);        
-  VectorXd* x; //(N_diis+2);
 
+DIIS::DIIS(int _N_diis_max,int n_rows,int n_cols){
+/**
+  The constructor of the DIIS handler for the rectangular matrices (e.g. the column vectors of coordinates)
 
-  if(debug_flag){    cout<<"*diis_err[N_diis]= "<<*diis_err[N_diis]<<endl; }
+  \param[in] _N_diis_max The maximal length of DIIS history - how many matrixes to store
+  \param[in] n_rows, n_cols The dimensions of the DIIS matrices
+*/
 
+  init(_N_diis_max, n_rows, n_cols);
 
-  // Actual size of DIIS matrices at given call
-  // We save this number, because N_diis can reduce in the following run, to give full-rank matrices
-  N_diis_curr = N_diis;
- 
-  // Initial guess 
-  A = new MatrixXd(N_diis+2,N_diis+2);
+}
 
-  for(i=0;i<=N_diis;i++){
-    for(j=0;j<=N_diis;j++){            
-      (*A)(i,j) = ((*diis_err[i]).T() * (*diis_err[j])).tr();
 
-      if(i==j){ (*A)(i,j) *= (1.0+diis_damp); }
-    }
-    (*A)(i,N_diis+1) = -1.0;
-    (*A)(N_diis+1,i) = -1.0;
-  } 
-  (*A)(N_diis+1,N_diis+1) = 0.0;
+DIIS::DIIS(const DIIS& ob){
+/**
+  The copy constructor - makes a deep copy of the DIIS history
+*/
 
+  N_diis = ob.N_diis;
+  N_diis_eff = ob.N_diis_eff;
+  N_diis_max = ob.N_diis_max;
+  diis_head = ob.diis_head;
+  diis_c = ob.diis_c;
 
-  // Determine the rank of the DIIS matrix A
-  FullPivLU<MatrixXd> lu_decomp(*A);
-  rank = lu_decomp.rank();
+  for(int n=0;n<ob.diis_X.size();n++){  diis_X.push_back(new MATRIX(*ob.diis_X[n]));  }
+  for(int n=0;n<ob.diis_err.size();n++){  diis_err.push_back(new MATRIX(*ob.diis_err[n]));  }
+  diis_B = new MATRIX(*ob.diis_B);
 
-  if(rank==(N_diis+2)){  if(debug_flag){    cout<<"Matrix is well-conditioned\n"<<*A<<endl;  }  }
-  else{     if(debug_flag){    cout<<"Matrix is ill-conditioned\n"<<*A<<endl;   }
+}
 
-    int min_indx = 0;
+DIIS::~DIIS(){
+/**
+  The destructor - frees the memory of the DIIS history
+*/
 
-    // Reduce DIIS matrix by removing older iterates untill it is well-conditioned
-    while(rank!=(N_diis+2)){
+  for(int n=0;n<diis_X.size();n++){  delete diis_X[n];  }
+  for(int n=0;n<diis_err.size();n++){  delete diis_err[n];  }
+  diis_X.clear();
+  diis_err.clear();
+  delete diis_B;
 
-      N_diis--;
-      min_indx++; // this will hide first min_indx diis_err matrices from consideration 
+}
 
-      MatrixXd tempA(N_diis+2,N_diis+2);  
+void DIIS::operator=(const DIIS& ob){
+/**
+  The assignment operator - makes a deep copy of the DIIS history
+*/
 
-      for(i=0;i<=N_diis;i++){
-        for(j=0;j<=N_diis;j++){            
-          tempA(i,j) = ((*diis_err[min_indx+i]).T() * (*diis_err[min_indx+j])).tr();
+  if(this==&ob){ return; }
 
-          if(i==j){ tempA(i,j) *= (1.0+diis_damp); }
+  for(int n=0;n<diis_X.size();n++){  delete diis_X[n];  }
+  for(int n=0;n<diis_err.size();n++){  delete diis_err[n];  }
+  diis_X.clear();
+  diis_err.clear();
+  delete diis_B;
 
-        }
-        tempA(i,N_diis+1) = -1.0;
-        tempA(N_diis+1,i) = -1.0;
-      } 
-      tempA(N_diis+1,N_diis+1) = 0.0;
+  N_diis = ob.N_diis;
+  N_diis_eff = ob.N_diis_eff;
+  N_diis_max = ob.N_diis_max;
+  diis_head = ob.diis_head;
+  diis_c = ob.diis_c;
 
-      FullPivLU<MatrixXd> tmp_lu_decomp(tempA);
-      rank = tmp_lu_decomp.rank();
+  for(int n=0;n<ob.diis_X.size();n++){  diis_X.push_back(new MATRIX(*ob.diis_X[n]));  }
+  for(int n=0;n<ob.diis_err.size();n++){  diis_err.push_back(new MATRIX(*ob.diis_err[n]));  }
+  diis_B = new MATRIX(*ob.diis_B);
 
-      if(debug_flag){
-        cout<<"Reduction iteration "<<min_indx<<endl;
-        cout<<"Reduced matrix = \n"<<tempA<<endl;
-        cout<<"Reduced matrix rank = "<<rank<<endl;
-      }
+}
 
-      if(rank==N_diis+2){ 
-        delete A;   A = new MatrixXd(N_diis+2,N_diis+2);   *A = tempA; 
-      }
 
-    }// while
+int DIIS::slot(int i){
+/**
+  The history is a ring buffer: returns the storage index of the i-th stored iterate,
+  counting in the chronological order (i = 0 is the oldest one)
+*/
 
-  }// else rank!=Ndiis+2
+  return (diis_head + i) % N_diis_max;
 
+}
 
-  b = new VectorXd(N_diis+2);  for(i=0;i<=N_diis;i++){  (*b)(i) = 0.0;  }  (*b)(N_diis+1) = -1.0;
-  x = new VectorXd(N_diis+2);
 
-  // Solve linear algebra to get coefficients
-  *x = A->lu().solve(*b); for(i=0;i<=N_diis;i++){  diis_c[i] = (*x)[i];  }
+void DIIS::update_diis_coefficients(){
+/**
+  General case - holds true for both N_diis<N_diis_max and for N_diis==N_diis_max
+  Starting at this point we compute the extrapolation coefficients:
+  Solving Ax = b, where b - are the errors, x - are the changes of the parameter space, A contain the extrapolation coefficients
+
+  The error overlaps B(a,b) = Tr(err_a^T * err_b) are taken from the cache diis_B, which is updated in add_diis_matrices,
+  so this function only works with the small (N_diis+1) x (N_diis+1) matrices.
+  If the DIIS matrix is ill-conditioned, the oldest iterates are excluded (their coefficients are set to zero)
+  until it becomes full-rank
+*/
 
-  if(debug_flag){
-    cout<<"A*x = "<<(*A)*(*x)<<endl;
-    cout<<"b = "<<*b<<endl;
-    cout<<"x = "<<*x<<endl;
-  }
+  int i,j;
+  int debug_flag = 0;
+  double diis_damp = 0.0; // see [Hamilton,Pulay, JCP 84, 5728 (1986) ] - scale diagonal element of B matrix by (1+diis_damp) to
+                          // avoid numerical problems associated with large diis coefficents
 
-  // Free memory
-  delete A;
-  delete b;
-  delete x;
+  // Normalize the B matrix by its largest diagonal element - this does not change the coefficients (they sum up to 1),
+  // but keeps the rank determination meaningful when the errors become small
+  double scl = 0.0;
+  for(i=0;i<N_diis;i++){  scl = max(scl, diis_B->get(slot(i),slot(i)));  }
+  if(scl<=0.0){ scl = 1.0; }
 
 
-  // Compute effective size of the DIIS matrix
-  N_diis_eff = (N_diis_curr - N_diis); // keep in mind that N_diis is a current one (updated)   
-  N_diis = N_diis_curr;
+  int min_indx = 0;   // the first min_indx (oldest) iterates are hidden from consideration
+  VectorXd x;
 
+  while(1){
 
-}//void DIIS::update_diis_coefficients()
+    int n = N_diis - min_indx;   // the number of iterates used
 
+    MatrixXd A(n+1,n+1);
+    for(i=0;i<n;i++){
+      for(j=0;j<n;j++){
+        A(i,j) = diis_B->get(slot(min_indx+i),slot(min_indx+j)) / scl;
 
+        if(i==j){ A(i,j) *= (1.0+diis_damp); }
+      }
+      A(i,n) = -1.0;
+      A(n,i) = -1.0;
+    }
+    A(n,n) = 0.0;
 
+    VectorXd b(n+1);  for(i=0;i<n;i++){  b(i) = 0.0;  }  b(n) = -1.0;
 
-void DIIS::add_diis_matrices(MATRIX* X, MATRIX* err){
-/**
-  This function adds information about new iteration, so it updates the DIIS input matrices
+    FullPivLU<MatrixXd> lu_decomp(A);
 
-  \param[in] X the matrix of parameters change
-  \param[in] err the matrix of the corresponding errors 
+    if(debug_flag){
+      cout<<"Reduction iteration "<<min_indx<<endl;
+      cout<<"DIIS matrix = \n"<<A<<endl;
+      cout<<"DIIS matrix rank = "<<lu_decomp.rank()<<endl;
+    }
 
-  Note that this function will be only accumulating the matrices until the DIIS history is filled. Then, it will 
-  be rotating matrices, adding these matrices to the end and removing very first set of matrices (queue mechanism)
+    // A with a single iterate is always full-rank, so the loop terminates
+    if(lu_decomp.rank()==n+1){  x = lu_decomp.solve(b);  break;  }
 
-  Note: this operation also updates corresponding extrapolation coefficients.
+    min_indx++;
 
-*/
+  }// while
 
-//  cout<<"Starting add_diis_matrices\n  N_diis = "<<N_diis<<endl;
-  int i,j;
-//  int N_diis_curr;
 
-  if(N_diis==0){ // The very first iterate (most likely this will be used right after guess)
+  // Coefficients in the chronological order, the excluded iterates get zeros
+  for(i=0;i<N_diis_max;i++){  diis_c[i] = 0.0;  }
+  for(i=0;i<N_diis-min_indx;i++){  diis_c[min_indx+i] = x(i);  }
 
-    *diis_X[0] = *X;        
-    *diis_err[0] = *err;
-    diis_c[0]     = 1.0;
+  N_diis_eff = N_diis - min_indx;
 
-//    N_diis_curr = N_diis;
+}//void DIIS::update_diis_coefficients()
 
-  }// N_diis==0
 
-  else if(N_diis>0){  // we already have a few matrices stored
 
-    if(N_diis>=N_diis_max){ // this happens because last call of add_diis_matrices incremented N_diis
 
-      N_diis = N_diis_max-1;  // so we set N_diis to maximal valid index, pointing to the last entries in the arrays
+void DIIS::add_diis_matrices(MATRIX* X, MATRIX* err){
+/**
+  This function adds information about new iteration, so it updates the DIIS input matrices
 
+  \param[in] X the matrix of parameters change
+  \param[in] err the matrix of the corresponding errors
 
-    // Rotate matrices
-    // so only last entry X[N_diis_max-1] is old 
-    // in the following sections we will update it
-      for(i=0;i<N_diis;i++){
-        
-        *diis_X[i] = *diis_X[i+1];
-        *diis_err[i] = *diis_err[i+1];
-        diis_c[i]    = diis_c[i+1];
+  Note that this function will be only accumulating the matrices until the DIIS history is filled. Then, it will
+  be overwriting the oldest set of matrices (queue mechanism, implemented as a ring buffer - no matrices are copied
+  or allocated other than the new ones).
+  Only the row and the column of the error-overlap matrix corresponding to the new error matrix are computed.
 
-      }// for i
+  Note: this operation also updates corresponding extrapolation coefficients.
 
+*/
 
-    }// N_diis==N_diis_max  (so it will actually always be N_diis_max)
-    else{
-      // do nothing special
-    }
+  int i,k;
 
+  // The storage index for the new entry
+  if(N_diis<N_diis_max){  k = slot(N_diis);  N_diis++;  }
+  else{  k = diis_head;  diis_head = (diis_head + 1) % N_diis_max;  }
 
-    // N_diis - always points to the last valid element of DIIS lists (arrays)
-    // so the size of the matrices is (N_diis+1) x (N_diis+1)
-    *diis_X[N_diis] = *X;    
-    *diis_err[N_diis] = *err;
+  *diis_X[k] = *X;
+  *diis_err[k] = *err;
 
-    // Now we need to update coefficients for given set of DIIS matrices
-    update_diis_coefficients();
- 
-  }// N_diis>0
+  // Update the cached error overlaps: B(k,a) = B(a,k) = Tr(err_k^T * err_a) = sum_ij err_k(i,j) * err_a(i,j)
+  int sz = err->n_elts;
+  for(i=0;i<N_diis;i++){
+    int a = slot(i);
+    double res = 0.0;
+    for(int n=0;n<sz;n++){  res += diis_err[k]->M[n] * diis_err[a]->M[n];  }
 
-  N_diis++;
+    diis_B->set(k,a,res);
+    diis_B->set(a,k,res);
+  }
 
-//  cout<<"Finish add_diis_matrices\n  N_diis = "<<N_diis<<endl;
+  // Now we need to update coefficients for given set of DIIS matrices
+  update_diis_coefficients();
 
 }// void DIIS::add_diis_matrices(MATRIX* _X, MATRIX* _err)
 
@@ -267,8 +280,8 @@ void DIIS::extrapolate_matrix(MATRIX* X_ext){
   Note the Fock matrix constructed below (extrapolated) will only be used to obtain density
   It will not be stored in diis_Fao_... (timing/sequence of function calls in scf() procedure is very important!!! )
 
-  //!!!!!!!!!! Assume it is called just after add_diis_matrices !!!!!!!!!!!
-  so we need to used decremented N_diis value!!!!!
+  Uses the coefficients computed in the last call of add_diis_matrices. The sum is accumulated in place,
+  without temporary matrices
 
   \param[out] X_ext The extrapolated input matrix (in context of SCF - this is an extrapolted Fock or density matrix)
 
@@ -276,8 +289,11 @@ void DIIS::extrapolate_matrix(MATRIX* X_ext){
 
   *X_ext = 0.0;
 
-  for(int i=0;i<=((N_diis-1)-N_diis_eff);i++){
-    *X_ext += diis_c[i] * (*diis_X[N_diis_eff + i]);
+  int sz = X_ext->n_elts;
+  for(int i=N_diis-N_diis_eff;i<N_diis;i++){
+    double c = diis_c[i];
+    double* x = diis_X[slot(i)]->M;
+    for(int n=0;n<sz;n++){  X_ext->M[n] += c * x[n];  }
   }
 
 }// void DIIS::extrapolate_matrix(MATRIX* X_ext)
@@ -287,36 +303,37 @@ void DIIS::extrapolate_matrix(MATRIX& X_ext){ extrapolate_matrix(&X_ext); }
 
 boost::python::list DIIS::get_diis_X(){
 /**
-  Returns the list of presently stored objective matrices.
+  Returns the list of presently stored objective matrices, in the chronological order (the oldest one first).
   The returned objects are brand-new objects (constructed here), so don't worry about references
 */
 
-  boost::python::list res;
-  for(int i=0;i<diis_X.size();i++){ res.append(*diis_X[i]); }
+  boost::python::list res;
+  for(int i=0;i<N_diis;i++){ res.append(*diis_X[slot(i)]); }
   return res;
 
 }
 
 boost::python::list DIIS::get_diis_err(){
 /**
-  Returns the list of presently stored error matrices.
+  Returns the list of presently stored error matrices, in the chronological order (the oldest one first).
   The returned objects are brand-new objects (constructed here), so don't worry about references
 */
 
-  boost::python::list res;
-  for(int i=0;i<diis_err.size();i++){ res.append(*diis_err[i]); }
+  boost::python::list res;
+  for(int i=0;i<N_diis;i++){ res.append(*diis_err[slot(i)]); }
   return res;
 
 }
 
 boost::python::list DIIS::get_diis_c(){
 /**
-  Returns the list of presently stored extrapolation coefficients
+  Returns the list of presently stored extrapolation coefficients, in the chronological order
+  of the stored matrices (the oldest one first)
   The returned objects are brand-new objects (constructed here), so don't worry about references
 */
 
-  boost::python::list res;
-  for(int i=0;i<diis_c.size();i++){ res.append(diis_c[i]); }
+  boost::python::list res;
+  for(int i=0;i<N_diis;i++){ res.append(diis_c[i]); }
   return res;
 
 }
@@ -38,10 +38,16 @@ class DIIS{
   This is the class that handles DIIS (direct inversion of the iterative space) method
 */
   void update_diis_coefficients();
+  int slot(int i);
+  void init(int _N_diis_max, int n_rows, int n_cols);
 
 public:
 
   DIIS(int _N_diis_max,int Norb);  ///< Constructor
+  DIIS(int _N_diis_max,int n_rows,int n_cols);  ///< Constructor for the rectangular matrices
+  DIIS(const DIIS&);               ///< Copy constructor
+  ~DIIS();                         ///< Destructor
+  void operator=(const DIIS&);     ///< Assignment operator
 
   void add_diis_matrices(MATRIX* X, MATRIX* err);
   void add_diis_matrices(MATRIX& X, MATRIX& err);
@@ -54,10 +60,12 @@ public:
   int N_diis_max;                ///< Length of DIIS history (size of the lists)  
 
   int N_diis;                    ///< current # of matrices stored
-  int N_diis_eff;                ///< effective size of the DIIS matrix (such that it is full-rank)
-  vector<MATRIX*> diis_X;        ///< diis iteration of objective matrices (typically Fock matrices)
-  vector<MATRIX*> diis_err;      ///< diis error matrices
-  vector<double>  diis_c;        ///< diis extrapolation coefficients
+  int N_diis_eff;                ///< effective size of the DIIS matrix (such that it is full-rank) - the # of the most recent matrices used
+  int diis_head;                 ///< storage index of the oldest stored matrices - the history is kept in a ring buffer
+  vector<MATRIX*> diis_X;        ///< diis iteration of objective matrices (typically Fock matrices), in the storage order
+  vector<MATRIX*> diis_err;      ///< diis error matrices, in the storage order
+  vector<double>  diis_c;        ///< diis extrapolation coefficients, in the chronological order (the oldest first)
+  MATRIX* diis_B;                ///< cached overlaps of the error matrices Tr(err_a^T * err_b), in the storage order
 
 
   boost::python::list get_diis_X();
@@ -41,6 +41,7 @@ void export_solvers_objects(){
   void (DIIS::*expt_extrapolate_matrix_v1)(MATRIX& X) = &DIIS::extrapolate_matrix;
 
   class_<DIIS>("DIIS",init<int,int>())
+      .def(init<int,int,int>())
       .def("__copy__", &generic__copy__<DIIS>)
       .def("__deepcopy__", &generic__deepcopy__<DIIS>)
 
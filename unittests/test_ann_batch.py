@@ -0,0 +1,168 @@
+#*********************************************************************************
+#* Copyright (C) 2017 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the batched propagation and minibatch training of the NeuralNetwork
+"""
+
+import os
+import sys
+import math
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+class patt():
+    pass
+
+
+def make_ann(is_scaled=1, derivs_flag=1):
+    """ A 2-4-3-1 network with a few patterns of f(x,y) = sin(x)*cos(y) and its gradient.
+    Without the scaling, the internal units of the ANN are the same as the external ones """
+
+    training_set = []
+    for i in range(50):
+        p = patt()
+        x, y = random.uniform(-1.0, 1.0), random.uniform(-1.0, 1.0)
+        p.Input = [x, y]
+        p.Output = [math.sin(x)*math.cos(y)]
+        p.Derivs = [math.cos(x)*math.cos(y), -math.sin(x)*math.sin(y)]
+        training_set.append(p)
+
+    ANN = NeuralNetwork()
+    ANN.CreateANN([2, 4, 3, 1])
+    ANN.SetTrainingData(training_set, derivs_flag)
+    if is_scaled:
+        ANN.ScaleTrainingData(1, 1)
+
+    return ANN, training_set
+
+
+
+class Test_ANN_Batch(unittest.TestCase):
+
+    def test_1(self):
+        """Propagate_batch gives the same outputs and derivatives as the pattern-by-pattern Propagate"""
+
+        random.seed(0)
+        ANN, training_set = make_ann()
+
+        npatt = 70   # more than two blocks, with an incomplete last one
+        X = MATRIX(2, npatt)
+        for i in range(2):
+            for p in range(npatt):
+                X.set(i, p, random.uniform(-1.0, 1.0))
+
+        Y = MATRIX(1, npatt)
+        dY = MATRIX(2, npatt)
+        ANN.Propagate_batch(X, Y, dY)
+
+        Y1 = MATRIX(1, npatt)
+        ANN.Propagate_batch(X, Y1)
+
+        for p in range(npatt):
+            x = MATRIX(2, 1);  x.set(0, 0, X.get(0, p));  x.set(1, 0, X.get(1, p))
+            y = MATRIX(1, 1)
+            dy = MATRIX(1, 2)
+            ANN.Propagate(x, y, dy)
+
+            self.assertAlmostEqual(Y.get(0, p), y.get(0, 0), places=12)
+            self.assertAlmostEqual(Y1.get(0, p), y.get(0, 0), places=12)
+            self.assertAlmostEqual(dY.get(0, p), dy.get(0, 0), places=12)
+            self.assertAlmostEqual(dY.get(1, p), dy.get(0, 1), places=12)
+
+
+    def test_2(self):
+        """Minibatch training with the gradient fitting reduces the error"""
+
+        random.seed(1)
+        ANN, training_set = make_ann()
+        ANN.set({"learning_method":"BackProp", "learning_rate":0.01, "epoch_size":50,
+                 "momentum_term":0.0, "grad_weight":0.5, "norm_exp":0.0, "iterations_in_cycle":200})
+
+        npatt = len(training_set)
+        X = MATRIX(2, npatt)
+        for p in range(npatt):
+            X.set(0, p, training_set[p].Input[0])
+            X.set(1, p, training_set[p].Input[1])
+
+        def error():
+            Y = MATRIX(1, npatt)
+            ANN.Propagate_batch(X, Y)
+            return sum( (Y.get(0,p) - training_set[p].Output[0])**2 for p in range(npatt) )
+
+        e0 = error()
+        ANN.ANNTrain()
+        self.assertLess(error(), e0)
+
+
+    def test_3(self):
+        """AccumulateGradients gives the negative gradients of the loss (central finite differences),
+        with and without the gradient fitting and the weight decay"""
+
+        random.seed(2)
+        lr = 0.1
+        h = 1e-5
+
+        for derivs_flag, gw, wd in [ [0, 0.0, 0.0], [1, 0.5, 0.0], [1, 0.3, 0.01] ]:
+
+            ANN, training_set = make_ann(0, derivs_flag)
+            ANN.set({"learning_rate":lr, "grad_weight":gw, "norm_exp":0.0, "weight_decay":[wd, 2.0*wd, 3.0*wd]})
+
+            patterns = [3, 7, 11, 20, 21, 40, 45]
+            npatt = len(patterns)
+            X = MATRIX(2, npatt)
+            for p in range(npatt):
+                X.set(0, p, training_set[patterns[p]].Input[0])
+                X.set(1, p, training_set[patterns[p]].Input[1])
+
+            def loss():
+                """ 1/2 * sum_p { |t - y|^2 + gw * |dt/dx - dy/dx|^2 } + 1/2 * npatt * sum_L { wd_L * |W_L|^2 } """
+                Y, dY = MATRIX(1, npatt), MATRIX(2, npatt)
+                ANN.Propagate_batch(X, Y, dY)
+                res = 0.0
+                for p in range(npatt):
+                    tp = training_set[patterns[p]]
+                    res += 0.5*(tp.Output[0] - Y.get(0,p))**2
+                    if derivs_flag:
+                        res += 0.5*gw*sum( (tp.Derivs[a] - dY.get(a,p))**2 for a in range(2) )
+                for L in range(1, 4):
+                    w = ANN.W[L]
+                    res += 0.5*npatt*wd*L*sum( w.get(i,j)**2 for i in range(w.num_of_rows) for j in range(w.num_of_cols) )
+                return res
+
+            perm = intList()
+            for p in patterns:
+                perm.append(p)
+            ANN.AccumulateGradients(perm)
+
+            gmax = 0.0
+            for L in range(1, 4):
+                for M, dM in [ [ANN.W, ANN.dWcurr], [ANN.B, ANN.dBcurr] ]:
+                    g = MATRIX(dM[L])
+                    for i in range(g.num_of_rows):
+                        for j in range(g.num_of_cols):
+                            x0 = M[L].get(i, j)
+                            M[L].set(i, j, x0 + h);  ep = loss()
+                            M[L].set(i, j, x0 - h);  em = loss()
+                            M[L].set(i, j, x0)
+                            self.assertAlmostEqual(g.get(i, j), -lr*(ep - em)/(2.0*h), places=8)
+                            gmax = max(gmax, abs(g.get(i, j)))
+            self.assertGreater(gmax, 1e-3)
+
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,106 @@
+#*********************************************************************************
+#* Copyright (C) 2017 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the ANN surrogate of the diabatic Hamiltonian in nHamiltonian
+"""
+
+import os
+import sys
+import math
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+class patt():
+    pass
+
+
+def make_ann():
+    """ A 2-input network with the 3 outputs H(0,0), H(0,1), H(1,1) of a two-state Hamiltonian """
+
+    training_set = []
+    for i in range(20):
+        p = patt()
+        x, y = random.uniform(-1.0, 1.0), random.uniform(-1.0, 1.0)
+        p.Input = [x, y]
+        p.Output = [0.01*x*x, 0.001*y, 0.01*(x-1.0)**2]
+        training_set.append(p)
+
+    ANN = NeuralNetwork()
+    ANN.CreateANN([2, 5, 3])
+    ANN.SetTrainingData(training_set, 0)
+    ANN.ScaleTrainingData(1, 1)
+
+    return ANN
+
+
+
+class Test_ANN_Hamiltonian(unittest.TestCase):
+
+    def test_1(self):
+        """compute_diabatic with an ANN fills every trajectory with the ANN values and their gradients"""
+
+        random.seed(0)
+        ANN = make_ann()
+
+        ndia, nnucl, ntraj = 2, 2, 5
+        ham = nHamiltonian(ndia, ndia, nnucl)
+        ham.add_new_children(ndia, ndia, nnucl, ntraj)
+        ham.init_all(2, 1)
+
+        q = MATRIX(nnucl, ntraj)
+        for i in range(nnucl):
+            for tr in range(ntraj):
+                q.set(i, tr, random.uniform(-1.0, 1.0))
+
+        ham.compute_diabatic(ANN, q, 1)
+
+        def ann_value(x0, x1):
+            x = MATRIX(nnucl, 1);  x.set(0, 0, x0);  x.set(1, 0, x1)
+            y = MATRIX(3, 1)
+            ANN.Propagate(x, y)
+            return y
+
+        dx = 1e-5
+        for tr in range(ntraj):
+            x0, x1 = q.get(0, tr), q.get(1, tr)
+            y = ann_value(x0, x1)
+            dy = [ ann_value(x0+dx, x1) - ann_value(x0-dx, x1),
+                   ann_value(x0, x1+dx) - ann_value(x0, x1-dx) ]
+
+            Id = intList();  Id.append(0);  Id.append(tr)
+            H = ham.get_ham_dia(Id)
+            S = ham.get_ovlp_dia(Id)
+
+            k = 0
+            for i in range(ndia):
+                for j in range(i, ndia):
+                    self.assertAlmostEqual(H.get(i,j).real, y.get(k, 0), places=12)
+                    self.assertAlmostEqual(H.get(j,i).real, y.get(k, 0), places=12)
+                    for n in range(nnucl):
+                        dH = ham.get_d1ham_dia(n, Id)
+                        self.assertAlmostEqual(dH.get(i,j).real, dy[n].get(k, 0)/(2.0*dx), places=6)
+                        self.assertAlmostEqual(dH.get(j,i).real, dH.get(i,j).real, places=12)
+                    k = k + 1
+
+            for i in range(ndia):
+                for j in range(ndia):
+                    self.assertAlmostEqual(S.get(i,j).real, 1.0 if i==j else 0.0, places=12)
+
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,125 @@
+#*********************************************************************************
+#* Copyright (C) 2017 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the shared-Hamiltonian (NBRA) propagator applied to a block of amplitudes
+"""
+
+import os
+import sys
+import math
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def make_hvib(n):
+    H = CMATRIX(n, n)
+    for i in range(n):
+        H.set(i, i, (0.02*i)*(1.0+0.0j))
+        for j in range(i+1, n):
+            x = 0.001*(random.random()-0.5) + 0.001j*(random.random()-0.5)
+            H.set(i, j, x)
+            H.set(j, i, x.conjugate())
+    return H
+
+
+
+class Test_Batched_Propagator(unittest.TestCase):
+
+    def test_1(self):
+        """The propagator is unitary and one GEMM reproduces column-by-column propagation"""
+
+        random.seed(0)
+        n, ntraj, dt = 8, 5, 41.0
+        H = make_hvib(n)
+
+        U = compute_propagator(dt, H)
+        I = U.H() * U
+        for i in range(n):
+            for j in range(n):
+                self.assertAlmostEqual(abs(I.get(i,j) - (1.0 if i==j else 0.0)), 0.0, places=10)
+
+        C = CMATRIX(n, ntraj)
+        for i in range(n):
+            for j in range(ntraj):
+                C.set(i, j, (random.random()-0.5) + 1.0j*(random.random()-0.5))
+
+        C_block = U * C
+
+        C_cols = CMATRIX(C)
+        propagate_electronic_krylov(dt, C_cols, H, 8, 1e-12, 1)
+
+        for i in range(n):
+            for j in range(ntraj):
+                self.assertAlmostEqual(abs(C_block.get(i,j) - C_cols.get(i,j)), 0.0, places=8)
+
+
+    def test_2(self):
+        """propagate_electronic_nbra reproduces the trajectory-by-trajectory propagation in both representations"""
+
+        random.seed(1)
+        n, ntraj, dt = 4, 5, 41.0
+        H = make_hvib(n)
+
+        S = CMATRIX(n, n)
+        for i in range(n):
+            S.set(i, i, 1.0+0.0j)
+            for j in range(i+1, n):
+                x = 0.05*(random.random()-0.5)
+                S.set(i, j, x+0.0j);  S.set(j, i, x+0.0j)
+
+        # All the trajectories share the same Hamiltonian
+        ham = nHamiltonian(n, n, 1)
+        children = []
+        for traj in range(ntraj):
+            child = nHamiltonian(n, n, 1)
+            child.set_hvib_dia_by_val(H)
+            child.set_ovlp_dia_by_val(S)
+            child.set_hvib_adi_by_val(H)
+            ham.add_child(child)
+            children.append(child)
+
+        # The projectors of the trajectories 1 and 3 differ from the first one - they are propagated individually
+        projectors = CMATRIXList()
+        for traj in range(ntraj):
+            P = CMATRIX(n, n)
+            for i in range(n):
+                P.set(i, i, 1.0+0.0j)
+            if traj in [1, 3]:
+                phi = 0.7*traj
+                P.set(1, 1, math.cos(phi) + 1.0j*math.sin(phi))
+                P.set(2, 2, -1.0+0.0j)
+            projectors.append(P)
+
+        C = CMATRIX(n, ntraj)
+        for i in range(n):
+            for j in range(ntraj):
+                C.set(i, j, (random.random()-0.5) + 1.0j*(random.random()-0.5))
+
+        for rep in [0, 1]:
+            C_nbra = CMATRIX(C)
+            propagate_electronic_nbra(dt, C_nbra, projectors, ham, rep, 1)
+
+            C_traj = CMATRIX(C)
+            propagate_electronic(dt, C_traj, projectors, ham, rep, 1)
+
+            for i in range(n):
+                for j in range(ntraj):
+                    self.assertAlmostEqual(abs(C_nbra.get(i,j) - C_traj.get(i,j)), 0.0, places=8)
+
+
+
+if __name__=='__main__':
+    unittest.main()
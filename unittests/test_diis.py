@@ -0,0 +1,107 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the DIIS extrapolation in libsolvers
+"""
+
+import os
+import sys
+import math
+import copy
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def add_point(diis, x, n):
+    """ The objective matrix is diag(x) and the error is linear in it: err(i,i) = (i+1)*(x_i - 0.3) """
+    X, E = MATRIX(n, n), MATRIX(n, n)
+    for i in range(n):
+        X.set(i, i, x[i]);  E.set(i, i, (i+1.0)*(x[i] - 0.3))
+    diis.add_diis_matrices(X, E)
+
+
+
+class Test_DIIS(unittest.TestCase):
+
+    def test_1(self):
+        """For the linear error, the extrapolation finds the root once the history spans the space"""
+
+        random.seed(0)
+        n = 2
+        diis = DIIS(4, n)
+        for it in range(8):
+            add_point(diis, [ random.uniform(-1.0, 1.0) for i in range(n) ], n)
+
+            c = diis.get_diis_c()
+            self.assertEqual(len(c), min(it+1, 4))
+            self.assertAlmostEqual(sum(c), 1.0, places=10)
+
+            if it>=n:
+                X = MATRIX(n, n);  diis.extrapolate_matrix(X)
+                for i in range(n):
+                    self.assertAlmostEqual(X.get(i, i), 0.3, places=8)
+
+
+    def test_2(self):
+        """The history keeps the most recent matrices, the oldest first, and copies are independent"""
+
+        diis = DIIS(3, 1)
+        for it in range(5):
+            add_point(diis, [float(it)], 1)
+
+        self.assertEqual([ x.get(0, 0) for x in diis.get_diis_X() ], [2.0, 3.0, 4.0])
+        self.assertEqual([ e.get(0, 0) for e in diis.get_diis_err() ], [x - 0.3 for x in [2.0, 3.0, 4.0]])
+
+        diis2 = copy.deepcopy(diis)
+        add_point(diis, [5.0], 1)
+        self.assertEqual([ x.get(0, 0) for x in diis2.get_diis_X() ], [2.0, 3.0, 4.0])
+        self.assertEqual([ x.get(0, 0) for x in diis.get_diis_X() ], [3.0, 4.0, 5.0])
+
+
+    def test_3(self):
+        """Linearly dependent errors exclude the oldest iterates instead of failing"""
+
+        diis = DIIS(3, 1)
+        for x in [1.0, 1.0, 1.0]:
+            add_point(diis, [x], 1)
+
+        c = diis.get_diis_c()
+        self.assertEqual(diis.N_diis_eff, 1)
+        for i, ci in enumerate([0.0, 0.0, 1.0]):
+            self.assertAlmostEqual(c[i], ci, places=12)
+
+
+    def test_4(self):
+        """Column vectors (e.g. the GDIIS geometries): the root of the linear error is found"""
+
+        random.seed(1)
+        n = 3
+        diis = DIIS(5, n, 1)
+        for it in range(n+1):
+            X, E = MATRIX(n, 1), MATRIX(n, 1)
+            for i in range(n):
+                x = random.uniform(-1.0, 1.0)
+                X.set(i, 0, x);  E.set(i, 0, (i+1.0)*(x - 0.3))
+            diis.add_diis_matrices(X, E)
+
+        X = MATRIX(n, 1);  diis.extrapolate_matrix(X)
+        for i in range(n):
+            self.assertAlmostEqual(X.get(i, 0), 0.3, places=8)
+
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,117 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the prediction of the guess density matrices across the MD steps (Electronic_Structure)
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def set_density(el, t):
+    """ P(t) = A + t*B - a linear trajectory of the density matrices """
+    P = MATRIX(2, 2)
+    P.set(0, 0, 1.0 - 0.1*t);  P.set(1, 1, 0.1*t)
+    P.set(0, 1, 0.05*t);       P.set(1, 0, 0.05*t)
+    el.set_P_alp(P);  el.set_P_bet(P)
+    return P
+
+
+
+class Test_DM_Extrapolation(unittest.TestCase):
+
+    def test_1(self):
+        """ASPC is exact for the densities that change linearly along the trajectory"""
+
+        for k in [0, 1, 3]:
+            el = Electronic_Structure(2)
+            self.assertEqual(el.predict_density("aspc", k), 0)
+
+            for t in range(6):
+                set_density(el, float(t))
+                el.update_density_history("aspc", k)
+
+            self.assertEqual(el.predict_density("aspc", k), 1)
+
+            P = set_density(Electronic_Structure(2), 6.0)
+            for i in range(2):
+                for j in range(2):
+                    self.assertAlmostEqual(el.get_P_alp().get(i, j), P.get(i, j), places=10)
+                    self.assertAlmostEqual(el.get_P().get(i, j), 2.0*P.get(i, j), places=10)
+
+
+    def test_2(self):
+        """XL-BOMD: the auxiliary density stays at the converged one, if the latter does not change"""
+
+        el = Electronic_Structure(2)
+        for n in range(10):
+            P = set_density(el, 1.0)
+            el.update_density_history("xlbomd", 5)
+
+        self.assertEqual(el.predict_density("xlbomd", 5), 1)
+        for i in range(2):
+            for j in range(2):
+                self.assertAlmostEqual(el.get_P_bet().get(i, j), P.get(i, j), places=10)
+
+        el.reset_density_history()
+        self.assertEqual(el.predict_density("xlbomd", 5), 0)
+
+
+    def test_3(self):
+        """XL-BOMD: the auxiliary density follows the Verlet recursion with the dissipation, along a linear trajectory"""
+
+        # K = 5: kappa, alpha and c_k of Niklasson et al. J. Chem. Phys. 130, 214109 (2009)
+        K, kappa, alpha = 5, 1.82, 0.018
+        c = [-6.0, 14.0, -8.0, -3.0, 4.0, -1.0]
+
+        el = Electronic_Structure(2)
+        P = [ set_density(Electronic_Structure(2), float(t)) for t in range(8) ]
+
+        # Hand-computed first steps: the history starts filled with P(0) and sum_k c_k = 0, so
+        # X(1) = P(0) and X(2) = X(1) + kappa * (P(1) - X(1))
+        set_density(el, 0.0);  el.update_density_history("xlbomd", K)
+        set_density(el, 1.0);  el.update_density_history("xlbomd", K)
+        el.predict_density("xlbomd", K)
+        for i in range(2):
+            for j in range(2):
+                x = P[0].get(i, j) + kappa * (P[1].get(i, j) - P[0].get(i, j))
+                self.assertAlmostEqual(el.get_P_alp().get(i, j), x, places=12)
+
+        # The rest of the trajectory, against the recursion written out element by element
+        X = [ [ [P[0].get(i, j)]*(K+1) for j in range(2) ] for i in range(2) ]
+        for i in range(2):
+            for j in range(2):
+                h = X[i][j]
+                h.append( 2.0*h[-1] - h[-2] + kappa*(P[1].get(i, j) - h[-1]) + alpha*sum( c[k]*h[-1-k] for k in range(K+1) ) )
+
+        for t in range(2, 8):
+            set_density(el, float(t))
+            el.update_density_history("xlbomd", K)
+            el.predict_density("xlbomd", K)
+
+            for i in range(2):
+                for j in range(2):
+                    h = X[i][j]
+                    h.append( 2.0*h[-1] - h[-2] + kappa*(P[t].get(i, j) - h[-1]) + alpha*sum( c[k]*h[-1-k] for k in range(K+1) ) )
+                    self.assertAlmostEqual(el.get_P_alp().get(i, j), h[-1], places=10)
+                    self.assertAlmostEqual(el.get_P().get(i, j), 2.0*h[-1], places=10)
+
+
+
+if __name__=='__main__':
+    unittest.main()
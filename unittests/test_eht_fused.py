@@ -0,0 +1,219 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the one-pass (fused) EHT overlaps, core Hamiltonian and their gradients (Hamiltonian_core_eht_fused)
+"""
+
+import os
+import sys
+import math
+import ctypes
+import ctypes.util
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tests", "test_qm", "tests_azulene")
+Angst = 1.889725989
+
+# A distorted methane molecule [Angstrom]
+CH4 = [ ["C",  0.00,  0.00,  0.00],
+        ["H",  0.05,  0.02, -1.06],
+        ["H",  1.02, -0.03,  0.33],
+        ["H", -0.48,  0.88,  0.37],
+        ["H", -0.51, -0.85,  0.34] ]
+
+
+class element:
+    pass
+
+def make_universe():
+    U = Universe()
+    for name, z, m in [ ["H", 1, 1.008], ["C", 6, 12.011] ]:
+        e = element()
+        e.Elt_name, e.Elt_number, e.Elt_nucleus_charge, e.Elt_mass = name, z, z, m*1822.888
+        elt = Element();  elt.set(e)
+        U.Add_Element_To_Periodic_Table(elt)
+    return U
+
+def make_system(U, atoms):
+    syst = System()
+    for a in atoms:
+        syst.CREATE_ATOM( Atom(U, {"Atom_element":a[0], "Atom_cm_x":a[1]*Angst, "Atom_cm_y":a[2]*Angst, "Atom_cm_z":a[3]*Angst}) )
+    return syst
+
+def make_ham(U, atoms, eht_formula):
+    """ The parameters file is given relative to the control file """
+    cwd = os.getcwd();  os.chdir(DATA)
+    syst = make_system(U, atoms)
+    ham = listHamiltonian_QM("control_parameters_eht.dat", syst)
+    os.chdir(cwd)
+    ham.prms.eht_formula = eht_formula
+    return syst, ham
+
+def core_fused(syst, ham, P, W, thresh):
+    H, S = MATRIX(ham.Norb, ham.Norb), MATRIX(ham.Norb, ham.Norb)
+    dEdR = VECTORList()
+    Hamiltonian_core_eht_fused(syst, ham.basis_ao, ham.prms, ham.modprms, ham.atom_to_ao_map, ham.ao_to_atom_map, H, S, P, W, thresh, dEdR)
+    return H, S, dEdR
+
+def trace(A, B):
+    n = A.num_of_rows
+    return sum( A.get(i,j)*B.get(j,i) for i in range(n) for j in range(n) )
+
+def max_diff(A, B):
+    return max( abs(A.get(i,j) - B.get(i,j)) for i in range(A.num_of_rows) for j in range(A.num_of_cols) )
+
+def random_symmetric(n):
+    P = MATRIX(n, n)
+    for i in range(n):
+        for j in range(i, n):
+            x = random.random() - 0.5
+            P.set(i, j, x);  P.set(j, i, x)
+    return P
+
+def set_omp_threads(n):
+    """ Returns 0 if the OpenMP runtime is not available """
+    name = ctypes.util.find_library("gomp")
+    if name==None:
+        return 0
+    ctypes.CDLL(name).omp_set_num_threads(n)
+    return 1
+
+
+
+class Test_EHT_Fused(unittest.TestCase):
+
+    def test_1(self):
+        """The fused overlaps and core Hamiltonian agree with Hamiltonian_core_eht, with and without the screening"""
+
+        U = make_universe()
+
+        # Two molecules 6 Angstrom apart, so some of the pairs of atoms are screened out
+        atoms = CH4 + [ [a[0], a[1]+6.0, a[2], a[3]] for a in CH4 ]
+
+        for f in [0, 1, 2]:
+            syst, ham = make_ham(U, atoms, f)
+            n = ham.Norb
+
+            # The reference: the full overlap matrix, then the core Hamiltonian built from it
+            H0, S0 = MATRIX(n, n), MATRIX(n, n)
+            update_overlap_matrix(0, 0, 0, VECTOR(), VECTOR(), VECTOR(), ham.basis_ao, S0)
+            Hamiltonian_core_eht(syst, ham.basis_ao, ham.prms, ham.modprms, ham.atom_to_ao_map, ham.ao_to_atom_map, H0, S0, 0)
+
+            # The largest |H_ij / S_ij| - the skipped Hamiltonian elements are bounded by beta_max * thresh
+            beta_max = max( abs(H0.get(i,j)/S0.get(i,j)) for i in range(n) for j in range(n) if abs(S0.get(i,j))>1e-6 )
+
+            # No screening: the same matrices up to the round-off
+            H, S = MATRIX(n, n), MATRIX(n, n)
+            Hamiltonian_core_eht_fused(syst, ham.basis_ao, ham.prms, ham.modprms, ham.atom_to_ao_map, ham.ao_to_atom_map, H, S, 0.0)
+            self.assertLess(max_diff(S, S0), 1e-12)
+            self.assertLess(max_diff(H, H0), 1e-12)
+
+            # Screening: the dropped overlaps are never larger than the threshold
+            n_skipped = 0
+            for thresh in [1e-2, 1e-4, 1e-8]:
+                H, S = MATRIX(n, n), MATRIX(n, n)
+                Hamiltonian_core_eht_fused(syst, ham.basis_ao, ham.prms, ham.modprms, ham.atom_to_ao_map, ham.ao_to_atom_map, H, S, thresh)
+
+                self.assertLessEqual(max_diff(S, S0), thresh)
+                self.assertLessEqual(max_diff(H, H0), beta_max * thresh)
+                n_skipped += sum( 1 for i in range(n) for j in range(n) if S.get(i,j)==0.0 and S0.get(i,j)!=0.0 )
+
+            # ... and some of them are actually dropped
+            self.assertGreater(n_skipped, 0)
+
+
+    def test_1a(self):
+        """The screening is off by default"""
+
+        U = make_universe()
+        syst, ham = make_ham(U, CH4, 0)
+        self.assertEqual(ham.ovlp_thresh, 0.0)
+
+
+    def test_2(self):
+        """dEdR is the derivative of Tr(P*H) - Tr(W*S) for all the EHT formulas (central differences)"""
+
+        random.seed(0)
+        U = make_universe()
+        dx = 1e-4
+
+        for f in [0, 1, 2]:
+            syst, ham = make_ham(U, CH4, f)
+            n = ham.Norb
+
+            P, W, Z = random_symmetric(n), random_symmetric(n), MATRIX(n, n)
+
+            for PP, WW in [ [P, Z], [Z, W] ]:
+                H, S, dEdR = core_fused(syst, ham, PP, WW, 0.0)
+
+                for at in range(len(CH4)):
+                    for k in range(3):
+                        E = []
+                        for sign in [1.0, -1.0]:
+                            atoms = [ list(a) for a in CH4 ]
+                            atoms[at][k+1] += sign * dx / Angst
+                            syst1, ham1 = make_ham(U, atoms, f)
+                            H1, S1 = MATRIX(n, n), MATRIX(n, n)
+                            Hamiltonian_core_eht_fused(syst1, ham1.basis_ao, ham1.prms, ham1.modprms, ham1.atom_to_ao_map, ham1.ao_to_atom_map, H1, S1, 0.0)
+                            E.append( trace(PP, H1) - trace(WW, S1) )
+
+                        g = [dEdR[at].x, dEdR[at].y, dEdR[at].z][k]
+                        self.assertAlmostEqual(g, (E[0] - E[1])/(2.0*dx), places=6)
+
+
+    def test_3(self):
+        """The threaded build gives the same matrices and gradients as the single-threaded one"""
+
+        random.seed(1)
+        U = make_universe()
+        atoms = CH4 + [ [a[0], a[1]+3.0, a[2]+1.0, a[3]] for a in CH4 ]
+        syst, ham = make_ham(U, atoms, 1)
+        n = ham.Norb
+        P, W = random_symmetric(n), random_symmetric(n)
+
+        if not set_omp_threads(4):
+            self.skipTest("no OpenMP runtime")
+        H4, S4, dEdR4 = core_fused(syst, ham, P, W, 1e-8)
+
+        set_omp_threads(1)
+        H1, S1, dEdR1 = core_fused(syst, ham, P, W, 1e-8)
+
+        self.assertLess(max_diff(H4, H1), 1e-12)
+        self.assertLess(max_diff(S4, S1), 1e-12)
+        for at in range(len(atoms)):
+            self.assertLess((dEdR4[at] - dEdR1[at]).length(), 1e-12)
+
+
+    def test_4(self):
+        """With the charge corrections, energy_and_forces() warns about the forces, but does not stop"""
+
+        U = make_universe()
+        for sce, elst in [ [1, 0], [0, 1] ]:
+            syst, ham = make_ham(U, CH4, 0)
+            ham.prms.eht_sce_formula = sce
+            ham.prms.eht_electrostatics = elst
+
+            E = ham.energy_and_forces(syst)
+            self.assertTrue(math.isfinite(E))
+            for at in range(len(CH4)):
+                self.assertTrue(math.isfinite(syst.Atoms[at].Atom_RB.rb_force.length()))
+
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,201 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the EHT parameters indexed by the orbital type: the mEHT_K tables and the
+ per-orbital OrbParams must reproduce the (element, shell) string lookups, and the
+ EHT energies must stay the same
+"""
+
+import os
+import sys
+import math
+import shutil
+import tempfile
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tests", "test_qm", "tests_azulene")
+Angst = 1.889725989
+eV = 0.036749309
+
+# Disilane [Angstrom]: it has the non-default H-Si and Si-Si K constants and the SC-EHT slopes for Si
+SI2H6 = [ ["Si",  0.00,  0.00,  1.17],
+          ["Si",  0.02, -0.01, -1.16],
+          ["H",   1.40,  0.00,  1.66],
+          ["H",  -0.70,  1.21,  1.65],
+          ["H",  -0.69, -1.20,  1.67],
+          ["H",  -1.39,  0.01, -1.66],
+          ["H",   0.70,  1.22, -1.64],
+          ["H",   0.71, -1.21, -1.67] ]
+
+# Cd has a two-zeta 4d shell
+CDH2 = [ ["Cd",  0.00,  0.00,  0.00],
+         ["H",   1.68,  0.00,  0.05],
+         ["H",  -1.67,  0.03,  0.00] ]
+
+# The shell parameters as given in muller_params: [Nquant, coeffs, zetas, J_param1 and J_param2 in eV]
+SHELLS = { ("H", "1s"):  [1, [1.0], [1.300], 0.0, 0.0],
+           ("Si","3s"):  [3, [1.0], [1.588], 8.64, 8.64],
+           ("Si","3p"):  [3, [1.0], [1.256], 8.70, 8.70],
+           ("Cd","5s"):  [5, [1.0], [1.706], 0.0, 0.0],
+           ("Cd","5p"):  [5, [1.0], [1.432], 0.0, 0.0],
+           ("Cd","4d"):  [4, [0.824, 0.325], [4.094, 1.640], 0.0, 0.0] }
+
+# Disilane energies for [eht_formula, eht_sce_formula]. The charge-independent ones are computed with the
+# original implementation, which looked up the parameters by the element and shell names. The SC-EHT ones
+# are computed with the parameters of the i-th orbital - the original code took those of the orbital with
+# the index of the atom instead (-5.9161322165 and -7.8799707998)
+REF = { (0,0): -7.0548577032,
+        (1,0): -7.0732585201,
+        (2,0): -7.7477548143,
+        (0,1): -6.6527326907,
+        (2,1): -8.1533584178 }
+
+
+class element:
+    pass
+
+def make_universe():
+    U = Universe()
+    for name, z, m in [ ["H", 1, 1.008], ["Si", 14, 28.086], ["Cd", 48, 112.411] ]:
+        e = element()
+        e.Elt_name, e.Elt_number, e.Elt_nucleus_charge, e.Elt_mass = name, z, z, m*1822.888
+        elt = Element();  elt.set(e)
+        U.Add_Element_To_Periodic_Table(elt)
+    return U
+
+def make_system(U, atoms):
+    syst = System()
+    for a in atoms:
+        syst.CREATE_ATOM( Atom(U, {"Atom_element":a[0], "Atom_cm_x":a[1]*Angst, "Atom_cm_y":a[2]*Angst, "Atom_cm_z":a[3]*Angst}) )
+    return syst
+
+def make_ham(U, atoms, eht_formula=0, eht_sce_formula=0):
+    """ Run in the working directory made by setUp: the parameters file is given relative to the control file """
+    syst = make_system(U, atoms)
+    ham = listHamiltonian_QM("control_parameters_eht.dat", syst)
+    ham.prms.eht_formula = eht_formula
+    ham.prms.eht_sce_formula = eht_sce_formula
+    ham.prms.scf_algo = "oda"    # plain iterations do not converge with the charge-dependent Fock matrix
+    ham.prms.etol = 1e-8
+    ham.prms.den_tol = 1e-6
+    return ham, syst
+
+def radius(n, coeffs, zetas):
+    """ The orbital radius of the Calzaferi formula """
+    if len(zetas)==1:
+        return n/zetas[0]
+    z1, z2 = zetas
+    c1, c2 = coeffs
+    return n/(c1*c1*z1 + c2*c2*z2 + 2.0**(2.0*n) * (z1*z2)**(n+0.5) / (z1+z2)**(2.0*n))
+
+
+
+class Test_EHT_Tables(unittest.TestCase):
+
+    def setUp(self):
+        self.cwd = os.getcwd()
+        self.tmp = tempfile.mkdtemp()
+        for f in ["control_parameters_eht.dat", "muller_params"]:
+            shutil.copy(os.path.join(DATA, f), self.tmp)
+        os.chdir(self.tmp)
+
+    def tearDown(self):
+        os.chdir(self.cwd)
+        shutil.rmtree(self.tmp)
+
+
+    def test_1(self):
+        """The type-indexed K and C tables are the same as the lookups by the element and shell names"""
+
+        U = make_universe()
+        for atoms in [SI2H6, CDH2]:
+            ham, syst = make_ham(U, atoms)
+            modprms, ao = ham.modprms, ham.basis_ao
+            norb = len(ao)
+
+            for I in range(norb):
+                for J in range(norb):
+                    for k in range(5):
+                        K = modprms.eht_k.get_K_value(k, ao[I].element, ao[I].ao_shell, ao[J].element, ao[J].ao_shell)
+                        C = modprms.eht_k.get_C_value(k, ao[I].element, ao[I].ao_shell, ao[J].element, ao[J].ao_shell)
+                        self.assertEqual(modprms.meht_k.get_K_value(k, I, J), K)
+                        self.assertEqual(modprms.meht_k.get_C_value(k, I, J), C)
+
+        # Make sure the explicitly given constants are among those compared
+        self.assertAlmostEqual(modprms.eht_k.get_K_value(0, "H", "1s", "Si", "3p"), 1.24, places=12)
+        self.assertAlmostEqual(modprms.eht_k.get_K_value(0, "Si", "3s", "Si", "3s"), 1.412, places=12)
+
+
+    def test_2(self):
+        """The per-orbital parameters: the orbital radii, the IPs and the SC-EHT slopes"""
+
+        U = make_universe()
+        for atoms in [SI2H6, CDH2]:
+            ham, syst = make_ham(U, atoms)
+            modprms, ao = ham.modprms, ham.basis_ao
+
+            for i in range(len(ao)):
+                n, coeffs, zetas, J1, J2 = SHELLS[ (ao[i].element, ao[i].ao_shell) ]
+                op = modprms.orb_params[i]
+
+                self.assertAlmostEqual(op.radius, radius(n, coeffs, zetas), places=12)
+                self.assertEqual(op.Nquant, n)
+                self.assertAlmostEqual(op.J_param1, J1*eV, places=12)
+                self.assertAlmostEqual(op.J_param2, J2*eV, places=12)
+
+
+    def test_3(self):
+        """The EHT energies with the charge-independent and the charge-dependent (SC-EHT) Fock matrices"""
+
+        U = make_universe()
+        for key in sorted(REF.keys()):
+            ham, syst = make_ham(U, SI2H6, key[0], key[1])
+            E = ham.compute_scf(syst)
+            self.assertAlmostEqual(E, REF[key], places=8)
+
+
+    def test_4(self):
+        """SC-EHT: the diagonal Fock elements are shifted by the Mulliken charge of the atom times the slope of the orbital"""
+
+        U = make_universe()
+        ham, syst = make_ham(U, SI2H6, 0, 1)
+        ham.compute_scf(syst)
+
+        el, ao = ham.get_electronic_structure(), ham.basis_ao
+        Hamiltonian_Fock_eht(el, syst, ao, ham.prms, ham.modprms, ham.atom_to_ao_map, ham.ao_to_atom_map)
+
+        P, S, H, F = el.get_P(), el.get_Sao(), el.get_Hao(), el.get_Fao_alp()
+        norb = len(ao)
+        Zeff = {"Si": 4.0, "H": 1.0}
+
+        Q = [ Zeff[a[0]] for a in SI2H6 ]
+        for i in range(norb):
+            Q[ham.ao_to_atom_map[i]] -= sum(P.get(i,j)*S.get(j,i) for j in range(norb))
+
+        for i in range(norb):
+            q = Q[ham.ao_to_atom_map[i]]
+            n, coeffs, zetas, J1, J2 = SHELLS[ (ao[i].element, ao[i].ao_shell) ]
+            A = J1 if q>0 else J2
+            self.assertAlmostEqual(F.get(i,i), H.get(i,i) - A*eV*q, places=10)
+
+        # The charges are not negligible, so the check is meaningful
+        self.assertTrue(abs(Q[0]) > 0.01)
+
+
+
+if __name__=='__main__':
+    unittest.main()
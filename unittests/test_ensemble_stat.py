@@ -0,0 +1,103 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the C++ ensemble statistics of the TSH calculations
+"""
+
+import os
+import sys
+import math
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def _test_setup(nst, nframes, ntraj):
+
+    random.seed(5)
+
+    Hvib = []
+    for f in range(nframes):
+        H = CMATRIX(nst, nst)
+        for i in range(nst):
+            H.set(i, i, (0.1*i + 0.01*random.random())*(1.0+0.0j))
+            for j in range(i+1, nst):
+                x = 0.001*(random.random()-0.5) + 0.001j*(random.random()-0.5)
+                H.set(i, j, x);  H.set(j, i, x.conjugate())
+        Hvib.append(H)
+
+    C = CMATRIX(nst, ntraj)
+    for tr in range(ntraj):
+        for i in range(nst):
+            C.set(i, tr, (random.random()-0.5) + 1.0j*(random.random()-0.5))
+
+    act_states = [ random.randint(0, nst-1) for tr in range(ntraj) ]
+    ham_indx = [ int(tr*nframes/ntraj) for tr in range(ntraj) ]
+
+    return Hvib, C, act_states, ham_indx
+
+
+
+class TestEnsembleStat(unittest.TestCase):
+
+    def test_1(self):
+        """compute_ensemble_stat reproduces the direct Python averaging"""
+
+        nst, nframes, ntraj = 4, 3, 30
+        Hvib, C, act_states, ham_indx = _test_setup(nst, nframes, ntraj)
+
+        dm_se, dm_sh = CMATRIX(nst, nst), CMATRIX(nst, nst)
+        res = compute_ensemble_stat(C, Py2Cpp_int(act_states), Py2Cpp_CMATRIX(Hvib), Py2Cpp_int(ham_indx), dm_se, dm_sh)
+
+        rho_ave = CMATRIX(nst, nst)
+        en_se, en_sh = 0.0, 0.0
+        for tr in range(ntraj):
+            H = Hvib[ham_indx[tr]]
+            rho = C.col(tr) * C.col(tr).H()
+            rho_ave = rho_ave + rho
+            en_se += (rho.real() * H.real()).tr()
+            en_sh += H.get(act_states[tr], act_states[tr]).real
+
+        for i in range(nst):
+            self.assertAlmostEqual(res.get(0, 3*i+1), rho_ave.get(i,i).real/ntraj, places=12)
+            self.assertAlmostEqual(res.get(0, 3*i+2), act_states.count(i)/float(ntraj), places=12)
+            for j in range(nst):
+                self.assertAlmostEqual(abs(dm_se.get(i,j) - rho_ave.get(i,j)/ntraj), 0.0, places=12)
+
+        self.assertAlmostEqual(res.get(0, 3*nst+0), en_se/ntraj, places=12)
+        self.assertAlmostEqual(res.get(0, 3*nst+1), en_sh/ntraj, places=12)
+        self.assertAlmostEqual(res.get(0, 3*nst+3), 1.0, places=12)
+
+
+    def test_2(self):
+        """The running accumulator averages the results over the steps"""
+
+        nst, nframes, ntraj = 3, 2, 10
+        Hvib, C, act_states, ham_indx = _test_setup(nst, nframes, ntraj)
+
+        stat = tsh_ensemble_stat(nst)
+        r1 = stat.update(C, Py2Cpp_int(act_states), Py2Cpp_CMATRIX(Hvib), Py2Cpp_int(ham_indx))
+        C *= 0.5
+        r2 = stat.update(C, Py2Cpp_int(act_states), Py2Cpp_CMATRIX(Hvib), Py2Cpp_int(ham_indx))
+
+        ave = stat.get_res_ave()
+        self.assertEqual(stat.nsamples, 2)
+        for k in range(3*nst+4):
+            self.assertAlmostEqual(ave.get(0,k), 0.5*(r1.get(0,k) + r2.get(0,k)), places=12)
+
+
+
+if __name__=='__main__':
+    unittest.main()
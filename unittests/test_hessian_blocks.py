@@ -0,0 +1,268 @@
+#*********************************************************************************
+#* Copyright (C) 2017 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the sparse storage of the Hamiltonian second derivatives and for the Hessians
+ of an atomistic (MM) Hamiltonian
+"""
+
+import os
+import sys
+import math
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+from libra_py import LoadUFF, normal_modes
+
+
+UFF = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "libra_py", "uff.dat")
+Angst = 1.889725989
+
+# A distorted propane molecule [Angstrom]: the H atoms of the two terminal carbons
+# are not connected by any bond or angle
+PROPANE = [ ["C", "C_3",  0.00,  0.00,  0.00],
+            ["C", "C_3",  1.55,  0.02,  0.01],
+            ["C", "C_3",  2.07,  1.46, -0.03],
+            ["H", "H_",  -0.38, -1.03,  0.05],
+            ["H", "H_",  -0.37,  0.50,  0.91],
+            ["H", "H_",  -0.40,  0.55, -0.86],
+            ["H", "H_",   1.92, -0.52,  0.88],
+            ["H", "H_",   1.90, -0.50, -0.90],
+            ["H", "H_",   3.16,  1.45,  0.02],
+            ["H", "H_",   1.74,  1.99,  0.88],
+            ["H", "H_",   1.70,  1.98, -0.91] ]
+BONDS = [ (1,2), (2,3), (1,4), (1,5), (1,6), (2,7), (2,8), (3,9), (3,10), (3,11) ]
+MASS = { "H": 1.008*1822.888, "C": 12.011*1822.888 }
+
+
+class element:
+    pass
+
+def make_ham():
+    """ Harmonic bonds and angles of UFF """
+    U = Universe()
+    for name, z in [ ["H", 1], ["C", 6] ]:
+        e = element()
+        e.Elt_name, e.Elt_number, e.Elt_nucleus_charge, e.Elt_mass = name, z, z, MASS[name]
+        elt = Element();  elt.set(e)
+        U.Add_Element_To_Periodic_Table(elt)
+
+    syst = System()
+    for a in PROPANE:
+        syst.CREATE_ATOM( Atom(U, {"Atom_element":a[0], "Atom_ff_type":a[1], "Atom_cm_x":a[2]*Angst, "Atom_cm_y":a[3]*Angst, "Atom_cm_z":a[4]*Angst}) )
+    for b in BONDS:
+        syst.LINK_ATOMS(b[0], b[1])
+    syst.determine_functional_groups(0)
+
+    uff = ForceField({"bond_functional":"Harmonic", "angle_functional":"Harmonic"})
+    LoadUFF.Load_UFF(uff, UFF)
+
+    nat = len(PROPANE)
+    atlst = list(range(1, nat+1))
+    ham = Hamiltonian_Atomistic(1, 3*nat)
+    ham.set_Hamiltonian_type("MM")
+    ham.set_interactions_for_atoms(syst, atlst, atlst, uff, 0, 0)
+    ham.set_system(syst)
+
+    q0 = []
+    for a in PROPANE:
+        q0 = q0 + [a[2]*Angst, a[3]*Angst, a[4]*Angst]
+
+    return ham, syst, q0
+
+def energy(ham, q):
+    ham.set_q(q);  ham.compute()
+    return ham.H(0,0).real
+
+def forces(ham, q):
+    ham.set_q(q);  ham.compute()
+    return [ -ham.dHdq(0,0,n).real for n in range(len(q)) ]
+
+def hessian_fd(ham, q0, dq):
+    """ The Hessian by the central finite differences of the forces """
+    ndof = len(q0)
+    H = MATRIX(ndof, ndof)
+    for n2 in range(ndof):
+        qp = list(q0);  qp[n2] += dq
+        qm = list(q0);  qm[n2] -= dq
+        fp, fm = forces(ham, qp), forces(ham, qm)
+        for n1 in range(ndof):
+            H.set(n1, n2, -(fp[n1] - fm[n1])/(2.0*dq) )
+    ham.set_q(q0)
+    return H
+
+
+
+class Test_Hessian_Blocks(unittest.TestCase):
+
+    def test_1(self):
+        """Only the requested blocks are allocated, the rest are zero"""
+
+        h = Hessian_Blocks(2, 1000)
+        self.assertEqual(h.num_blocks(), 0)
+        self.assertEqual(h.is_allocated(3, 5), 0)
+        self.assertAlmostEqual(h.get(3, 5).get(0,0), 0.0)
+
+        x = MATRIX(2, 2); x.set(0, 0, 1.5); x.set(1, 1, -2.0)
+        h.set(3, 5, x)
+        self.assertEqual(h.num_blocks(), 1)
+        self.assertEqual(h.is_allocated(3, 5), 1)
+        self.assertEqual(h.is_allocated(5, 3), 0)
+        self.assertAlmostEqual(h.get(3, 5).get(1,1), -2.0)
+
+        h.zero()
+        self.assertEqual(h.num_blocks(), 1)
+        self.assertAlmostEqual(h.get(3, 5).get(0,0), 0.0)
+
+        h.clear()
+        self.assertEqual(h.num_blocks(), 0)
+
+
+    def test_2(self):
+        """Sparse Hessian-vector product agrees with the dense one"""
+
+        n = 6
+        dense = MATRIX(n, n)
+        h = Hessian_Blocks(2, n)
+        for (i, j, val) in [(0,0,2.0), (0,1,-1.0), (1,0,-1.0), (1,1,2.0), (4,5,0.5), (5,4,0.5)]:
+            x = MATRIX(2, 2); x.set(1, 1, val)
+            h.set(i, j, x)
+            dense.set(i, j, val)
+
+        v = MATRIX(n, 1)
+        for i in range(n):
+            v.set(i, 0, 1.0 + i)
+
+        res = h.multiply(v, 1)
+        ref = dense * v
+        for i in range(n):
+            self.assertAlmostEqual(res.get(i,0), ref.get(i,0))
+
+        # The state 0 elements are all zero
+        res = h.multiply(v, 0)
+        for i in range(n):
+            self.assertAlmostEqual(res.get(i,0), 0.0)
+
+        # All states: res[n1] = sum_n2 { H[n1][n2] * v[n2] }, as nelec x nelec matrices
+        res = MATRIXList()
+        h.multiply(v, res)
+        self.assertEqual(len(res), n)
+        for i in range(n):
+            self.assertAlmostEqual(res[i].get(1,1), ref.get(i,0))
+            self.assertAlmostEqual(res[i].get(0,0), 0.0)
+
+        h2 = Hessian_Blocks(h)
+        self.assertEqual(h2.num_blocks(), 6)
+        self.assertAlmostEqual(h2.multiply(v, 1).get(0,0), ref.get(0,0))
+
+
+    def test_3(self):
+        """Hessian-vector products and the full Hessian of the MM Hamiltonian agree with the finite differences of the forces"""
+
+        random.seed(0)
+        ham, syst, q0 = make_ham()
+        ndof, dq = len(q0), 0.001
+        E0 = energy(ham, q0)
+        Hfd = hessian_fd(ham, q0, dq)
+
+        H = ham.compute_hessian(0, dq)
+        for n1 in range(ndof):
+            for n2 in range(ndof):
+                self.assertAlmostEqual(H.get(n1,n2), Hfd.get(n1,n2), places=6)
+
+        for k in range(3):
+            v = MATRIX(ndof, 1)
+            for n in range(ndof):
+                v.set(n, 0, random.uniform(-1.0, 1.0))
+            hv = ham.hessian_vector_product(v, 0, dq)
+            ref = Hfd * v
+            for n in range(ndof):
+                self.assertAlmostEqual(hv.get(n,0), ref.get(n,0), places=6)
+
+            # The curvature along v, from the energies only
+            h = 0.002
+            qp = [ q0[n] + h*v.get(n,0) for n in range(ndof) ]
+            qm = [ q0[n] - h*v.get(n,0) for n in range(ndof) ]
+            curv = (energy(ham, qp) + energy(ham, qm) - 2.0*E0)/(h*h)
+            ham.set_q(q0)
+            self.assertAlmostEqual( (v.T() * hv).get(0,0) / curv, 1.0, places=4)
+
+        # hessian_vector_product restores the coordinates
+        hv = ham.hessian_vector_product(v, 0, dq)
+        ham.compute()
+        self.assertAlmostEqual(ham.H(0,0).real, E0, places=12)
+        self.assertTrue( abs(Hfd.get(0,0)) > 0.1 )
+
+
+    def test_4(self):
+        """The second-derivative blocks of the bonded interactions are the Hessian elements, the rest of the Hessian is zero"""
+
+        ham, syst, q0 = make_ham()
+        ndof, dq = len(q0), 0.001
+        Hfd = hessian_fd(ham, q0, dq)
+
+        ham.request_d2ham_bonded()
+        ham.compute_d2ham(dq)
+        self.assertTrue( ham.num_d2ham_blocks() < ndof*ndof )
+
+        nalloc = 0
+        for n1 in range(ndof):
+            for n2 in range(ndof):
+                if ham.d2ham_blocks.is_allocated(n1, n2):
+                    nalloc += 1
+                    self.assertAlmostEqual(ham.get_d2ham(n1, n2).get(0,0), Hfd.get(n1,n2), places=6)
+                else:
+                    self.assertAlmostEqual(Hfd.get(n1,n2), 0.0, places=8)
+        self.assertEqual(nalloc, ham.num_d2ham_blocks())
+
+        # H atoms 4 and 9 sit on different terminal carbons
+        self.assertEqual(ham.d2ham_blocks.is_allocated(3*3, 3*8), 0)
+
+
+    def test_5(self):
+        """The normal modes from compute_dynmat_ham diagonalize the dynamic matrix made of the finite-difference Hessian"""
+
+        ham, syst, q0 = make_ham()
+        ndof, dq = len(q0), 0.001
+        Hfd = hessian_fd(ham, q0, dq)
+
+        M = MATRIX(ndof, 1)
+        R = MATRIX(ndof, 1)
+        E = [ a[0] for a in PROPANE ]
+        for n in range(ndof):
+            M.set(n, 0, MASS[ E[n//3] ])
+            R.set(n, 0, q0[n])
+
+        D = MATRIX(ndof, ndof)
+        for n1 in range(ndof):
+            for n2 in range(ndof):
+                D.set(n1, n2, Hfd.get(n1,n2)/math.sqrt(M.get(n1,0)*M.get(n2,0)) )
+
+        w, w_inv_cm, U = normal_modes.compute_dynmat_ham(ham, R, M, E, {"verbosity":0, "visualize":0, "dq":dq})
+
+        npos = 0
+        for k in range(ndof):
+            if w.get(k,0) > 0.0:
+                npos += 1
+                u = U.col(k)
+                res = D * u - (w.get(k,0)**2) * u
+                self.assertAlmostEqual( math.sqrt((res.T() * res).get(0,0)), 0.0, places=8)
+
+        # All but the translations and rotations (and a few modes of the distorted geometry) are real
+        self.assertTrue( npos >= ndof - 12 )
+
+
+
+if __name__=='__main__':
+    unittest.main()
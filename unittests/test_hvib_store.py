@@ -0,0 +1,190 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the binary memory-mapped Hvib store
+"""
+
+import os
+import sys
+import math
+import random
+import shutil
+import tempfile
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+import libra_py.workflows.nbra.step4 as step4
+
+
+def _test_setup(nst, nframes):
+
+    random.seed(7)
+
+    Hvib = []
+    for idata in range(len(nframes)):
+        hvib = []
+        for f in range(nframes[idata]):
+            H = CMATRIX(nst, nst)
+            for i in range(nst):
+                H.set(i, i, (0.1*i + 0.01*random.random())*(1.0+0.0j))
+                for j in range(i+1, nst):
+                    x = 0.001*(random.random()-0.5) + 0.001j*(random.random()-0.5)
+                    if j==i+2:
+                        x = 1e-8j     # negligible coupling
+                    H.set(i, j, x);  H.set(j, i, x.conjugate())
+            hvib.append(H)
+        Hvib.append(hvib)
+
+    hvib_map = CMATRIXMap()
+    for hvib in Hvib:
+        hvib_map.append(Py2Cpp_CMATRIX(hvib))
+
+    return Hvib, hvib_map
+
+
+def _write_text_files(path, nstates, nfiles):
+    """ The Hvib text files as produced by the NBRA step3: Hvib_<i>_re and Hvib_<i>_im """
+
+    os.mkdir(path)
+    for i in range(nfiles):
+        for suffix in ["_re", "_im"]:
+            f = open(os.path.join(path, "Hvib_%i%s" % (i, suffix)), "w")
+            for a in range(nstates):
+                f.write(" ".join("%.15e" % (random.random()-0.5) for b in range(nstates)) + "\n")
+            f.close()
+
+
+def _max_diff(A, B):
+    return max( abs(A.get(i,j) - B.get(i,j)) for i in range(A.num_of_rows) for j in range(A.num_of_cols) )
+
+
+
+class TestHvibStore(unittest.TestCase):
+
+    def setUp(self):
+        self.tmp = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp)
+
+
+    def test_1(self):
+        """The dense store returns exactly the stored frames"""
+
+        nst = 4
+        Hvib, hvib_map = _test_setup(nst, [3, 5])
+        filename = os.path.join(self.tmp, "hvib_dense.bin")
+        hvib_store_write(filename, hvib_map, 0, 0.0)
+
+        store = Hvib_store(filename)
+        self.assertEqual(store.ndata, 2)
+        self.assertEqual(store.get_nframes(1), 5)
+
+        out = CMATRIX(nst, nst)
+        for idata in range(2):
+            for f in range(len(Hvib[idata])):
+                store.get_frame(idata, f, out)
+                self.assertEqual(_max_diff(out, Hvib[idata][f]), 0.0)
+
+
+    def test_2(self):
+        """The sparse store drops only the off-diagonal elements below the threshold"""
+
+        nst = 4
+        Hvib, hvib_map = _test_setup(nst, [4])
+        filename = os.path.join(self.tmp, "hvib_sparse.bin")
+        hvib_store_write(filename, hvib_map, 1, 1e-6)
+
+        store = Hvib_store(filename)
+        for f in range(4):
+            H = store.get_frame(0, f)
+            for i in range(nst):
+                for j in range(nst):
+                    if j==i+2 or i==j+2:
+                        self.assertEqual(abs(H.get(i,j)), 0.0)
+                    else:
+                        self.assertEqual(abs(H.get(i,j) - Hvib[0][f].get(i,j)), 0.0)
+
+
+    def test_3(self):
+        """Text files -> store (hvib_store_convert and step4.convert_Hvib2) -> load_Hvib_store gives the same
+        matrices as reading the text files with step4.get_Hvib2"""
+
+        random.seed(11)
+        nstates, nfiles = 5, 3
+        paths = []
+        for d in range(2):
+            paths.append(os.path.join(self.tmp, "set%i" % d) + os.sep)
+            _write_text_files(paths[-1], nstates, nfiles)
+
+        params = { "data_set_paths":paths, "nstates":nstates, "nfiles":nfiles, "active_space":[0, 2, 3, 4],
+                   "Hvib_re_prefix":"Hvib_", "Hvib_im_prefix":"Hvib_", "Hvib_re_suffix":"_re", "Hvib_im_suffix":"_im" }
+        ref = step4.get_Hvib2(dict(params))
+        nst = len(params["active_space"])
+
+        # The C++ function directly
+        filename = os.path.join(self.tmp, "hvib_conv.bin")
+        cpp_paths = StringList()
+        for path in paths:
+            cpp_paths.append(path)
+        hvib_store_convert(filename, cpp_paths, "Hvib_", "_re", "Hvib_", "_im", nstates, nfiles,
+                           Py2Cpp_int(params["active_space"]), 0, 0.0)
+
+        store = Hvib_store(filename)
+        self.assertEqual(store.nst, nst)
+        self.assertEqual(store.ndata, 2)
+        out = CMATRIX(nst, nst)
+        for d in range(2):
+            self.assertEqual(store.get_nframes(d), nfiles)
+            for i in range(nfiles):
+                store.get_frame(d, i, out)
+                self.assertEqual(_max_diff(out, ref[d][i]), 0.0)
+
+        # The Python workflow: dense and sparse stores
+        for is_sparse, thresh in [ (0, 0.0), (1, 0.2) ]:
+            prms = dict(params)
+            prms.update({ "Hvib_store_file":os.path.join(self.tmp, "hvib_%i.bin" % is_sparse),
+                          "Hvib_store_sparse":is_sparse, "Hvib_store_threshold":thresh })
+            step4.convert_Hvib2(prms)
+            Hvib = step4.load_Hvib_store(prms["Hvib_store_file"])
+
+            self.assertEqual(len(Hvib), 2)
+            ndropped = 0
+            for d in range(2):
+                self.assertEqual(len(Hvib[d]), nfiles)
+                for i, H in enumerate(Hvib[d]):
+                    for a in range(nst):
+                        for b in range(nst):
+                            x = ref[d][i].get(a,b)
+                            if a!=b and abs(x) <= thresh:
+                                self.assertEqual(abs(H.get(a,b)), 0.0)
+                                ndropped += 1
+                            else:
+                                self.assertEqual(abs(H.get(a,b) - x), 0.0)
+
+                # Indexing like a list
+                self.assertEqual(_max_diff(Hvib[d][-1], Hvib[d][nfiles-1]), 0.0)
+                sl = Hvib[d][1:]
+                self.assertEqual(len(sl), nfiles-1)
+                self.assertEqual(_max_diff(sl[0], Hvib[d][1]), 0.0)
+                with self.assertRaises(IndexError):
+                    Hvib[d][nfiles]
+
+            self.assertEqual(ndropped > 0, is_sparse==1)
+
+
+
+if __name__=='__main__':
+    unittest.main()
+
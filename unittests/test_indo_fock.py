@@ -0,0 +1,155 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Regression tests for the INDO Fock matrix built from the precomputed integral tables (indo_fock_cache):
+ the SCF energies and Fock matrices must stay the same as those of the original implementation
+"""
+
+import os
+import sys
+import math
+import shutil
+import tempfile
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tests", "test_qm", "tests_azulene")
+Angst = 1.889725989
+
+# A distorted methane molecule [Angstrom]; without the last H it is the methyl radical
+CH4 = [ ["C",  0.00,  0.00,  0.00],
+        ["H",  0.05,  0.02, -1.06],
+        ["H",  1.02, -0.03,  0.33],
+        ["H", -0.48,  0.88,  0.37],
+        ["H", -0.51, -0.85,  0.34] ]
+
+
+# The reference values computed with the original (per-element) INDO Fock build:
+# [energy, [diagonal, first row, Frobenius norm] of Fao_alp, and the same for Fao_bet]
+REF = {
+"rhf": [ -19.6444478546,
+         [ [-0.1705945143, -0.1710292767, -0.1714876336, -0.5583934368, -0.2675236772, -0.2672829049, -0.2676393358, -0.2679211234],
+           [-0.1705945143, -0.0003464677, -0.0013078515,  0.0007180299, -0.0156256821, -0.4391273947,  0.2074518127,  0.2277390816],
+           1.9413958190 ],
+         [ [-0.1705945143, -0.1710292767, -0.1714876336, -0.5583934368, -0.2675236772, -0.2672829049, -0.2676393358, -0.2679211234],
+           [-0.1705945143, -0.0003464677, -0.0013078515,  0.0007180299, -0.0156256821, -0.4391273947,  0.2074518127,  0.2277390816],
+           1.9413958190 ] ],
+"uhf": [ -15.7183757990,
+         [ [-0.0811320891,  0.0305397848, -0.1186444044, -0.4989733874, -0.2694129034, -0.2695756224, -0.2688404663],
+           [-0.0811320891,  0.1026572163, -0.0397138029, -0.0475525548,  0.0014703790, -0.4212432356,  0.2259906379],
+           1.6817293870 ],
+         [ [-0.2444844307, -0.3322320834, -0.2167874357, -0.6797381887, -0.2566602996, -0.2563115091, -0.2576680986],
+           [-0.2444844307, -0.0817296965,  0.0294503834,  0.0658112430, -0.0209229495, -0.4437539669,  0.2028372323],
+           1.7908717590 ] ],
+"rosh": [ -15.5585733349,
+         [ [-0.1614938451, -0.1466693494, -0.1672109524, -0.5953809594, -0.2623113554, -0.2622324376, -0.2625314241],
+           [-0.1614938451,  0.0125736850, -0.0057217295,  0.0111553618, -0.0089757143, -0.4318490756,  0.2152809471],
+           1.7060325822 ],
+         [ [-0.1614938451, -0.1466693494, -0.1672109524, -0.5953809594, -0.2623113554, -0.2622324376, -0.2625314241],
+           [-0.1614938451,  0.0125736850, -0.0057217295,  0.0111553618, -0.0089757143, -0.4318490756,  0.2152809471],
+           1.7060325822 ] ]
+}
+
+SYSTEMS = { "rhf": [CH4, 0], "uhf": [CH4[:4], 0], "rosh": [CH4[:4], 1] }
+
+
+class element:
+    pass
+
+def make_universe():
+    U = Universe()
+    for name, z, m in [ ["H", 1, 1.008], ["C", 6, 12.011] ]:
+        e = element()
+        e.Elt_name, e.Elt_number, e.Elt_nucleus_charge, e.Elt_mass = name, z, z, m*1822.888
+        elt = Element();  elt.set(e)
+        U.Add_Element_To_Periodic_Table(elt)
+    return U
+
+def make_system(U, atoms):
+    syst = System()
+    for a in atoms:
+        syst.CREATE_ATOM( Atom(U, {"Atom_element":a[0], "Atom_cm_x":a[1]*Angst, "Atom_cm_y":a[2]*Angst, "Atom_cm_z":a[3]*Angst}) )
+    return syst
+
+def run_scf(U, case):
+    """ Run in the working directory made by setUp: the parameters file is given relative to the control file """
+    atoms, use_rosh = SYSTEMS[case]
+    syst = make_system(U, atoms)
+    ham = listHamiltonian_QM("control_parameters_indo.dat", syst)
+    ham.prms.use_rosh = use_rosh
+    E = ham.compute_scf(syst)
+    return E, ham, syst
+
+
+
+class Test_INDO_Fock(unittest.TestCase):
+
+    def setUp(self):
+        """INDO writes its scratch files (deri.*.bin, dV_AB.*.bin, ...) into the current directory, so run in a temporary one"""
+        self.cwd = os.getcwd()
+        self.tmp = tempfile.mkdtemp()
+        for f in ["control_parameters_indo.dat", "params_indo"]:
+            shutil.copy(os.path.join(DATA, f), self.tmp)
+        os.chdir(self.tmp)
+
+    def tearDown(self):
+        os.chdir(self.cwd)
+        shutil.rmtree(self.tmp)
+
+
+    def check_fock(self, F, ref):
+        diag, row0, norm = ref
+        n = F.num_of_cols
+        self.assertEqual(n, len(diag))
+        for i in range(n):
+            self.assertAlmostEqual(F.get(i,i), diag[i], places=8)
+            self.assertAlmostEqual(F.get(0,i), row0[i], places=8)
+        self.assertAlmostEqual(math.sqrt(sum(F.get(i,j)**2 for i in range(n) for j in range(n))), norm, places=8)
+
+
+    def test_1(self):
+        """The SCF energies and the converged Fock matrices: closed shell, unrestricted and restricted open shell"""
+
+        U = make_universe()
+        for case in ["rhf", "uhf", "rosh"]:
+            E, ham, syst = run_scf(U, case)
+            el = ham.get_electronic_structure()
+
+            self.assertAlmostEqual(E, REF[case][0], places=8)
+            self.check_fock(el.get_Fao_alp(), REF[case][1])
+            self.check_fock(el.get_Fao_bet(), REF[case][2])
+
+
+    def test_2(self):
+        """Hamiltonian_Fock_indo called directly on the converged densities, with the integral tables built from scratch"""
+
+        U = make_universe()
+        for case in ["rhf", "uhf", "rosh"]:
+            E, ham, syst = run_scf(U, case)
+            el = ham.get_electronic_structure()
+
+            # Rebuild the integral tables explicitly
+            prms, modprms = ham.prms, ham.modprms
+            indo_fock_cache(syst, ham.basis_ao, modprms, ham.atom_to_ao_map, ham.ao_to_atom_map)
+            Hamiltonian_Fock_indo(el, syst, ham.basis_ao, prms, modprms, ham.atom_to_ao_map, ham.ao_to_atom_map)
+
+            self.check_fock(el.get_Fao_alp(), REF[case][1])
+            self.check_fock(el.get_Fao_bet(), REF[case][2])
+
+
+
+if __name__=='__main__':
+    unittest.main()
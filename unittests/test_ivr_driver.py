@@ -0,0 +1,121 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the registered IVR potentials and the parallel IVR TCF driver
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def _setup(ndof):
+
+    prms = ivr_params(ndof)
+    qIn, pIn = MATRIX(ndof, 1), MATRIX(ndof, 1)
+    qIn.set(0, 0, 0.5)
+    prms.set_qIn(qIn);  prms.set_pIn(pIn)
+    prms.set_Width0(1.0);  prms.set_WidthT(1.0)
+    prms.set_TuningQ(1.0);  prms.set_TuningP(1.0)
+
+    mass = MATRIX(ndof, ndof)
+    for i in range(ndof):
+        mass.set(i, i, 1.0)
+
+    return prms, mass
+
+
+def _run(prms, mass, potential, pot_params, ivr_opt, ntime, nsamples, seed):
+
+    TCF = complexList()
+    MCnum = intList()
+    for t in range(ntime):
+        TCF.append(0.0+0.0j);  MCnum.append(0)
+
+    ivr_run_tcf(TCF, MCnum, prms, mass, potential, Py2Cpp_double(pot_params), ivr_opt, 0, 0, 0.05, 5, nsamples, seed, 1e-4)
+
+    return TCF, MCnum
+
+
+
+class TestIVRDriver(unittest.TestCase):
+
+    def test_potentials(self):
+        """The built-in potentials and their derivatives"""
+
+        q, dv, d2v = MATRIX(2, 1), MATRIX(2, 1), MATRIX(2, 2)
+        q.set(0, 0, 0.3);  q.set(1, 0, -0.2)
+
+        v = ivr_vdv("harmonic", q, dv, d2v, Py2Cpp_double([1.0, 2.0]))
+        self.assertAlmostEqual(v, 0.5*0.09 + 0.5*2.0*0.04, places=12)
+        self.assertAlmostEqual(dv.get(1, 0), -0.4, places=12)
+        self.assertAlmostEqual(d2v.get(1, 1), 2.0, places=12)
+
+        # Finite-difference check of the Morse gradient
+        prms = Py2Cpp_double([0.1, 1.5, 0.1])
+        h = 1e-5
+        qp, qm = MATRIX(q), MATRIX(q)
+        qp.set(0, 0, 0.3 + h);  qm.set(0, 0, 0.3 - h)
+        v = ivr_vdv("morse", q, dv, d2v, prms)
+        fd = (ivr_vdv("morse", qp, MATRIX(2, 1), MATRIX(2, 2), prms) - ivr_vdv("morse", qm, MATRIX(2, 1), MATRIX(2, 2), prms))/(2.0*h)
+        self.assertAlmostEqual(dv.get(0, 0), fd, places=8)
+
+
+    def test_driver(self):
+        """All the samples pass the energy and symplecticity checks, the TCF is finite and reproducible for a given seed"""
+
+        prms, mass = _setup(2)
+
+        for ivr_opt in [0, 1]:
+            TCF1, MCnum1 = _run(prms, mass, "anharmonic", [1.0, 0.05, 0.01], ivr_opt, 20, 50, 11)
+            TCF2, MCnum2 = _run(prms, mass, "anharmonic", [1.0, 0.05, 0.01], ivr_opt, 20, 50, 11)
+
+            for t in range(20):
+                self.assertEqual(MCnum1[t], 50)
+                self.assertEqual(MCnum1[t], MCnum2[t])
+                self.assertTrue(math.isfinite(TCF1[t].real) and math.isfinite(TCF1[t].imag))
+                self.assertAlmostEqual(abs(TCF1[t] - TCF2[t]), 0.0, places=8)
+
+
+    def test_harmonic(self):
+        """Harmonic oscillator with the frequency matched to the width of the initial coherent state:
+        the FF-MQC position TCF must oscillate as cos(w*t) - real, with no sin(w*t) component"""
+
+        prms, mass = _setup(1)
+        ntime, nsamples = 26, 5000
+        TCF, MCnum = _run(prms, mass, "harmonic", [1.0], 0, ntime, nsamples, 11)
+        normalize_tcf(TCF, MCnum)
+
+        # Time points are 5 steps of 0.05 apart, w = sqrt(k/m) = 1, so the run covers one period
+        c = [ math.cos(0.25*t) for t in range(ntime) ]
+        s = [ math.sin(0.25*t) for t in range(ntime) ]
+        A = sum(TCF[t].real * c[t] for t in range(ntime)) / sum(x*x for x in c)
+        B = sum(TCF[t].real * s[t] for t in range(ntime)) / sum(x*x for x in s)
+
+        # The tolerances are those of the Monte Carlo noise for this number of samples
+        self.assertTrue(0.3 < A < 0.55)
+        self.assertTrue(abs(B) < 0.03)
+        for t in range(ntime):
+            self.assertEqual(MCnum[t], nsamples)
+            self.assertTrue(abs(TCF[t].real - A*c[t]) < 0.06)
+            self.assertTrue(abs(TCF[t].imag) < 0.06)
+
+
+
+if __name__=='__main__':
+    unittest.main()
+
@@ -0,0 +1,97 @@
+#*********************************************************************************
+#* Copyright (C) 2017 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the Krylov-subspace (Lanczos/Arnoldi) electronic propagator
+"""
+
+import os
+import sys
+import math
+import cmath
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def make_hvib(n, width):
+    """ Banded Hermitian vibronic Hamiltonian """
+    H = CMATRIX(n, n)
+    for i in range(n):
+        H.set(i, i, (0.01*i)*(1.0+0.0j))
+        for j in range(i+1, min(n, i+3)):
+            x = width*(random.random()-0.5) + 1.0j*width*(random.random()-0.5)
+            H.set(i, j, x)
+            H.set(j, i, x.conjugate())
+    return H
+
+def exact_propagator(H, dt):
+    n = H.num_of_cols
+    E = CMATRIX(n, n);  C = CMATRIX(n, n)
+    solve_eigen(H, E, C, 0)
+    expE = CMATRIX(n, n)
+    for i in range(n):
+        expE.set(i, i, cmath.exp(-1.0j*E.get(i,i)*dt))
+    return C * expE * C.H()
+
+def max_diff(A, B):
+    res = 0.0
+    for i in range(A.num_of_rows):
+        for j in range(A.num_of_cols):
+            res = max(res, abs(A.get(i,j) - B.get(i,j)))
+    return res
+
+
+
+class Test_Krylov(unittest.TestCase):
+
+    def test_1(self):
+        """All columns are propagated as with the exact propagator, for both Lanczos and Arnoldi"""
+
+        random.seed(0)
+        n, ntraj, dt = 60, 3, 41.0
+        H = make_hvib(n, 0.002)
+
+        C0 = CMATRIX(n, ntraj)
+        for i in range(n):
+            for j in range(ntraj):
+                C0.set(i, j, (random.random()-0.5) + 1.0j*(random.random()-0.5))
+
+        ref = exact_propagator(H, dt) * C0
+
+        for is_hermitian in [1, 0]:
+            C = CMATRIX(C0)
+            nmv = propagate_electronic_krylov(dt, C, H, 30, 1e-10, is_hermitian, 0.0)
+            self.assertTrue(nmv > 0)
+            self.assertTrue(max_diff(C, ref) < 1e-8)
+
+
+    def test_2(self):
+        """Small subspace forces substepping, the result is still accurate"""
+
+        random.seed(1)
+        n, dt = 40, 200.0
+        H = make_hvib(n, 0.005)
+
+        C0 = CMATRIX(n, 1);  C0.set(0, 0, 1.0+0.0j)
+        ref = exact_propagator(H, dt) * C0
+
+        C = CMATRIX(C0)
+        propagate_electronic_krylov(dt, C, H, 6, 1e-10, 1)
+        self.assertTrue(max_diff(C, ref) < 1e-8)
+
+
+
+if __name__=='__main__':
+    unittest.main()
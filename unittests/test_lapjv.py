@@ -0,0 +1,133 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the Jonker-Volgenant assignment solvers used in the state tracking
+"""
+
+import os
+import sys
+import math
+import random
+import itertools
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def cost(X, perm):
+    return sum( X.get(i, perm[i]) for i in range(len(perm)) )
+
+
+def best_cost(X, n):
+    """ The brute-force minimum over all permutations """
+    return min( cost(X, p) for p in itertools.permutations(range(n)) )
+
+
+
+class Test_LAPJV(unittest.TestCase):
+
+    def test_1(self):
+        """The dense and sparse solvers give the optimal assignment, with and without the guess"""
+
+        random.seed(0)
+        for trial in range(30):
+            n = 1 + trial % 6
+            X = MATRIX(n, n)
+            cols, costs = intList2(), doubleList2()
+            for i in range(n):
+                ci, cc = intList(), doubleList()
+                for j in range(n):
+                    X.set(i, j, random.uniform(-1.0, 1.0))
+                    ci.append(j);  cc.append(X.get(i, j))
+                cols.append(ci);  costs.append(cc)
+
+            guess = intList()
+            for i in range(n):
+                guess.append(random.randint(0, n-1))
+            no_guess = intList()
+
+            emin = best_cost(X, n)
+            for perm in [ Jonker_Volgenant_minimize(X, 0), Jonker_Volgenant_minimize(X, guess, 0),
+                          Jonker_Volgenant_minimize_sparse(cols, costs, guess, 0),
+                          Jonker_Volgenant_minimize_sparse(cols, costs, no_guess, 0) ]:
+                self.assertEqual(sorted(list(perm)), list(range(n)))
+                self.assertAlmostEqual(cost(X, perm), emin, places=10)
+
+
+    def test_2(self):
+        """Swapped states are found in a large nearly-diagonal overlap matrix"""
+
+        n = 200
+        S = MATRIX(n, n)
+        for i in range(n):
+            S.set(i, i, 0.9)
+            if i+1 < n:
+                S.set(i, i+1, 0.05);  S.set(i+1, i, 0.05)
+        S.set(10, 10, 0.1);  S.set(11, 11, 0.1);  S.set(10, 11, 0.8);  S.set(11, 10, 0.8)
+
+        identity = intList()
+        for i in range(n):
+            identity.append(i)
+
+        for perm in [ Jonker_Volgenant_maximize(S, 0), Jonker_Volgenant_maximize(S, identity, 0),
+                      Jonker_Volgenant_maximize_sparse(S, 0.01, identity, 0) ]:
+            for i in range(n):
+                ref = {10:11, 11:10}.get(i, i)
+                self.assertEqual(perm[i], ref)
+
+
+    def test_3(self):
+        """An incomplete sparse pattern has no assignment"""
+
+        cols, costs = intList2(), doubleList2()
+        for i in range(3):
+            ci, cc = intList(), doubleList()
+            ci.append(0);  cc.append(1.0)
+            cols.append(ci);  costs.append(cc)
+
+        self.assertEqual(len(Jonker_Volgenant_minimize_sparse(cols, costs, intList(), 0)), 0)
+
+
+    def test_4(self):
+        """The block-wise reordering finds the crossing blocks and agrees with the full assignment"""
+
+        n = 100
+        St, E = CMATRIX(n, n), CMATRIX(n, n)
+        for i in range(n):
+            St.set(i, i, 0.95+0.1j);  E.set(i, i, 0.01*i+0j)
+            if i+1 < n:
+                St.set(i, i+1, 0.05+0j);  St.set(i+1, i, -0.05+0j)
+
+        # a cyclic crossing of three states and a pair crossing
+        for i, j in [(50,51), (51,52), (52,50), (80,81), (81,80)]:
+            St.set(i, j, 0.9+0j)
+        for i in [50, 51, 52, 80, 81]:
+            St.set(i, i, 0.1+0j)
+
+        blocks = [ list(b) for b in get_overlap_blocks(St, 0.01) if len(b) > 1 ]
+        self.assertEqual(blocks, [[50, 51, 52], [80, 81]])
+
+        identity = intList()
+        for i in range(n):
+            identity.append(i)
+
+        perm = get_block_reordering(St, E, 0.0, 0.01)
+        ref = Jonker_Volgenant(St, E, 0.0, identity, 0)
+        self.assertEqual(list(perm), list(ref))
+        self.assertEqual([perm[50], perm[51], perm[52], perm[80], perm[81]], [51, 52, 50, 81, 80])
+
+
+
+if __name__=='__main__':
+    unittest.main()
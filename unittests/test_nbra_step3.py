@@ -0,0 +1,122 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the C++ NBRA step3 engine: it should reproduce the Python version of step3.run
+"""
+
+import os
+import sys
+import math
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+import libra_py.workflows.nbra.step3 as step3
+
+
+def _test_setup(ndata, nsteps, norbs):
+    """Random KS data: nearly-diagonal TDMs with random signs and a state swap"""
+
+    random.seed(10)
+    sz = 2*norbs
+
+    S, St, E = [], [], []
+    for idata in range(ndata):
+        s, st, e = [], [], []
+        for i in range(nsteps):
+            s_i, st_i, e_i = CMATRIX(sz,sz), CMATRIX(sz,sz), CMATRIX(sz,sz)
+            for a in range(sz):
+                e_i.set(a, a, (0.05*(a % norbs) + 0.001*random.random())*(1.0+0.0j))
+                for b in range(sz):
+                    if a // norbs == b // norbs:
+                        x = 0.02*(random.random()-0.5)
+                        st_i.set(a, b, x*(1.0+0.0j))
+                        if a==b:
+                            s_i.set(a, b, 1.0+0.0j)
+                            st_i.set(a, b, random.choice([-1.0, 1.0])*(1.0+0.0j))
+                        elif a<b:
+                            s_i.set(a, b, 0.1*x*(1.0+0.0j));  s_i.set(b, a, 0.1*x*(1.0+0.0j))
+            if i==nsteps//2:
+                perm = Py2Cpp_int(list(range(sz)))
+                perm[0], perm[1] = 1, 0
+                st_i.permute_cols(perm)
+            s.append(s_i); st.append(st_i); e.append(e_i)
+        S.append(s); St.append(st); E.append(e)
+
+    return S, St, E
+
+
+def _copy(X):
+    return [ [ CMATRIX(x) for x in data ] for data in X ]
+
+
+class TestStep3(unittest.TestCase):
+
+    def test_1(self):
+        """C++ and Python versions of step3.run give the same Hvib, for all the state reordering algorithms"""
+
+        S, St, E = _test_setup(2, 6, 3)
+
+        for algo in [0, 2, 4, 5]:
+            params = { "SD_basis":[ [1,-4], [2,-4], [1,-5] ], "SD_energy_corr":[0.0, 0.01, 0.01],
+                       "CI_basis":[ [1.0, 0.0, 0.0], [0.0, 1.0, 1.0] ], "output_set_paths":["", ""],
+                       "do_orthogonalization":1, "do_state_reordering":algo, "do_phase_correction":1 }
+
+            # The Python version is the default
+            H_py = step3.run(_copy(S), _copy(St), _copy(E), dict(params))
+
+            params["use_cpp_engine"] = 1
+            H_cpp = step3.run(_copy(S), _copy(St), _copy(E), dict(params))
+
+            for idata in range(2):
+                for i in range(6):
+                    d = H_py[idata][i] - H_cpp[idata][i]
+                    self.assertAlmostEqual(abs(d.max_elt()), 0.0, places=10)
+
+    def test_1a(self):
+        """The Python and C++ state reorderings find the same permutations"""
+
+        S, St, E = _test_setup(1, 6, 3)
+
+        for algo in [2, 4, 5]:
+            St_py, E_py = _copy(St)[0], _copy(E)[0]
+            step3.apply_state_reordering(St_py, E_py, {"do_state_reordering":algo, "state_reordering_alpha":0.0})
+
+            St_cpp, E_cpp = Py2Cpp_CMATRIX(_copy(St)[0]), Py2Cpp_CMATRIX(_copy(E)[0])
+            nbra_apply_state_reordering(St_cpp, E_cpp, algo, 0.0)
+
+            for i in range(6):
+                d = St_py[i] - St_cpp[i]
+                self.assertAlmostEqual(abs(d.max_elt()), 0.0, places=12)
+
+                # The swap at the middle step is undone
+                for a in range(6):
+                    self.assertAlmostEqual(abs(St_cpp[i].get(a,a)), 1.0, places=10)
+
+    def test_2(self):
+        """The reordering undoes the state swap, the phase correction makes the diagonal positive"""
+
+        S, St, E = _test_setup(1, 6, 3)
+        St_cpp, E_cpp = Py2Cpp_CMATRIX(St[0]), Py2Cpp_CMATRIX(E[0])
+        nbra_apply_state_reordering(St_cpp, E_cpp, 2, 0.0)
+        nbra_apply_phase_correction(St_cpp)
+
+        for st in St_cpp:
+            for a in range(6):
+                self.assertAlmostEqual(st.get(a,a).real, 1.0, places=10)
+
+
+if __name__=='__main__':
+    unittest.main()
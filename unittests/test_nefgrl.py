@@ -0,0 +1,101 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Regression tests for the tabulated nonequilibrium FGR populations: NEFGRL_population_incremental
+ should reproduce NEFGRL_population for all the methods in the Condon and non-Condon cases
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def _bath(nmodes):
+
+    omega_nm, gamma_nm, req_nm, shift_NE = [], [], [], []
+    for i in range(nmodes):
+        omega_nm.append(0.0005 + 0.0002*i)
+        gamma_nm.append(0.0001*(1.0 + 0.1*i))
+        req_nm.append(1.0/(1.0 + i))
+        shift_NE.append(0.5*req_nm[i]*(1.0 if i%3==0 else -0.5))
+
+    return Py2Cpp_double(omega_nm), Py2Cpp_double(gamma_nm), Py2Cpp_double(req_nm), Py2Cpp_double(shift_NE)
+
+
+
+class TestNEFGRL(unittest.TestCase):
+
+    def _compare(self, dyn_type):
+
+        omega_nm, gamma_nm, req_nm, shift_NE = _bath(20)
+        omega_DA, V, beta = 0.005, 0.0005, 1000.0
+        dtau, tmax, dt = 1.0, 200.0, 5.0
+
+        for method in range(6):
+            ref = NEFGRL_population(omega_DA, V, omega_nm, gamma_nm, req_nm, shift_NE, method, beta, dyn_type, dtau, tmax, dt)
+            res = NEFGRL_population_incremental(omega_DA, V, omega_nm, gamma_nm, req_nm, shift_NE, method, beta, dyn_type, dtau, tmax, dt)
+
+            self.assertEqual(res.num_of_rows, ref.num_of_rows)
+            for step in range(ref.num_of_rows):
+                self.assertAlmostEqual(res.get(step, 0), ref.get(step, 0), places=12)
+                self.assertAlmostEqual(res.get(step, 1), ref.get(step, 1), places=10)
+                self.assertAlmostEqual(res.get(step, 2), ref.get(step, 2), places=10)
+
+
+    def test_condon(self):
+        """Condon case: methods 0 - 5"""
+        self._compare(0)
+
+
+    def test_non_condon(self):
+        """Non-Condon (linear coupling) case: methods 0 - 5"""
+        self._compare(1)
+
+
+    def test_scan(self):
+        """The batched scan over points with two baths reproduces the individual calls"""
+
+        baths = [ _bath(10), _bath(15) ]
+        omega_DA = [ 0.004 + 0.0005*i for i in range(12) ]
+        V = [ 0.0005*(1 + i%2) for i in range(12) ]
+        beta = [ 800.0 + 50.0*i for i in range(12) ]
+        method = [ i%6 for i in range(12) ]
+        bath = [ i%2 for i in range(12) ]
+        dtau, tmax, dt = 1.0, 100.0, 5.0
+
+        omega_nm, gamma_nm, req_nm, shift_NE = doubleList2(), doubleList2(), doubleList2(), doubleList2()
+        for b in baths:
+            omega_nm.append(b[0]);  gamma_nm.append(b[1]);  req_nm.append(b[2]);  shift_NE.append(b[3])
+
+        for dyn_type in [0, 1]:
+            res = NEFGRL_population_scan(Py2Cpp_double(omega_DA), Py2Cpp_double(V), Py2Cpp_double(beta),
+                                         Py2Cpp_int(method), Py2Cpp_int(bath), omega_nm, gamma_nm, req_nm, shift_NE,
+                                         dyn_type, dtau, tmax, dt)
+            self.assertEqual(len(res), 12)
+
+            for i in range(12):
+                b = baths[bath[i]]
+                ref = NEFGRL_population(omega_DA[i], V[i], b[0], b[1], b[2], b[3], method[i], beta[i], dyn_type, dtau, tmax, dt)
+                for step in range(ref.num_of_rows):
+                    self.assertAlmostEqual(res[i].get(step, 1), ref.get(step, 1), places=10)
+                    self.assertAlmostEqual(res[i].get(step, 2), ref.get(step, 2), places=10)
+
+
+
+if __name__=='__main__':
+    unittest.main()
+
@@ -0,0 +1,129 @@
+#*********************************************************************************
+#* Copyright (C) 2017 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the linear-scaling CSR neighbor list: it must contain the same pairs as make_nlist_auto
+"""
+
+import os
+import sys
+import math
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def make_system(nat, L):
+    R = MATRIX(3*nat, 1)
+    for i in range(3*nat):
+        R.set(i, 0, L*random.random())
+    return R
+
+def pairs_auto(R, box, Roff):
+    """ make_nlist_auto also lists every atom as its own central neighbor - these are skipped """
+    res = []
+    nlist = make_nlist_auto(R, box, Roff, Roff, Roff, Roff)
+    for i in range(len(nlist)):
+        for is_central, j, n1, n2, n3 in nlist[i]:
+            if is_central==1 and i==j:
+                continue
+            res.append( (i, j, n1, n2, n3, is_central) )
+    return res
+
+def pairs_csr(R, box, Roff):
+    res = []
+    offset, neib = make_nlist_csr(R, box, Roff)
+    for i in range(len(offset)-1):
+        for k in range(offset[i], offset[i+1]):
+            is_central, j, n1, n2, n3 = neib[k]
+            res.append( (i, j, n1, n2, n3, is_central) )
+    return res
+
+
+
+class Test_NList_CSR(unittest.TestCase):
+
+    def compare(self, R, box, Roff):
+        nat = R.num_of_rows // 3
+        p1 = pairs_auto(R, box, Roff)
+        p2 = pairs_csr(R, box, Roff)
+
+        # No duplicates, the same pairs and the same translations
+        self.assertEqual(len(p2), len(set(p2)))
+        self.assertEqual(sorted(p1), sorted(p2))
+        self.assertTrue(len(p2) > 0)
+
+        # CSR pointers
+        offset, neib = make_nlist_csr(R, box, Roff)
+        self.assertEqual(len(offset), nat + 1)
+        self.assertEqual(offset[0], 0)
+        self.assertEqual(offset[nat], len(neib))
+
+
+    def test_1(self):
+        """Periodic system: the atoms fill the cell and interact with the images"""
+
+        random.seed(0)
+        L, Roff = 12.0, 4.0
+        box = MATRIX3x3(VECTOR(L, 0.0, 0.0), VECTOR(0.0, L, 0.0), VECTOR(0.0, 0.0, L))
+        R = make_system(60, L)
+
+        self.compare(R, box, Roff)
+
+        # Some of the pairs go across the cell boundaries
+        self.assertTrue( any(p[5]==0 for p in pairs_csr(R, box, Roff)) )
+
+
+    def test_2(self):
+        """Triclinic cell and the atoms outside of it"""
+
+        random.seed(1)
+        box = MATRIX3x3(VECTOR(12.0, 0.0, 0.0), VECTOR(2.0, 11.0, 0.0), VECTOR(1.0, -1.5, 13.0))
+        R = make_system(50, 12.0)
+        for i in range(R.num_of_rows):
+            R.set(i, 0, R.get(i,0) - 4.0)
+
+        self.compare(R, box, 4.5)
+
+
+    def test_3(self):
+        """No periodicity: a cluster in a large cell, so only the central pairs are found"""
+
+        random.seed(2)
+        L, Roff = 40.0, 4.0
+        box = MATRIX3x3(VECTOR(L, 0.0, 0.0), VECTOR(0.0, L, 0.0), VECTOR(0.0, 0.0, L))
+        R = make_system(60, 10.0)
+        for i in range(R.num_of_rows):
+            R.set(i, 0, R.get(i,0) + 5.0)
+
+        self.compare(R, box, Roff)
+
+        p = pairs_csr(R, box, Roff)
+        self.assertTrue( all(x[5]==1 and x[2:5]==(0,0,0) for x in p) )
+
+        # Compare with the direct count
+        nat = R.num_of_rows // 3
+        cnt = 0
+        for i in range(nat):
+            ri = VECTOR(R.get(3*i,0), R.get(3*i+1,0), R.get(3*i+2,0))
+            for j in range(i+1, nat):
+                rj = VECTOR(R.get(3*j,0), R.get(3*j+1,0), R.get(3*j+2,0))
+                if (ri - rj).length() < Roff:
+                    cnt += 1
+        self.assertEqual(len(p), cnt)
+
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,98 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the diagonalization-free density matrix methods in libcalculators
+"""
+
+import os
+import sys
+import math
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def make_chain(n, s):
+    """ A chain with alternating site energies (gapped spectrum) and the overlap s between the neighbors """
+    H, S = MATRIX(n, n), MATRIX(n, n)
+    for i in range(n):
+        H.set(i, i, -1.0 if i%2==0 else 1.0);  S.set(i, i, 1.0)
+        if i+1<n:
+            H.set(i, i+1, -0.3);  H.set(i+1, i, -0.3)
+            S.set(i, i+1, s);  S.set(i+1, i, s)
+    return H, S
+
+
+def max_diff(A, B):
+    return max([ abs(A.get(i, j) - B.get(i, j)) for i in range(A.num_of_rows) for j in range(A.num_of_cols) ])
+
+
+
+class Test_Purification(unittest.TestCase):
+
+    def test_1(self):
+        """All the methods reproduce the density matrix from the diagonalization, orthogonal and non-orthogonal bases"""
+
+        n, nocc = 10, 5
+        for s in [0.0, 0.1]:
+            H, S = make_chain(n, s)
+            P_ref = Fock_to_P(H, S, nocc, 1.0, 0.0001, 0.0001, 0)[2]
+
+            for method in ["mcweeny", "trs4", "sp2"]:
+                P = Fock_to_P_purify(method, H, S, nocc, 1e-12, 1e-12, 100, 0.0, 0)
+                self.assertLess(max_diff(P, P_ref), 1e-8)
+
+            P = Fock_to_P_purify("foe", H, S, nocc, 1e-12, 1e-12, 100, 0.02, 200)
+            self.assertLess(max_diff(P, P_ref), 1e-4)
+
+
+    def test_2(self):
+        """The trivial occupations"""
+
+        H, S = make_chain(4, 0.0)
+        P = Fock_to_P_purify("sp2", H, S, 0, 1e-12, 1e-12, 100, 0.0, 0)
+        self.assertEqual(max_diff(P, MATRIX(4, 4)), 0.0)
+
+        I = MATRIX(4, 4);  I.Init_Unit_Matrix(1.0)
+        P = Fock_to_P_purify("trs4", H, S, 4, 1e-12, 1e-12, 100, 0.0, 0)
+        self.assertEqual(max_diff(P, I), 0.0)
+
+
+
+    def test_3(self):
+        """The moments of the FOE engine and the populations from them agree with the eigenvalues"""
+
+        n = 12
+        H, S = make_chain(n, 0.0)
+        E = Fock_to_P(H, S, 6, 1.0, 0.0001, 0.0001, 0)[0]
+        e = [ E.get(i, i) for i in range(n) ]
+
+        foe = Chebyshev_FOE(H, 200, -1.0)
+        for k in [0, 1, 2, 7, 50, 199]:
+            mu_k = sum([ math.cos(k*math.acos((ei - foe.e0)/foe.de)) for ei in e ])
+            self.assertAlmostEqual(foe.mu[k], mu_k, places=8)
+
+        kT = 0.05
+        for ef in [-1.2, 0.0, 0.4]:
+            n_ref = sum([ 1.0/(1.0 + math.exp((ei - ef)/kT)) for ei in e ])
+            self.assertAlmostEqual(foe.population(ef, kT), n_ref, places=6)
+
+        ef = foe.chemical_potential(6.0, kT, 1e-10)
+        P = MATRIX(n, n);  foe.density_matrix(ef, kT, P)
+        self.assertAlmostEqual(P.tr(), 6.0, places=8)
+
+
+if __name__=='__main__':
+    unittest.main()
+
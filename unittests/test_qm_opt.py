@@ -0,0 +1,176 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the geometry optimization, the batched forces and the screened overlaps of listHamiltonian_QM
+"""
+
+import os
+import sys
+import math
+import random
+import shutil
+import tempfile
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tests", "test_qm", "tests_azulene")
+Angst = 1.889725989
+
+# A distorted methane molecule [Angstrom]
+CH4 = [ ["C",  0.00,  0.00,  0.00],
+        ["H",  0.05,  0.02, -1.06],
+        ["H",  1.02, -0.03,  0.33],
+        ["H", -0.48,  0.88,  0.37],
+        ["H", -0.51, -0.85,  0.34] ]
+
+
+class element:
+    pass
+
+def make_universe():
+    U = Universe()
+    for name, z, m in [ ["H", 1, 1.008], ["C", 6, 12.011] ]:
+        e = element()
+        e.Elt_name, e.Elt_number, e.Elt_nucleus_charge, e.Elt_mass = name, z, z, m*1822.888
+        elt = Element();  elt.set(e)
+        U.Add_Element_To_Periodic_Table(elt)
+    return U
+
+def make_system(U, atoms):
+    syst = System()
+    for a in atoms:
+        syst.CREATE_ATOM( Atom(U, {"Atom_element":a[0], "Atom_cm_x":a[1]*Angst, "Atom_cm_y":a[2]*Angst, "Atom_cm_z":a[3]*Angst}) )
+    return syst
+
+def make_ham(U, atoms, ctrl):
+    """ Run in the working directory made by setUp: the parameters file is given relative to the control file """
+    syst = make_system(U, atoms)
+    ham = listHamiltonian_QM(ctrl, syst)
+    return syst, ham
+
+def get_q(syst):
+    q = doubleList()
+    for i in range(3*syst.Number_of_atoms):
+        q.append(0.0)
+    syst.extract_atomic_q(q)
+    return q
+
+def get_f(syst):
+    f = doubleList()
+    for i in range(3*syst.Number_of_atoms):
+        f.append(0.0)
+    syst.extract_atomic_f(f)
+    return f
+
+def max_diff(A, B):
+    return max( abs(A.get(i,j) - B.get(i,j)) for i in range(A.num_of_rows) for j in range(A.num_of_cols) )
+
+
+
+class Test_QM_Opt(unittest.TestCase):
+
+    def setUp(self):
+        """INDO writes its scratch files (deri.*.bin, dV_AB.*.bin, ...) into the current directory, so run in a temporary one"""
+        self.cwd = os.getcwd()
+        self.tmp = tempfile.mkdtemp()
+        for f in ["control_parameters_indo.dat", "control_parameters_eht.dat", "params_indo", "muller_params"]:
+            shutil.copy(os.path.join(DATA, f), self.tmp)
+        os.chdir(self.tmp)
+
+    def tearDown(self):
+        os.chdir(self.cwd)
+        shutil.rmtree(self.tmp)
+
+
+    def test_1(self):
+        """optimize_geometry lowers the energy and converges the forces"""
+
+        U = make_universe()
+        syst, ham = make_ham(U, CH4, "control_parameters_indo.dat")
+        ham.prms.scf_algo = "diis_fock"
+
+        E0 = ham.energy_and_forces(syst)
+        f0 = max( abs(x) for x in get_f(syst) )
+
+        E = ham.optimize_geometry(syst, 100, 1e-3, 0.2, 5)
+        f_opt = list(get_f(syst))
+        f = max( abs(x) for x in f_opt )
+
+        self.assertLess(E, E0)
+        self.assertLess(f, 1e-3)
+        self.assertLess(f, f0)
+
+        # The returned energy and the forces kept in syst belong to the final geometry
+        self.assertAlmostEqual(ham.energy_and_forces(syst), E, places=6)
+        for x, y in zip(get_f(syst), f_opt):
+            self.assertAlmostEqual(x, y, places=5)
+
+
+    def test_2(self):
+        """INDO: the batched forces() are the same as the atom-by-atom force()"""
+
+        U = make_universe()
+        syst, ham = make_ham(U, CH4, "control_parameters_indo.dat")
+        ham.prms.scf_algo = "diis_fock"
+        ham.energy_and_forces(syst)
+
+        el = ham.get_electronic_structure()
+        Hao, Sao = el.get_Hao(), el.get_Sao()
+
+        F = VECTORList()
+        forces(el, syst, ham.basis_ao, ham.prms, ham.modprms, ham.atom_to_ao_map, ham.ao_to_atom_map, Hao, Sao, ham.Norb, F)
+
+        self.assertEqual(len(F), syst.Number_of_atoms)
+        for n in range(syst.Number_of_atoms):
+            f = force(el, syst, ham.basis_ao, ham.prms, ham.modprms, ham.atom_to_ao_map, ham.ao_to_atom_map,
+                      Hao, Sao, ham.Norb, n, 0, 0, 0, VECTOR(), VECTOR(), VECTOR())
+            self.assertLess((F[n] - f).length(), 1e-8)
+
+
+    def test_3(self):
+        """The overlaps recomputed only for the screened AO pairs match the full overlap matrix"""
+
+        random.seed(0)
+        U = make_universe()
+
+        # Two molecules 6 Angstrom apart, so the distant pairs are not in the list
+        atoms = CH4 + [ [a[0], a[1]+6.0, a[2], a[3]] for a in CH4 ]
+        syst, ham = make_ham(U, atoms, "control_parameters_eht.dat")
+        ham.ovlp_thresh = 1e-8
+        ham.ovlp_skin = 1.0
+        n = ham.Norb
+
+        # The first call builds the pair list, the second one - moves all atoms by less than skin/2 and reuses it
+        for step in range(2):
+            if step==1:
+                q = get_q(syst)
+                for i in range(len(q)):
+                    q[i] = q[i] + 0.1*(random.random() - 0.5)
+                syst.set_atomic_q(q)
+
+            ham.energy_and_forces(syst)
+
+            S = ham.get_electronic_structure().get_Sao()
+            S_full = MATRIX(n, n)
+            update_overlap_matrix(0, 0, 0, VECTOR(), VECTOR(), VECTOR(), ham.basis_ao, S_full)
+
+            self.assertLess(max_diff(S, S_full), 1e-7)
+            self.assertEqual(S.get(0, 0), S_full.get(0, 0))
+
+
+
+if __name__=='__main__':
+    unittest.main()
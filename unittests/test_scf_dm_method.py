@@ -0,0 +1,104 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the diagonalization-free density matrix builds (dm_method) inside the SCF procedures
+"""
+
+import os
+import sys
+import math
+import shutil
+import tempfile
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tests", "test_qm", "tests_azulene")
+Angst = 1.889725989
+
+# A distorted methane molecule [Angstrom]
+CH4 = [ ["C",  0.00,  0.00,  0.00],
+        ["H",  0.05,  0.02, -1.06],
+        ["H",  1.02, -0.03,  0.33],
+        ["H", -0.48,  0.88,  0.37],
+        ["H", -0.51, -0.85,  0.34] ]
+
+
+class element:
+    pass
+
+def make_universe():
+    U = Universe()
+    for name, z, m in [ ["H", 1, 1.008], ["C", 6, 12.011] ]:
+        e = element()
+        e.Elt_name, e.Elt_number, e.Elt_nucleus_charge, e.Elt_mass = name, z, z, m*1822.888
+        elt = Element();  elt.set(e)
+        U.Add_Element_To_Periodic_Table(elt)
+    return U
+
+def make_system(U, atoms):
+    syst = System()
+    for a in atoms:
+        syst.CREATE_ATOM( Atom(U, {"Atom_element":a[0], "Atom_cm_x":a[1]*Angst, "Atom_cm_y":a[2]*Angst, "Atom_cm_z":a[3]*Angst}) )
+    return syst
+
+def scf_energy(U, algo, dm_method):
+    """ Run in the working directory made by setUp: the parameters file is given relative to the control file """
+    syst = make_system(U, CH4)
+    ham = listHamiltonian_QM("control_parameters_indo.dat", syst)
+
+    ham.prms.scf_algo = algo
+    ham.prms.dm_method = dm_method
+    ham.prms.dm_tol = 1e-10
+    ham.prms.dm_thresh = 1e-12
+    # The Chebyshev order needed for FOE grows as (spectral width)/foe_kT: the default 200 terms
+    # leave an error of a few mHa here
+    ham.prms.foe_kT = 0.01
+    ham.prms.foe_order = 800
+    return ham.compute_scf(syst)
+
+
+
+class Test_SCF_dm_method(unittest.TestCase):
+
+    def setUp(self):
+        """INDO writes its scratch files (deri.*.bin, dV_AB.*.bin, ...) into the current directory, so run in a temporary one"""
+        self.cwd = os.getcwd()
+        self.tmp = tempfile.mkdtemp()
+        for f in ["control_parameters_indo.dat", "params_indo"]:
+            shutil.copy(os.path.join(DATA, f), self.tmp)
+        os.chdir(self.tmp)
+
+    def tearDown(self):
+        os.chdir(self.cwd)
+        shutil.rmtree(self.tmp)
+
+
+    def test_1(self):
+        """The purification and FOE density matrices give the same converged energy as the diagonalization,
+        with the ODA, DIIS and plain SCF iterations"""
+
+        U = make_universe()
+
+        for algo in ["oda", "diis_fock", "none"]:
+            E_diag = scf_energy(U, algo, "diag")
+            for dm_method in ["trs4", "sp2", "foe"]:
+                E = scf_energy(U, algo, dm_method)
+                self.assertAlmostEqual(E, E_diag, places=6)
+
+
+
+if __name__=='__main__':
+    unittest.main()
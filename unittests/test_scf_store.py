@@ -0,0 +1,200 @@
+#*********************************************************************************
+#* Copyright (C) 2019 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the memory-budgeted storage of the SCF matrices (SCF_store) and for the SCF that uses it
+ (scf_oda_disk, use_disk = 1)
+"""
+
+import os
+import sys
+import math
+import random
+import shutil
+import tempfile
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def make_matrix(n):
+    X = MATRIX(n, n)
+    for i in range(n):
+        for j in range(n):
+            X.set(i, j, random.random() - 0.5 + 1e-3*math.pi*(i-j))
+    return X
+
+
+def max_diff(A, B):
+    return max( abs(A.get(i,j) - B.get(i,j)) for i in range(A.num_of_rows) for j in range(A.num_of_cols) )
+
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tests", "test_qm", "tests_azulene")
+Angst = 1.889725989
+
+# A distorted methane molecule [Angstrom]; without the last H it is the methyl radical
+CH4 = [ ["C",  0.00,  0.00,  0.00],
+        ["H",  0.05,  0.02, -1.06],
+        ["H",  1.02, -0.03,  0.33],
+        ["H", -0.48,  0.88,  0.37],
+        ["H", -0.51, -0.85,  0.34] ]
+
+
+class element:
+    pass
+
+def make_universe():
+    U = Universe()
+    for name, z, m in [ ["H", 1, 1.008], ["C", 6, 12.011] ]:
+        e = element()
+        e.Elt_name, e.Elt_number, e.Elt_nucleus_charge, e.Elt_mass = name, z, z, m*1822.888
+        elt = Element();  elt.set(e)
+        U.Add_Element_To_Periodic_Table(elt)
+    return U
+
+def scf_energy(U, atoms, use_disk, mem_cap=0.0, mem_single=0, scratch_dir="."):
+    """ Run in the working directory with the INDO parameters (see Test_SCF_oda_disk.setUp) """
+    syst = System()
+    for a in atoms:
+        syst.CREATE_ATOM( Atom(U, {"Atom_element":a[0], "Atom_cm_x":a[1]*Angst, "Atom_cm_y":a[2]*Angst, "Atom_cm_z":a[3]*Angst}) )
+
+    ham = listHamiltonian_QM("control_parameters_indo.dat", syst)
+    # scf_oda_disk implements only the density mixing, so use it in both SCF procedures
+    ham.prms.scf_algo = "oda"
+    ham.prms.use_damping = 1
+    ham.prms.damping_const = 0.5
+    ham.prms.use_disk = use_disk
+    ham.prms.scf_mem_cap = mem_cap
+    ham.prms.scf_mem_single = mem_single
+    ham.prms.scf_scratch_dir = scratch_dir
+    return ham.compute_scf(syst)
+
+
+
+class Test_SCF_Store(unittest.TestCase):
+
+    def test_1(self):
+        """Round trip of the matrices kept in double precision, in single precision and in the scratch files"""
+
+        random.seed(0)
+        n = 4    # one matrix is 128 bytes in double and 64 bytes in single precision
+        root = tempfile.mkdtemp()
+
+        store = SCF_store(200.0, 1, root)
+        A, B, C = make_matrix(n), make_matrix(n), make_matrix(n)
+        store.put("A", A)
+        store.put("B", B)
+        store.put("C", C)
+
+        self.assertEqual(store.get_mode("A"), 0)
+        self.assertEqual(store.get_mode("B"), 1)
+        self.assertEqual(store.get_mode("C"), 2)
+        self.assertEqual(store.get_mode("D"), -1)
+        self.assertAlmostEqual(store.mem_used, 192.0, places=10)
+
+        scratch = store.scratch_dir
+        self.assertTrue(os.path.isfile(os.path.join(scratch, "C.bin")))
+
+        X = MATRIX(n, n)
+        store.get("A", X);  self.assertEqual(max_diff(X, A), 0.0)
+        store.get("B", X);  self.assertLess(max_diff(X, B), 1e-7)
+        store.get("C", X);  self.assertEqual(max_diff(X, C), 0.0)
+
+        # Overwriting keeps the storage type of the entry
+        for name in ["A", "B", "C"]:
+            D = make_matrix(n)
+            store.put(name, D)
+            store.get(name, X)
+            self.assertLess(max_diff(X, D), 1e-7)
+        self.assertEqual(store.get_mode("C"), 2)
+
+        # The scratch files and the directory are removed with the store
+        del store
+        self.assertFalse(os.path.exists(scratch))
+        os.rmdir(root)
+
+
+    def test_2(self):
+        """Without the single precision, all the matrices past the budget go to the files; no budget - all in RAM"""
+
+        random.seed(1)
+        n = 4
+        root = tempfile.mkdtemp()
+
+        store = SCF_store(200.0, 0, root)
+        A, B = make_matrix(n), make_matrix(n)
+        store.put("A", A)
+        store.put("B", B)
+        self.assertEqual(store.get_mode("A"), 0)
+        self.assertEqual(store.get_mode("B"), 2)
+
+        X = MATRIX(n, n)
+        store.get("B", X);  self.assertEqual(max_diff(X, B), 0.0)
+        del store
+
+        store = SCF_store(0.0, 1, root)
+        for k in range(10):
+            store.put("M%i" % k, make_matrix(n))
+            self.assertEqual(store.get_mode("M%i" % k), 0)
+        self.assertEqual(store.scratch_dir, "")
+        del store
+        os.rmdir(root)
+
+
+
+class Test_SCF_oda_disk(unittest.TestCase):
+
+    def setUp(self):
+        """INDO writes its scratch files (deri.*.bin, dV_AB.*.bin, ...) into the current directory, so run in a temporary one"""
+        self.cwd = os.getcwd()
+        self.tmp = tempfile.mkdtemp()
+        for f in ["control_parameters_indo.dat", "params_indo"]:
+            shutil.copy(os.path.join(DATA, f), self.tmp)
+        os.chdir(self.tmp)
+
+    def tearDown(self):
+        os.chdir(self.cwd)
+        shutil.rmtree(self.tmp)
+
+
+    def test_1(self):
+        """scf_oda_disk with a memory budget of a few matrices gives the same energy as scf_oda,
+        with and without the single precision storage, for the closed and open shell systems"""
+
+        U = make_universe()
+        scratch = os.path.join(self.tmp, "scratch")
+        os.mkdir(scratch)
+
+        for atoms in [CH4, CH4[:4]]:
+            E_ref = scf_energy(U, atoms, 0)
+
+            # No budget: all the matrices are in RAM
+            E = scf_energy(U, atoms, 1)
+            self.assertAlmostEqual(E, E_ref, places=10)
+
+            # An 8 x 8 matrix takes 512 bytes, so only the first two fit into the budget;
+            # the rest are spilled to the scratch files
+            E = scf_energy(U, atoms, 1, 0.001, 0, scratch)
+            self.assertAlmostEqual(E, E_ref, places=10)
+
+            # Same, but some of the matrices are kept in single precision
+            E = scf_energy(U, atoms, 1, 0.001, 1, scratch)
+            self.assertAlmostEqual(E, E_ref, places=5)
+
+            # The per-job scratch directories are removed at the end of the SCF
+            self.assertEqual(os.listdir(scratch), [])
+
+
+
+if __name__=='__main__':
+    unittest.main()
@@ -0,0 +1,171 @@
+#*********************************************************************************
+#* Copyright (C) 2017 Alexey V. Akimov
+#*
+#* This file is distributed under the terms of the GNU General Public License
+#* as published by the Free Software Foundation, either version 2 of
+#* the License, or (at your option) any later version.
+#* See the file LICENSE in the root directory of this distribution
+#* or <http://www.gnu.org/licenses/>.
+#*
+#*********************************************************************************/
+"""
+ Tests for the persistent Verlet neighbor list with a skin distance
+"""
+
+import os
+import sys
+import math
+import random
+import unittest
+
+if sys.platform=="cygwin":
+    from cyglibra_core import *
+elif sys.platform=="linux" or sys.platform=="linux2":
+    from liblibra_core import *
+
+
+def make_system(nat, L):
+    R = MATRIX(3*nat, 1)
+    for i in range(3*nat):
+        R.set(i, 0, L*random.random())
+    return R
+
+def displace(R, dx):
+    for i in range(R.num_of_rows):
+        R.set(i, 0, R.get(i,0) + dx*(random.random()-0.5))
+
+def count_within(vlist, R, tv, Roff):
+    """ Number of distinct pairs in the list within the cutoff distance """
+    t1, t2, t3 = tv
+    nat = R.num_of_rows // 3
+    res = 0
+    for i in range(nat):
+        ri = VECTOR(R.get(3*i,0), R.get(3*i+1,0), R.get(3*i+2,0))
+        for is_central, j, n1, n2, n3 in vlist.get_neighbors(i):
+            if is_central==1 and i==j:
+                continue
+            rj = VECTOR(R.get(3*j,0), R.get(3*j+1,0), R.get(3*j+2,0))
+            if (ri - rj - n1*t1 - n2*t2 - n3*t3).length() <= Roff:
+                res += 1
+    return res
+
+def count_bruteforce(R, tv, Roff, nmax=2):
+    t1, t2, t3 = tv
+    nat = R.num_of_rows // 3
+    res = 0
+    for i in range(nat):
+        ri = VECTOR(R.get(3*i,0), R.get(3*i+1,0), R.get(3*i+2,0))
+        for j in range(i, nat):
+            rj = VECTOR(R.get(3*j,0), R.get(3*j+1,0), R.get(3*j+2,0))
+            for n1 in range(-nmax, nmax+1):
+                for n2 in range(-nmax, nmax+1):
+                    for n3 in range(-nmax, nmax+1):
+                        if i==j and n1==0 and n2==0 and n3==0:
+                            continue
+                        if (ri - rj - n1*t1 - n2*t2 - n3*t3).length() <= Roff:
+                            res += 1
+    return res
+
+def make_lattice(n, L, dx):
+    """ Simple cubic lattice of n^3 atoms with random displacements """
+    a = L / n
+    r = VECTORList()
+    for i in range(n):
+        for j in range(n):
+            for k in range(n):
+                r.append(VECTOR(a*(i + 0.5) + dx*(random.random()-0.5),
+                                a*(j + 0.5) + dx*(random.random()-0.5),
+                                a*(k + 0.5) + dx*(random.random()-0.5)))
+    return r
+
+def to_matrix(r):
+    R = MATRIX(3*len(r), 1)
+    for i in range(len(r)):
+        R.set(3*i, 0, r[i].x);  R.set(3*i+1, 0, r[i].y);  R.set(3*i+2, 0, r[i].z)
+    return R
+
+
+
+class Test_VerletList(unittest.TestCase):
+
+    def test_1(self):
+        """The list stays complete while atoms move and is only rebuilt when needed"""
+
+        random.seed(0)
+        L, Roff, skin = 14.0, 5.0, 1.0
+        tv = [VECTOR(L, 0.0, 0.0), VECTOR(0.0, L, 0.0), VECTOR(0.0, 0.0, L)]
+        box = MATRIX3x3(tv[0], tv[1], tv[2])
+        R = make_system(40, L)
+
+        vlist = VerletList(Roff, skin)
+        self.assertEqual(vlist.update(R, box), 1)
+
+        for step in range(10):
+            displace(R, 0.05)
+            vlist.update(R, box)
+            self.assertEqual(count_within(vlist, R, tv, Roff), count_bruteforce(R, tv, Roff))
+
+        self.assertEqual(vlist.nupdates, 11)
+        self.assertTrue(vlist.nbuilds < vlist.nupdates)
+
+
+    def test_2(self):
+        """Large displacement triggers the rebuild"""
+
+        random.seed(1)
+        L = 14.0
+        box = MATRIX3x3(VECTOR(L, 0.0, 0.0), VECTOR(0.0, L, 0.0), VECTOR(0.0, 0.0, L))
+        R = make_system(10, L)
+
+        vlist = VerletList(5.0, 1.0)
+        vlist.update(R, box)
+        self.assertEqual(vlist.update(R, box), 0)
+
+        R.set(0, 0, R.get(0,0) + 0.6)  # > skin/2
+        self.assertEqual(vlist.update(R, box), 1)
+
+
+    def test_3(self):
+        """Vdw_LJ2_vlist gives the same energy, forces and stress as Vdw_LJ2_no_excl, also after the rebuilds"""
+
+        for is_cutoff, R_on, R_off in [[0, 3.5, 4.0], [1, 3.5, 4.0]]:
+            random.seed(2)
+            L, skin, n = 14.0, 1.0, 4
+            box = MATRIX3x3(VECTOR(L, 0.0, 0.0), VECTOR(0.0, L, 0.0), VECTOR(0.0, 0.0, L))
+            r = make_lattice(n, L, 0.5)
+            nat = len(r)
+            epsilon, sigma = doubleList(), doubleList()
+            for i in range(nat):
+                epsilon.append(0.1 + 0.05*random.random())
+                sigma.append(2.5 + 0.5*random.random())
+
+            vlist = VerletList(R_off, skin)
+
+            for step in range(8):
+                f1, f2 = VECTORList(), VECTORList()
+                at1, fr1, at2, fr2 = MATRIX3x3(), MATRIX3x3(), MATRIX3x3(), MATRIX3x3()
+
+                e1 = Vdw_LJ2_no_excl(r, epsilon, sigma, box, f1, at1, fr1, is_cutoff, R_on, R_off)
+                e2 = Vdw_LJ2_vlist(r, epsilon, sigma, box, f2, at2, fr2, is_cutoff, R_on, R_off, vlist)
+
+                self.assertAlmostEqual(e1, e2, places=10)
+                for i in range(nat):
+                    self.assertAlmostEqual((f1[i] - f2[i]).length(), 0.0, places=10)
+                for a in ["xx", "xy", "xz", "yx", "yy", "yz", "zx", "zy", "zz"]:
+                    x1, x2 = getattr(fr1, a), getattr(fr2, a)
+                    self.assertAlmostEqual(x1, x2, delta=1e-10*max(1.0, abs(x1)))
+
+                # Displacements of up to 0.2 per step: the list is rebuilt a few times
+                for i in range(nat):
+                    r[i] = VECTOR(r[i].x + 0.4*(random.random()-0.5),
+                                  r[i].y + 0.4*(random.random()-0.5),
+                                  r[i].z + 0.4*(random.random()-0.5))
+
+            self.assertEqual(vlist.nupdates, 8)
+            self.assertTrue(vlist.nbuilds > 1)
+            self.assertTrue(vlist.nbuilds < vlist.nupdates)
+
+
+
+if __name__=='__main__':
+    unittest.main()